@@ -0,0 +1,642 @@
+/************************************************************************************
+*		FILE:		"nsbench.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Loopback benchmarks for the TCP function table, so a
+*					change to New_Send / New_Recv or the nowait wrappers
+*					can be measured. Needs nothing outside the process:
+*					the server side is an in-process sharded server.
+*
+*		Notes:		Linux only. Build and run:
+*
+*					gcc -O2 -o nsbench NSBENCH.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./nsbench [-t test] [-m blocking|nowait] [-n count]
+*					          [-s seconds] [-c connections] [-e epoll|io_uring]
+*
+*					tests: pingpong, stream, connect, fanin (default all).
+*					Each result is one JSON object per line on stdout, for
+*					diffing against an earlier run; progress goes to stderr.
+*
+*					Latencies are round trips in microseconds, including
+*					the in-process server's share of the CPU.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.10.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Fan-in short reads counted; stream drain bounded
+*		1.25.1	  10/17/26		Server side is tcp_loopback_start
+*************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "NSSHARD.h"
+#include <sys/resource.h>
+
+/* bytes of receive buffer per server connection slot */
+#define BENCH_SLOT_BUFFER		16384
+#define BENCH_MAX_CONNECTIONS		8192
+
+/* completion tags used by the client */
+#define BENCH_TAG_SEND			1
+#define BENCH_TAG_RECV			2
+#define BENCH_TAG_CONNECT		3
+
+typedef struct bench_options
+{
+	const char			*test;
+	int				nowait;
+	int				both_modes;
+	long				count;
+	double				seconds;
+	int				connections;
+	int				engine;
+} BENCH_OPTIONS;
+
+
+/***************************************************************************************
+*						SERVER SIDE
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Bench_Server_Start
+*
+* FUNCTION:             One-shard loopback echo or sink server
+*                       (tcp_loopback_start) on a free port.
+*
+* RETURNS:              int - 0, -1 on failure
+***************************************************************/
+static int Bench_Server_Start ( TCP_LOOPBACK *bench, BENCH_OPTIONS *options, int mode )
+{
+	memset ( bench, 0, sizeof ( *bench ) );
+	bench->mode = mode;
+	bench->slot = BENCH_SLOT_BUFFER;
+
+	strcpy ( bench->config.ipaddr, "127.0.0.1" );
+	bench->config.shards = 1;
+	bench->config.max_connections = BENCH_MAX_CONNECTIONS;
+	bench->config.engine = options->engine;
+
+	return tcp_loopback_start ( bench );
+}
+
+
+/***************************************************************************************
+*						CLIENT SIDE
+***************************************************************************************/
+
+static double Bench_Seconds ( long long start )
+{
+	return ( tcp_clock_usec ( ) - start ) / 1e6;
+}
+
+static int Bench_Compare ( const void *a, const void *b )
+{
+	long long x = *( const long long * ) a;
+	long long y = *( const long long * ) b;
+
+	return x < y ? -1 : x > y;
+}
+
+/***************************************************************
+*
+* NAME:                           Bench_Percentiles
+*
+* FUNCTION:             Sorts the samples and prints the latency
+*                       part of a result line.
+*
+***************************************************************/
+static void Bench_Percentiles ( long long *samples, long count )
+{
+	double sum = 0;
+	long   i;
+
+	qsort ( samples, count, sizeof ( long long ), Bench_Compare );
+	for ( i = 0; i < count; i++ )
+		sum += samples[i];
+
+	printf ( ",\"min_us\":%lld,\"mean_us\":%.2f,\"p50_us\":%lld,\"p99_us\":%lld,\"p999_us\":%lld,\"max_us\":%lld"
+		   , samples[0]
+		   , sum / count
+		   , samples[count / 2]
+		   , samples[( long ) ( count * 0.99 )]
+		   , samples[( long ) ( count * 0.999 )]
+		   , samples[count - 1] );
+}
+
+/***************************************************************
+*
+* NAME:                           Bench_Connect
+*
+* FUNCTION:             Opens a client connection to the server,
+*                       blocking or through connect_nw.
+*
+* RETURNS:              TCP_CONNECTION_INFO * - 0 on failure
+***************************************************************/
+static TCP_CONNECTION_INFO *Bench_Connect ( TCP *tcp, TCP_PORT port, int nowait )
+{
+	TCP_CONNECTION_INFO	*connection = tcp->get_conn_info ( );
+	TCP_COMPLETION		 completion;
+	int			 on = 1;
+	int			 status;
+
+	if ( !connection )
+		return 0;
+
+	strcpy ( connection->ipaddr, "127.0.0.1" );
+	connection->port = port;
+	tcp->set_sockaddr ( connection, AF_INET );
+
+	if ( nowait )
+	{
+		tcp->get_sock_nw ( connection, AF_INET, SOCK_STREAM, 0, 0 );
+		tcp->set_addtionals ( connection, 0, 0, BENCH_TAG_CONNECT, sizeof ( struct sockaddr_in ) );
+		status = tcp->make_connect_nw ( connection );
+		if ( status == 0 )
+		{
+			status = tcp->reap_completions ( &completion, 1, -1 ) == 1 && !completion.error ? 0 : -1;
+		}
+	}
+	else
+	{
+		tcp->get_sock ( connection, AF_INET, SOCK_STREAM, 0 );
+		status = tcp->make_connect ( connection );
+	}
+
+	if ( status < 0 )
+	{
+		tcp->close_sock ( connection );
+		tcp->clean_conn_info ( connection );
+		return 0;
+	}
+
+	setsockopt ( *connection->sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+	return connection;
+}
+
+static void Bench_Disconnect ( TCP *tcp, TCP_CONNECTION_INFO *connection )
+{
+	tcp->close_sock ( connection );
+	tcp->clean_conn_info ( connection );
+}
+
+/***************************************************************
+*
+* NAME:                           Bench_Round_Trip
+*
+* FUNCTION:             Sends length bytes and waits for all of
+*                       them to come back.
+*
+* RETURNS:              int - 0, -1 on failure
+***************************************************************/
+static int Bench_Round_Trip ( TCP *tcp, TCP_CONNECTION_INFO *connection, char *out, char *in, int length, int nowait )
+{
+	TCP_COMPLETION	completions[2];
+	int		got = 0;
+	int		sent = 0;
+	int		count;
+	int		i;
+
+	if ( !nowait )
+	{
+		if ( tcp->new_send ( connection, out, length ) != length )
+			return -1;
+		while ( got < length )
+		{
+			count = tcp->new_recv ( connection, in + got, length - got );
+			if ( count <= 0 )
+				return -1;
+			got += count;
+		}
+		return 0;
+	}
+
+	connection->tag = BENCH_TAG_SEND;
+	if ( tcp->new_send_nw ( connection, out, length ) < 0 )
+		return -1;
+	connection->tag = BENCH_TAG_RECV;
+	if ( tcp->new_recv_nw ( connection, in, length ) < 0 )
+		return -1;
+
+	while ( got < length || sent < length )
+	{
+		count = tcp->reap_completions ( completions, 2, -1 );
+		if ( count <= 0 )
+			return -1;
+		for ( i = 0; i < count; i++ )
+		{
+			if ( completions[i].error )
+				return -1;
+			if ( completions[i].tag == BENCH_TAG_SEND )
+			{
+				sent += ( int ) completions[i].count;
+				if ( sent < length )
+				{
+					connection->tag = BENCH_TAG_SEND;
+					tcp->new_send_nw ( connection, out + sent, length - sent );
+				}
+			}
+			else
+			{
+				if ( completions[i].count <= 0 )
+					return -1;
+				got += ( int ) completions[i].count;
+				if ( got < length )
+				{
+					connection->tag = BENCH_TAG_RECV;
+					tcp->new_recv_nw ( connection, in + got, length - got );
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+
+/***************************************************************************************
+*						BENCHMARKS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Bench_Pingpong
+*
+* FUNCTION:             Round-trip latency on one connection, for a
+*                       few message sizes.
+*
+***************************************************************/
+static void Bench_Pingpong ( TCP *tcp, BENCH_OPTIONS *options, int nowait )
+{
+	static const int	 sizes[] = { 64, 1024, 16384 };
+	TCP_LOOPBACK		 bench;
+	TCP_CONNECTION_INFO	*connection;
+	long long		*samples;
+	long long		 start;
+	long long		 t0;
+	char			*out;
+	char			*in;
+	long			 i;
+	unsigned		 s;
+
+	if ( Bench_Server_Start ( &bench, options, TCP_LOOPBACK_ECHO ) < 0 )
+		return;
+	samples = ( long long * ) malloc ( options->count * sizeof ( long long ) );
+	out = ( char * ) malloc ( BENCH_SLOT_BUFFER );
+	in = ( char * ) malloc ( BENCH_SLOT_BUFFER );
+	memset ( out, 'p', BENCH_SLOT_BUFFER );
+
+	connection = Bench_Connect ( tcp, bench.config.port, nowait );
+	for ( s = 0; connection && s < sizeof ( sizes ) / sizeof ( sizes[0] ); s++ )
+	{
+		/* warm up */
+		for ( i = 0; i < 100; i++ )
+			Bench_Round_Trip ( tcp, connection, out, in, sizes[s], nowait );
+
+		start = tcp_clock_usec ( );
+		for ( i = 0; i < options->count; i++ )
+		{
+			t0 = tcp_clock_usec ( );
+			if ( Bench_Round_Trip ( tcp, connection, out, in, sizes[s], nowait ) < 0 )
+				break;
+			samples[i] = tcp_clock_usec ( ) - t0;
+		}
+		if ( !i )
+			break;
+
+		printf ( "{\"bench\":\"pingpong\",\"mode\":\"%s\",\"engine\":%d,\"size\":%d,\"count\":%ld,\"ops_per_sec\":%.0f"
+			   , nowait ? "nowait" : "blocking", tcp->engine, sizes[s], i, i / Bench_Seconds ( start ) );
+		Bench_Percentiles ( samples, i );
+		printf ( "}\n" );
+		fflush ( stdout );
+	}
+
+	if ( connection )
+		Bench_Disconnect ( tcp, connection );
+	tcp_loopback_stop ( &bench );
+	free ( samples );
+	free ( out );
+	free ( in );
+}
+
+/***************************************************************
+*
+* NAME:                           Bench_Stream
+*
+* FUNCTION:             One-way throughput into a sink, for a few
+*                       write sizes. Timed until the server has
+*                       taken every byte.
+*
+***************************************************************/
+static void Bench_Stream ( TCP *tcp, BENCH_OPTIONS *options, int nowait )
+{
+	static const int	 sizes[] = { 64, 1024, 16384, 65536 };
+	TCP_LOOPBACK		 bench;
+	TCP_CONNECTION_INFO	*connection;
+	TCP_COMPLETION		 completion;
+	long long		 start;
+	long long		 stop;
+	double			 send_time;
+	long			 sent;
+	long			 writes;
+	long			 base;
+	char			*out;
+	int			 status;
+	unsigned		 s;
+
+	if ( Bench_Server_Start ( &bench, options, TCP_LOOPBACK_SINK ) < 0 )
+		return;
+	out = ( char * ) malloc ( 65536 );
+	memset ( out, 's', 65536 );
+
+	connection = Bench_Connect ( tcp, bench.config.port, nowait );
+	for ( s = 0; connection && s < sizeof ( sizes ) / sizeof ( sizes[0] ); s++ )
+	{
+		base = __atomic_load_n ( &bench.sunk, __ATOMIC_RELAXED );
+		sent = 0;
+		writes = 0;
+		start = tcp_clock_usec ( );
+		stop = start + ( long long ) ( options->seconds * 1e6 );
+
+		while ( tcp_clock_usec ( ) < stop )
+		{
+			if ( nowait )
+			{
+				connection->tag = BENCH_TAG_SEND;
+				status = -1;
+				if ( tcp->new_send_nw ( connection, out, sizes[s] ) == 0
+				  && tcp->reap_completions ( &completion, 1, -1 ) == 1 && !completion.error )
+					status = ( int ) completion.count;
+			}
+			else
+				status = tcp->new_send ( connection, out, sizes[s] );
+			if ( status < 0 )
+				break;
+			sent += status;
+			writes++;
+		}
+
+		/* until the server has it all, or gave up on the connection */
+		send_time = Bench_Seconds ( start );
+		while ( __atomic_load_n ( &bench.sunk, __ATOMIC_RELAXED ) - base < sent && Bench_Seconds ( start ) < send_time + 5 )
+			usleep ( 100 );
+
+		printf ( "{\"bench\":\"stream\",\"mode\":\"%s\",\"engine\":%d,\"size\":%d,\"writes\":%ld,\"bytes\":%ld,"
+				 "\"mb_per_sec\":%.1f,\"writes_per_sec\":%.0f}\n"
+			   , nowait ? "nowait" : "blocking", tcp->engine, sizes[s], writes, sent
+			   , sent / Bench_Seconds ( start ) / 1e6, writes / Bench_Seconds ( start ) );
+		fflush ( stdout );
+	}
+
+	if ( connection )
+		Bench_Disconnect ( tcp, connection );
+	tcp_loopback_stop ( &bench );
+	free ( out );
+}
+
+/***************************************************************
+*
+* NAME:                           Bench_Connect_Rate
+*
+* FUNCTION:             Connect + close as fast as possible; the
+*                       server's accept count gives accepts/sec.
+*
+***************************************************************/
+static void Bench_Connect_Rate ( TCP *tcp, BENCH_OPTIONS *options, int nowait )
+{
+	TCP_LOOPBACK		 bench;
+	TCP_CONNECTION_INFO	*connection;
+	long long		 start;
+	double			 connect_time;
+	long			 count = options->count < 5000 ? options->count : 5000;
+	long			 done;
+
+	if ( Bench_Server_Start ( &bench, options, TCP_LOOPBACK_ECHO ) < 0 )
+		return;
+
+	start = tcp_clock_usec ( );
+	for ( done = 0; done < count; done++ )
+	{
+		connection = Bench_Connect ( tcp, bench.config.port, nowait );
+		if ( !connection )
+			break;
+		Bench_Disconnect ( tcp, connection );
+	}
+	connect_time = Bench_Seconds ( start );
+
+	while ( bench.server->shards[0].accepted < done && Bench_Seconds ( start ) < connect_time + 5 )
+		usleep ( 100 );
+
+	printf ( "{\"bench\":\"connect\",\"mode\":\"%s\",\"engine\":%d,\"count\":%ld,"
+			 "\"connects_per_sec\":%.0f,\"accepts_per_sec\":%.0f}\n"
+		   , nowait ? "nowait" : "blocking", tcp->engine, done
+		   , done / connect_time, bench.server->shards[0].accepted / Bench_Seconds ( start ) );
+	fflush ( stdout );
+
+	tcp_loopback_stop ( &bench );
+}
+
+/***************************************************************
+*
+* NAME:                           Bench_Fanin
+*
+* FUNCTION:             Many connections into one server shard; every
+*                       connection does a 64-byte round trip per round.
+*                       Reports messages/sec and per-round latency.
+*
+***************************************************************/
+static void Bench_Fanin ( TCP *tcp, BENCH_OPTIONS *options, int nowait )
+{
+	TCP_LOOPBACK		  bench;
+	TCP_CONNECTION_INFO	**connections;
+	TCP_CONN_TABLE		 *table = 0;
+	TCP_HANDLE		 *handles = 0;
+	TCP_COMPLETION		  completions[TCP_COMPLETION_BATCH];
+	long long		 *samples;
+	long long		  start;
+	long long		  t0;
+	char			  out[64];
+	char			 *in;
+	long			  rounds;
+	long			  round;
+	int			  open;
+	int			  pending;
+	int			  count;
+	int			  i;
+
+	if ( Bench_Server_Start ( &bench, options, TCP_LOOPBACK_ECHO ) < 0 )
+		return;
+
+	rounds = options->count / options->connections;
+	if ( rounds < 10 )
+		rounds = 10;
+	connections = ( TCP_CONNECTION_INFO ** ) calloc ( options->connections, sizeof ( *connections ) );
+	samples = ( long long * ) malloc ( rounds * sizeof ( long long ) );
+	in = ( char * ) malloc ( ( size_t ) options->connections * 64 );
+	memset ( out, 'f', sizeof ( out ) );
+
+	for ( open = 0; open < options->connections; open++ )
+	{
+		connections[open] = Bench_Connect ( tcp, bench.config.port, nowait );
+		if ( !connections[open] )
+			break;
+	}
+	fprintf ( stderr, "fanin: %d connections open\n", open );
+
+	if ( nowait && open )
+	{
+		table = conn_table_new ( open );
+		handles = ( TCP_HANDLE * ) malloc ( open * sizeof ( TCP_HANDLE ) );
+		for ( i = 0; i < open; i++ )
+			handles[i] = conn_add ( table, *connections[i]->sock, TCP_CONN_CONNECTED, i );
+	}
+
+	start = tcp_clock_usec ( );
+	for ( round = 0; open && round < rounds; round++ )
+	{
+		t0 = tcp_clock_usec ( );
+		if ( nowait )
+		{
+			/* 64 bytes fit any socket buffer, so a send completes whole */
+			for ( i = 0; i < open; i++ )
+			{
+				conn_send_nw ( table, handles[i], out, sizeof ( out ) );
+				conn_recv_nw ( table, handles[i], in + ( size_t ) i * 64, 64 );
+			}
+			for ( pending = 2 * open; pending > 0; pending -= count )
+			{
+				count = tcp->reap_completions ( completions, TCP_COMPLETION_BATCH, 500 );
+				if ( count <= 0 )
+					break;
+				for ( i = 0; i < count; i++ )
+				{
+					conn_complete ( table, &completions[i] );
+					/* a short read: read the rest as part of this round */
+					if ( !( ( unsigned long ) completions[i].tag & TCP_CONN_TAG_SEND )
+					  && completions[i].count > 0 && completions[i].count < 64 )
+					{
+						pending++;
+						conn_recv_nw ( table, conn_by_fd ( table, completions[i].sock )
+									 , completions[i].buffer + completions[i].count
+									 , 64 - ( int ) completions[i].count );
+					}
+				}
+			}
+			if ( pending > 0 )
+				break;
+		}
+		else
+		{
+			for ( i = 0; i < open; i++ )
+				if ( tcp->new_send ( connections[i], out, sizeof ( out ) ) != sizeof ( out ) )
+					break;
+			for ( i = 0; i < open; i++ )
+				for ( count = 0; count < 64; count += pending )
+					if ( ( pending = tcp->new_recv ( connections[i], in, 64 - count ) ) <= 0 )
+						break;
+		}
+		samples[round] = tcp_clock_usec ( ) - t0;
+	}
+
+	if ( round )
+	{
+		printf ( "{\"bench\":\"fanin\",\"mode\":\"%s\",\"engine\":%d,\"connections\":%d,\"rounds\":%ld,\"msgs_per_sec\":%.0f"
+			   , nowait ? "nowait" : "blocking", tcp->engine, open, round
+			   , ( double ) round * open / Bench_Seconds ( start ) );
+		Bench_Percentiles ( samples, round );
+		printf ( "}\n" );
+		fflush ( stdout );
+	}
+
+	for ( i = 0; i < open; i++ )
+		Bench_Disconnect ( tcp, connections[i] );
+	conn_table_free ( table );
+	tcp_loopback_stop ( &bench );
+	free ( handles );
+	free ( connections );
+	free ( samples );
+	free ( in );
+}
+
+/***************************************************************
+*
+* NAME:                           Bench_Usage
+*
+***************************************************************/
+static void Bench_Usage ( const char *name )
+{
+	fprintf ( stderr, "usage: %s [-t pingpong|stream|connect|fanin] [-m blocking|nowait]\n"
+					  "          [-n count] [-s seconds] [-c connections] [-e epoll|io_uring]\n", name );
+	exit ( 2 );
+}
+
+int main ( int argc, char **argv )
+{
+	BENCH_OPTIONS	options;
+	struct rlimit	limit;
+	TCP		*tcp;
+	int		opt;
+	int		mode;
+
+	memset ( &options, 0, sizeof ( options ) );
+	options.test = "all";
+	options.both_modes = 1;
+	options.count = 20000;
+	options.seconds = 1.0;
+	options.connections = 1000;
+	options.engine = TCP_ENGINE_DEFAULT;
+
+	while ( ( opt = getopt ( argc, argv, "t:m:n:s:c:e:h" ) ) != -1 )
+	{
+		switch ( opt )
+		{
+		case 't': options.test = optarg; break;
+		case 'm': options.both_modes = 0; options.nowait = !strcmp ( optarg, "nowait" ); break;
+		case 'n': options.count = atol ( optarg ); break;
+		case 's': options.seconds = atof ( optarg ); break;
+		case 'c': options.connections = atoi ( optarg ); break;
+		case 'e': options.engine = !strcmp ( optarg, "io_uring" ) ? TCP_ENGINE_IO_URING : TCP_ENGINE_EPOLL; break;
+		default: Bench_Usage ( argv[0] );
+		}
+	}
+	if ( options.count <= 0 || options.connections <= 0 || options.connections > BENCH_MAX_CONNECTIONS )
+		Bench_Usage ( argv[0] );
+
+	/* both ends of every fan-in connection live in this process */
+	if ( getrlimit ( RLIMIT_NOFILE, &limit ) == 0 )
+	{
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit ( RLIMIT_NOFILE, &limit );
+	}
+
+	tcp = intialize_tcp_engine ( options.engine );
+	if ( !tcp )
+		return 1;
+
+	for ( mode = 0; mode < 2; mode++ )
+	{
+		if ( !options.both_modes && mode != options.nowait )
+			continue;
+
+		if ( !strcmp ( options.test, "all" ) || !strcmp ( options.test, "pingpong" ) )
+			Bench_Pingpong ( tcp, &options, mode );
+		if ( !strcmp ( options.test, "all" ) || !strcmp ( options.test, "stream" ) )
+			Bench_Stream ( tcp, &options, mode );
+		if ( !strcmp ( options.test, "all" ) || !strcmp ( options.test, "connect" ) )
+			Bench_Connect_Rate ( tcp, &options, mode );
+		if ( !strcmp ( options.test, "all" ) || !strcmp ( options.test, "fanin" ) )
+			Bench_Fanin ( tcp, &options, mode );
+	}
+
+	release_tcp ( tcp );
+	tcp_thread_exit ( );
+	return 0;
+}
@@ -0,0 +1,383 @@
+/************************************************************************************
+*		FILE:		"nscapt.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Traffic capture to a memory-mapped file. See nscapt.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.22.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nscapth"
+#include "=nsstatsh"
+#else
+#include "NSCAPT.h"
+#include "NSSTATS.h"
+#include <sys/mman.h>
+#include <sys/time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int tcp_capture_on;
+
+#ifndef __TANDEM
+#define CAPT_LOAD(p)			__atomic_load_n ( p, __ATOMIC_ACQUIRE )
+#define CAPT_STORE(p, v)		__atomic_store_n ( p, v, __ATOMIC_RELEASE )
+#define CAPT_ADD(p, v)			__atomic_fetch_add ( p, v, __ATOMIC_RELAXED )
+
+static TCP_CAPTURE_HEADER	*capt_map;
+static int			 capt_fd = -1;
+static long long		 capt_capacity;		/* bytes for records */
+static unsigned			 capt_generation;	/* capture_start count */
+static unsigned short		 capt_threads;
+
+/* the calling thread's ring */
+static TCP_THREAD_LOCAL char		*capt_ring;
+static TCP_THREAD_LOCAL long		 capt_used;
+static TCP_THREAD_LOCAL long		 capt_records;
+static TCP_THREAD_LOCAL unsigned	 capt_ring_generation;
+static TCP_THREAD_LOCAL unsigned short	 capt_thread;
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+#ifndef __TANDEM
+/***************************************************************
+*
+* NAME:                           Capt_Reserve
+*
+* FUNCTION:             Takes bytes of the file for the records at
+*                       data. Where the file ends part way, the
+*                       records that fit are kept; the rest are
+*                       counted as dropped.
+*
+* RETURNS:              long long - offset to write them at, -1
+*                       when none fit; *bytes is cut to what fits
+***************************************************************/
+static long long Capt_Reserve ( TCP_CAPTURE_HEADER *map, const char *data, long *bytes, long records )
+{
+	long long	offset = CAPT_ADD ( &map->tail, ( long long ) *bytes );
+	long		fits = 0;
+	long		kept = 0;
+
+	if ( offset + *bytes > capt_capacity )
+	{
+		while ( kept < records && offset + fits < capt_capacity
+		     && offset + fits + ( ( const TCP_CAPTURE_RECORD * ) ( data + fits ) )->size <= capt_capacity )
+		{
+			fits += ( ( const TCP_CAPTURE_RECORD * ) ( data + fits ) )->size;
+			kept++;
+		}
+		CAPT_ADD ( &map->dropped, ( long long ) ( records - kept ) );
+		*bytes = fits;
+		records = kept;
+		if ( !kept )
+			return -1;
+	}
+
+	CAPT_ADD ( &map->records, ( long long ) records );
+	return offset;
+}
+
+/***************************************************************
+*
+* NAME:                           Capt_Ring
+*
+* FUNCTION:             The calling thread's ring, made on first
+*                       use. What is left in it from an earlier
+*                       capture is thrown away.
+*
+* RETURNS:              int - 0, or -1 when out of memory
+***************************************************************/
+static int Capt_Ring ( void )
+{
+	unsigned generation = CAPT_LOAD ( &capt_generation );
+
+	if ( !capt_ring )
+	{
+		capt_ring = ( char * ) malloc ( TCP_CAPTURE_RING );
+		if ( !capt_ring )
+			return -1;
+		capt_thread = ( unsigned short ) ( CAPT_ADD ( &capt_threads, 1 ) + 1 );
+	}
+	if ( capt_ring_generation != generation )
+	{
+		capt_used = 0;
+		capt_records = 0;
+		capt_ring_generation = generation;
+	}
+
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Capt_Flush
+*
+* FUNCTION:             Moves the thread's ring to the file.
+*
+***************************************************************/
+static void Capt_Flush ( TCP_CAPTURE_HEADER *map )
+{
+	long long offset;
+	long      bytes = capt_used;
+
+	if ( !capt_used )
+		return;
+
+	offset = Capt_Reserve ( map, capt_ring, &bytes, capt_records );
+	if ( offset >= 0 )
+		memcpy ( ( char * ) ( map + 1 ) + offset, capt_ring, bytes );
+	capt_used = 0;
+	capt_records = 0;
+}
+#endif
+
+/***************************************************************
+*
+* NAME:                           capture_start
+*
+* FUNCTION:             Starts capturing to path, made (or emptied)
+*                       and size bytes long, keeping at most snap
+*                       bytes of each message (0 = all).
+*
+* RETURNS:              int - 0, or -1 when a capture is running
+*                       already, on bad arguments or when the file
+*                       can't be made
+***************************************************************/
+int capture_start ( const char *path, long size, long snap )
+{
+#ifdef __TANDEM
+	( void ) path;
+	( void ) size;
+	( void ) snap;
+	return -1;
+#else
+	TCP_CAPTURE_HEADER	*map;
+	struct timeval		 now;
+	int			 fd;
+
+	if ( CAPT_LOAD ( &capt_map ) || !path || snap < 0
+	  || size < ( long ) ( sizeof ( TCP_CAPTURE_HEADER ) + sizeof ( TCP_CAPTURE_RECORD ) ) )
+		return -1;
+
+	fd = open ( path, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+	if ( fd < 0 )
+		return -1;
+	if ( ftruncate ( fd, size ) < 0 )
+	{
+		close ( fd );
+		return -1;
+	}
+	map = ( TCP_CAPTURE_HEADER * ) mmap ( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	if ( map == MAP_FAILED )
+	{
+		close ( fd );
+		return -1;
+	}
+
+	gettimeofday ( &now, 0 );
+	memcpy ( map->magic, TCP_CAPTURE_MAGIC, sizeof ( map->magic ) );
+	map->size = size;
+	map->snap = snap;
+	map->start_usec = tcp_clock_usec ( );
+	map->wall_usec = ( long long ) now.tv_sec * 1000000 + now.tv_usec;
+
+	capt_fd = fd;
+	capt_capacity = size - ( long long ) sizeof ( TCP_CAPTURE_HEADER );
+	CAPT_ADD ( &capt_generation, 1 );
+	CAPT_STORE ( &capt_map, map );
+	CAPT_STORE ( &tcp_capture_on, 1 );
+	return 0;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           capture_stop
+*
+* FUNCTION:             Flushes the calling thread, unmaps the file
+*                       and cuts it to what was written.
+*
+* NOTE:                 Other threads must have flushed and stopped
+*                       sending first; their rings are not waited
+*                       for.
+*
+* RETURNS:              int - 0, or -1 when nothing is running
+***************************************************************/
+int capture_stop ( void )
+{
+#ifdef __TANDEM
+	return -1;
+#else
+	TCP_CAPTURE_HEADER	*map = CAPT_LOAD ( &capt_map );
+	long long		 used;
+	long long		 size;
+
+	if ( !map )
+		return -1;
+
+	capture_flush ( );
+	CAPT_STORE ( &tcp_capture_on, 0 );
+	CAPT_STORE ( &capt_map, ( TCP_CAPTURE_HEADER * ) 0 );
+
+	used = map->tail < capt_capacity ? map->tail : capt_capacity;
+	size = map->size;
+	map->size = ( long long ) sizeof ( TCP_CAPTURE_HEADER ) + used;
+	msync ( map, ( size_t ) size, MS_SYNC );
+	munmap ( map, ( size_t ) size );
+	if ( ftruncate ( capt_fd, ( off_t ) ( sizeof ( TCP_CAPTURE_HEADER ) + used ) ) < 0 )
+		used = -1;
+	close ( capt_fd );
+	capt_fd = -1;
+
+	return used < 0 ? -1 : 0;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           capture_flush
+*
+* FUNCTION:             Moves what the calling thread has captured
+*                       so far into the file.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void capture_flush ( void )
+{
+#ifndef __TANDEM
+	TCP_CAPTURE_HEADER *map = CAPT_LOAD ( &capt_map );
+
+	if ( map && capt_ring && capt_ring_generation == CAPT_LOAD ( &capt_generation ) )
+		Capt_Flush ( map );
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           capture_record
+*
+* FUNCTION:             Captures one message of length bytes (the
+*                       TCP_CAPTURE hook).
+*
+* RETURNS:                         nothing
+***************************************************************/
+void capture_record ( int type, int sock, const char *buffer, long length )
+{
+#ifdef __TANDEM
+	( void ) type;
+	( void ) sock;
+	( void ) buffer;
+	( void ) length;
+#else
+	TCP_CAPTURE_HEADER	*map = CAPT_LOAD ( &capt_map );
+	TCP_CAPTURE_RECORD	 record;
+	char			*place;
+	long			 saved;
+	long			 size;
+	long			 bytes;
+	long long		 offset;
+
+	if ( !map || length <= 0 || Capt_Ring ( ) < 0 )
+		return;
+
+	saved = map->snap && length > map->snap ? map->snap : length;
+	size = ( ( long ) sizeof ( record ) + saved + 7 ) & ~7L;
+
+	record.size = ( unsigned int ) size;
+	record.type = ( unsigned short ) type;
+	record.thread = capt_thread;
+	record.sock = sock;
+	record.length = ( unsigned int ) length;
+	record.saved = ( unsigned int ) saved;
+	record.pad = 0;
+	record.usec = tcp_clock_usec ( ) - map->start_usec;
+
+	if ( size > TCP_CAPTURE_RING )
+	{
+		/* keep the order: what is in the ring goes first */
+		Capt_Flush ( map );
+		bytes = size;
+		offset = Capt_Reserve ( map, ( const char * ) &record, &bytes, 1 );
+		place = offset < 0 ? 0 : ( char * ) ( map + 1 ) + offset;
+	}
+	else
+	{
+		if ( capt_used + size > TCP_CAPTURE_RING )
+			Capt_Flush ( map );
+		place = capt_ring + capt_used;
+		capt_used += size;
+		capt_records++;
+	}
+	if ( !place )
+		return;
+
+	memcpy ( place, &record, sizeof ( record ) );
+	memcpy ( place + sizeof ( record ), buffer, saved );
+	memset ( place + sizeof ( record ) + saved, 0, size - sizeof ( record ) - saved );
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           capture_complete
+*
+* FUNCTION:             Captures the sends and receives in a batch
+*                       of reaped completions (the
+*                       TCP_CAPTURE_COMPLETE hook). Guardian
+*                       completions don't say what they were, so
+*                       there this does nothing.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void capture_complete ( TCP_COMPLETION *completions, int count )
+{
+	int i;
+
+	for ( i = 0; i < count; i++ )
+	{
+		if ( completions[i].error || completions[i].count <= 0 || !completions[i].buffer )
+			continue;
+		if ( completions[i].op == TCP_OP_SEND )
+			capture_record ( TCP_CAPTURE_SEND, completions[i].sock, completions[i].buffer, completions[i].count );
+		else if ( completions[i].op == TCP_OP_RECV )
+			capture_record ( TCP_CAPTURE_RECV, completions[i].sock, completions[i].buffer, completions[i].count );
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           capture_thread_exit
+*
+* FUNCTION:             Flushes the calling thread's ring and frees
+*                       it (from tcp_thread_exit).
+*
+* RETURNS:                         nothing
+***************************************************************/
+void capture_thread_exit ( void )
+{
+#ifndef __TANDEM
+	capture_flush ( );
+	free ( capt_ring );
+	capt_ring = 0;
+	capt_used = 0;
+	capt_records = 0;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
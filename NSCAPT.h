@@ -0,0 +1,146 @@
+/************************************************************************************
+*		FILE:		"nscapt.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Traffic capture: every message that goes through
+*					new_send / new_recv (and, on Linux, every nowait send
+*					or receive reaped) is appended, with a timestamp, to
+*					a memory-mapped capture file, for NSREPLAY.c to play
+*					back later against a test server.
+*
+*		Notes:		capture_start ( path, size, snap ) makes the file,
+*					size bytes, and maps it. Each message keeps at most
+*					snap bytes of its data (0 = all of it).
+*					capture_stop unmaps it and cuts the file down to what
+*					was written.
+*
+*					Writers take no lock. Each thread copies its records
+*					into a ring of its own (TCP_CAPTURE_RING bytes), and
+*					only when that is full moves them to the file: one
+*					atomic add reserves the space, then a memcpy. A record
+*					bigger than the ring goes straight to the file the
+*					same way. When the file is full the records are
+*					dropped and counted in the header.
+*
+*					A thread's ring reaches the file when it fills, on
+*					capture_flush, or on tcp_thread_exit. Have every
+*					thread flush (or exit) and the traffic stop before
+*					capture_stop; capture_stop flushes only its own
+*					thread.
+*
+*					The file is a TCP_CAPTURE_HEADER and then records,
+*					each a TCP_CAPTURE_RECORD and its data, padded to 8
+*					bytes. Records of one thread are in time order; those
+*					of different threads come in blocks, so sort by usec
+*					to merge them. A record of size 0 ends the file.
+*
+*					The hooks cost one load of a global when capture is
+*					off; build with -DNSTCP_NO_CAPTURE to leave them out.
+*					Linux only for now: on Guardian capture_start fails
+*					and nothing is recorded.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.22.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifndef _NSCAPTH_INCLUDE_
+#define _NSCAPTH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+#define TCP_CAPTURE_MAGIC		"NSCAPT1"
+#define TCP_CAPTURE_RING		65536
+
+/* record types */
+enum
+{
+	TCP_CAPTURE_SEND = 1,
+	TCP_CAPTURE_RECV = 2
+};
+
+/***************************************************************
+*
+*	Name:		TCP_CAPTURE_HEADER
+*	Type:		struct
+*	Purpose:	Start of a capture file. tail is the bytes of
+*				records reserved after the header (it may run
+*				past the end once the file is full).
+*
+***************************************************************/
+typedef struct tcp_capture_header
+{
+	char				magic[8];
+	long long			size;		/* of the file */
+	long long			tail;
+	long long			records;
+	long long			dropped;
+	long long			start_usec;	/* tcp_clock_usec at capture_start */
+	long long			wall_usec;	/* time of day then, in microseconds */
+	long long			snap;
+} TCP_CAPTURE_HEADER;
+
+/***************************************************************
+*
+*	Name:		TCP_CAPTURE_RECORD
+*	Type:		struct
+*	Purpose:	One message: which way it went, on which
+*				socket, how many bytes the call moved, how
+*				many of them follow (saved), and when, in
+*				microseconds from capture_start.
+*
+***************************************************************/
+typedef struct tcp_capture_record
+{
+	unsigned int			size;		/* of the record with data and padding */
+	unsigned short			type;		/* TCP_CAPTURE_* */
+	unsigned short			thread;		/* writer, numbered from 1 */
+	int				sock;
+	unsigned int			length;
+	unsigned int			saved;
+	unsigned int			pad;
+	long long			usec;
+} TCP_CAPTURE_RECORD;
+
+#ifdef NSTCP_NO_CAPTURE
+#define TCP_CAPTURE(type, sock, buffer, length)	( ( void ) 0 )
+#define TCP_CAPTURE_COMPLETE(c, n)		( ( void ) 0 )
+#else
+#define TCP_CAPTURE(type, sock, buffer, length)	( tcp_capture_on ? capture_record ( type, sock, buffer, length ) : ( void ) 0 )
+#define TCP_CAPTURE_COMPLETE(c, n)		( tcp_capture_on ? capture_complete ( c, n ) : ( void ) 0 )
+#endif
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* set while a capture is running; the hooks test it */
+extern int tcp_capture_on;
+
+int capture_start ( const char *path, long size, long snap );
+int capture_stop ( void );
+void capture_flush ( void );
+
+/* called by the hooks and tcp_thread_exit */
+void capture_record ( int type, int sock, const char *buffer, long length );
+void capture_complete ( TCP_COMPLETION *completions, int count );
+void capture_thread_exit ( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSCAPTH_INCLUDE_
@@ -0,0 +1,455 @@
+/************************************************************************************
+*		FILE:		"nscork.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Outbound send coalescing. See nscork.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.8.0	  10/17/26		Initial Release
+*		1.11.0	  10/17/26		Sends counted in the operation counters
+*		1.25.1	  10/17/26		Short writes on non-blocking sockets kept, not resent
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nscorkh"
+#include "=nsstatsh"
+#else
+#include "NSCORK.h"
+#include "NSSTATS.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/* a non-blocking socket that can take no more for now */
+#define COALESCE_WOULD_BLOCK		( errno == EAGAIN || errno == EWOULDBLOCK )
+
+/***************************************************************
+*
+* NAME:                           Coalesce_Write
+*
+* FUNCTION:             Writes every byte of the parts given,
+*                       resuming after short writes, until a
+*                       non-blocking socket would block. more asks
+*                       for MSG_MORE where the platform has it.
+*
+* RETURNS:              long - bytes written (fewer than asked when
+*                       the socket would block), -1 on error
+***************************************************************/
+static long Coalesce_Write ( TCP_CONNECTION_INFO *connection, TCP_IOVEC *iov, int count, int more )
+{
+	long		written = 0;
+	int		status;
+#ifdef __TANDEM
+	int		i;
+	int		done;
+
+	( void ) more;
+	for ( i = 0; i < count; i++ )
+	{
+		for ( done = 0; done < iov[i].iov_len; done += status )
+		{
+			status = send ( *connection->sock
+						  , iov[i].iov_base + done
+						  , iov[i].iov_len - done
+						  , connection->flags );
+			TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, iov[i].iov_len - done, status );
+			if ( status < 0 )
+				return COALESCE_WOULD_BLOCK ? written : -1;
+			written += status;
+		}
+	}
+	return written;
+#else
+	struct msghdr	msg;
+	int		flags = connection->flags;
+	long		left = 0;
+	int		i;
+
+#ifdef MSG_MORE
+	if ( more )
+		flags |= MSG_MORE;
+#else
+	( void ) more;
+#endif
+
+	memset ( &msg, 0, sizeof ( msg ) );
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count;
+	for ( i = 0; i < count; i++ )
+		left += ( long ) iov[i].iov_len;
+
+	while ( msg.msg_iovlen )
+	{
+		status = ( int ) sendmsg ( *connection->sock, &msg, flags );
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, left, status );
+		if ( status < 0 )
+		{
+			if ( errno == EINTR )
+				continue;
+			return COALESCE_WOULD_BLOCK ? written : -1;
+		}
+		left -= status;
+		written += status;
+
+		while ( msg.msg_iovlen && ( size_t ) status >= msg.msg_iov->iov_len )
+		{
+			status -= ( int ) msg.msg_iov->iov_len;
+			msg.msg_iov++;
+			msg.msg_iovlen--;
+		}
+		if ( msg.msg_iovlen )
+		{
+			msg.msg_iov->iov_base = ( char * ) msg.msg_iov->iov_base + status;
+			msg.msg_iov->iov_len -= status;
+		}
+	}
+	return written;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           Coalesce_Keep
+*
+* FUNCTION:             After a short write of the buffer and then
+*                       extra, keeps what didn't go out at the front
+*                       of the buffer, growing it if need be, so the
+*                       next push sends it first and nothing twice.
+*
+* RETURNS:              int - 0, or -1 when out of memory
+***************************************************************/
+static int Coalesce_Keep ( TCP_COALESCE *c, long written, char *extra, long extra_length )
+{
+	char	*buffer;
+	long	 size;
+
+	if ( written < c->used )
+	{
+		memmove ( c->buffer, c->buffer + written, c->used - written );
+		c->used -= written;
+	}
+	else
+	{
+		extra += written - c->used;
+		extra_length -= written - c->used;
+		c->used = 0;
+	}
+	if ( extra_length <= 0 )
+		return 0;
+
+	if ( c->used + extra_length > c->size )
+	{
+		for ( size = c->size * 2; size < c->used + extra_length; size *= 2 )
+			;
+		buffer = ( char * ) realloc ( c->buffer, size );
+		if ( !buffer )
+			return -1;
+		c->buffer = buffer;
+		c->size = size;
+	}
+	memcpy ( c->buffer + c->used, extra, extra_length );
+	c->used += extra_length;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Coalesce_Cork
+*
+* FUNCTION:             Sets or clears TCP_CORK. Clearing it also
+*                       sends whatever the kernel was holding.
+*
+***************************************************************/
+static void Coalesce_Cork ( TCP_CONNECTION_INFO *connection, int on )
+{
+#ifdef TCP_CORK
+	setsockopt ( *connection->sock, IPPROTO_TCP, TCP_CORK, ( char * ) &on, sizeof ( on ) );
+#else
+	( void ) connection;
+	( void ) on;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           Coalesce_Push
+*
+* FUNCTION:             Sends the buffer plus an optional extra
+*                       message in one gather write. more = 1 for
+*                       threshold flushes, where data keeps coming.
+*
+* NOTE:                 When the socket would block part way, the
+*                       rest (of extra too) stays in the buffer.
+*
+* RETURNS:              int - bytes written, -1 on error; -1 with
+*                       errno EAGAIN when some are still buffered
+***************************************************************/
+static int Coalesce_Push ( TCP_CONNECTION_INFO *connection, char *extra, long extra_length, int more )
+{
+	TCP_COALESCE	*c = connection->coalesce;
+	TCP_IOVEC	 iov[2];
+	int		 count = 0;
+	int		 total;
+	long		 written;
+
+	/* MSG_MORE only when the deadline can push the held tail later */
+	more = more && ( c->flags & TCP_COALESCE_MSG_MORE ) && c->flush_usec;
+
+	if ( c->used )
+	{
+		iov[count].iov_base = c->buffer;
+		iov[count].iov_len = c->used;
+		count++;
+	}
+	if ( extra_length > 0 )
+	{
+		iov[count].iov_base = extra;
+		iov[count].iov_len = extra_length;
+		count++;
+	}
+	total = ( int ) ( c->used + ( extra_length > 0 ? extra_length : 0 ) );
+
+	if ( !count )
+		return 0;
+
+	written = Coalesce_Write ( connection, iov, count, more );
+	if ( written < 0 )
+		return -1;
+	if ( written < total )
+	{
+		if ( Coalesce_Keep ( c, written, extra, extra_length ) < 0 )
+			return -1;
+		c->count = 1;
+		errno = EAGAIN;
+		return -1;
+	}
+
+	c->used = 0;
+	c->count = 0;
+
+	if ( more )
+	{
+		c->held = 1;
+		c->first_usec = tcp_clock_usec ( );
+	}
+	else if ( c->held || ( c->flags & TCP_COALESCE_CORK ) )
+	{
+		/* let go of anything the kernel is holding back */
+		Coalesce_Cork ( connection, 0 );
+		if ( c->flags & TCP_COALESCE_CORK )
+			Coalesce_Cork ( connection, 1 );
+		c->held = 0;
+	}
+
+	return total;
+}
+
+/***************************************************************
+*
+* NAME:                           coalesce_attach
+*
+* FUNCTION:             Gives a connection a coalescing buffer of
+*                       capacity bytes. flush_bytes, flush_count and
+*                       flush_usec are the triggers (0 = off; bytes
+*                       defaults to the capacity). flags: TCP_COALESCE_*.
+*
+* RETURNS:              int - 0, or -1 on bad arguments / no memory
+***************************************************************/
+int coalesce_attach ( TCP_CONNECTION_INFO *connection, long capacity, long flush_bytes
+					, int flush_count, long flush_usec, int flags )
+{
+	TCP_COALESCE *c;
+
+	if ( capacity <= 0 || flush_bytes < 0 || flush_count < 0 || flush_usec < 0 )
+		return -1;
+
+	c = ( TCP_COALESCE * ) calloc ( 1, sizeof ( TCP_COALESCE ) );
+	if ( !c )
+		return -1;
+
+	c->buffer = ( char * ) malloc ( capacity );
+	if ( !c->buffer )
+	{
+		free ( c );
+		return -1;
+	}
+
+	c->size = capacity;
+	c->flush_bytes = ( flush_bytes && flush_bytes < capacity ) ? flush_bytes : capacity;
+	c->flush_count = flush_count;
+	c->flush_usec = flush_usec;
+	c->flags = flags;
+
+	coalesce_detach ( connection );
+	connection->coalesce = c;
+
+	if ( flags & TCP_COALESCE_CORK )
+		Coalesce_Cork ( connection, 1 );
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           coalesce_detach
+*
+* FUNCTION:             Frees a connection's buffer. Anything still
+*                       in it is dropped, so coalesce_flush first.
+*                       Called by clean_conn_info.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void coalesce_detach ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_COALESCE *c = connection->coalesce;
+
+	if ( !c )
+		return;
+
+	free ( c->buffer );
+	free ( c );
+	connection->coalesce = 0;
+}
+
+/***************************************************************
+*
+* NAME:                           coalesce_send
+*
+* FUNCTION:             Queues one message, sending when a trigger
+*                       fires. A message that doesn't fit goes out
+*                       straight away together with the buffer, in
+*                       one gather write and without being copied.
+*
+* NOTE:                 On a non-blocking socket that is full, what
+*                       didn't go out is kept in the buffer (grown
+*                       to fit) for the next flush, so the message
+*                       is still taken whole. Without a buffer
+*                       attached this is a plain send of the whole
+*                       message, which may be short in that case.
+*
+* RETURNS:              int - length (or bytes sent, without a
+*                       buffer), -1 on error
+***************************************************************/
+int coalesce_send ( TCP_CONNECTION_INFO *connection, char *buffer, long length )
+{
+	TCP_COALESCE	*c = connection->coalesce;
+	TCP_IOVEC	 iov;
+	long long	 now = 0;
+	long		 written;
+
+	if ( length <= 0 )
+		return 0;
+
+	if ( !c )
+	{
+		iov.iov_base = buffer;
+		iov.iov_len = length;
+		written = Coalesce_Write ( connection, &iov, 1, 0 );
+		if ( !written && length )
+		{
+			errno = EAGAIN;
+			return -1;
+		}
+		return ( int ) written;
+	}
+
+	if ( c->flush_usec )
+		now = tcp_clock_usec ( );
+
+	if ( c->used + length > c->size )
+		return Coalesce_Push ( connection, buffer, length, 1 ) < 0 && !COALESCE_WOULD_BLOCK ? -1 : ( int ) length;
+
+	if ( !c->used && !c->held )
+		c->first_usec = now;
+	memcpy ( c->buffer + c->used, buffer, length );
+	c->used += length;
+	c->count++;
+
+	/* a full socket isn't an error here: the rest stays buffered */
+	if ( c->used >= c->flush_bytes || ( c->flush_count && c->count >= c->flush_count ) )
+	{
+		if ( Coalesce_Push ( connection, 0, 0, 1 ) < 0 && !COALESCE_WOULD_BLOCK )
+			return -1;
+	}
+	else if ( c->flush_usec && now - c->first_usec >= c->flush_usec )
+	{
+		if ( Coalesce_Push ( connection, 0, 0, 0 ) < 0 && !COALESCE_WOULD_BLOCK )
+			return -1;
+	}
+
+	return ( int ) length;
+}
+
+/***************************************************************
+*
+* NAME:                           coalesce_flush
+*
+* FUNCTION:             Sends everything buffered now and pushes
+*                       out anything the kernel was holding back.
+*
+* RETURNS:              int - bytes sent, -1 on error; -1 with errno
+*                       EAGAIN when a non-blocking socket filled and
+*                       the rest is still buffered (flush again once
+*                       it is writable)
+***************************************************************/
+int coalesce_flush ( TCP_CONNECTION_INFO *connection )
+{
+	if ( !connection->coalesce )
+		return 0;
+
+	return Coalesce_Push ( connection, 0, 0, 0 );
+}
+
+/***************************************************************
+*
+* NAME:                           coalesce_due
+*
+* FUNCTION:             Time left before the deadline trigger,
+*                       for sizing an event loop's wait.
+*
+* RETURNS:              long - microseconds (0 = due now), -1 when
+*                       nothing is waiting or there is no deadline
+***************************************************************/
+long coalesce_due ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_COALESCE	*c = connection->coalesce;
+	long long	 left;
+
+	if ( !c || !c->flush_usec || ( !c->used && !c->held ) )
+		return -1;
+
+	left = c->first_usec + c->flush_usec - tcp_clock_usec ( );
+	return left > 0 ? ( long ) left : 0;
+}
+
+/***************************************************************
+*
+* NAME:                           coalesce_tick
+*
+* FUNCTION:             Flushes if the deadline has passed.
+*
+* RETURNS:              int - bytes sent, 0 if not due, -1 on error
+*                       (EAGAIN as coalesce_flush)
+***************************************************************/
+int coalesce_tick ( TCP_CONNECTION_INFO *connection )
+{
+	if ( coalesce_due ( connection ) != 0 )
+		return 0;
+
+	return Coalesce_Push ( connection, 0, 0, 0 );
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,102 @@
+/************************************************************************************
+*		FILE:		"nscork.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Optional write-combining buffer for a connection, so a
+*					burst of small messages goes out in one send (and as
+*					few TCP segments as possible) instead of one each.
+*
+*		Notes:		The buffer is flushed when it holds flush_bytes, when
+*					it holds flush_count messages, when the oldest message
+*					in it is flush_usec old, or on coalesce_flush. A zero
+*					setting turns that trigger off.
+*
+*					Nothing runs in the background: the deadline is only
+*					checked in coalesce_send and coalesce_tick. An event
+*					loop should wait no longer than coalesce_due and then
+*					call coalesce_tick.
+*
+*					With TCP_COALESCE_MSG_MORE, flushes made because more
+*					data is coming (bytes / count) carry MSG_MORE so the
+*					kernel may hold back a short last segment; the
+*					deadline then still pushes it out, so this needs
+*					flush_usec. Explicit and deadline flushes push
+*					everything. TCP_COALESCE_CORK also holds the socket
+*					corked between pushes. Neither exists on Guardian,
+*					where the flags are ignored.
+*
+*					On a non-blocking socket a push may go out only in
+*					part. What didn't go out stays at the front of the
+*					buffer (which grows if a large message has to be
+*					kept too) and is sent first by the next push, so no
+*					byte is lost or sent twice. coalesce_send still takes
+*					the whole message; coalesce_flush / coalesce_tick
+*					return -1 with errno EAGAIN while bytes remain.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.8.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Short writes on non-blocking sockets kept, not resent
+*************************************************************************************/
+
+#ifndef _NSCORKH_INCLUDE_
+#define _NSCORKH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* coalescing flags */
+#define TCP_COALESCE_MSG_MORE		0x01	/* MSG_MORE on threshold flushes */
+#define TCP_COALESCE_CORK		0x02	/* keep TCP_CORK set between pushes */
+
+/***************************************************************
+*
+*	Name:		TCP_COALESCE
+*	Type:		struct
+*	Purpose:	Write-combining buffer of one connection
+*				(TCP_CONNECTION_INFO::coalesce).
+*
+***************************************************************/
+typedef struct tcp_coalesce
+{
+	char				*buffer;
+	long				size;
+	long				used;
+	int				count;
+	long				flush_bytes;
+	int				flush_count;
+	long				flush_usec;
+	long long			first_usec;	/* when the oldest buffered message came in */
+	int				flags;
+	int				held;		/* kernel may be holding a MSG_MORE tail */
+} TCP_COALESCE;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int coalesce_attach ( TCP_CONNECTION_INFO *connection, long capacity, long flush_bytes
+					, int flush_count, long flush_usec, int flags );
+void coalesce_detach ( TCP_CONNECTION_INFO *connection );
+int coalesce_send ( TCP_CONNECTION_INFO *connection, char *buffer, long length );
+int coalesce_flush ( TCP_CONNECTION_INFO *connection );
+long coalesce_due ( TCP_CONNECTION_INFO *connection );
+int coalesce_tick ( TCP_CONNECTION_INFO *connection );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSCORKH_INCLUDE_
@@ -0,0 +1,749 @@
+/************************************************************************************
+*		FILE:		"nscoro.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	C++20 coroutines over the nowait calls, so a session
+*					is written top to bottom instead of as a state machine
+*					around reap_completions:
+*
+*						nstcp::Task<> Echo ( nstcp::Connection conn )
+*						{
+*							char buf[4096];
+*							for ( ;; )
+*							{
+*								nstcp::IoResult r = co_await conn.recv ( buf );
+*								if ( !r || !r.count )
+*									co_return;
+*								co_await conn.send ( buf, r.count );
+*							}
+*						}
+*
+*		Notes:		A Loop owns the thread's TCP table and runs the
+*					completion loop: every awaitable submits one nowait
+*					call tagged with itself, and reap_completions hands
+*					the tag back to resume the coroutine waiting on it.
+*					Loop::spawn starts a detached Task; Loop::run returns
+*					once all of them have finished. ~Loop destroys any
+*					still suspended, withdrawing their nowait calls and
+*					timers.
+*
+*					Coroutine frames come from per-thread size-class free
+*					lists (FramePool), so a session or an accept costs no
+*					malloc once the pool is warm. Errors come back as
+*					values (IoResult, Connection::error), never as
+*					exceptions.
+*
+*					Everything here belongs to the thread that made the
+*					Loop, as the nowait engine does. Keep one operation
+*					of a kind outstanding per connection at a time (one
+*					recv and one send may be in flight together), and one
+*					accept per Listener.
+*
+*					Header only. Needs a C++20 compiler, so it is Linux
+*					only; Guardian code keeps the TCP table.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.15.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Deadlines report ETIMEDOUT
+*		1.25.1	  10/17/26		~Loop destroys unfinished spawned tasks
+*		1.25.1	  10/17/26		Destroyed awaiters withdraw their nowait call
+*************************************************************************************/
+
+#ifndef _NSCOROH_INCLUDE_
+#define _NSCOROH_INCLUDE_
+
+#if defined(__cplusplus) && __cplusplus >= 202002L && !defined(__TANDEM)
+
+#include "NSTCP.h"
+#include "NSTIMER.h"
+#include <coroutine>
+#include <cerrno>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace nstcp
+{
+
+class Loop;
+
+/***************************************************************
+*
+*	Name:		FramePool
+*	Type:		class
+*	Purpose:	Per-thread free lists of coroutine frames, one
+*				per 64-byte size class. Frames over the last
+*				class go to the heap. trim gives the free ones
+*				back; ~Loop calls it.
+*
+***************************************************************/
+class FramePool
+{
+public:
+	static constexpr std::size_t GRAIN = 64;
+	static constexpr std::size_t CLASSES = 129;	/* frames up to 8 KB are pooled */
+
+	static void *get ( std::size_t size )
+	{
+		std::size_t	 index = ( size + GRAIN - 1 ) / GRAIN;
+		Block		*block;
+
+		if ( index >= CLASSES )
+			return ::operator new ( size );
+		block = heads ( )[index];
+		if ( block )
+		{
+			heads ( )[index] = block->next;
+			return block;
+		}
+		return ::operator new ( index * GRAIN );
+	}
+
+	static void put ( void *frame, std::size_t size ) noexcept
+	{
+		std::size_t	 index = ( size + GRAIN - 1 ) / GRAIN;
+		Block		*block = static_cast<Block *> ( frame );
+
+		if ( index >= CLASSES )
+		{
+			::operator delete ( frame );
+			return;
+		}
+		block->next = heads ( )[index];
+		heads ( )[index] = block;
+	}
+
+	static void trim ( ) noexcept
+	{
+		Block		*block;
+		std::size_t	 index;
+
+		for ( index = 0; index < CLASSES; index++ )
+			while ( ( block = heads ( )[index] ) != nullptr )
+			{
+				heads ( )[index] = block->next;
+				::operator delete ( block );
+			}
+	}
+
+private:
+	struct Block
+	{
+		Block		*next;
+	};
+
+	static Block **heads ( ) noexcept
+	{
+		static thread_local Block *lists[CLASSES];
+		return lists;
+	}
+};
+
+/***************************************************************
+*
+*	Name:		IoResult
+*	Type:		struct
+*	Purpose:	What an awaited operation gives back: the bytes
+*				moved and 0 or the errno value (ETIMEDOUT
+*				when a deadline ran out). A recv with count 0
+*				and no error is the peer closing.
+*
+***************************************************************/
+struct IoResult
+{
+	long				count;
+	int				error;
+
+	explicit operator bool ( ) const noexcept { return error == 0; }
+};
+
+namespace detail
+{
+
+/* one submitted nowait call; its address is the completion tag */
+struct Operation
+{
+	std::coroutine_handle<>		waiter;
+	IoResult			result { 0, 0 };
+};
+
+inline long Tag_Of ( Operation *operation )
+{
+	return reinterpret_cast<long> ( operation );
+}
+
+/* submit ( tag ) makes the call on sock and returns its status;
+*  when it fails the coroutine carries on at once with errno as the
+*  error. A usec above 0 puts a timer_deadline on the call. */
+template <typename Submit>
+class Awaiter : public Operation
+{
+public:
+	Awaiter ( Submit submit, int sock = -1, long usec = 0 )
+		: submit_ ( std::move ( submit ) ), sock_ ( sock ), usec_ ( usec ) { }
+
+	/* a frame destroyed while waiting withdraws its call (CANCELREQ)
+	*  and its deadline, so neither comes back to freed memory */
+	~Awaiter ( )
+	{
+		if ( pending_ )
+			CANCELREQ ( sock_, Tag_Of ( this ) );
+		timer_cancel ( &timer_ );
+	}
+
+	bool await_ready ( ) const noexcept { return false; }
+
+	bool await_suspend ( std::coroutine_handle<> handle )
+	{
+		waiter = handle;
+		if ( submit_ ( Tag_Of ( this ) ) < 0 )
+		{
+			result.error = errno ? errno : -1;
+			return false;
+		}
+		pending_ = true;
+		if ( usec_ > 0 )
+		{
+			timer_init ( &timer_, nullptr, nullptr );
+			timer_deadline ( &timer_, sock_, Tag_Of ( this ), usec_ );
+		}
+		return true;
+	}
+
+	IoResult await_resume ( ) noexcept
+	{
+		pending_ = false;
+		if ( usec_ > 0 )
+			timer_cancel ( &timer_ );
+		return result;
+	}
+
+private:
+	Submit				submit_;
+	int				sock_;
+	long				usec_;
+	bool				pending_ = false;
+	TCP_TIMER			timer_ { };
+};
+
+template <typename Submit>
+Awaiter<Submit> Make_Awaiter ( Submit submit, int sock = -1, long usec = 0 )
+{
+	return Awaiter<Submit> ( std::move ( submit ), sock, usec );
+}
+
+struct Promise_Base;
+
+inline void Task_Finished ( Loop *loop, Promise_Base *promise ) noexcept;
+
+/* what every Task promise shares: pooled frames, lazy start,
+*  and at the end either the awaiting coroutine or, for a
+*  spawned task, freeing the frame. A spawned task is on its
+*  Loop's list (prev, next) until it finishes. */
+struct Promise_Base
+{
+	std::coroutine_handle<>		continuation;
+	Loop				*loop = nullptr;
+	std::coroutine_handle<>		self;
+	Promise_Base			*prev = nullptr;
+	Promise_Base			*next = nullptr;
+
+	static void *operator new ( std::size_t size ) { return FramePool::get ( size ); }
+	static void operator delete ( void *frame, std::size_t size ) noexcept { FramePool::put ( frame, size ); }
+
+	struct Final_Awaiter
+	{
+		bool await_ready ( ) const noexcept { return false; }
+
+		template <typename Promise>
+		std::coroutine_handle<> await_suspend ( std::coroutine_handle<Promise> handle ) noexcept
+		{
+			Promise_Base	&promise = handle.promise ( );
+			Loop		*loop = promise.loop;
+
+			if ( promise.continuation )
+				return promise.continuation;
+			if ( loop )
+			{
+				Task_Finished ( loop, &promise );
+				handle.destroy ( );
+			}
+			return std::noop_coroutine ( );
+		}
+
+		void await_resume ( ) const noexcept { }
+	};
+
+	std::suspend_always initial_suspend ( ) const noexcept { return { }; }
+	Final_Awaiter final_suspend ( ) const noexcept { return { }; }
+	void unhandled_exception ( ) const noexcept { std::terminate ( ); }
+};
+
+} /* namespace detail */
+
+/***************************************************************
+*
+*	Name:		Task
+*	Type:		class template
+*	Purpose:	A coroutine returning T. It starts when awaited
+*				(co_await task) or spawned on a Loop, and the
+*				awaiting coroutine resumes straight from its
+*				end, without going back through the loop.
+*
+***************************************************************/
+template <typename T = void>
+class Task
+{
+public:
+	struct promise_type : detail::Promise_Base
+	{
+		std::optional<T>		value;
+
+		Task get_return_object ( ) { return Task ( Handle::from_promise ( *this ) ); }
+		void return_value ( T result ) { value.emplace ( std::move ( result ) ); }
+	};
+	using Handle = std::coroutine_handle<promise_type>;
+
+	Task ( Task &&other ) noexcept : handle_ ( std::exchange ( other.handle_, nullptr ) ) { }
+	Task ( const Task & ) = delete;
+	Task &operator= ( const Task & ) = delete;
+	~Task ( ) { if ( handle_ ) handle_.destroy ( ); }
+
+	bool await_ready ( ) const noexcept { return false; }
+
+	std::coroutine_handle<> await_suspend ( std::coroutine_handle<> waiter ) noexcept
+	{
+		handle_.promise ( ).continuation = waiter;
+		return handle_;
+	}
+
+	T await_resume ( ) { return std::move ( *handle_.promise ( ).value ); }
+
+private:
+	explicit Task ( Handle handle ) : handle_ ( handle ) { }
+
+	Handle				handle_;
+};
+
+template <>
+class Task<void>
+{
+public:
+	struct promise_type : detail::Promise_Base
+	{
+		Task get_return_object ( ) { return Task ( Handle::from_promise ( *this ) ); }
+		void return_void ( ) const noexcept { }
+	};
+	using Handle = std::coroutine_handle<promise_type>;
+
+	Task ( Task &&other ) noexcept : handle_ ( std::exchange ( other.handle_, nullptr ) ) { }
+	Task ( const Task & ) = delete;
+	Task &operator= ( const Task & ) = delete;
+	~Task ( ) { if ( handle_ ) handle_.destroy ( ); }
+
+	bool await_ready ( ) const noexcept { return false; }
+
+	std::coroutine_handle<> await_suspend ( std::coroutine_handle<> waiter ) noexcept
+	{
+		handle_.promise ( ).continuation = waiter;
+		return handle_;
+	}
+
+	void await_resume ( ) const noexcept { }
+
+private:
+	friend class Loop;
+
+	explicit Task ( Handle handle ) : handle_ ( handle ) { }
+
+	Handle				handle_;
+};
+
+/***************************************************************
+*
+*	Name:		Loop
+*	Type:		class
+*	Purpose:	The thread's completion loop. Owns a TCP table
+*				(intialize_tcp_engine), runs spawned tasks and
+*				resumes each awaiting coroutine as its
+*				completion is reaped. Timers (sleep, recv
+*				deadlines) run inside the same wait.
+*				Spawned tasks still suspended when it goes
+*				(run returned -1, or was never called) are
+*				destroyed with it, before the TCP table; each
+*				call they wait on is withdrawn (CANCELREQ),
+*				so a later Loop never reaps it.
+*
+***************************************************************/
+class Loop
+{
+public:
+	explicit Loop ( int engine = TCP_ENGINE_DEFAULT ) : tcp_ ( intialize_tcp_engine ( engine ) ) { }
+
+	~Loop ( )
+	{
+		Destroy_Spawned ( );
+		release_tcp ( tcp_ );
+		FramePool::trim ( );
+	}
+
+	Loop ( const Loop & ) = delete;
+	Loop &operator= ( const Loop & ) = delete;
+
+	/* 0 if intialize_tcp_engine failed */
+	TCP *tcp ( ) const noexcept { return tcp_; }
+
+	/* starts task on the next run; the Loop frees it when done */
+	void spawn ( Task<> task )
+	{
+		Task<>::Handle handle = std::exchange ( task.handle_, nullptr );
+
+		handle.promise ( ).loop = this;
+		handle.promise ( ).self = handle;
+		handle.promise ( ).next = spawned_;
+		if ( spawned_ )
+			spawned_->prev = &handle.promise ( );
+		spawned_ = &handle.promise ( );
+		live_++;
+		ready_.push_back ( handle );
+	}
+
+	/* runs until every spawned task has finished; -1 if tasks are
+	*  left waiting on nothing that can complete */
+	int run ( )
+	{
+		TCP_COMPLETION			 batch[TCP_COMPLETION_BATCH];
+		detail::Operation		*operation;
+		int				 reaped;
+		int				 i;
+
+		while ( live_ > 0 )
+		{
+			if ( !ready_.empty ( ) )
+			{
+				starting_.swap ( ready_ );
+				for ( std::coroutine_handle<> handle : starting_ )
+					handle.resume ( );
+				starting_.clear ( );
+				continue;
+			}
+
+			reaped = tcp_->reap_completions ( batch, TCP_COMPLETION_BATCH, -1 );
+			if ( reaped < 0 )
+			{
+				if ( live_ > 0 && ready_.empty ( ) )
+					return -1;
+				continue;
+			}
+
+			for ( i = 0; i < reaped; i++ )
+			{
+				operation = reinterpret_cast<detail::Operation *> ( batch[i].tag );
+				if ( !operation )
+					continue;
+				operation->result.count = batch[i].count;
+				operation->result.error = batch[i].error;
+				operation->waiter.resume ( );
+			}
+		}
+		return 0;
+	}
+
+	/* co_await loop.sleep ( usec ) */
+	class Sleep
+	{
+	public:
+		explicit Sleep ( long usec ) : usec_ ( usec ) { }
+		~Sleep ( ) { timer_cancel ( &timer_ ); }
+
+		bool await_ready ( ) const noexcept { return usec_ <= 0; }
+
+		void await_suspend ( std::coroutine_handle<> handle )
+		{
+			waiter_ = handle;
+			timer_init ( &timer_, Wake, this );
+			timer_arm ( &timer_, usec_ );
+		}
+
+		void await_resume ( ) const noexcept { }
+
+	private:
+		static void Wake ( TCP_TIMER *, void *context )
+		{
+			static_cast<Sleep *> ( context )->waiter_.resume ( );
+		}
+
+		long				usec_;
+		std::coroutine_handle<>		waiter_;
+		TCP_TIMER			timer_ { };
+	};
+
+	Sleep sleep ( long usec ) const { return Sleep ( usec ); }
+
+private:
+	friend void detail::Task_Finished ( Loop *, detail::Promise_Base * ) noexcept;
+
+	/* destroys the spawned tasks that haven't finished; their
+	*  awaiters and sleeps cancel their own timers as they go */
+	void Destroy_Spawned ( ) noexcept
+	{
+		std::coroutine_handle<>		 handle;
+
+		while ( spawned_ )
+		{
+			handle = spawned_->self;
+			detail::Task_Finished ( this, spawned_ );
+			handle.destroy ( );
+		}
+		ready_.clear ( );
+	}
+
+	TCP				*tcp_;
+	long				 live_ = 0;
+	detail::Promise_Base		*spawned_ = nullptr;
+	std::vector<std::coroutine_handle<>>	 ready_;
+	std::vector<std::coroutine_handle<>>	 starting_;
+};
+
+inline void detail::Task_Finished ( Loop *loop, Promise_Base *promise ) noexcept
+{
+	if ( promise->prev )
+		promise->prev->next = promise->next;
+	else
+		loop->spawned_ = promise->next;
+	if ( promise->next )
+		promise->next->prev = promise->prev;
+	loop->live_--;
+}
+
+/***************************************************************
+*
+*	Name:		Connection
+*	Type:		class
+*	Purpose:	One socket, on a pooled TCP_CONNECTION_INFO
+*				(get_conn_info). Move only; the socket is
+*				closed and the info given back when it goes.
+*				info ( ) reaches the TCP table calls for
+*				anything not wrapped here.
+*
+***************************************************************/
+class Connection
+{
+public:
+	explicit Connection ( Loop &loop ) : tcp_ ( loop.tcp ( ) ), info_ ( tcp_ ? tcp_->get_conn_info ( ) : nullptr )
+	{
+		if ( !info_ )
+			error_ = ENOMEM;
+	}
+
+	Connection ( Connection &&other ) noexcept
+		: tcp_ ( other.tcp_ ), info_ ( std::exchange ( other.info_, nullptr ) ), error_ ( other.error_ ) { }
+
+	Connection &operator= ( Connection &&other ) noexcept
+	{
+		if ( this != &other )
+		{
+			release ( );
+			tcp_ = other.tcp_;
+			info_ = std::exchange ( other.info_, nullptr );
+			error_ = other.error_;
+		}
+		return *this;
+	}
+
+	Connection ( const Connection & ) = delete;
+	Connection &operator= ( const Connection & ) = delete;
+	~Connection ( ) { release ( ); }
+
+	/* false when there is no socket: a failed accept or connect */
+	explicit operator bool ( ) const noexcept { return info_ && info_->sock_num >= 0 && !error_; }
+	int error ( ) const noexcept { return error_; }
+	TCP_CONNECTION_INFO *info ( ) const noexcept { return info_; }
+
+	/* co_await conn.connect ( ipaddr, port ): a dotted quad or a host
+	*  name (set_sockaddr, so through the resolver cache) */
+	Task<IoResult> connect ( const char *ipaddr, TCP_PORT port )
+	{
+		IoResult			 result { 0, 0 };
+		TCP_CONNECTION_INFO		*info = info_;
+		TCP				*tcp = tcp_;
+
+		if ( !info )
+			co_return IoResult { 0, ENOMEM };
+		strncpy ( info->ipaddr, ipaddr, sizeof ( info->ipaddr ) - 1 );
+		info->ipaddr[sizeof ( info->ipaddr ) - 1] = '\0';
+		info->port = port;
+		tcp->set_sockaddr ( info, AF_INET );
+		if ( info->sockaddr->sin_addr.s_addr == INADDR_NONE )
+			result.error = errno;	/* EAGAIN: the name is still being looked up */
+		else if ( tcp->get_sock_nw ( info, AF_INET, SOCK_STREAM, 0, 0 ) < 0 )
+			result.error = errno;
+		else
+		{
+			info->sockaddr_len = sizeof ( struct sockaddr_in );
+			result = co_await detail::Make_Awaiter ( [ tcp, info ] ( long tag )
+			{
+				info->tag = tag;
+				return tcp->make_connect_nw ( info );
+			}, info->sock_num );
+		}
+		error_ = result.error;
+		co_return result;
+	}
+
+	/* co_await conn.recv ( buf, length [, usec] ): usec above 0 is a
+	*  deadline, after which the result is ETIMEDOUT */
+	auto recv ( char *buffer, int length, long usec = 0 )
+	{
+		TCP_CONNECTION_INFO		*info = info_;
+		TCP				*tcp = tcp_;
+
+		return detail::Make_Awaiter ( [ tcp, info, buffer, length ] ( long tag )
+		{
+			info->tag = tag;
+			return tcp->new_recv_nw ( info, buffer, length );
+		}, info ? info->sock_num : -1, usec );
+	}
+
+	/* co_await conn.recv ( buf ) for an array */
+	template <std::size_t N>
+	auto recv ( char ( &buffer )[N] ) { return recv ( buffer, static_cast<int> ( N ) ); }
+
+	/* co_await conn.send ( buf, length ); count may be short of length */
+	auto send ( const char *buffer, long length )
+	{
+		TCP_CONNECTION_INFO		*info = info_;
+		TCP				*tcp = tcp_;
+
+		return detail::Make_Awaiter ( [ tcp, info, buffer, length ] ( long tag )
+		{
+			info->tag = tag;
+			return tcp->new_send_nw ( info, const_cast<char *> ( buffer ), static_cast<int> ( length ) );
+		}, info ? info->sock_num : -1 );
+	}
+
+	/* closes the socket now; the info stays for a later connect */
+	void close ( )
+	{
+		if ( info_ )
+			tcp_->close_sock ( info_ );
+	}
+
+private:
+	friend class Listener;
+
+	void release ( )
+	{
+		if ( !info_ )
+			return;
+		close ( );
+		tcp_->clean_conn_info ( info_ );
+		info_ = nullptr;
+	}
+
+	TCP				*tcp_;
+	TCP_CONNECTION_INFO		*info_;
+	int				 error_ = 0;
+};
+
+/***************************************************************
+*
+*	Name:		Listener
+*	Type:		class
+*	Purpose:	A listening socket. co_await accept ( ) gives
+*				the next connection; test it for false and
+*				read error ( ) when the accept failed.
+*
+***************************************************************/
+class Listener
+{
+public:
+	explicit Listener ( Loop &loop ) : loop_ ( loop ), socket_ ( loop ) { }
+
+	/* binds and listens; port 0 takes any, see port ( ) */
+	int listen ( const char *ipaddr, TCP_PORT port, int backlog = 128 )
+	{
+		TCP_CONNECTION_INFO		*info = socket_.info_;
+		TCP				*tcp = socket_.tcp_;
+		int				 on = 1;
+
+		if ( !info )
+			return -1;
+		strncpy ( info->ipaddr, ipaddr, sizeof ( info->ipaddr ) - 1 );
+		info->ipaddr[sizeof ( info->ipaddr ) - 1] = '\0';
+		info->port = port;
+		info->queue_len = backlog;
+		tcp->set_sockaddr ( info, AF_INET );
+		if ( tcp->get_sock_nw ( info, AF_INET, SOCK_STREAM, 0, 0 ) < 0 )
+			return -1;
+		setsockopt ( info->sock_num, SOL_SOCKET, SO_REUSEADDR, &on, sizeof ( on ) );
+		info->sockaddr_len = sizeof ( struct sockaddr_in );
+		if ( tcp->set_bind ( info ) < 0 || tcp->set_listen ( info ) < 0
+		  || tcp->get_sock_name ( info ) < 0 )
+			return -1;
+		port_ = ntohs ( info->sockaddr_in.sin_port );
+		return 0;
+	}
+
+	/* the port listened on */
+	TCP_PORT port ( ) const noexcept { return port_; }
+
+	/* co_await listener.accept ( ) */
+	Task<Connection> accept ( )
+	{
+		TCP_CONNECTION_INFO		*info = socket_.info_;
+		TCP				*tcp = socket_.tcp_;
+		Connection			 conn ( loop_ );
+		IoResult			 result;
+
+		if ( !conn.info_ )
+			co_return conn;
+
+		/* wait for the connection, then take it on a new socket */
+		info->sockaddr_len = sizeof ( struct sockaddr_in );
+		result = co_await detail::Make_Awaiter ( [ tcp, info ] ( long tag )
+		{
+			info->tag = tag;
+			return tcp->new_accept_nw ( info );
+		}, info->sock_num );
+		if ( result )
+		{
+			conn.info_->sockaddr_in = info->sockaddr_in;
+			conn.info_->sockaddr = &conn.info_->sockaddr_in;
+			conn.info_->tune = info->tune;	/* the listener's profile */
+			if ( tcp->get_sock_nw ( conn.info_, AF_INET, SOCK_STREAM, 0, 0 ) < 0 )
+				result.error = errno;
+			else
+				result = co_await detail::Make_Awaiter ( [ tcp, info = conn.info_ ] ( long tag )
+				{
+					info->tag = tag;
+					return tcp->new_accept_nw2 ( info );
+				}, conn.info_->sock_num );
+		}
+		if ( !result )
+		{
+			conn.close ( );
+			conn.error_ = result.error;
+		}
+		co_return conn;
+	}
+
+private:
+	Loop				&loop_;
+	Connection			 socket_;
+	TCP_PORT			 port_ = 0;
+};
+
+} /* namespace nstcp */
+
+#endif /* C++20, not Guardian */
+
+#endif // !_NSCOROH_INCLUDE_
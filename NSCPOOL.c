@@ -0,0 +1,626 @@
+/************************************************************************************
+*		FILE:		"nscpool.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Client connection pool. See nscpool.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.19.0	  10/17/26		Initial Release
+*		1.21.0	  10/17/26		Pre-warm connects are striped (nsstrip.h)
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nscpoolh"
+#include "=nsstatsh"
+#include "=nsstriph"
+#else
+#include "NSCPOOL.h"
+#include "NSSTATS.h"
+#include "NSSTRIP.h"
+#include <poll.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* initial hash table size (a power of two) */
+#define CPOOL_DESTS			16
+
+/* connects pool_prewarm keeps in flight at once */
+#define CPOOL_BATCH			64
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Cpool_Hash
+*
+* FUNCTION:             FNV-1a over the address and port.
+*
+* RETURNS:                         unsigned
+***************************************************************/
+static unsigned Cpool_Hash ( const char *ipaddr, TCP_PORT port )
+{
+	unsigned hash = 2166136261u;
+
+	while ( *ipaddr )
+		hash = ( hash ^ ( unsigned char ) *ipaddr++ ) * 16777619u;
+	hash = ( hash ^ ( port & 0xff ) ) * 16777619u;
+	hash = ( hash ^ ( port >> 8 ) ) * 16777619u;
+
+	return hash;
+}
+
+/***************************************************************
+*
+* NAME:                           Cpool_Grow
+*
+* FUNCTION:             Doubles the destination table and puts
+*                       every destination back in.
+*
+* RETURNS:              int - 0, or -1 when out of memory
+***************************************************************/
+static int Cpool_Grow ( TCP_CONN_POOL *pool )
+{
+	TCP_POOL_DEST	*old = pool->dests;
+	TCP_POOL_DEST	*dests;
+	unsigned	 size = ( pool->mask + 1 ) * 2;
+	unsigned	 i;
+	unsigned	 slot;
+
+	dests = ( TCP_POOL_DEST * ) calloc ( size, sizeof ( TCP_POOL_DEST ) );
+	if ( !dests )
+		return -1;
+
+	for ( i = 0; i <= pool->mask; i++ )
+	{
+		if ( !old[i].used )
+			continue;
+		slot = Cpool_Hash ( old[i].ipaddr, old[i].port ) & ( size - 1 );
+		while ( dests[slot].used )
+			slot = ( slot + 1 ) & ( size - 1 );
+		dests[slot] = old[i];
+	}
+
+	free ( old );
+	pool->dests = dests;
+	pool->mask = size - 1;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Cpool_Find
+*
+* FUNCTION:             Looks a destination up, adding it when
+*                       create is set.
+*
+* NOTE:                 Adding may move every destination.
+*
+* RETURNS:              TCP_POOL_DEST * - 0 if not there / no memory
+***************************************************************/
+static TCP_POOL_DEST *Cpool_Find ( TCP_CONN_POOL *pool, const char *ipaddr, TCP_PORT port, int create )
+{
+	TCP_POOL_DEST	*dest;
+	unsigned	 slot;
+
+	if ( strlen ( ipaddr ) >= sizeof ( TCP_IPADDR ) )
+		return 0;
+
+	for ( slot = Cpool_Hash ( ipaddr, port ) & pool->mask; pool->dests[slot].used; slot = ( slot + 1 ) & pool->mask )
+	{
+		dest = &pool->dests[slot];
+		if ( dest->port == port && !strcmp ( dest->ipaddr, ipaddr ) )
+			return dest;
+	}
+	if ( !create )
+		return 0;
+
+	/* keep the table at most three quarters full */
+	if ( ( pool->used + 1 ) * 4 > ( pool->mask + 1 ) * 3 )
+	{
+		if ( Cpool_Grow ( pool ) < 0 )
+			return 0;
+		for ( slot = Cpool_Hash ( ipaddr, port ) & pool->mask; pool->dests[slot].used; slot = ( slot + 1 ) & pool->mask )
+			;
+	}
+
+	dest = &pool->dests[slot];
+	dest->idle = ( TCP_POOL_IDLE * ) calloc ( pool->max_idle, sizeof ( TCP_POOL_IDLE ) );
+	if ( !dest->idle )
+		return 0;
+	strcpy ( dest->ipaddr, ipaddr );
+	dest->port = port;
+	dest->count = 0;
+	dest->used = 1;
+	pool->used++;
+
+	return dest;
+}
+
+/***************************************************************
+*
+* NAME:                           Cpool_Drop
+*
+* FUNCTION:             Closes a connection and gives it back to
+*                       get_conn_info.
+*
+***************************************************************/
+static void Cpool_Drop ( TCP_CONN_POOL *pool, TCP_CONNECTION_INFO *connection )
+{
+	if ( connection->sock && *connection->sock >= 0 )
+		pool->tcp->close_sock ( connection );
+	pool->tcp->clean_conn_info ( connection );
+}
+
+/***************************************************************
+*
+* NAME:                           Cpool_Open
+*
+* FUNCTION:             A connection with its address set and a
+*                       socket, not yet connected.
+*
+* RETURNS:              TCP_CONNECTION_INFO * - 0 when the address
+*                       doesn't resolve or there is no socket
+***************************************************************/
+static TCP_CONNECTION_INFO *Cpool_Open ( TCP_CONN_POOL *pool, const char *ipaddr, TCP_PORT port )
+{
+	TCP_CONNECTION_INFO	*connection;
+	int			 saved;
+
+	connection = pool->tcp->get_conn_info ( );
+	if ( !connection )
+		return 0;
+
+	strcpy ( connection->ipaddr, ipaddr );
+	connection->port = port;
+	connection->sockaddr_len = sizeof ( struct sockaddr_in );
+	pool->tcp->set_sockaddr ( connection, AF_INET );
+	if ( connection->sockaddr->sin_addr.s_addr == INADDR_NONE
+	  || pool->tcp->get_sock ( connection, AF_INET, SOCK_STREAM, 0 ) < 0 )
+	{
+		saved = errno;
+		pool->tcp->clean_conn_info ( connection );
+		errno = saved;
+		return 0;
+	}
+
+	return connection;
+}
+
+/***************************************************************
+*
+* NAME:                           Cpool_Alive
+*
+* FUNCTION:             Whether an idle connection is still open
+*                       at the far end: a peek finds nothing to
+*                       read and would block. Guardian can't peek
+*                       without waiting, so there it always is.
+*
+* RETURNS:              int - 1 alive, 0 not
+***************************************************************/
+static int Cpool_Alive ( TCP_CONNECTION_INFO *connection )
+{
+#ifdef __TANDEM
+	return connection->sock && *connection->sock >= 0;
+#else
+	char	byte;
+	ssize_t	status;
+
+	if ( !connection->sock || *connection->sock < 0 )
+		return 0;
+	do
+		status = recv ( *connection->sock, &byte, 1, MSG_PEEK | MSG_DONTWAIT );
+	while ( status < 0 && errno == EINTR );
+
+	return status < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK );
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           Cpool_Push
+*
+* FUNCTION:             Puts a connection on top of its
+*                       destination's idle stack, or closes it
+*                       when the stack is full.
+*
+***************************************************************/
+static void Cpool_Push ( TCP_CONN_POOL *pool, TCP_POOL_DEST *dest, TCP_CONNECTION_INFO *connection, long long now )
+{
+	if ( dest->count >= pool->max_idle )
+	{
+		Cpool_Drop ( pool, connection );
+		return;
+	}
+
+	dest->idle[dest->count].connection = connection;
+	dest->idle[dest->count].since = now;
+	dest->count++;
+}
+
+/***************************************************************
+*
+* NAME:                           Cpool_Warm
+*
+* FUNCTION:             Opens up to count (at most CPOOL_BATCH)
+*                       connections to dest with their connects
+*                       all in flight together, waits up to
+*                       connect_usec, and stacks the ones that
+*                       made it. On Guardian the connects are
+*                       made one by one.
+*
+* RETURNS:              int - connections stacked
+***************************************************************/
+static int Cpool_Warm ( TCP_CONN_POOL *pool, TCP_POOL_DEST *dest, int count )
+{
+	TCP_CONNECTION_INFO	*batch[CPOOL_BATCH];
+	int			 opened = 0;
+	int			 i;
+#ifdef __TANDEM
+	int			 status;
+
+	for ( i = 0; i < count; i++ )
+	{
+		batch[i] = Cpool_Open ( pool, dest->ipaddr, dest->port );
+		status = batch[i] ? pool->tcp->make_connect ( batch[i] ) : -1;
+		if ( status < 0 )
+		{
+			pool->failures++;
+			if ( batch[i] )
+				Cpool_Drop ( pool, batch[i] );
+			continue;
+		}
+		pool->connects++;
+		Cpool_Push ( pool, dest, batch[i], tcp_clock_usec ( ) );
+		opened++;
+	}
+#else
+	struct pollfd		 fds[CPOOL_BATCH];
+	int			 state[CPOOL_BATCH];	/* 0 connecting, 1 up, -1 failed */
+	int			 modes[CPOOL_BATCH];
+	int			 pending = 0;
+	int			 error;
+	long long		 deadline;
+	long long		 now;
+	TCP_SOCKLEN		 length;
+
+	for ( i = 0; i < count; i++ )
+	{
+		fds[i].fd = -1;
+		fds[i].events = POLLOUT;
+		fds[i].revents = 0;
+		state[i] = -1;
+		batch[i] = Cpool_Open ( pool, dest->ipaddr, dest->port );
+		if ( !batch[i] )
+			continue;
+
+		/* non-blocking for the connect only */
+		modes[i] = fcntl ( *batch[i]->sock, F_GETFL );
+		fcntl ( *batch[i]->sock, F_SETFL, modes[i] | O_NONBLOCK );
+		if ( stripe_connect ( batch[i] ) < 0 )
+			continue;
+		if ( connect ( *batch[i]->sock, ( struct sockaddr * ) batch[i]->sockaddr, sizeof ( struct sockaddr_in ) ) == 0 )
+			state[i] = 1;
+		else if ( errno == EINPROGRESS )
+		{
+			state[i] = 0;
+			fds[i].fd = *batch[i]->sock;
+			pending++;
+		}
+	}
+
+	deadline = tcp_clock_usec ( ) + pool->connect_usec;
+	while ( pending > 0 )
+	{
+		now = tcp_clock_usec ( );
+		if ( now >= deadline )
+			break;
+		if ( poll ( fds, count, ( int ) ( ( deadline - now + 999 ) / 1000 ) ) < 0 )
+		{
+			if ( errno == EINTR )
+				continue;
+			break;
+		}
+		for ( i = 0; i < count; i++ )
+		{
+			if ( fds[i].fd < 0 || !fds[i].revents )
+				continue;
+			error = 0;
+			length = sizeof ( error );
+			getsockopt ( fds[i].fd, SOL_SOCKET, SO_ERROR, &error, &length );
+			state[i] = error ? -1 : 1;
+			fds[i].fd = -1;
+			pending--;
+		}
+	}
+
+	now = tcp_clock_usec ( );
+	for ( i = 0; i < count; i++ )
+	{
+		if ( !batch[i] )
+		{
+			pool->failures++;
+			continue;
+		}
+		TCP_STATS_CALL ( &batch[i]->stats, TCP_OP_CONNECT, 0, state[i] > 0 ? 0 : -1 );
+		if ( state[i] <= 0 )
+		{
+			pool->failures++;
+			Cpool_Drop ( pool, batch[i] );
+			continue;
+		}
+		fcntl ( *batch[i]->sock, F_SETFL, modes[i] );
+		pool->connects++;
+		Cpool_Push ( pool, dest, batch[i], now );
+		opened++;
+	}
+#endif
+
+	return opened;
+}
+
+/***************************************************************
+*
+* NAME:                           cpool_new
+*
+* FUNCTION:             Makes a pool on tcp. Each destination
+*                       keeps at least min_idle (once pool_tick has
+*                       run) and at most max_idle connections, and
+*                       an idle one is closed after idle_usec
+*                       (0 = never).
+*
+* RETURNS:              TCP_CONN_POOL * - 0 on bad limits / no memory
+***************************************************************/
+TCP_CONN_POOL *cpool_new ( TCP *tcp, int min_idle, int max_idle, long idle_usec )
+{
+	TCP_CONN_POOL *pool;
+
+	if ( !tcp || min_idle < 0 || max_idle <= 0 || min_idle > max_idle || idle_usec < 0 )
+		return 0;
+
+	pool = ( TCP_CONN_POOL * ) calloc ( 1, sizeof ( TCP_CONN_POOL ) );
+	if ( !pool )
+		return 0;
+	pool->dests = ( TCP_POOL_DEST * ) calloc ( CPOOL_DESTS, sizeof ( TCP_POOL_DEST ) );
+	if ( !pool->dests )
+	{
+		free ( pool );
+		return 0;
+	}
+
+	pool->tcp = tcp;
+	pool->mask = CPOOL_DESTS - 1;
+	pool->min_idle = min_idle;
+	pool->max_idle = max_idle;
+	pool->idle_usec = idle_usec;
+	pool->connect_usec = TCP_POOL_CONNECT_USEC;
+
+	return pool;
+}
+
+/***************************************************************
+*
+* NAME:                           cpool_free
+*
+* FUNCTION:             Closes every idle connection and releases
+*                       the pool. Connections still checked out
+*                       are the caller's to close; don't check
+*                       them in afterwards. Called by release_tcp.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void cpool_free ( TCP_CONN_POOL *pool )
+{
+	unsigned i;
+
+	if ( !pool )
+		return;
+
+	for ( i = 0; i <= pool->mask; i++ )
+	{
+		if ( !pool->dests[i].used )
+			continue;
+		while ( pool->dests[i].count > 0 )
+			Cpool_Drop ( pool, pool->dests[i].idle[--pool->dests[i].count].connection );
+		free ( pool->dests[i].idle );
+	}
+	free ( pool->dests );
+	free ( pool );
+}
+
+/***************************************************************
+*
+* NAME:                           cpool_checkout
+*
+* FUNCTION:             A connected connection to ipaddr:port: the
+*                       most recently checked in idle one that is
+*                       still alive, else a new one (blocking
+*                       connect, as make_connect).
+*
+* RETURNS:              TCP_CONNECTION_INFO * - 0 when no connection
+*                       could be made (errno EAGAIN: a host name
+*                       still being looked up, try again shortly)
+***************************************************************/
+TCP_CONNECTION_INFO *cpool_checkout ( TCP_CONN_POOL *pool, const char *ipaddr, TCP_PORT port )
+{
+	TCP_POOL_DEST		*dest;
+	TCP_CONNECTION_INFO	*connection;
+	long long		 now;
+
+	/* the destination is kept even on a miss, so pool_tick warms it */
+	dest = Cpool_Find ( pool, ipaddr, port, 1 );
+	if ( dest && dest->count > 0 )
+	{
+		now = tcp_clock_usec ( );
+		while ( dest->count > 0 )
+		{
+			dest->count--;
+			connection = dest->idle[dest->count].connection;
+			if ( pool->idle_usec && now - dest->idle[dest->count].since > pool->idle_usec )
+			{
+				pool->expired++;
+				Cpool_Drop ( pool, connection );
+				continue;
+			}
+			if ( !Cpool_Alive ( connection ) )
+			{
+				pool->stale++;
+				Cpool_Drop ( pool, connection );
+				continue;
+			}
+			pool->hits++;
+			return connection;
+		}
+	}
+
+	pool->misses++;
+	if ( strlen ( ipaddr ) >= sizeof ( TCP_IPADDR ) )
+	{
+		pool->failures++;
+		return 0;
+	}
+	connection = Cpool_Open ( pool, ipaddr, port );
+	if ( !connection || pool->tcp->make_connect ( connection ) < 0 )
+	{
+		pool->failures++;
+		if ( connection )
+			Cpool_Drop ( pool, connection );
+		return 0;
+	}
+
+	pool->connects++;
+	return connection;
+}
+
+/***************************************************************
+*
+* NAME:                           cpool_checkin
+*
+* FUNCTION:             Hands a connection from pool_checkout back.
+*                       With reuse set it goes on top of its
+*                       destination's idle stack (unless that holds
+*                       max_idle already); otherwise it is closed.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void cpool_checkin ( TCP_CONN_POOL *pool, TCP_CONNECTION_INFO *connection, int reuse )
+{
+	TCP_POOL_DEST *dest;
+
+	if ( !connection )
+		return;
+
+	if ( !reuse || !connection->sock || *connection->sock < 0
+	  || ( dest = Cpool_Find ( pool, connection->ipaddr, connection->port, 1 ) ) == 0 )
+	{
+		Cpool_Drop ( pool, connection );
+		return;
+	}
+
+	Cpool_Push ( pool, dest, connection, tcp_clock_usec ( ) );
+}
+
+/***************************************************************
+*
+* NAME:                           cpool_prewarm
+*
+* FUNCTION:             Opens up to count new connections to
+*                       ipaddr:port and leaves them idle, as far as
+*                       max_idle allows. The connects all go out at
+*                       once and are waited for together, at most
+*                       connect_usec.
+*
+* RETURNS:              int - connections opened, -1 on no memory
+***************************************************************/
+int cpool_prewarm ( TCP_CONN_POOL *pool, const char *ipaddr, TCP_PORT port, int count )
+{
+	TCP_POOL_DEST	*dest;
+	int		 opened = 0;
+	int		 batch;
+
+	dest = Cpool_Find ( pool, ipaddr, port, 1 );
+	if ( !dest )
+		return -1;
+
+	if ( count > pool->max_idle - dest->count )
+		count = pool->max_idle - dest->count;
+	while ( count > 0 )
+	{
+		batch = count < CPOOL_BATCH ? count : CPOOL_BATCH;
+		opened += Cpool_Warm ( pool, dest, batch );
+		count -= batch;
+	}
+
+	return opened;
+}
+
+/***************************************************************
+*
+* NAME:                           cpool_tick
+*
+* FUNCTION:             Housekeeping, every second or so: closes
+*                       connections idle longer than idle_usec
+*                       (the bottom of each stack) and warms every
+*                       destination back up to min_idle.
+*
+* RETURNS:              int - connections opened
+***************************************************************/
+int cpool_tick ( TCP_CONN_POOL *pool )
+{
+	TCP_POOL_DEST	*dest;
+	long long	 now = tcp_clock_usec ( );
+	unsigned	 i;
+	int		 old;
+	int		 opened = 0;
+
+	for ( i = 0; i <= pool->mask; i++ )
+	{
+		dest = &pool->dests[i];
+		if ( !dest->used )
+			continue;
+
+		old = 0;
+		while ( pool->idle_usec && old < dest->count && now - dest->idle[old].since > pool->idle_usec )
+			Cpool_Drop ( pool, dest->idle[old++].connection );
+		if ( old )
+		{
+			pool->expired += old;
+			dest->count -= old;
+			memmove ( dest->idle, dest->idle + old, dest->count * sizeof ( TCP_POOL_IDLE ) );
+		}
+
+		if ( dest->count < pool->min_idle )
+			opened += cpool_prewarm ( pool, dest->ipaddr, dest->port, pool->min_idle - dest->count );
+	}
+
+	return opened;
+}
+
+/***************************************************************
+*
+* NAME:                           cpool_idle
+*
+* FUNCTION:             Idle connections held for ipaddr:port.
+*
+* RETURNS:                           int
+***************************************************************/
+int cpool_idle ( TCP_CONN_POOL *pool, const char *ipaddr, TCP_PORT port )
+{
+	TCP_POOL_DEST *dest = Cpool_Find ( pool, ipaddr, port, 0 );
+
+	return dest ? dest->count : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,147 @@
+/************************************************************************************
+*		FILE:		"nscpool.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Client connection pool: connections to a destination
+*					(ipaddr, port) are kept open between transactions and
+*					handed out again, so a short transaction skips the
+*					socket, connect handshake and connection setup.
+*
+*		Notes:		A transaction is
+*
+*						conn = tcp->pool_checkout ( pool, ipaddr, port );
+*						... new_send / new_recv on conn ...
+*						tcp->pool_checkin ( pool, conn, ok );
+*
+*					checkin with ok = 0 (the exchange failed, or the
+*					protocol leaves the stream in an unknown state)
+*					closes the connection instead of keeping it.
+*
+*					Idle connections of a destination are a stack: the
+*					one checked in last goes out first, so the busy few
+*					stay warm and the rest sink to the bottom, where
+*					pool_tick closes them once idle_usec has passed.
+*					pool_tick also tops every destination back up to
+*					min_idle, and no destination keeps more than
+*					max_idle.
+*
+*					Before handing out an idle connection, checkout
+*					makes sure the peer hasn't closed it meanwhile: a
+*					peek that would block means it is alive; end of
+*					stream, an error or unasked-for data mean it is
+*					dropped and the next one tried. Guardian has no
+*					non-blocking peek, so there only the age is checked.
+*
+*					pool_prewarm opens count connections at once, all
+*					connects in flight together, and waits at most
+*					connect_usec for them. On Guardian they are made one
+*					after another.
+*
+*					Pooled connections are plain blocking sockets from
+*					get_conn_info, and come back as they were left:
+*					a framer or coalescing buffer stays attached. The
+*					pool belongs to one thread, like its TCP.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.19.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifndef _NSCPOOLH_INCLUDE_
+#define _NSCPOOLH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* default limit on a pool_prewarm wait */
+#define TCP_POOL_CONNECT_USEC		1000000L
+
+/***************************************************************
+*
+*	Name:		TCP_POOL_IDLE
+*	Type:		struct
+*	Purpose:	One idle connection and when it was checked
+*				in.
+*
+***************************************************************/
+typedef struct tcp_pool_idle
+{
+	TCP_CONNECTION_INFO		*connection;
+	long long			since;
+} TCP_POOL_IDLE;
+
+/***************************************************************
+*
+*	Name:		TCP_POOL_DEST
+*	Type:		struct
+*	Purpose:	The idle connections to one destination,
+*				oldest first: idle[count - 1] goes out next.
+*
+***************************************************************/
+typedef struct tcp_pool_dest
+{
+	TCP_IPADDR			ipaddr;
+	TCP_PORT			port;
+	int				used;
+	int				count;
+	TCP_POOL_IDLE			*idle;		/* max_idle entries */
+} TCP_POOL_DEST;
+
+/***************************************************************
+*
+*	Name:		TCP_CONN_POOL
+*	Type:		struct
+*	Purpose:	A pool (TCP::conn_pool): destinations in an
+*				open-addressed hash table of size mask + 1,
+*				the limits, and counters of how checkouts
+*				went.
+*
+***************************************************************/
+typedef struct tcp_conn_pool
+{
+	TCP				*tcp;
+	TCP_POOL_DEST			*dests;
+	unsigned			 mask;
+	unsigned			 used;
+	int				 min_idle;
+	int				 max_idle;
+	long				 idle_usec;	/* 0 = keep for ever */
+	long				 connect_usec;	/* pool_prewarm wait */
+
+	long				 hits;		/* checkouts given an idle connection */
+	long				 misses;	/* checkouts that had to connect */
+	long				 stale;		/* idle connections the peer had closed */
+	long				 expired;	/* closed after idle_usec */
+	long				 connects;	/* connections made */
+	long				 failures;	/* connects that failed */
+} TCP_CONN_POOL;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+TCP_CONN_POOL *cpool_new ( TCP *tcp, int min_idle, int max_idle, long idle_usec );
+void cpool_free ( TCP_CONN_POOL *pool );
+TCP_CONNECTION_INFO *cpool_checkout ( TCP_CONN_POOL *pool, const char *ipaddr, TCP_PORT port );
+void cpool_checkin ( TCP_CONN_POOL *pool, TCP_CONNECTION_INFO *connection, int reuse );
+int cpool_prewarm ( TCP_CONN_POOL *pool, const char *ipaddr, TCP_PORT port, int count );
+int cpool_tick ( TCP_CONN_POOL *pool );
+int cpool_idle ( TCP_CONN_POOL *pool, const char *ipaddr, TCP_PORT port );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSCPOOLH_INCLUDE_
@@ -0,0 +1,490 @@
+/************************************************************************************
+*		FILE:		"nsctab.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Connection table for many sockets per TCP. See nsctab.h.
+*
+*		Notes:		Removing a connection swaps the last entry of live[]
+*					into its place, so live[] stays packed and adding or
+*					removing is O(1).
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.5.0	  10/17/26		Initial Release
+*		1.11.0	  10/17/26		Counted in the operation counters
+*		1.12.0	  10/17/26		conn_set_timeouts
+*		1.25.1	  10/17/26		Receive timeouts end with TCP_ETIMEDOUT
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nsctabh"
+#include "=nsstatsh"
+#include "=nstimerh"
+#else
+#include "NSCTAB.h"
+#include "NSSTATS.h"
+#include "NSTIMER.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Conn_Handle
+*
+* FUNCTION:             Builds the handle for a slot from its
+*                       current generation.
+*
+* RETURNS:                     TCP_HANDLE
+***************************************************************/
+static TCP_HANDLE Conn_Handle ( TCP_CONN_TABLE *table, unsigned slot )
+{
+	return ( ( TCP_HANDLE ) table->generation[slot] << TCP_HANDLE_INDEX_BITS ) | slot;
+}
+
+/***************************************************************
+*
+* NAME:                           Conn_Map_Fd
+*
+* FUNCTION:             Records which slot owns a descriptor,
+*                       growing the fd map as needed.
+*
+* RETURNS:                int - 0, or -1 when out of memory
+***************************************************************/
+static int Conn_Map_Fd ( TCP_CONN_TABLE *table, int fd, unsigned slot_plus_one )
+{
+	unsigned   *grown;
+	int         count;
+
+	if ( fd < 0 )
+		return 0;
+
+	if ( fd >= table->fd_count )
+	{
+		count = table->fd_count ? table->fd_count * 2 : 1024;
+		while ( count <= fd )
+			count *= 2;
+
+		grown = ( unsigned * ) realloc ( table->slot_of_fd, count * sizeof ( unsigned ) );
+		if ( !grown )
+			return -1;
+
+		memset ( grown + table->fd_count, 0, ( count - table->fd_count ) * sizeof ( unsigned ) );
+		table->slot_of_fd = grown;
+		table->fd_count = count;
+	}
+
+	table->slot_of_fd[fd] = slot_plus_one;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           conn_table_new
+*
+* FUNCTION:             Makes a table for up to capacity
+*                       connections. All memory is taken here.
+*
+* RETURNS:          TCP_CONN_TABLE * - 0 on bad size / no memory
+***************************************************************/
+TCP_CONN_TABLE *conn_table_new ( int capacity )
+{
+	TCP_CONN_TABLE *table;
+	unsigned        i;
+
+	if ( capacity <= 0 || ( unsigned ) capacity > TCP_HANDLE_INDEX_MASK )
+		return 0;
+
+	table = ( TCP_CONN_TABLE * ) calloc ( 1, sizeof ( TCP_CONN_TABLE ) );
+	if ( !table )
+		return 0;
+
+	table->capacity = ( unsigned ) capacity;
+	table->fd = ( int * ) malloc ( capacity * sizeof ( int ) );
+	table->state = ( unsigned char * ) calloc ( capacity, 1 );
+	table->generation = ( unsigned char * ) malloc ( capacity );
+	table->tag = ( long * ) calloc ( capacity, sizeof ( long ) );
+	table->pending = ( long * ) calloc ( capacity, sizeof ( long ) );
+	table->stats = ( TCP_CONN_STATS * ) calloc ( capacity, sizeof ( TCP_CONN_STATS ) );
+	table->live = ( unsigned * ) malloc ( capacity * sizeof ( unsigned ) );
+	table->live_pos = ( unsigned * ) malloc ( capacity * sizeof ( unsigned ) );
+	table->free_slots = ( unsigned * ) malloc ( capacity * sizeof ( unsigned ) );
+	table->cold = ( TCP_CONN_COLD * ) calloc ( capacity, sizeof ( TCP_CONN_COLD ) );
+
+	if ( !table->fd || !table->state || !table->generation || !table->tag || !table->pending
+	  || !table->stats || !table->live || !table->live_pos || !table->free_slots || !table->cold )
+	{
+		conn_table_free ( table );
+		return 0;
+	}
+
+	/* hand out low slots first; generation 0 is never used so a
+	*  handle is never TCP_HANDLE_NONE */
+	for ( i = 0; i < table->capacity; i++ )
+	{
+		table->fd[i] = -1;
+		table->generation[i] = 1;
+		table->free_slots[i] = table->capacity - 1 - i;
+	}
+	table->free_count = table->capacity;
+
+	return table;
+}
+
+/***************************************************************
+*
+* NAME:                           conn_table_free
+*
+* FUNCTION:             Releases a table. Sockets are left alone.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void conn_table_free ( TCP_CONN_TABLE *table )
+{
+	unsigned i;
+
+	if ( !table )
+		return;
+
+	/* the wheel must not keep pointers into the table */
+	for ( i = 0; i < table->capacity; i++ )
+	{
+		if ( table->recv_timer )
+			timer_cancel ( &table->recv_timer[i] );
+		if ( table->idle_timer )
+			timer_cancel ( &table->idle_timer[i] );
+	}
+	free ( table->recv_timer );
+	free ( table->idle_timer );
+
+	free ( table->fd );
+	free ( table->state );
+	free ( table->generation );
+	free ( table->tag );
+	free ( table->pending );
+	free ( table->stats );
+	free ( table->live );
+	free ( table->live_pos );
+	free ( table->free_slots );
+	free ( table->slot_of_fd );
+	free ( table->cold );
+	free ( table );
+}
+
+/***************************************************************
+*
+* NAME:                           conn_add
+*
+* FUNCTION:             Takes a free slot for a socket.
+*
+* RETURNS:            TCP_HANDLE - TCP_HANDLE_NONE when full
+***************************************************************/
+TCP_HANDLE conn_add ( TCP_CONN_TABLE *table, int fd, int state, long tag )
+{
+	unsigned slot;
+
+	if ( !table->free_count )
+		return TCP_HANDLE_NONE;
+
+	slot = table->free_slots[table->free_count - 1];
+	if ( Conn_Map_Fd ( table, fd, slot + 1 ) < 0 )
+		return TCP_HANDLE_NONE;
+	table->free_count--;
+
+	table->fd[slot] = fd;
+	table->state[slot] = ( unsigned char ) ( state == TCP_CONN_FREE ? TCP_CONN_OPEN : state );
+	table->tag[slot] = tag;
+	table->pending[slot] = 0;
+	memset ( &table->stats[slot], 0, sizeof ( TCP_CONN_STATS ) );
+	memset ( &table->cold[slot], 0, sizeof ( TCP_CONN_COLD ) );
+
+	table->live_pos[slot] = table->count;
+	table->live[table->count++] = slot;
+
+	if ( table->idle_usec )
+		timer_arm ( &table->idle_timer[slot], table->idle_usec );
+
+	return Conn_Handle ( table, slot );
+}
+
+/***************************************************************
+*
+* NAME:                           conn_valid
+*
+* FUNCTION:             Checks a handle still names a live
+*                       connection.
+*
+* RETURNS:                  int - 1 valid, 0 stale
+***************************************************************/
+int conn_valid ( TCP_CONN_TABLE *table, TCP_HANDLE handle )
+{
+	unsigned slot = TCP_HANDLE_INDEX ( handle );
+
+	return slot < table->capacity
+		&& table->state[slot] != TCP_CONN_FREE
+		&& table->generation[slot] == TCP_HANDLE_GENERATION ( handle );
+}
+
+/***************************************************************
+*
+* NAME:                           conn_remove
+*
+* FUNCTION:             Frees a connection's slot. The socket is
+*                       not closed; do that first (close_sock /
+*                       FILE_CLOSE_).
+*
+* RETURNS:                         nothing
+***************************************************************/
+void conn_remove ( TCP_CONN_TABLE *table, TCP_HANDLE handle )
+{
+	unsigned slot = TCP_HANDLE_INDEX ( handle );
+	unsigned pos;
+	unsigned last;
+
+	if ( !conn_valid ( table, handle ) )
+		return;
+
+	if ( table->fd[slot] >= 0 && table->fd[slot] < table->fd_count
+	  && table->slot_of_fd[table->fd[slot]] == slot + 1 )
+		table->slot_of_fd[table->fd[slot]] = 0;
+
+	/* keep live[] packed */
+	pos = table->live_pos[slot];
+	last = table->live[--table->count];
+	table->live[pos] = last;
+	table->live_pos[last] = pos;
+
+	if ( table->recv_timer )
+		timer_cancel ( &table->recv_timer[slot] );
+	if ( table->idle_timer )
+		timer_cancel ( &table->idle_timer[slot] );
+
+	table->state[slot] = TCP_CONN_FREE;
+	table->fd[slot] = -1;
+	table->generation[slot] = ( unsigned char ) ( ( table->generation[slot] + 1 ) & 0x7f );
+	if ( !table->generation[slot] )
+		table->generation[slot] = 1;
+
+	table->free_slots[table->free_count++] = slot;
+}
+
+/***************************************************************
+*
+* NAME:                           conn_by_fd
+*
+* FUNCTION:             Finds the connection that owns a socket.
+*
+* RETURNS:            TCP_HANDLE - TCP_HANDLE_NONE if none
+***************************************************************/
+TCP_HANDLE conn_by_fd ( TCP_CONN_TABLE *table, int fd )
+{
+	if ( fd < 0 || fd >= table->fd_count || !table->slot_of_fd[fd] )
+		return TCP_HANDLE_NONE;
+
+	return Conn_Handle ( table, table->slot_of_fd[fd] - 1 );
+}
+
+/***************************************************************
+*
+* NAME:                           conn_cold
+*
+* FUNCTION:             Address / name details of a connection.
+*
+* RETURNS:          TCP_CONN_COLD * - 0 for a stale handle
+***************************************************************/
+TCP_CONN_COLD *conn_cold ( TCP_CONN_TABLE *table, TCP_HANDLE handle )
+{
+	if ( !conn_valid ( table, handle ) )
+		return 0;
+
+	return &table->cold[TCP_HANDLE_INDEX ( handle )];
+}
+
+/***************************************************************
+*
+* NAME:                           conn_send_nw
+*
+* FUNCTION:             send_nw on a table connection. The handle
+*                       (marked as a send) is the nowait tag, so
+*                       conn_complete can route the completion.
+*
+* RETURNS:              int - send_nw status, -1 for a stale handle
+***************************************************************/
+int conn_send_nw ( TCP_CONN_TABLE *table, TCP_HANDLE handle, char *buffer, int length )
+{
+	unsigned slot = TCP_HANDLE_INDEX ( handle );
+	int      status;
+
+	if ( !conn_valid ( table, handle ) )
+		return -1;
+
+	status = send_nw ( table->fd[slot]
+					 , buffer
+					 , length
+					 , 0
+					 , ( long ) ( handle | TCP_CONN_TAG_SEND ) );
+
+	if ( status == 0 )
+		table->pending[slot] += length;
+	TCP_STATS_SUBMIT ( &table->stats[slot], TCP_OP_SEND, status );
+
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           conn_recv_nw
+*
+* FUNCTION:             recv_nw on a table connection, tagged with
+*                       its handle. With a receive timeout set, the
+*                       receive completes with TCP_ETIMEDOUT if nothing
+*                       arrives in time.
+*
+* RETURNS:              int - recv_nw status, -1 for a stale handle
+***************************************************************/
+int conn_recv_nw ( TCP_CONN_TABLE *table, TCP_HANDLE handle, char *buffer, int length )
+{
+	unsigned slot = TCP_HANDLE_INDEX ( handle );
+	int      status;
+
+	if ( !conn_valid ( table, handle ) )
+		return -1;
+
+	status = recv_nw ( table->fd[slot]
+					 , buffer
+					 , length
+					 , 0
+					 , ( long ) handle );
+	TCP_STATS_SUBMIT ( &table->stats[slot], TCP_OP_RECV, status );
+	if ( status == 0 && table->recv_usec )
+		timer_deadline ( &table->recv_timer[slot], table->fd[slot], ( long ) handle, table->recv_usec );
+
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           conn_complete
+*
+* FUNCTION:             Maps a reaped completion back to its
+*                       connection and settles the pending count
+*                       for sends. Completions not submitted through
+*                       the table are matched on their socket.
+*
+* RETURNS:            TCP_HANDLE - TCP_HANDLE_NONE if no match
+***************************************************************/
+TCP_HANDLE conn_complete ( TCP_CONN_TABLE *table, TCP_COMPLETION *completion )
+{
+	unsigned long   tag = ( unsigned long ) completion->tag;
+	TCP_HANDLE      handle = ( TCP_HANDLE ) ( tag & ~TCP_CONN_TAG_SEND );
+	unsigned        slot = TCP_HANDLE_INDEX ( handle );
+
+	if ( !conn_valid ( table, handle ) || table->fd[slot] != completion->sock )
+		return conn_by_fd ( table, completion->sock );
+
+	if ( tag & TCP_CONN_TAG_SEND )
+	{
+		table->pending[slot] -= completion->length;
+		if ( table->pending[slot] < 0 )
+			table->pending[slot] = 0;
+		TCP_STATS_CONN_COMPLETE ( &table->stats[slot], TCP_OP_SEND, completion );
+	}
+	else
+	{
+		TCP_STATS_CONN_COMPLETE ( &table->stats[slot], TCP_OP_RECV, completion );
+		if ( table->recv_timer )
+			timer_cancel ( &table->recv_timer[slot] );
+	}
+
+	/* traffic moved: the connection isn't idle */
+	if ( table->idle_usec && !completion->error && completion->count > 0 )
+		timer_arm ( &table->idle_timer[slot], table->idle_usec );
+
+	return handle;
+}
+
+/***************************************************************
+*
+* NAME:                           Conn_Idle_Expired
+*
+* FUNCTION:             Idle timer callback: hands the connection to
+*                       the table's on_idle handler, which usually
+*                       closes it and calls conn_remove.
+*
+***************************************************************/
+static void Conn_Idle_Expired ( TCP_TIMER *timer, void *context )
+{
+	TCP_CONN_TABLE	*table = ( TCP_CONN_TABLE * ) context;
+	unsigned	 slot = ( unsigned ) ( timer - table->idle_timer );
+
+	if ( table->state[slot] != TCP_CONN_FREE && table->on_idle )
+		table->on_idle ( table, Conn_Handle ( table, slot ), table->idle_context );
+}
+
+/***************************************************************
+*
+* NAME:                           conn_set_timeouts
+*
+* FUNCTION:             Sets the table's receive timeout (how long a
+*                       conn_recv_nw may stay outstanding) and idle
+*                       timeout (how long a connection may go without
+*                       a completed send or receive before on_idle is
+*                       called). 0 turns either off. Connections
+*                       already in the table get the idle timer now.
+*
+* NOTE:                 Timers run on the thread that calls this;
+*                       use the table from that thread only.
+*
+* RETURNS:              int - 0, -1 when out of memory
+***************************************************************/
+int conn_set_timeouts ( TCP_CONN_TABLE *table, long recv_usec, long idle_usec, TCP_CONN_IDLE on_idle, void *context )
+{
+	unsigned i;
+
+	if ( recv_usec > 0 && !table->recv_timer )
+	{
+		table->recv_timer = ( TCP_TIMER * ) calloc ( table->capacity, sizeof ( TCP_TIMER ) );
+		if ( !table->recv_timer )
+			return -1;
+	}
+	if ( idle_usec > 0 && !table->idle_timer )
+	{
+		table->idle_timer = ( TCP_TIMER * ) calloc ( table->capacity, sizeof ( TCP_TIMER ) );
+		if ( !table->idle_timer )
+			return -1;
+		for ( i = 0; i < table->capacity; i++ )
+			timer_init ( &table->idle_timer[i], Conn_Idle_Expired, table );
+	}
+
+	table->recv_usec = recv_usec > 0 ? recv_usec : 0;
+	table->idle_usec = idle_usec > 0 ? idle_usec : 0;
+	table->on_idle = on_idle;
+	table->idle_context = context;
+
+	for ( i = 0; i < table->count; i++ )
+	{
+		if ( table->recv_timer && !table->recv_usec )
+			timer_cancel ( &table->recv_timer[table->live[i]] );
+		if ( table->idle_usec )
+			timer_arm ( &table->idle_timer[table->live[i]], table->idle_usec );
+		else if ( table->idle_timer )
+			timer_cancel ( &table->idle_timer[table->live[i]] );
+	}
+
+	return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
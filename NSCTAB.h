@@ -0,0 +1,172 @@
+/************************************************************************************
+*		FILE:		"nsctab.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Connection table, so one TCP can look after tens of
+*					thousands of sockets instead of one tcp_connect each.
+*
+*		Notes:		Connections are named by a TCP_HANDLE: the slot index
+*					in the low 24 bits and a 7-bit generation count above
+*					it, so a stale handle to a reused slot is caught. The
+*					top bit is left free: conn_send_nw/conn_recv_nw use the
+*					handle as the nowait tag and mark sends with it.
+*
+*					Fields touched on every event (fd, state, tag, bytes
+*					pending) are kept in their own dense arrays; addresses
+*					and names live apart in the cold array. live[] lists
+*					the slots in use, so dispatch walks count entries
+*					rather than the whole capacity.
+*
+*					The capacity is fixed when the table is made, which
+*					keeps memory use predictable.
+*
+*					conn_set_timeouts puts a receive deadline and an idle
+*					timer on every connection, kept on the thread's timer
+*					wheel (nstimer.h): conn_recv_nw arms the deadline,
+*					conn_complete clears it and pushes the idle timer back.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.5.0	  10/17/26		Initial Release
+*		1.11.0	  10/17/26		Per-connection counters (stats array)
+*		1.12.0	  10/17/26		conn_set_timeouts: receive deadline, idle timeout
+*		1.25.1	  10/17/26		TCP_CONN_COLD::tune_short
+*************************************************************************************/
+
+#ifndef _NSCTABH_INCLUDE_
+#define _NSCTABH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* handle layout */
+#define TCP_HANDLE_INDEX_BITS		24
+#define TCP_HANDLE_INDEX_MASK		( ( 1u << TCP_HANDLE_INDEX_BITS ) - 1 )
+#define TCP_HANDLE_INDEX(h)		( ( h ) & TCP_HANDLE_INDEX_MASK )
+#define TCP_HANDLE_GENERATION(h)	( ( ( h ) >> TCP_HANDLE_INDEX_BITS ) & 0x7fu )
+#define TCP_HANDLE_NONE			0u
+#define TCP_CONN_TAG_SEND		0x80000000ul
+
+/* connection states */
+enum
+{
+	TCP_CONN_FREE = 0,
+	TCP_CONN_OPEN,
+	TCP_CONN_LISTENING,
+	TCP_CONN_CONNECTING,
+	TCP_CONN_CONNECTED,
+	TCP_CONN_CLOSING
+};
+
+/***************************************************************
+*
+*	Name:		TCP_CONN_COLD
+*	Type:		struct
+*	Purpose:	Per-connection details that are only needed
+*				when setting up, logging or reconnecting.
+*				tune_short is what the sharded server's
+*				tuning profile fell short of on an accepted
+*				socket (see nstune.h).
+*
+***************************************************************/
+typedef struct tcp_conn_cold
+{
+	TCP_IPADDR			ipaddr;
+	TCP_PORT			port;
+	TCP_PROC_NAME			process_name;
+	struct sockaddr_in		sockaddr;
+	long				sockaddr_len;
+	void				*user;
+	int				tune_short;
+} TCP_CONN_COLD;
+
+/***************************************************************
+*
+*	Name:		TCP_CONN_TABLE
+*	Type:		struct
+*	Purpose:	Struct-of-arrays connection table. Index the
+*				hot arrays with TCP_HANDLE_INDEX(handle), or
+*				use the TCP_CONN_* macros below.
+*
+***************************************************************/
+typedef struct tcp_conn_table
+{
+	unsigned			capacity;
+	unsigned			count;
+
+	/* hot: one entry per slot */
+	int				*fd;
+	unsigned char			*state;
+	unsigned char			*generation;
+	long				*tag;
+	long				*pending;	/* bytes in conn_send_nw calls not yet completed */
+	TCP_CONN_STATS			*stats;		/* see nsstats.h */
+
+	/* slots in use, packed; live_pos[slot] is the slot's place in live */
+	unsigned			*live;
+	unsigned			*live_pos;
+
+	/* unused slots */
+	unsigned			*free_slots;
+	unsigned			free_count;
+
+	/* fd -> slot + 1 (0 = none), grown on demand */
+	unsigned			*slot_of_fd;
+	int				fd_count;
+
+	/* cold */
+	TCP_CONN_COLD			*cold;
+
+	/* timeouts, one timer per slot; 0 until conn_set_timeouts */
+	struct tcp_timer		*recv_timer;
+	struct tcp_timer		*idle_timer;
+	long				recv_usec;
+	long				idle_usec;
+	TCP_CONN_IDLE			on_idle;
+	void				*idle_context;
+} TCP_CONN_TABLE;
+
+/* hot-field access by handle; the handle must be valid */
+#define TCP_CONN_FD(t, h)		( ( t )->fd[TCP_HANDLE_INDEX ( h )] )
+#define TCP_CONN_STATE(t, h)		( ( t )->state[TCP_HANDLE_INDEX ( h )] )
+#define TCP_CONN_TAG(t, h)		( ( t )->tag[TCP_HANDLE_INDEX ( h )] )
+#define TCP_CONN_PENDING(t, h)		( ( t )->pending[TCP_HANDLE_INDEX ( h )] )
+#define TCP_CONN_STATS_OF(t, h)		( &( t )->stats[TCP_HANDLE_INDEX ( h )] )
+
+/* handle of the i'th live connection, 0 <= i < count */
+#define TCP_CONN_LIVE(t, i)		( ( ( unsigned ) ( t )->generation[( t )->live[i]] << TCP_HANDLE_INDEX_BITS ) \
+					| ( t )->live[i] )
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+TCP_CONN_TABLE *conn_table_new ( int capacity );
+void conn_table_free ( TCP_CONN_TABLE *table );
+TCP_HANDLE conn_add ( TCP_CONN_TABLE *table, int fd, int state, long tag );
+void conn_remove ( TCP_CONN_TABLE *table, TCP_HANDLE handle );
+int conn_valid ( TCP_CONN_TABLE *table, TCP_HANDLE handle );
+TCP_HANDLE conn_by_fd ( TCP_CONN_TABLE *table, int fd );
+TCP_CONN_COLD *conn_cold ( TCP_CONN_TABLE *table, TCP_HANDLE handle );
+int conn_send_nw ( TCP_CONN_TABLE *table, TCP_HANDLE handle, char *buffer, int length );
+int conn_recv_nw ( TCP_CONN_TABLE *table, TCP_HANDLE handle, char *buffer, int length );
+TCP_HANDLE conn_complete ( TCP_CONN_TABLE *table, TCP_COMPLETION *completion );
+int conn_set_timeouts ( TCP_CONN_TABLE *table, long recv_usec, long idle_usec, TCP_CONN_IDLE on_idle, void *context );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSCTABH_INCLUDE_
@@ -0,0 +1,915 @@
+/************************************************************************************
+*		FILE:		"nsdns.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Host name cache and background resolver. See nsdns.h.
+*
+*		Notes:		The cache is set associative: a name hashes to a set
+*					of DNS_WAYS entries and pushes out the least recently
+*					used one there, so a probe touches one or two cache
+*					lines and nothing is allocated after setup. Readers
+*					take no lock: they copy the entry between two reads of
+*					a sequence number that writers (a miss, a refresh or a
+*					lookup result, under one mutex) make odd while they
+*					work, and retry if it moved.
+*
+*					An entry waiting for the resolver is never pushed out,
+*					and is queued at most once, so the queue can't hold
+*					more names than the cache has entries.
+*
+*					Nothing holds the cache lock while taking the queue
+*					lock. tcp_resolver_config and tcp_resolver_stop free
+*					what readers look at, so call them while no other
+*					thread is resolving.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.13.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Misses don't wait unless miss_wait_usec asks to
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nsdnsh"
+#else
+#include "NSDNS.h"
+#include <pthread.h>
+#endif
+#include <ctype.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						TYPES AND CONSTANTS
+***************************************************************************************/
+
+#define DNS_WAYS			4
+#define DNS_ENTRIES			1024
+#define DNS_TTL_USEC			60000000L
+#define DNS_NEGATIVE_USEC		5000000L
+#define DNS_STALE_USEC			600000000L
+#define DNS_LINE			512
+#define DNS_FOREVER			( 1LL << 60 )
+
+enum
+{
+	DNS_EMPTY = 0,
+	DNS_PENDING,		/* first lookup outstanding */
+	DNS_FOUND,
+	DNS_MISSING
+};
+
+/* one cached name; queued while the resolver owes it an answer */
+typedef struct dns_entry
+{
+	TCP_IPADDR			name;
+	struct in_addr			addr;
+	int				state;
+	int				queued;
+	long long			expires;
+	long long			retry;		/* no lookup before this */
+	long long			used;
+} DNS_ENTRY;
+
+/* one hosts-file name; kept sorted for bsearch */
+typedef struct dns_host
+{
+	TCP_IPADDR			name;
+	struct in_addr			addr;
+	int				order;
+} DNS_HOST;
+
+static TCP_RESOLVER_CONFIG dns_config;
+static DNS_ENTRY *dns_cache;
+static unsigned dns_sets;
+static DNS_HOST *dns_hosts;
+static int dns_host_count;
+
+#ifdef __TANDEM
+#define DNS_WRITE_LOCK()		( ( void ) 0 )
+#define DNS_UNLOCK()			( ( void ) 0 )
+#define DNS_TOUCH(e, now)		( ( e )->used = ( now ) )
+#else
+#define DNS_WRITE_LOCK()		Dns_Write_Lock ( )
+#define DNS_UNLOCK()			Dns_Write_Unlock ( )
+/* readers hold no lock, so the LRU stamp is a relaxed store */
+#define DNS_TOUCH(e, now)		__atomic_store_n ( &( e )->used, ( now ), __ATOMIC_RELAXED )
+
+static pthread_mutex_t dns_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned dns_sequence;		/* odd while a writer is at work */
+static pthread_mutex_t dns_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dns_queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t dns_resolved = PTHREAD_COND_INITIALIZER;
+static TCP_IPADDR *dns_queue;
+static unsigned dns_queue_size;
+static unsigned dns_queue_head;
+static unsigned dns_queue_count;
+static pthread_t dns_thread;
+static int dns_running;
+static int dns_stopping;
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Dns_Key
+*
+* FUNCTION:             Copies name to key in lower case (names are
+*                       case-insensitive) and hashes it.
+*
+* RETURNS:              int - 0, 1 if the name is only digits and
+*                       dots (an address, most likely), -1 if it is
+*                       too long
+***************************************************************/
+static int Dns_Key ( const char *name, char *key, unsigned *hash )
+{
+	unsigned h = 2166136261u;
+	size_t	 i;
+	int	 numeric = 1;
+
+	for ( i = 0; name[i]; i++ )
+	{
+		if ( i == sizeof ( TCP_IPADDR ) - 1 )
+			return -1;
+		key[i] = name[i] >= 'A' && name[i] <= 'Z' ? ( char ) ( name[i] + 'a' - 'A' ) : name[i];
+		if ( ( key[i] < '0' || key[i] > '9' ) && key[i] != '.' )
+			numeric = 0;
+		h = ( h ^ ( unsigned char ) key[i] ) * 16777619u;
+	}
+	key[i] = '\0';
+	*hash = h;
+
+	return numeric;
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Now
+*
+* FUNCTION:             The clock lifetimes are kept on. A few ms of
+*                       resolution is plenty, and on Linux the coarse
+*                       clock costs a fraction of the precise one.
+*
+* RETURNS:              long long - microseconds
+***************************************************************/
+static long long Dns_Now ( void )
+{
+#if defined(__TANDEM) || !defined(CLOCK_MONOTONIC_COARSE)
+	return tcp_clock_usec ( );
+#else
+	struct timespec now;
+
+	clock_gettime ( CLOCK_MONOTONIC_COARSE, &now );
+	return ( long long ) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
+
+#ifndef __TANDEM
+/***************************************************************
+*
+* NAME:                           Dns_Write_Lock / Dns_Write_Unlock
+*
+* FUNCTION:             Takes the cache for writing: the mutex keeps
+*                       writers apart, the odd sequence number sends
+*                       readers round again.
+*
+* RETURNS:              nothing
+***************************************************************/
+static void Dns_Write_Lock ( void )
+{
+	pthread_mutex_lock ( &dns_lock );
+	__atomic_store_n ( &dns_sequence, dns_sequence + 1, __ATOMIC_RELAXED );
+	__atomic_thread_fence ( __ATOMIC_RELEASE );
+}
+
+static void Dns_Write_Unlock ( void )
+{
+	__atomic_store_n ( &dns_sequence, dns_sequence + 1, __ATOMIC_RELEASE );
+	pthread_mutex_unlock ( &dns_lock );
+}
+#endif
+
+/***************************************************************
+*
+* NAME:                           Dns_Find
+*
+* FUNCTION:             The entry for key in its set.
+*
+* RETURNS:              DNS_ENTRY * - 0 if not cached
+***************************************************************/
+static DNS_ENTRY *Dns_Find ( const char *key, unsigned hash )
+{
+	DNS_ENTRY	*set;
+	int		 i;
+
+	if ( !dns_cache )
+		return 0;
+
+	set = &dns_cache[( hash & ( dns_sets - 1 ) ) * DNS_WAYS];
+	for ( i = 0; i < DNS_WAYS; i++ )
+		if ( set[i].state != DNS_EMPTY && !strcmp ( set[i].name, key ) )
+			return &set[i];
+
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Claim
+*
+* FUNCTION:             Takes an entry in key's set for key: an empty
+*                       one, or else the least recently used one the
+*                       resolver doesn't owe an answer. Write lock.
+*
+* RETURNS:              DNS_ENTRY * - 0 if the whole set is waiting
+***************************************************************/
+static DNS_ENTRY *Dns_Claim ( const char *key, unsigned hash )
+{
+	DNS_ENTRY	*set = &dns_cache[( hash & ( dns_sets - 1 ) ) * DNS_WAYS];
+	DNS_ENTRY	*victim = 0;
+	int		 i;
+
+	for ( i = 0; i < DNS_WAYS; i++ )
+	{
+		if ( set[i].state == DNS_EMPTY )
+		{
+			victim = &set[i];
+			break;
+		}
+		if ( !set[i].queued && ( !victim || set[i].used < victim->used ) )
+			victim = &set[i];
+	}
+	if ( !victim )
+		return 0;
+
+	memset ( victim, 0, sizeof ( *victim ) );
+	strcpy ( victim->name, key );
+	victim->state = DNS_PENDING;
+
+	return victim;
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Host_Compare
+*
+* FUNCTION:             qsort / bsearch order of hosts-file names:
+*                       by name, then by position in the file.
+*
+* RETURNS:              int - <0, 0, >0
+***************************************************************/
+static int Dns_Host_Compare ( const void *a, const void *b )
+{
+	const DNS_HOST	*x = ( const DNS_HOST * ) a;
+	const DNS_HOST	*y = ( const DNS_HOST * ) b;
+	int		 order = strcmp ( x->name, y->name );
+
+	if ( order || x->order < 0 || y->order < 0 )
+		return order;
+
+	return x->order - y->order;
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Read
+*
+* FUNCTION:             Copies what the cache knows about key into
+*                       copy, without locking: a hosts-file name
+*                       comes back as found forever, an unknown one
+*                       as DNS_EMPTY.
+*
+* RETURNS:              DNS_ENTRY * - the cache entry the copy came
+*                       from, 0 for a hosts-file or unknown name
+***************************************************************/
+static DNS_ENTRY *Dns_Read ( const char *key, unsigned hash, DNS_ENTRY *copy )
+{
+	DNS_HOST	 probe;
+	DNS_HOST	*host;
+	DNS_ENTRY	*entry;
+#ifndef __TANDEM
+	unsigned	 sequence;
+
+	for ( ;; )
+	{
+		sequence = __atomic_load_n ( &dns_sequence, __ATOMIC_ACQUIRE );
+		if ( sequence & 1 )
+			continue;
+#endif
+		host = 0;
+		if ( dns_host_count )
+		{
+			strcpy ( probe.name, key );
+			probe.order = -1;
+			host = ( DNS_HOST * ) bsearch ( &probe, dns_hosts, dns_host_count, sizeof ( DNS_HOST ), Dns_Host_Compare );
+		}
+		entry = host ? 0 : Dns_Find ( key, hash );
+		if ( host )
+		{
+			memset ( copy, 0, sizeof ( *copy ) );
+			copy->state = DNS_FOUND;
+			copy->addr = host->addr;
+			copy->expires = DNS_FOREVER;
+		}
+		else if ( entry )
+			*copy = *entry;
+		else
+			copy->state = DNS_EMPTY;
+#ifndef __TANDEM
+		__atomic_thread_fence ( __ATOMIC_ACQUIRE );
+		if ( __atomic_load_n ( &dns_sequence, __ATOMIC_RELAXED ) == sequence )
+			break;
+	}
+#endif
+
+	return entry;
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Usable
+*
+* FUNCTION:             Whether entry answers a lookup at now: found
+*                       and no older than ttl + stale, or missing
+*                       and inside the negative time.
+*
+* RETURNS:              int - TCP_RESOLVE_FOUND / _MISSING, or
+*                       TCP_RESOLVE_PENDING if it needs a lookup
+***************************************************************/
+static int Dns_Usable ( DNS_ENTRY *entry, long long now )
+{
+	if ( entry->state == DNS_FOUND && now < entry->expires + dns_config.stale_usec )
+		return TCP_RESOLVE_FOUND;
+	if ( entry->state == DNS_MISSING && now < entry->expires )
+		return TCP_RESOLVE_MISSING;
+
+	return TCP_RESOLVE_PENDING;
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Lookup
+*
+* FUNCTION:             The default lookup: the host's resolver
+*                       (getaddrinfo, gethostbyname on Guardian),
+*                       first IPv4 address.
+*
+* RETURNS:              int - TCP_RESOLVE_FOUND / _MISSING / _AGAIN
+***************************************************************/
+static int Dns_Lookup ( const char *name, struct in_addr *addr, void *context )
+{
+#ifdef __TANDEM
+	struct hostent *host;
+
+	( void ) context;
+	host = gethostbyname ( ( char * ) name );
+	if ( !host || host->h_addrtype != AF_INET || !host->h_addr_list[0] )
+		return h_errno == TRY_AGAIN ? TCP_RESOLVE_AGAIN : TCP_RESOLVE_MISSING;
+	memcpy ( addr, host->h_addr_list[0], sizeof ( *addr ) );
+
+	return TCP_RESOLVE_FOUND;
+#else
+	struct addrinfo	 hints;
+	struct addrinfo	*result;
+	int		 status;
+
+	( void ) context;
+	memset ( &hints, 0, sizeof ( hints ) );
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+
+	status = getaddrinfo ( name, 0, &hints, &result );
+	if ( status == EAI_AGAIN || status == EAI_SYSTEM || status == EAI_MEMORY )
+		return TCP_RESOLVE_AGAIN;
+	if ( status != 0 )
+		return TCP_RESOLVE_MISSING;
+
+	*addr = ( ( struct sockaddr_in * ) result->ai_addr )->sin_addr;
+	freeaddrinfo ( result );
+
+	return TCP_RESOLVE_FOUND;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Resolve_One
+*
+* FUNCTION:             Looks key up and files the answer. A name
+*                       that was found before and now fails for the
+*                       moment keeps its old address, and isn't
+*                       looked up again for the negative time.
+*
+* NOTE:                 Called with no lock held.
+*
+* RETURNS:              nothing
+***************************************************************/
+static void Dns_Resolve_One ( const char *key, unsigned hash )
+{
+	struct in_addr	 addr;
+	DNS_ENTRY	*entry;
+	long long	 now;
+	int		 status;
+
+	memset ( &addr, 0, sizeof ( addr ) );
+	status = dns_config.lookup ( key, &addr, dns_config.context );
+	now = Dns_Now ( );
+
+	DNS_WRITE_LOCK ( );
+	entry = Dns_Find ( key, hash );
+	if ( entry )
+	{
+		if ( status == TCP_RESOLVE_FOUND )
+		{
+			entry->state = DNS_FOUND;
+			entry->addr = addr;
+			entry->expires = now + dns_config.ttl_usec;
+			entry->retry = 0;
+		}
+		else if ( status == TCP_RESOLVE_AGAIN && entry->state == DNS_FOUND )
+		{
+			/* serve the old address until the retry */
+			entry->retry = now + dns_config.negative_usec;
+			if ( entry->expires + dns_config.stale_usec < entry->retry )
+				entry->expires = entry->retry - dns_config.stale_usec;
+		}
+		else
+		{
+			entry->state = DNS_MISSING;
+			entry->expires = now + dns_config.negative_usec;
+			entry->retry = 0;
+		}
+		entry->queued = 0;
+		entry->used = now;
+	}
+	DNS_UNLOCK ( );
+
+#ifndef __TANDEM
+	pthread_mutex_lock ( &dns_queue_lock );
+	pthread_cond_broadcast ( &dns_resolved );
+	pthread_mutex_unlock ( &dns_queue_lock );
+#endif
+}
+
+#ifndef __TANDEM
+/***************************************************************
+*
+* NAME:                           Dns_Thread
+*
+* FUNCTION:             The resolver thread: looks up queued names
+*                       until tcp_resolver_stop.
+*
+* RETURNS:              void * - 0
+***************************************************************/
+static void *Dns_Thread ( void *argument )
+{
+	TCP_IPADDR	key;
+	unsigned	hash;
+
+	( void ) argument;
+	pthread_mutex_lock ( &dns_queue_lock );
+	while ( !dns_stopping )
+	{
+		if ( !dns_queue_count )
+		{
+			pthread_cond_wait ( &dns_queued, &dns_queue_lock );
+			continue;
+		}
+		strcpy ( key, dns_queue[dns_queue_head] );
+		dns_queue_head = ( dns_queue_head + 1 ) % dns_queue_size;
+		dns_queue_count--;
+		pthread_mutex_unlock ( &dns_queue_lock );
+
+		Dns_Key ( key, key, &hash );
+		Dns_Resolve_One ( key, hash );
+
+		pthread_mutex_lock ( &dns_queue_lock );
+	}
+	pthread_mutex_unlock ( &dns_queue_lock );
+
+	return 0;
+}
+#endif
+
+/***************************************************************
+*
+* NAME:                           Dns_Request
+*
+* FUNCTION:             Makes sure key is being looked up: claims an
+*                       entry if it has none and hands it to the
+*                       resolver thread, unless it is already queued.
+*                       On Guardian (or with no thread) the lookup is
+*                       done here and now.
+*
+* RETURNS:              nothing
+***************************************************************/
+static void Dns_Request ( const char *key, unsigned hash )
+{
+	DNS_ENTRY	*entry;
+	int		 queue = 0;
+
+	DNS_WRITE_LOCK ( );
+	entry = Dns_Find ( key, hash );
+	if ( !entry && dns_cache )
+		entry = Dns_Claim ( key, hash );
+	if ( entry && !entry->queued )
+	{
+		entry->queued = 1;
+		queue = 1;
+	}
+	DNS_UNLOCK ( );
+
+	if ( !queue )
+		return;
+
+#ifndef __TANDEM
+	pthread_mutex_lock ( &dns_queue_lock );
+	if ( !dns_running && !dns_stopping )
+		dns_running = pthread_create ( &dns_thread, 0, Dns_Thread, 0 ) == 0;
+	if ( dns_running && dns_queue_count < dns_queue_size )
+	{
+		strcpy ( dns_queue[( dns_queue_head + dns_queue_count ) % dns_queue_size], key );
+		dns_queue_count++;
+		pthread_cond_signal ( &dns_queued );
+		queue = 0;
+	}
+	pthread_mutex_unlock ( &dns_queue_lock );
+
+	if ( !queue )
+		return;
+#endif
+	Dns_Resolve_One ( key, hash );
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Wait
+*
+* FUNCTION:             Waits up to wait_usec for key to get a
+*                       usable answer, asking again if its entry is
+*                       pushed out of the cache meanwhile.
+*
+* RETURNS:              int - TCP_RESOLVE_FOUND with addr set,
+*                       TCP_RESOLVE_MISSING, or TCP_RESOLVE_PENDING
+*                       if the time ran out
+***************************************************************/
+static int Dns_Wait ( const char *key, unsigned hash, struct in_addr *addr, long wait_usec )
+{
+	DNS_ENTRY	 copy;
+	int		 status;
+#ifndef __TANDEM
+	struct timespec	 until;
+	long long	 nsec;
+	int		 asked = 1;
+
+	clock_gettime ( CLOCK_REALTIME, &until );
+	nsec = until.tv_nsec + ( long long ) ( wait_usec % 1000000 ) * 1000;
+	until.tv_sec += wait_usec / 1000000 + ( time_t ) ( nsec / 1000000000 );
+	until.tv_nsec = ( long ) ( nsec % 1000000000 );
+
+	pthread_mutex_lock ( &dns_queue_lock );
+	for ( ;; )
+	{
+#else
+	( void ) wait_usec;
+#endif
+		Dns_Read ( key, hash, &copy );
+		status = Dns_Usable ( &copy, Dns_Now ( ) );
+		if ( status == TCP_RESOLVE_FOUND )
+			*addr = copy.addr;
+#ifndef __TANDEM
+		if ( status != TCP_RESOLVE_PENDING || wait_usec <= 0 )
+			break;
+		if ( copy.state == DNS_EMPTY && !asked )
+		{
+			pthread_mutex_unlock ( &dns_queue_lock );
+			Dns_Request ( key, hash );
+			pthread_mutex_lock ( &dns_queue_lock );
+			asked = 1;
+			continue;
+		}
+		asked = 0;
+		if ( pthread_cond_timedwait ( &dns_resolved, &dns_queue_lock, &until ) != 0 )
+			wait_usec = 0;
+	}
+	pthread_mutex_unlock ( &dns_queue_lock );
+#endif
+
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Load_Hosts
+*
+* FUNCTION:             Reads a hosts-format file ("address name
+*                       alias ..." per line, # comments). IPv4 lines
+*                       only; where a name appears twice the first
+*                       line wins, as with /etc/hosts.
+*
+* RETURNS:              int - 0, -1 if it can't be read
+***************************************************************/
+static int Dns_Load_Hosts ( const char *path )
+{
+	FILE		*file = fopen ( path, "r" );
+	DNS_HOST	*hosts;
+	char		 line[DNS_LINE];
+	char		*word;
+	char		*end;
+	struct in_addr	 addr;
+	unsigned	 hash;
+	int		 size = 0;
+	int		 count = 0;
+	int		 i;
+
+	if ( !file )
+		return -1;
+
+	while ( fgets ( line, sizeof ( line ), file ) )
+	{
+		if ( ( end = strchr ( line, '#' ) ) != 0 )
+			*end = '\0';
+
+		/* address, then names */
+		addr.s_addr = INADDR_NONE;
+		for ( word = line; *word; word = end )
+		{
+			while ( *word && isspace ( ( unsigned char ) *word ) )
+				word++;
+			for ( end = word; *end && !isspace ( ( unsigned char ) *end ); end++ )
+				;
+			if ( end == word )
+				break;
+			if ( *end )
+				*end++ = '\0';
+
+			if ( addr.s_addr == INADDR_NONE )
+			{
+				if ( strchr ( word, ':' ) || ( addr.s_addr = inet_addr ( word ) ) == INADDR_NONE )
+					break;
+				continue;
+			}
+			if ( count == size )
+			{
+				size = size ? size * 2 : 64;
+				hosts = ( DNS_HOST * ) realloc ( dns_hosts, size * sizeof ( DNS_HOST ) );
+				if ( !hosts )
+					break;
+				dns_hosts = hosts;
+			}
+			if ( Dns_Key ( word, dns_hosts[count].name, &hash ) >= 0 )
+			{
+				dns_hosts[count].addr = addr;
+				dns_hosts[count].order = count;
+				count++;
+			}
+		}
+	}
+	fclose ( file );
+
+	if ( count )
+		qsort ( dns_hosts, count, sizeof ( DNS_HOST ), Dns_Host_Compare );
+
+	/* keep the first of each name */
+	dns_host_count = 0;
+	for ( i = 0; i < count; i++ )
+		if ( !dns_host_count || strcmp ( dns_hosts[i].name, dns_hosts[dns_host_count - 1].name ) )
+			dns_hosts[dns_host_count++] = dns_hosts[i];
+
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Dns_Setup
+*
+* FUNCTION:             Applies config (defaults for zero fields)
+*                       and makes the cache. Write lock, with the
+*                       resolver thread stopped.
+*
+* RETURNS:              int - 0, -1 with errno set
+***************************************************************/
+static int Dns_Setup ( TCP_RESOLVER_CONFIG *config )
+{
+	unsigned entries;
+
+	dns_config = *config;
+	if ( dns_config.ttl_usec <= 0 )
+		dns_config.ttl_usec = DNS_TTL_USEC;
+	if ( dns_config.negative_usec <= 0 )
+		dns_config.negative_usec = DNS_NEGATIVE_USEC;
+	if ( dns_config.stale_usec <= 0 )
+		dns_config.stale_usec = DNS_STALE_USEC;
+	if ( dns_config.miss_wait_usec < 0 )
+		dns_config.miss_wait_usec = 0;
+	if ( dns_config.entries <= 0 )
+		dns_config.entries = DNS_ENTRIES;
+	if ( !dns_config.lookup )
+		dns_config.lookup = Dns_Lookup;
+
+	/* a power of two number of sets */
+	for ( dns_sets = 1; dns_sets * DNS_WAYS < ( unsigned ) dns_config.entries; dns_sets <<= 1 )
+		;
+	entries = dns_sets * DNS_WAYS;
+
+	dns_cache = ( DNS_ENTRY * ) calloc ( entries, sizeof ( DNS_ENTRY ) );
+	if ( !dns_cache )
+		return -1;
+#ifndef __TANDEM
+	dns_queue = ( TCP_IPADDR * ) calloc ( entries, sizeof ( TCP_IPADDR ) );
+	if ( !dns_queue )
+	{
+		free ( dns_cache );
+		dns_cache = 0;
+		return -1;
+	}
+	dns_queue_size = entries;
+	dns_queue_head = 0;
+	dns_queue_count = 0;
+#endif
+
+	if ( dns_config.hosts_file && Dns_Load_Hosts ( dns_config.hosts_file ) != 0 )
+		return -1;
+	dns_config.hosts_file = 0;
+
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_resolver_config
+*
+* FUNCTION:             Sets the resolver up: cache size, lifetimes,
+*                       hosts file, lookup function. Anything cached
+*                       before is dropped. Without a call, the first
+*                       tcp_resolve takes the defaults.
+*
+* NOTE:                 Call before other threads resolve names.
+*
+* RETURNS:              int - 0, -1 with errno set (a hosts file that
+*                       can't be read leaves the rest set up)
+***************************************************************/
+int tcp_resolver_config ( TCP_RESOLVER_CONFIG *config )
+{
+	int status;
+
+	tcp_resolver_stop ( );
+
+	DNS_WRITE_LOCK ( );
+	status = Dns_Setup ( config );
+	DNS_UNLOCK ( );
+
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_resolve
+*
+* FUNCTION:             Finds name's IPv4 address. Dotted quads are
+*                       converted as they are; hosts-file names and
+*                       cached names come straight from memory (an
+*                       expired one also starts a refresh in the
+*                       background). Otherwise the name is looked up
+*                       and the caller waits up to wait_usec for it
+*                       (TCP_RESOLVE_WAIT: the configured wait).
+*
+* RETURNS:              int - TCP_RESOLVE_FOUND with addr set,
+*                       TCP_RESOLVE_MISSING, or TCP_RESOLVE_PENDING
+*                       if the lookup is still going on
+***************************************************************/
+int tcp_resolve ( const char *name, struct in_addr *addr, long wait_usec )
+{
+	TCP_IPADDR	 key;
+	DNS_ENTRY	 copy;
+	DNS_ENTRY	*entry;
+	unsigned	 hash;
+	long long	 now;
+	int		 status;
+	int		 numeric;
+	int		 refresh = 0;
+
+	if ( !name[0] )
+		return TCP_RESOLVE_MISSING;
+	numeric = Dns_Key ( name, key, &hash );
+	if ( numeric < 0 )
+		return TCP_RESOLVE_MISSING;
+	if ( numeric )
+	{
+		addr->s_addr = inet_addr ( name );
+		if ( addr->s_addr != INADDR_NONE || !strcmp ( name, "255.255.255.255" ) )
+			return TCP_RESOLVE_FOUND;
+	}
+
+	if ( !dns_cache )
+	{
+		TCP_RESOLVER_CONFIG defaults;
+
+		memset ( &defaults, 0, sizeof ( defaults ) );
+		DNS_WRITE_LOCK ( );
+		if ( !dns_cache )
+			Dns_Setup ( &defaults );
+		DNS_UNLOCK ( );
+	}
+
+	entry = Dns_Read ( key, hash, &copy );
+	now = Dns_Now ( );
+	status = Dns_Usable ( &copy, now );
+	if ( status == TCP_RESOLVE_FOUND )
+	{
+		*addr = copy.addr;
+		if ( entry && copy.used != now )
+			DNS_TOUCH ( entry, now );
+		refresh = now >= copy.expires && now >= copy.retry && !copy.queued;
+	}
+	else if ( status == TCP_RESOLVE_PENDING )
+		refresh = copy.state == DNS_EMPTY || ( now >= copy.retry && !copy.queued );
+
+	if ( refresh )
+		Dns_Request ( key, hash );
+	if ( status != TCP_RESOLVE_PENDING )
+		return status;
+
+	if ( wait_usec < 0 )
+		wait_usec = dns_config.miss_wait_usec;
+
+	return Dns_Wait ( key, hash, addr, wait_usec );
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_resolver_flush
+*
+* FUNCTION:             Forgets every cached name (hosts-file names
+*                       stay). Names the resolver is still looking
+*                       up are kept for their answer.
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_resolver_flush ( void )
+{
+	unsigned i;
+
+	DNS_WRITE_LOCK ( );
+	for ( i = 0; dns_cache && i < dns_sets * DNS_WAYS; i++ )
+		if ( !dns_cache[i].queued )
+			memset ( &dns_cache[i], 0, sizeof ( DNS_ENTRY ) );
+	DNS_UNLOCK ( );
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_resolver_stop
+*
+* FUNCTION:             Stops the resolver thread and frees the
+*                       cache. The next tcp_resolve starts over with
+*                       the defaults.
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_resolver_stop ( void )
+{
+#ifndef __TANDEM
+	pthread_mutex_lock ( &dns_queue_lock );
+	dns_stopping = 1;
+	pthread_cond_broadcast ( &dns_queued );
+	pthread_mutex_unlock ( &dns_queue_lock );
+	if ( dns_running )
+		pthread_join ( dns_thread, 0 );
+#endif
+
+	DNS_WRITE_LOCK ( );
+	free ( dns_cache );
+	free ( dns_hosts );
+	dns_cache = 0;
+	dns_hosts = 0;
+	dns_host_count = 0;
+#ifndef __TANDEM
+	free ( dns_queue );
+	dns_queue = 0;
+	dns_queue_size = 0;
+	dns_queue_count = 0;
+#endif
+	DNS_UNLOCK ( );
+
+#ifndef __TANDEM
+	pthread_mutex_lock ( &dns_queue_lock );
+	dns_running = 0;
+	dns_stopping = 0;
+	pthread_mutex_unlock ( &dns_queue_lock );
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,102 @@
+/************************************************************************************
+*		FILE:		"nsdns.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Host name resolution for set_sockaddr: a process-wide
+*					cache of IPv4 addresses with a time to live, negative
+*					entries for names that don't resolve, and lookups done
+*					off the caller's thread, so reconnecting to a name
+*					costs a table probe instead of a DNS round trip.
+*
+*		Notes:		A name that has expired is still answered from the
+*					cache, for up to stale_usec, while a background thread
+*					looks it up again. A name never seen before (or
+*					expired past stale_usec) is looked up the same way,
+*					and by default the caller doesn't wait for it:
+*					tcp_resolve returns TCP_RESOLVE_PENDING and
+*					set_sockaddr leaves INADDR_NONE (errno EAGAIN) at
+*					once, so a DNS stall never holds up the connection
+*					path. Ask again later for the answer, or set
+*					miss_wait_usec to wait that long for it instead.
+*
+*					Seed names from a hosts-format file with hosts_file;
+*					those never expire. A lookup function of your own
+*					(lookup) replaces getaddrinfo, e.g. for tests.
+*
+*					Guardian processes are single threaded, so there a
+*					miss or an expired name is looked up in line with
+*					gethostbyname.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.13.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Misses don't wait unless miss_wait_usec asks to
+*************************************************************************************/
+
+#ifndef _NSDNSH_INCLUDE_
+#define _NSDNSH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* tcp_resolve wait_usec: use the configured miss_wait_usec */
+#define TCP_RESOLVE_WAIT		( -1L )
+
+/* tcp_resolve results, also what a lookup function returns */
+enum
+{
+	TCP_RESOLVE_FOUND = 0,
+	TCP_RESOLVE_PENDING = 1,		/* still being looked up */
+	TCP_RESOLVE_AGAIN = 1,			/* lookup: temporary failure */
+	TCP_RESOLVE_MISSING = -1		/* no such name */
+};
+
+/* looks name up; returns TCP_RESOLVE_FOUND with addr set,
+*  TCP_RESOLVE_MISSING or TCP_RESOLVE_AGAIN */
+typedef int (*TCP_RESOLVE_LOOKUP)		(const char *, struct in_addr *, void *);
+
+/***************************************************************
+*
+*	Name:		TCP_RESOLVER_CONFIG
+*	Type:		struct
+*	Purpose:	What tcp_resolver_config takes. Zero fields
+*				take the defaults noted.
+*
+***************************************************************/
+typedef struct tcp_resolver_config
+{
+	long				ttl_usec;	/* 0 = 60 s */
+	long				negative_usec;	/* 0 = 5 s */
+	long				stale_usec;	/* served past ttl while refreshed, 0 = 600 s */
+	long				miss_wait_usec;	/* 0 = don't wait */
+	int				entries;	/* 0 = 1024 */
+	const char			*hosts_file;	/* 0 = none */
+	TCP_RESOLVE_LOOKUP		lookup;		/* 0 = getaddrinfo */
+	void				*context;
+} TCP_RESOLVER_CONFIG;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int tcp_resolver_config ( TCP_RESOLVER_CONFIG *config );
+int tcp_resolve ( const char *name, struct in_addr *addr, long wait_usec );
+void tcp_resolver_flush ( void );
+void tcp_resolver_stop ( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSDNSH_INCLUDE_
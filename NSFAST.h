@@ -0,0 +1,372 @@
+/************************************************************************************
+*		FILE:		"nsfast.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	The hot calls of the TCP table as inline C++ templates,
+*					for code that knows at compile time how it talks:
+*
+*						typedef nstcp::Tcp<nstcp::Blocking, nstcp::Ipv4> Io;
+*
+*						Io::Set_SockAddr ( conn );
+*						Io::Get_Sock ( conn );
+*						Io::Make_Connect ( conn );
+*						Io::New_Send ( conn, buffer, length );
+*
+*					Each call compiles down to the socket call itself (or
+*					the nowait one) with no function pointer in between,
+*					so it can be inlined and the branch is direct.
+*
+*		Notes:		The policies are the template parameters:
+*
+*					Mode	Blocking or Nowait: send / recv / connect /
+*							accept or their _nw forms, completed through
+*							reap_completions as usual.
+*					Family	Ipv4 or Ipv6. Ipv6 keeps its sockaddr_in6 on
+*							the heap behind TCP_CONNECTION_INFO::sockaddr,
+*							which clean_conn_info frees.
+*					Backend	Epoll, IoUring or Guardian; Init starts the
+*							thread's TCP table on it.
+*
+*					They work on the same TCP_CONNECTION_INFO as the
+*					table, keep the same counters (compile them out with
+*					-DNSTCP_NO_STATS) and can be mixed with table calls on
+*					one connection. Calling something a policy doesn't have,
+*					e.g. New_Accept2 when Blocking, fails to compile.
+*
+*					Framing, coalescing and the connection table stay
+*					table only.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.16.0	  10/17/26		Initial Release
+*		1.21.0	  10/17/26		Get_Sock / Make_Connect / Close_Sock stripe (nsstrip.h)
+*		1.22.0	  10/17/26		Send / Recv capture hooks (nscapt.h)
+*		1.24.0	  10/17/26		Get_Sock / Set_Listen / Accept tuning (nstune.h)
+*		1.25.1	  10/17/26		Accept keeps accept_short; Accept2 tunes
+*************************************************************************************/
+
+#ifndef _NSFASTH_INCLUDE_
+#define _NSFASTH_INCLUDE_
+
+#ifdef __cplusplus
+
+#ifdef __TANDEM
+#include "=nstcph"
+#include "=nsstatsh"
+#include "=nsdnsh"
+#include "=nsstriph"
+#include "=nscapth"
+#include "=nstuneh"
+#else
+#include "NSTCP.h"
+#include "NSSTATS.h"
+#include "NSDNS.h"
+#include "NSSTRIP.h"
+#include "NSCAPT.h"
+#include "NSTUNE.h"
+#endif
+
+namespace nstcp
+{
+
+/**********************************************************
+*		Mode policies
+**********************************************************/
+struct Blocking { };
+struct Nowait { };
+
+/**********************************************************
+*		Family policies
+**********************************************************/
+struct Ipv4
+{
+	typedef struct sockaddr_in	address_type;
+	enum { family = AF_INET };
+
+	/* the inline sockaddr_in, as set_sockaddr fills it */
+	static inline int Set ( TCP_CONNECTION_INFO *connection )
+	{
+		connection->sockaddr = &connection->sockaddr_in;
+		memset ( connection->sockaddr, 0, sizeof ( *connection->sockaddr ) );
+		connection->sockaddr->sin_family = AF_INET;
+		connection->sockaddr->sin_port = htons ( connection->port );
+		connection->sockaddr_len = sizeof ( struct sockaddr_in );
+		int status = tcp_resolve ( connection->ipaddr, &connection->sockaddr->sin_addr, TCP_RESOLVE_WAIT );
+
+		if ( status != TCP_RESOLVE_FOUND )
+		{
+			connection->sockaddr->sin_addr.s_addr = INADDR_NONE;
+			errno = status == TCP_RESOLVE_PENDING ? EAGAIN : EHOSTUNREACH;
+			return -1;
+		}
+		return 0;
+	}
+};
+
+struct Ipv6
+{
+	typedef struct sockaddr_in6	address_type;
+	enum { family = AF_INET6 };
+
+	/* a sockaddr_in6 on the heap; ipaddr must be a literal
+	*  address (the resolver cache is IPv4 only) */
+	static inline int Set ( TCP_CONNECTION_INFO *connection )
+	{
+		struct sockaddr_in6	*address;
+
+		if ( connection->sockaddr && connection->sockaddr != &connection->sockaddr_in )
+			address = ( struct sockaddr_in6 * ) connection->sockaddr;
+		else if ( ( address = ( struct sockaddr_in6 * ) malloc ( sizeof ( *address ) ) ) == 0 )
+			return -1;
+		memset ( address, 0, sizeof ( *address ) );
+		address->sin6_family = AF_INET6;
+		address->sin6_port = htons ( connection->port );
+		connection->sockaddr = ( struct sockaddr_in * ) address;
+		connection->sockaddr_len = sizeof ( struct sockaddr_in6 );
+		return inet_pton ( AF_INET6, connection->ipaddr, &address->sin6_addr ) == 1 ? 0 : -1;
+	}
+};
+
+/**********************************************************
+*		Backend policies
+**********************************************************/
+struct Epoll { enum { engine = TCP_ENGINE_EPOLL }; };
+struct IoUring { enum { engine = TCP_ENGINE_IO_URING }; };
+struct Guardian { enum { engine = TCP_ENGINE_DEFAULT }; };
+
+#ifdef __TANDEM
+typedef Guardian			Default_Backend;
+#else
+typedef Epoll				Default_Backend;
+#endif
+
+/***************************************************************
+*
+*	Name:		Mode_Calls
+*	Type:		class template
+*	Purpose:	The calls that differ between Blocking and
+*				Nowait, one specialization each. Only Tcp
+*				uses these.
+*
+***************************************************************/
+template <class Mode> struct Mode_Calls;
+
+template <>
+struct Mode_Calls<Blocking>
+{
+	static inline int Socket ( TCP_CONNECTION_INFO *, int family, int type, int protocol )
+	{
+		return socket ( family, type, protocol );
+	}
+
+	static inline int Connect ( TCP_CONNECTION_INFO *connection )
+	{
+		int status = connect ( *connection->sock
+					, ( struct sockaddr * ) connection->sockaddr
+					, ( TCP_SOCKLEN ) connection->sockaddr_len );
+
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_CONNECT, 0, status );
+		return status;
+	}
+
+	/* the remote address lands in the listener's sockaddr */
+	static inline int Accept ( TCP_CONNECTION_INFO *connection )
+	{
+		TCP_SOCKLEN	 length = ( TCP_SOCKLEN ) connection->sockaddr_len;
+		int		 status = accept ( *connection->sock
+						 , ( struct sockaddr * ) connection->sockaddr
+						 , &length );
+
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_ACCEPT, 0, status );
+		if ( status >= 0 )
+			connection->accept_short = tune_accepted ( connection->tune, status );
+		return status;
+	}
+
+	static inline int Send ( TCP_CONNECTION_INFO *connection, char *buffer, int length )
+	{
+		int status = send ( *connection->sock, buffer, length, connection->flags );
+
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, length, status );
+		if ( status > 0 )
+			TCP_CAPTURE ( TCP_CAPTURE_SEND, *connection->sock, buffer, status );
+		return status;
+	}
+
+	static inline int Recv ( TCP_CONNECTION_INFO *connection, char *buffer, int length )
+	{
+		int status = recv ( *connection->sock, buffer, length, connection->flags );
+
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_RECV, length, status );
+		if ( status > 0 )
+			TCP_CAPTURE ( TCP_CAPTURE_RECV, *connection->sock, buffer, status );
+		return status;
+	}
+};
+
+template <>
+struct Mode_Calls<Nowait>
+{
+	static inline int Socket ( TCP_CONNECTION_INFO *connection, int family, int type, int protocol )
+	{
+		return socket_nw ( family, type, protocol, connection->flags, 0 );
+	}
+
+	static inline int Connect ( TCP_CONNECTION_INFO *connection )
+	{
+		int status = connect_nw ( *connection->sock
+					, ( struct sockaddr * ) connection->sockaddr
+					, connection->sockaddr_len
+					, connection->tag );
+
+		TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_CONNECT, status );
+		return status;
+	}
+
+	/* waits for a connection; take it with New_Accept2 */
+	static inline int Accept ( TCP_CONNECTION_INFO *connection )
+	{
+		int status = accept_nw ( *connection->sock
+				       , ( struct sockaddr * ) connection->sockaddr
+				       , &connection->sockaddr_len
+				       , connection->tag );
+
+		TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_ACCEPT, status );
+		return status;
+	}
+
+	static inline int Send ( TCP_CONNECTION_INFO *connection, char *buffer, int length )
+	{
+		int status = send_nw ( *connection->sock, buffer, length, connection->flags, connection->tag );
+
+		TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_SEND, status );
+		return status;
+	}
+
+	static inline int Recv ( TCP_CONNECTION_INFO *connection, char *buffer, int length )
+	{
+		int status = recv_nw ( *connection->sock, buffer, length, connection->flags, connection->tag );
+
+		TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_RECV, status );
+		return status;
+	}
+
+	/* puts the connection New_Accept waited for on connection's
+	*  socket; from is the listener's sockaddr after that wait */
+	static inline int Accept2 ( TCP_CONNECTION_INFO *connection, struct sockaddr *from )
+	{
+		int status = accept_nw2 ( *connection->sock, from, connection->tag );
+
+		if ( status >= 0 )
+			tune_socket ( connection );
+		return status;
+	}
+};
+
+/***************************************************************
+*
+*	Name:		Tcp
+*	Type:		class template
+*	Purpose:	The table's calls, resolved at compile time for
+*				one Mode, Family and Backend. Same names,
+*				arguments and results as the TCP entries.
+*
+***************************************************************/
+template <class Mode = Blocking, class Family = Ipv4, class Backend = Default_Backend>
+struct Tcp
+{
+	typedef Mode_Calls<Mode>	Calls;
+
+	/* the thread's TCP table on Backend, for everything else */
+	static inline TCP *Init ( )
+	{
+		return intialize_tcp_engine ( Backend::engine );
+	}
+
+	/* -1 when ipaddr doesn't give an address */
+	static inline int Set_SockAddr ( TCP_CONNECTION_INFO *connection )
+	{
+		return Family::Set ( connection );
+	}
+
+	static inline int Get_Sock ( TCP_CONNECTION_INFO *connection, int type = SOCK_STREAM, int protocol = 0 )
+	{
+		int socket_num;
+
+		stripe_socket ( connection );
+		socket_num = Calls::Socket ( connection, Family::family, type, protocol );
+
+		connection->sock_num = socket_num;
+		connection->sock = &connection->sock_num;
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SOCKET, 0, socket_num );
+		if ( socket_num >= 0 )
+			tune_socket ( connection );
+		return socket_num;
+	}
+
+	static inline int Set_Bind ( TCP_CONNECTION_INFO *connection )
+	{
+		return bind ( *connection->sock
+			    , ( struct sockaddr * ) connection->sockaddr
+			    , ( TCP_SOCKLEN ) connection->sockaddr_len );
+	}
+
+	static inline int Set_Listen ( TCP_CONNECTION_INFO *connection )
+	{
+		return listen ( *connection->sock, tune_backlog ( connection ) );
+	}
+
+	static inline int Make_Connect ( TCP_CONNECTION_INFO *connection )
+	{
+		if ( stripe_connect ( connection ) < 0 )
+			return -1;
+		return Calls::Connect ( connection );
+	}
+
+	static inline int New_Accept ( TCP_CONNECTION_INFO *connection )
+	{
+		return Calls::Accept ( connection );
+	}
+
+	static inline int New_Accept2 ( TCP_CONNECTION_INFO *connection, TCP_CONNECTION_INFO *listener )
+	{
+		return Calls::Accept2 ( connection, ( struct sockaddr * ) listener->sockaddr );
+	}
+
+	static inline int New_Send ( TCP_CONNECTION_INFO *connection, char *buffer, int length )
+	{
+		return Calls::Send ( connection, buffer, length );
+	}
+
+	static inline int New_Recv ( TCP_CONNECTION_INFO *connection, char *buffer, int length )
+	{
+		return Calls::Recv ( connection, buffer, length );
+	}
+
+	static inline int Close_Sock ( TCP_CONNECTION_INFO *connection )
+	{
+		int status;
+
+		if ( !connection->sock || *connection->sock < 0 )
+			return 0;
+#ifdef __TANDEM
+		status = FILE_CLOSE_ ( ( signed short ) *connection->sock );
+#else
+		status = FILE_CLOSE_ ( *connection->sock );
+#endif
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_CLOSE, 0, status ? -1 : 0 );
+		stripe_close ( connection );
+		*connection->sock = -1;
+		return status;
+	}
+};
+
+} /* namespace nstcp */
+
+#endif /* __cplusplus */
+
+#endif // !_NSFASTH_INCLUDE_
@@ -0,0 +1,416 @@
+/************************************************************************************
+*		FILE:		"nsframe.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Length-prefixed framing over a receive ring. See
+*					nsframe.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.7.0	  10/17/26		Initial Release
+*		1.11.0	  10/17/26		Receives counted in the operation counters
+*************************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#ifdef __TANDEM
+#include "=nsframeh"
+#include "=nsstatsh"
+#else
+#include "NSFRAME.h"
+#include "NSSTATS.h"
+#include <sys/mman.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+#ifdef __linux__
+/***************************************************************
+*
+* NAME:                           Framer_Map_Mirror
+*
+* FUNCTION:             Maps size bytes of a memfd twice, back to
+*                       back, so base[i] and base[i + size] are the
+*                       same byte.
+*
+* RETURNS:              char * - 0 if the mapping can't be made
+***************************************************************/
+static char *Framer_Map_Mirror ( long size )
+{
+	char	*base;
+	int	 fd;
+
+	fd = memfd_create ( "nstcp-frame", MFD_CLOEXEC );
+	if ( fd < 0 )
+		return 0;
+	if ( ftruncate ( fd, size ) < 0 )
+	{
+		close ( fd );
+		return 0;
+	}
+
+	/* reserve both halves, then lay the file over each */
+	base = ( char * ) mmap ( 0, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if ( base == MAP_FAILED )
+	{
+		close ( fd );
+		return 0;
+	}
+
+	if ( mmap ( base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED
+	  || mmap ( base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED )
+	{
+		munmap ( base, 2 * size );
+		close ( fd );
+		return 0;
+	}
+
+	close ( fd );
+	return base;
+}
+#endif
+
+/***************************************************************
+*
+* NAME:                           Framer_Release
+*
+* FUNCTION:             Drops the frames already handed out.
+*
+***************************************************************/
+static void Framer_Release ( TCP_FRAMER *framer )
+{
+	framer->head += framer->scan;
+	framer->used -= framer->scan;
+	framer->scan = 0;
+
+	if ( !framer->used )
+		framer->head = 0;
+	else if ( framer->mirrored && framer->head >= framer->size )
+		framer->head -= framer->size;
+}
+
+/***************************************************************
+*
+* NAME:                           Framer_Space
+*
+* FUNCTION:             Releases handed-out frames and finds the
+*                       contiguous free space after the data. A
+*                       flat buffer is compacted when that space is
+*                       too small for the frame being built.
+*
+* RETURNS:              char * - where to receive; *room its size
+***************************************************************/
+static char *Framer_Space ( TCP_FRAMER *framer, long *room )
+{
+	long want;
+
+	Framer_Release ( framer );
+
+	if ( !framer->mirrored && framer->head )
+	{
+		want = framer->need > framer->size / 8 ? framer->need : framer->size / 8;
+		if ( framer->size - framer->head - framer->used < want )
+		{
+			memmove ( framer->base, framer->base + framer->head, framer->used );
+			framer->head = 0;
+		}
+	}
+
+	/* mirrored: head + used may pass size, the second mapping covers it */
+	*room = framer->mirrored ? framer->size - framer->used
+							 : framer->size - framer->head - framer->used;
+	return framer->base + framer->head + framer->used;
+}
+
+/***************************************************************
+*
+* NAME:                           framer_attach
+*
+* FUNCTION:             Gives a connection a receive ring of at
+*                       least capacity bytes (grown to hold the
+*                       largest frame). prefix_width is 1, 2 or 4
+*                       bytes; flags are TCP_FRAME_*.
+*
+* RETURNS:              int - 0, or -1 on bad arguments / no memory
+***************************************************************/
+int framer_attach ( TCP_CONNECTION_INFO *connection, long capacity, int prefix_width, int flags, long max_frame )
+{
+	TCP_FRAMER	*framer;
+	long		 size;
+	long		 limit;
+#ifdef __linux__
+	long		 page = sysconf ( _SC_PAGESIZE );
+#endif
+
+	if ( ( prefix_width != 1 && prefix_width != 2 && prefix_width != 4 ) || max_frame <= 0 )
+		return -1;
+	/* keep the largest frame expressible in the prefix */
+	if ( prefix_width < 4 )
+	{
+		limit = ( 1L << ( 8 * prefix_width ) ) - 1;
+		if ( flags & TCP_FRAME_LENGTH_INCLUSIVE )
+			limit -= prefix_width;
+		if ( max_frame > limit )
+			max_frame = limit;
+	}
+
+	size = capacity;
+	if ( size < max_frame + prefix_width )
+		size = max_frame + prefix_width;
+
+	framer = ( TCP_FRAMER * ) calloc ( 1, sizeof ( TCP_FRAMER ) );
+	if ( !framer )
+		return -1;
+
+#ifdef __linux__
+	size = ( size + page - 1 ) / page * page;
+	framer->base = Framer_Map_Mirror ( size );
+	framer->mirrored = framer->base != 0;
+#endif
+	if ( !framer->base )
+		framer->base = ( char * ) malloc ( size );
+	if ( !framer->base )
+	{
+		free ( framer );
+		return -1;
+	}
+
+	framer->size = size;
+	framer->prefix_width = prefix_width;
+	framer->flags = flags;
+	framer->max_frame = max_frame;
+
+	framer_detach ( connection );
+	connection->framer = framer;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           framer_detach
+*
+* FUNCTION:             Frees a connection's ring. Called by
+*                       clean_conn_info; views die with it.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void framer_detach ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_FRAMER *framer = connection->framer;
+
+	if ( !framer )
+		return;
+
+#ifdef __linux__
+	if ( framer->mirrored )
+		munmap ( framer->base, 2 * framer->size );
+	else
+#endif
+		free ( framer->base );
+
+	free ( framer );
+	connection->framer = 0;
+}
+
+/***************************************************************
+*
+* NAME:                           frame_recv
+*
+* FUNCTION:             Receives as much as fits into the ring.
+*                       Follow with frame_next until it returns 0.
+*
+* RETURNS:              int - bytes received, 0 when the peer
+*                       closed, -1 on error (or no room: a frame
+*                       larger than the ring)
+***************************************************************/
+int frame_recv ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_FRAMER	*framer = connection->framer;
+	char		*space;
+	long		 room;
+	int		 status;
+
+	if ( !framer )
+		return -1;
+
+	space = Framer_Space ( framer, &room );
+	if ( room <= 0 )
+		return -1;
+
+	status = recv ( *connection->sock, space, ( int ) room, connection->flags );
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_RECV, room, status );
+	if ( status > 0 )
+		framer->used += status;
+
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           frame_recv_nw
+*
+* FUNCTION:             This is a NOWAIT operation.
+*                       Posts a recv_nw into the ring's free space
+*                       under connection->tag. Hand the completion
+*                       count to frame_commit, then call frame_next.
+*
+* NOTE:                 Only one frame_recv_nw per connection may be
+*                       outstanding.
+*
+* RETURNS:              int - recv_nw status, -1 if no framer / room
+***************************************************************/
+int frame_recv_nw ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_FRAMER	*framer = connection->framer;
+	char		*space;
+	long		 room;
+	int		 status;
+
+	if ( !framer )
+		return -1;
+
+	space = Framer_Space ( framer, &room );
+	if ( room <= 0 )
+		return -1;
+
+	status = recv_nw ( *connection->sock
+					 , space
+					 , ( int ) room
+					 , connection->flags
+					 , connection->tag );
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_RECV, status );
+
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           frame_commit
+*
+* FUNCTION:             Adds the bytes a frame_recv_nw brought in.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void frame_commit ( TCP_CONNECTION_INFO *connection, long count )
+{
+	if ( connection->framer && count > 0 )
+		connection->framer->used += count;
+}
+
+/***************************************************************
+*
+* NAME:                           frame_next
+*
+* FUNCTION:             Hands out the next complete frame, without
+*                       its prefix, as a view into the ring.
+*
+* RETURNS:              int - 1 with *frame / *length set,
+*                       0 when more data is needed,
+*                       -1 when the prefix is bad or over max_frame
+*                       (the stream can't be resynchronised; close it)
+***************************************************************/
+int frame_next ( TCP_CONNECTION_INFO *connection, char **frame, long *length )
+{
+	TCP_FRAMER		*framer = connection->framer;
+	unsigned char		*p;
+	unsigned long		 body = 0;
+	long			 avail;
+	int			 width;
+	int			 i;
+
+	if ( !framer )
+		return -1;
+
+	width = framer->prefix_width;
+	avail = framer->used - framer->scan;
+	p = ( unsigned char * ) framer->base + framer->head + framer->scan;
+	if ( framer->mirrored && framer->head + framer->scan >= framer->size )
+		p -= framer->size;
+
+	if ( avail < width )
+	{
+		framer->need = width - avail;
+		return 0;
+	}
+
+	if ( framer->flags & TCP_FRAME_LITTLE_ENDIAN )
+		for ( i = width - 1; i >= 0; i-- )
+			body = ( body << 8 ) | p[i];
+	else
+		for ( i = 0; i < width; i++ )
+			body = ( body << 8 ) | p[i];
+
+	if ( framer->flags & TCP_FRAME_LENGTH_INCLUSIVE )
+	{
+		if ( body < ( unsigned long ) width )
+			return -1;
+		body -= width;
+	}
+	if ( body > ( unsigned long ) framer->max_frame )
+		return -1;
+
+	if ( avail < width + ( long ) body )
+	{
+		framer->need = width + ( long ) body - avail;
+		return 0;
+	}
+
+	*frame = ( char * ) p + width;
+	*length = ( long ) body;
+	framer->scan += width + ( long ) body;
+	framer->need = 0;
+	return 1;
+}
+
+/***************************************************************
+*
+* NAME:                           frame_prefix
+*
+* FUNCTION:             Writes the prefix for a body of length
+*                       bytes, in the connection's framing.
+*
+* RETURNS:              int - prefix width, -1 if length is over
+*                       max_frame
+***************************************************************/
+int frame_prefix ( TCP_CONNECTION_INFO *connection, char *prefix, long length )
+{
+	TCP_FRAMER	*framer = connection->framer;
+	unsigned long	 value;
+	int		 width;
+	int		 i;
+
+	if ( !framer || length < 0 || length > framer->max_frame )
+		return -1;
+
+	width = framer->prefix_width;
+	value = ( unsigned long ) length;
+	if ( framer->flags & TCP_FRAME_LENGTH_INCLUSIVE )
+		value += width;
+
+	for ( i = 0; i < width; i++ )
+	{
+		if ( framer->flags & TCP_FRAME_LITTLE_ENDIAN )
+			prefix[i] = ( char ) ( value >> ( 8 * i ) );
+		else
+			prefix[i] = ( char ) ( value >> ( 8 * ( width - 1 - i ) ) );
+	}
+
+	return width;
+}
+
+#ifdef __cplusplus
+}
+#endif
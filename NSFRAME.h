@@ -0,0 +1,91 @@
+/************************************************************************************
+*		FILE:		"nsframe.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Length-prefixed message framing on a connection. Data
+*					is received into a per-connection ring and complete
+*					frames come back as pointer + length views into it,
+*					so nothing is copied and one large recv can yield
+*					many frames.
+*
+*		Notes:		On Linux the ring is mapped twice back to back (a
+*					memfd seen at two addresses), so a frame that wraps
+*					past the end is still contiguous. Elsewhere, or if the
+*					mapping fails, a flat buffer is used and the unread
+*					tail is moved to the front once it runs out of room.
+*
+*					Views from frame_next stay valid until the next
+*					frame_recv / frame_recv_nw on the connection.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.7.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifndef _NSFRAMEH_INCLUDE_
+#define _NSFRAMEH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* framer flags; the default is a big-endian (network order) prefix
+*  giving the length of the body alone */
+#define TCP_FRAME_LITTLE_ENDIAN		0x01
+#define TCP_FRAME_LENGTH_INCLUSIVE	0x02	/* prefix counts itself too */
+
+/***************************************************************
+*
+*	Name:		TCP_FRAMER
+*	Type:		struct
+*	Purpose:	Receive ring and prefix settings of one
+*				connection (TCP_CONNECTION_INFO::framer).
+*
+*				Bytes [head, head + used) are in the ring;
+*				the first scan of them have been handed out
+*				by frame_next and are dropped on the next
+*				receive.
+*
+***************************************************************/
+typedef struct tcp_framer
+{
+	char				*base;
+	long				size;
+	long				head;
+	long				used;
+	long				scan;
+	long				need;		/* bytes the partial frame at scan still lacks */
+	long				max_frame;
+	int				prefix_width;
+	int				flags;
+	int				mirrored;
+} TCP_FRAMER;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int framer_attach ( TCP_CONNECTION_INFO *connection, long capacity, int prefix_width, int flags, long max_frame );
+void framer_detach ( TCP_CONNECTION_INFO *connection );
+int frame_recv ( TCP_CONNECTION_INFO *connection );
+int frame_recv_nw ( TCP_CONNECTION_INFO *connection );
+void frame_commit ( TCP_CONNECTION_INFO *connection, long count );
+int frame_next ( TCP_CONNECTION_INFO *connection, char **frame, long *length );
+int frame_prefix ( TCP_CONNECTION_INFO *connection, char *prefix, long length );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSFRAMEH_INCLUDE_
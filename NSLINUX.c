@@ -0,0 +1,2058 @@
+/************************************************************************************
+*		FILE:		"nslinux.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Linux emulation of the Guardian nowait socket calls.
+*					See nslinux.h for the contract.
+*
+*		Notes:		Every nowait request becomes an NSLX_OP. If the socket
+*					has nothing queued in that direction the request is tried
+*					straight away; when the kernel answers EAGAIN the op is
+*					parked on the socket's read or write queue and picked up
+*					again on the next epoll edge. Finished ops sit on the
+*					done list until AWAITIOX hands them back.
+*
+*					Ops and accepted-connection records are recycled through
+*					free lists, so steady-state traffic does no heap work.
+*
+*					With the io_uring engine (nslx_select_engine) the head
+*					op of each queue is instead handed to the kernel as an
+*					SQE. SQEs are published in bulk on the next wait, and
+*					every CQE already posted is harvested by the same call.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.1.0	  10/17/26		Initial Release
+*		1.2.0	  10/17/26		nslx_reap_completions batch reaping
+*		1.3.0	  10/17/26		Optional io_uring engine (nsuring.c)
+*		1.6.0	  10/17/26		nslx_sendv_nw / nslx_recvv_nw (iovec ops)
+*		1.9.0	  10/17/26		nslx_accepted_fd, nslx_thread_exit
+*		1.11.0	  10/17/26		Completion op kind and latency (nslx_set_timing)
+*		1.12.0	  10/17/26		nslx_timeout_op for timer deadlines
+*		1.25.1	  10/17/26		Accepted connections taken oldest first
+*		1.25.1	  10/17/26		Deadlines end with ETIMEDOUT, not FETIMEDOUT
+*		1.25.1	  10/17/26		CANCELREQ
+*************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "NSTCP.h"
+#include "NSURING.h"
+#include <sys/epoll.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						TYPES AND CONSTANTS
+***************************************************************************************/
+
+#define NSLX_OP_SLAB			64
+#define NSLX_MAX_EVENTS			256
+#define NSLX_INET_NAME_LEN		64
+#define NSLX_URING_ENTRIES		256
+#define NSLX_IOV_INLINE			4
+
+enum
+{
+	NSLX_OP_RECV = 0,
+	NSLX_OP_SEND,
+	NSLX_OP_ACCEPT,
+	NSLX_OP_CONNECT,
+	NSLX_OP_IMMEDIATE,
+	NSLX_OP_RECVV,
+	NSLX_OP_SENDV
+};
+
+/* ops served from a socket's read queue; the rest use the write queue */
+#define NSLX_READ_SIDE(type)	( ( type ) == NSLX_OP_RECV || ( type ) == NSLX_OP_ACCEPT \
+				|| ( type ) == NSLX_OP_RECVV )
+
+/* one outstanding (or finished, not yet reaped) nowait request */
+typedef struct nslx_op
+{
+	struct nslx_op			*next;
+	int				type;
+	int				fd;
+	char				*buffer;
+	int				length;
+	int				flags;
+	long				tag;
+	struct sockaddr			*address;
+	long				*address_len;
+	int				started;
+	unsigned char			cancelled;
+	unsigned char			timed_out;	/* nslx_timeout_op asked the kernel to cancel it */
+	struct nslx_accepted		*accepted;
+	long				count;
+	int				error;
+	long long			submitted;	/* tcp_clock_usec at submit, -1 untimed */
+
+	/* RECVV / SENDV: msg.msg_iov walks iov as a send resumes */
+	struct msghdr			msg;
+	struct iovec			*iov;
+	struct iovec			iov_inline[NSLX_IOV_INLINE];
+} NSLX_OP;
+
+/* simple FIFO of ops */
+typedef struct nslx_queue
+{
+	NSLX_OP				*head;
+	NSLX_OP				*tail;
+} NSLX_QUEUE;
+
+/* per-descriptor state, indexed by fd */
+typedef struct nslx_file
+{
+	NSLX_QUEUE			readq;
+	NSLX_QUEUE			writeq;
+	int				outstanding;
+	short				last_error;
+	unsigned char			registered;
+	unsigned char			prepared;
+} NSLX_FILE;
+
+/* a connection taken off the listen queue by accept_nw, waiting
+*  for accept_nw2/accept_nw3 to move it onto the caller's socket */
+typedef struct nslx_accepted
+{
+	struct nslx_accepted		*next;
+	int				fd;
+	struct sockaddr_storage		from;
+	socklen_t			from_len;
+} NSLX_ACCEPTED;
+
+/* one completion domain (one per thread) */
+typedef struct nslx_engine
+{
+	int				mode;
+	int				epfd;
+	NSLX_FILE			*files;
+	int				file_count;
+	NSLX_OP				*free_ops;
+	NSLX_OP				*op_slabs;
+	NSLX_QUEUE			done;
+	int				outstanding;
+	NSLX_ACCEPTED			*accepted;	/* oldest first */
+	NSLX_ACCEPTED			*accepted_tail;
+	NSLX_ACCEPTED			*free_accepted;
+	short				last_error;
+	char				inet_name[NSLX_INET_NAME_LEN];
+#ifdef NSUR_HAVE_IO_URING
+	NSUR_RING			ring;
+#endif
+} NSLX_ENGINE;
+
+static __thread NSLX_ENGINE	*nslx_engine;
+
+/* set by nslx_set_timing; read by every thread on submit */
+static volatile int		nslx_timing;
+
+/* TCP_COMPLETION::op for each NSLX_OP_* */
+static const int nslx_op_kind[] =
+{
+	TCP_OP_RECV,		/* NSLX_OP_RECV */
+	TCP_OP_SEND,		/* NSLX_OP_SEND */
+	TCP_OP_ACCEPT,		/* NSLX_OP_ACCEPT */
+	TCP_OP_CONNECT,		/* NSLX_OP_CONNECT */
+	TCP_OP_OTHER,		/* NSLX_OP_IMMEDIATE */
+	TCP_OP_RECV,		/* NSLX_OP_RECVV */
+	TCP_OP_SEND		/* NSLX_OP_SENDV */
+};
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+static int Nslx_Attempt ( NSLX_OP *op );
+#ifdef NSUR_HAVE_IO_URING
+static void Nslx_Uring_Start ( NSLX_ENGINE *e, NSLX_OP *op );
+static void Nslx_Uring_Cancel ( NSLX_ENGINE *e, NSLX_OP *op );
+static void Nslx_Uring_Done ( void *context, unsigned long long user_data, int result );
+#endif
+
+
+/***************************************************************
+*
+* NAME:                           Nslx_Engine
+*
+* FUNCTION:             Returns this thread's completion domain,
+*                       creating its epoll set on first use.
+*
+* RETURNS:              NSLX_ENGINE * - 0 if epoll is unavailable
+***************************************************************/
+static NSLX_ENGINE *Nslx_Engine ( void )
+{
+	NSLX_ENGINE *e;
+
+	if ( nslx_engine )
+		return nslx_engine;
+
+	e = ( NSLX_ENGINE * ) calloc ( 1, sizeof ( NSLX_ENGINE ) );
+	if ( !e )
+		return 0;
+
+	e->epfd = epoll_create1 ( EPOLL_CLOEXEC );
+	if ( e->epfd < 0 )
+	{
+		free ( e );
+		return 0;
+	}
+
+	e->mode = TCP_ENGINE_EPOLL;
+	nslx_engine = e;
+	return e;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_File
+*
+* FUNCTION:             Returns the state block for a descriptor,
+*                       growing the table as needed.
+*
+* NOTE:                 The table may move; don't hold the pointer
+*                       across another Nslx_File call.
+*
+* RETURNS:              NSLX_FILE * - 0 on bad fd / no memory
+***************************************************************/
+static NSLX_FILE *Nslx_File ( NSLX_ENGINE *e, int fd )
+{
+	NSLX_FILE	*grown;
+	int		 count;
+
+	if ( fd < 0 )
+		return 0;
+
+	if ( fd >= e->file_count )
+	{
+		count = e->file_count ? e->file_count * 2 : 64;
+		while ( count <= fd )
+			count *= 2;
+
+		grown = ( NSLX_FILE * ) realloc ( e->files, count * sizeof ( NSLX_FILE ) );
+		if ( !grown )
+			return 0;
+
+		memset ( grown + e->file_count
+			   , 0
+			   , ( count - e->file_count ) * sizeof ( NSLX_FILE ) );
+		e->files = grown;
+		e->file_count = count;
+	}
+
+	return &e->files[fd];
+}
+
+/***************************************************************
+*
+* NAME:                       Nslx_Queue_Push / Nslx_Queue_Pop
+*
+* FUNCTION:             FIFO helpers for op queues
+*
+***************************************************************/
+static void Nslx_Queue_Push ( NSLX_QUEUE *queue, NSLX_OP *op )
+{
+	op->next = 0;
+	if ( queue->tail )
+		queue->tail->next = op;
+	else
+		queue->head = op;
+	queue->tail = op;
+}
+
+static NSLX_OP *Nslx_Queue_Pop ( NSLX_QUEUE *queue )
+{
+	NSLX_OP *op = queue->head;
+
+	if ( op )
+	{
+		queue->head = op->next;
+		if ( !queue->head )
+			queue->tail = 0;
+		op->next = 0;
+	}
+	return op;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Op_Get
+*
+* FUNCTION:             Takes an op off the free list, refilling
+*                       it a slab at a time.
+*
+* RETURNS:              NSLX_OP * - 0 when out of memory
+***************************************************************/
+static NSLX_OP *Nslx_Op_Get ( NSLX_ENGINE *e )
+{
+	NSLX_OP	*op;
+	int	 i;
+
+	if ( !e->free_ops )
+	{
+		/* op[0] only chains the slab into op_slabs */
+		op = ( NSLX_OP * ) calloc ( NSLX_OP_SLAB + 1, sizeof ( NSLX_OP ) );
+		if ( !op )
+			return 0;
+		op[0].next = e->op_slabs;
+		e->op_slabs = op;
+		for ( i = 1; i <= NSLX_OP_SLAB; i++ )
+		{
+			op[i].next = e->free_ops;
+			e->free_ops = &op[i];
+		}
+	}
+
+	op = e->free_ops;
+	e->free_ops = op->next;
+	memset ( op, 0, sizeof ( *op ) );
+	return op;
+}
+
+static void Nslx_Op_Put ( NSLX_ENGINE *e, NSLX_OP *op )
+{
+	if ( op->iov && op->iov != op->iov_inline )
+		free ( op->iov );
+	op->iov = 0;
+
+	op->next = e->free_ops;
+	e->free_ops = op;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Register
+*
+* FUNCTION:             Puts a descriptor into the epoll set
+*                       (edge triggered, both directions) the
+*                       first time it has to wait on the kernel.
+*
+* RETURNS:              int - 0 or errno
+***************************************************************/
+static int Nslx_Register ( NSLX_ENGINE *e, int fd )
+{
+	struct epoll_event	 event;
+	NSLX_FILE		*file = Nslx_File ( e, fd );
+
+	if ( !file )
+		return ENOMEM;
+	if ( file->registered )
+		return 0;
+
+	memset ( &event, 0, sizeof ( event ) );
+	event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+	event.data.fd = fd;
+
+	if ( epoll_ctl ( e->epfd, EPOLL_CTL_ADD, fd, &event ) < 0 && errno != EEXIST )
+		return errno;
+
+	file->registered = 1;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Complete
+*
+* FUNCTION:             Moves a finished op onto the done list.
+*
+***************************************************************/
+static void Nslx_Complete ( NSLX_ENGINE *e, NSLX_OP *op )
+{
+	Nslx_Queue_Push ( &e->done, op );
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Submit
+*
+* FUNCTION:             Common entry for every nowait request.
+*                       Tries the op now if nothing is queued ahead
+*                       of it, otherwise parks it for the next edge.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+static int Nslx_Submit ( NSLX_ENGINE *e, NSLX_OP *op )
+{
+	NSLX_FILE	*file;
+	NSLX_QUEUE	*queue;
+	int		 rc;
+
+	file = Nslx_File ( e, op->fd );
+	if ( !file )
+	{
+		Nslx_Op_Put ( e, op );
+		errno = ENOMEM;
+		return -1;
+	}
+
+	/* epoll needs O_NONBLOCK on every descriptor used nowait, including
+	*  ones that did not come from socket_nw. io_uring wants the opposite:
+	*  on an O_NONBLOCK socket it hands EAGAIN back instead of waiting. */
+	if ( !file->prepared && op->type != NSLX_OP_IMMEDIATE )
+	{
+		rc = fcntl ( op->fd, F_GETFL );
+		if ( rc >= 0 && e->mode == TCP_ENGINE_EPOLL && !( rc & O_NONBLOCK ) )
+			rc = fcntl ( op->fd, F_SETFL, rc | O_NONBLOCK );
+		else if ( rc >= 0 && e->mode != TCP_ENGINE_EPOLL && ( rc & O_NONBLOCK ) )
+			rc = fcntl ( op->fd, F_SETFL, rc & ~O_NONBLOCK );
+		if ( rc < 0 )
+		{
+			Nslx_Op_Put ( e, op );
+			return -1;
+		}
+		file->prepared = 1;
+	}
+
+	file->outstanding++;
+	e->outstanding++;
+
+	if ( op->type == NSLX_OP_IMMEDIATE )
+	{
+		Nslx_Complete ( e, op );
+		return 0;
+	}
+
+	queue = NSLX_READ_SIDE ( op->type ) ? &file->readq : &file->writeq;
+
+#ifdef NSUR_HAVE_IO_URING
+	if ( e->mode == TCP_ENGINE_IO_URING )
+	{
+		/* one op per direction in flight keeps stream order */
+		Nslx_Queue_Push ( queue, op );
+		if ( queue->head == op )
+			Nslx_Uring_Start ( e, op );
+		return 0;
+	}
+#endif
+
+	if ( !queue->head && Nslx_Attempt ( op ) != EAGAIN )
+	{
+		Nslx_Complete ( e, op );
+		return 0;
+	}
+
+	rc = Nslx_Register ( e, op->fd );
+	if ( rc )
+	{
+		op->error = rc;
+		Nslx_Complete ( e, op );
+		return 0;
+	}
+
+	/* the registration may have moved the table */
+	file = &e->files[op->fd];
+	queue = NSLX_READ_SIDE ( op->type ) ? &file->readq : &file->writeq;
+	Nslx_Queue_Push ( queue, op );
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_New_Op
+*
+* FUNCTION:             Allocates and fills in the common fields
+*                       of a request.
+*
+* RETURNS:              NSLX_OP * - 0 with errno set
+***************************************************************/
+static NSLX_OP *Nslx_New_Op ( NSLX_ENGINE **engine, int type, int fd, long tag )
+{
+	NSLX_ENGINE	*e = Nslx_Engine ( );
+	NSLX_OP		*op;
+
+	if ( !e )
+	{
+		errno = ENOMEM;
+		return 0;
+	}
+	if ( fd < 0 )
+	{
+		errno = EBADF;
+		return 0;
+	}
+
+	op = Nslx_Op_Get ( e );
+	if ( !op )
+	{
+		errno = ENOMEM;
+		return 0;
+	}
+
+	op->type = type;
+	op->fd = fd;
+	op->tag = tag;
+	op->submitted = nslx_timing ? tcp_clock_usec ( ) : -1;
+	*engine = e;
+	return op;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Accepted_Take
+*
+* FUNCTION:             Finds the connection accept_nw pulled off
+*                       the listen queue for the given remote
+*                       address. A null address takes the oldest.
+*
+* RETURNS:              NSLX_ACCEPTED * - 0 when nothing matches
+***************************************************************/
+static NSLX_ACCEPTED *Nslx_Accepted_Take ( NSLX_ENGINE *e, struct sockaddr *address )
+{
+	NSLX_ACCEPTED	**link;
+	NSLX_ACCEPTED	 *entry;
+	NSLX_ACCEPTED	 *prev = 0;
+	int		  match;
+
+	for ( link = &e->accepted; *link; prev = *link, link = &( *link )->next )
+	{
+		entry = *link;
+		match = !address;
+
+		if ( !match && address->sa_family == entry->from.ss_family )
+		{
+			if ( address->sa_family == AF_INET )
+			{
+				struct sockaddr_in *a = ( struct sockaddr_in * ) address;
+				struct sockaddr_in *b = ( struct sockaddr_in * ) &entry->from;
+
+				match = a->sin_port == b->sin_port
+					 && a->sin_addr.s_addr == b->sin_addr.s_addr;
+			}
+			else if ( address->sa_family == AF_INET6 )
+			{
+				struct sockaddr_in6 *a = ( struct sockaddr_in6 * ) address;
+				struct sockaddr_in6 *b = ( struct sockaddr_in6 * ) &entry->from;
+
+				match = a->sin6_port == b->sin6_port
+					 && !memcmp ( &a->sin6_addr, &b->sin6_addr, sizeof ( a->sin6_addr ) );
+			}
+			else
+				match = !memcmp ( address, &entry->from, entry->from_len );
+		}
+
+		if ( match )
+		{
+			*link = entry->next;
+			if ( e->accepted_tail == entry )
+				e->accepted_tail = prev;
+			return entry;
+		}
+	}
+
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Accept_Report
+*
+* FUNCTION:             Parks a freshly accepted connection for
+*                       accept_nw2/accept_nw3, behind those already
+*                       waiting, and copies the remote address back
+*                       to the accept_nw caller.
+*
+***************************************************************/
+static void Nslx_Accept_Report ( NSLX_ENGINE *e, NSLX_OP *op, NSLX_ACCEPTED *entry )
+{
+	socklen_t len;
+
+	entry->next = 0;
+	if ( e->accepted_tail )
+		e->accepted_tail->next = entry;
+	else
+		e->accepted = entry;
+	e->accepted_tail = entry;
+
+	if ( op->address )
+	{
+		len = ( op->address_len && *op->address_len > 0 ) ? ( socklen_t ) *op->address_len
+														   : ( socklen_t ) sizeof ( struct sockaddr_in );
+		if ( len > entry->from_len )
+			len = entry->from_len;
+		memcpy ( op->address, &entry->from, len );
+	}
+	if ( op->address_len )
+		*op->address_len = entry->from_len;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Iov_Advance
+*
+* FUNCTION:             Steps a vectored op's msghdr past bytes
+*                       the kernel has already taken.
+*
+* RETURNS:              int - 1 while bytes remain, 0 when done
+***************************************************************/
+static int Nslx_Iov_Advance ( NSLX_OP *op, size_t bytes )
+{
+	struct msghdr *msg = &op->msg;
+
+	while ( msg->msg_iovlen && bytes >= msg->msg_iov->iov_len )
+	{
+		bytes -= msg->msg_iov->iov_len;
+		msg->msg_iov++;
+		msg->msg_iovlen--;
+	}
+
+	if ( msg->msg_iovlen )
+	{
+		msg->msg_iov->iov_base = ( char * ) msg->msg_iov->iov_base + bytes;
+		msg->msg_iov->iov_len -= bytes;
+	}
+
+	return msg->msg_iovlen != 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Attempt
+*
+* FUNCTION:             Runs one non-blocking step of an op.
+*
+* RETURNS:              int - EAGAIN if the op must keep waiting,
+*                       0 once it has finished (op->error holds
+*                       the outcome)
+***************************************************************/
+static int Nslx_Attempt ( NSLX_OP *op )
+{
+	ssize_t		 bytes;
+	socklen_t	 len;
+	int		 fd;
+	int		 so_error;
+	NSLX_ACCEPTED	*entry;
+
+	switch ( op->type )
+	{
+	case NSLX_OP_RECV:
+		bytes = recv ( op->fd, op->buffer, op->length, op->flags );
+		break;
+
+	case NSLX_OP_SEND:
+		bytes = send ( op->fd, op->buffer, op->length, op->flags | MSG_NOSIGNAL );
+		break;
+
+	case NSLX_OP_RECVV:
+		bytes = recvmsg ( op->fd, &op->msg, op->flags );
+		break;
+
+	case NSLX_OP_SENDV:
+		/* keep going until every part is out or the socket fills */
+		for ( ;; )
+		{
+			bytes = sendmsg ( op->fd, &op->msg, op->flags | MSG_NOSIGNAL );
+			if ( bytes < 0 )
+			{
+				if ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR )
+					return EAGAIN;
+				op->error = errno;
+				return 0;
+			}
+			op->count += ( long ) bytes;
+			if ( !Nslx_Iov_Advance ( op, ( size_t ) bytes ) )
+				return 0;
+		}
+
+	case NSLX_OP_ACCEPT:
+		entry = nslx_engine->free_accepted;
+		if ( entry )
+			nslx_engine->free_accepted = entry->next;
+		else if ( ( entry = ( NSLX_ACCEPTED * ) malloc ( sizeof ( NSLX_ACCEPTED ) ) ) == 0 )
+		{
+			op->error = ENOMEM;
+			return 0;
+		}
+		entry->from_len = sizeof ( entry->from );
+		fd = accept4 ( op->fd
+					 , ( struct sockaddr * ) &entry->from
+					 , &entry->from_len
+					 , SOCK_NONBLOCK | SOCK_CLOEXEC );
+		if ( fd < 0 )
+		{
+			so_error = errno;
+			entry->next = nslx_engine->free_accepted;
+			nslx_engine->free_accepted = entry;
+			errno = so_error;
+			if ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR )
+				return EAGAIN;
+			op->error = errno;
+			return 0;
+		}
+
+		entry->fd = fd;
+		Nslx_Accept_Report ( nslx_engine, op, entry );
+		return 0;
+
+	case NSLX_OP_CONNECT:
+		if ( !op->started )
+		{
+			op->started = 1;
+			if ( connect ( op->fd, op->address, ( socklen_t ) op->length ) == 0 )
+				return 0;
+			if ( errno == EINPROGRESS || errno == EAGAIN || errno == EINTR )
+				return EAGAIN;
+			op->error = errno;
+			return 0;
+		}
+
+		so_error = 0;
+		len = sizeof ( so_error );
+		if ( getsockopt ( op->fd, SOL_SOCKET, SO_ERROR, &so_error, &len ) < 0 )
+			so_error = errno;
+		if ( so_error )
+		{
+			op->error = so_error;
+			return 0;
+		}
+
+		/* EPOLLOUT with no error still might not mean connected */
+		len = 0;
+		if ( getpeername ( op->fd, 0, &len ) < 0 && errno == ENOTCONN )
+			return EAGAIN;
+		return 0;
+
+	default:
+		return 0;
+	}
+
+	if ( bytes < 0 )
+	{
+		if ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR )
+			return EAGAIN;
+		op->error = errno;
+		return 0;
+	}
+
+	op->count = ( long ) bytes;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Run_Queue
+*
+* FUNCTION:             Pushes a socket's read or write queue
+*                       forward after an epoll edge, until the
+*                       kernel says EAGAIN again.
+*
+***************************************************************/
+static void Nslx_Run_Queue ( NSLX_ENGINE *e, NSLX_QUEUE *queue )
+{
+	NSLX_OP *op;
+
+	while ( ( op = queue->head ) != 0 )
+	{
+		if ( Nslx_Attempt ( op ) == EAGAIN )
+			break;
+		Nslx_Queue_Pop ( queue );
+		Nslx_Complete ( e, op );
+	}
+}
+
+#ifdef NSUR_HAVE_IO_URING
+/***************************************************************
+*
+* NAME:                           Nslx_Uring_Sqe
+*
+* FUNCTION:             Gets a submission entry, pushing what is
+*                       already queued to the kernel if the ring
+*                       is full.
+*
+* RETURNS:              struct io_uring_sqe * - 0 if still full
+***************************************************************/
+static struct io_uring_sqe *Nslx_Uring_Sqe ( NSLX_ENGINE *e )
+{
+	struct io_uring_sqe *sqe = nsur_get_sqe ( &e->ring );
+
+	if ( !sqe && nsur_enter ( &e->ring, 0, 0 ) >= 0 )
+		sqe = nsur_get_sqe ( &e->ring );
+	return sqe;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Uring_Finish
+*
+* FUNCTION:             Retires the in-flight head of a socket's
+*                       queue and starts the op behind it.
+*
+***************************************************************/
+static void Nslx_Uring_Finish ( NSLX_ENGINE *e, NSLX_OP *op )
+{
+	NSLX_FILE	*file = &e->files[op->fd];
+	NSLX_QUEUE	*queue;
+
+	queue = NSLX_READ_SIDE ( op->type ) ? &file->readq : &file->writeq;
+	Nslx_Queue_Pop ( queue );
+	Nslx_Complete ( e, op );
+
+	if ( queue->head )
+		Nslx_Uring_Start ( e, queue->head );
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Uring_Start
+*
+* FUNCTION:             Turns the head op of a socket's queue into
+*                       an SQE. It reaches the kernel with the next
+*                       wait, together with everything else queued.
+*
+***************************************************************/
+static void Nslx_Uring_Start ( NSLX_ENGINE *e, NSLX_OP *op )
+{
+	struct io_uring_sqe	*sqe = Nslx_Uring_Sqe ( e );
+	NSLX_ACCEPTED		*entry;
+
+	if ( !sqe )
+	{
+		op->error = EBUSY;
+		Nslx_Uring_Finish ( e, op );
+		return;
+	}
+
+	sqe->fd = op->fd;
+	sqe->user_data = ( unsigned long long ) ( uintptr_t ) op;
+
+	switch ( op->type )
+	{
+	case NSLX_OP_RECV:
+		sqe->opcode = IORING_OP_RECV;
+		sqe->addr = ( unsigned long long ) ( uintptr_t ) op->buffer;
+		sqe->len = ( unsigned ) op->length;
+		sqe->msg_flags = ( unsigned ) op->flags;
+		break;
+
+	case NSLX_OP_SEND:
+		sqe->opcode = IORING_OP_SEND;
+		sqe->addr = ( unsigned long long ) ( uintptr_t ) op->buffer;
+		sqe->len = ( unsigned ) op->length;
+		sqe->msg_flags = ( unsigned ) ( op->flags | MSG_NOSIGNAL );
+		break;
+
+	case NSLX_OP_RECVV:
+		sqe->opcode = IORING_OP_RECVMSG;
+		sqe->addr = ( unsigned long long ) ( uintptr_t ) &op->msg;
+		sqe->msg_flags = ( unsigned ) op->flags;
+		break;
+
+	case NSLX_OP_SENDV:
+		sqe->opcode = IORING_OP_SENDMSG;
+		sqe->addr = ( unsigned long long ) ( uintptr_t ) &op->msg;
+		sqe->msg_flags = ( unsigned ) ( op->flags | MSG_NOSIGNAL );
+		break;
+
+	case NSLX_OP_ACCEPT:
+		entry = e->free_accepted;
+		if ( entry )
+			e->free_accepted = entry->next;
+		else if ( ( entry = ( NSLX_ACCEPTED * ) malloc ( sizeof ( NSLX_ACCEPTED ) ) ) == 0 )
+		{
+			/* hand the slot back as a no-op so the ring stays consistent */
+			sqe->opcode = IORING_OP_NOP;
+			sqe->user_data = 0;
+			op->error = ENOMEM;
+			Nslx_Uring_Finish ( e, op );
+			return;
+		}
+		entry->from_len = sizeof ( entry->from );
+		op->accepted = entry;
+
+		sqe->opcode = IORING_OP_ACCEPT;
+		sqe->addr = ( unsigned long long ) ( uintptr_t ) &entry->from;
+		sqe->addr2 = ( unsigned long long ) ( uintptr_t ) &entry->from_len;
+		sqe->accept_flags = SOCK_CLOEXEC;
+		break;
+
+	case NSLX_OP_CONNECT:
+		sqe->opcode = IORING_OP_CONNECT;
+		sqe->addr = ( unsigned long long ) ( uintptr_t ) op->address;
+		sqe->off = ( unsigned long long ) op->length;
+		break;
+
+	default:
+		sqe->opcode = IORING_OP_NOP;
+		break;
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Uring_Cancel
+*
+* FUNCTION:             Detaches an in-flight op from its socket
+*                       and asks the kernel to cancel it. The op is
+*                       recycled once its CQE arrives.
+*
+***************************************************************/
+static void Nslx_Uring_Cancel ( NSLX_ENGINE *e, NSLX_OP *op )
+{
+	struct io_uring_sqe *sqe;
+
+	op->cancelled = 1;
+	e->outstanding--;
+
+	sqe = Nslx_Uring_Sqe ( e );
+	if ( sqe )
+	{
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->addr = ( unsigned long long ) ( uintptr_t ) op;
+		sqe->user_data = 0;
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Uring_Done
+*
+* FUNCTION:             CQE handler: records the result on the op
+*                       and moves it to the done list.
+*
+***************************************************************/
+static void Nslx_Uring_Done ( void *context, unsigned long long user_data, int result )
+{
+	NSLX_ENGINE	*e = ( NSLX_ENGINE * ) context;
+	NSLX_OP		*op = ( NSLX_OP * ) ( uintptr_t ) user_data;
+	NSLX_ACCEPTED	*entry;
+
+	/* cancel requests and no-ops carry no op */
+	if ( !op )
+		return;
+
+	entry = op->accepted;
+	op->accepted = 0;
+
+	if ( op->cancelled )
+	{
+		if ( entry )
+		{
+			if ( result >= 0 )
+				close ( result );
+			entry->next = e->free_accepted;
+			e->free_accepted = entry;
+		}
+		Nslx_Op_Put ( e, op );
+		return;
+	}
+
+	/* a deadline's cancel landed (or beat a retry) */
+	if ( op->timed_out && ( result == -ECANCELED || result == -EAGAIN || result == -EINTR ) )
+		result = -TCP_ETIMEDOUT;
+
+	if ( result == -EAGAIN || result == -EINTR )
+	{
+		if ( entry )
+		{
+			entry->next = e->free_accepted;
+			e->free_accepted = entry;
+		}
+		Nslx_Uring_Start ( e, op );
+		return;
+	}
+
+	if ( result < 0 )
+	{
+		op->error = -result;
+		if ( entry )
+		{
+			entry->next = e->free_accepted;
+			e->free_accepted = entry;
+		}
+	}
+	else if ( entry )
+	{
+		entry->fd = result;
+		Nslx_Accept_Report ( e, op, entry );
+	}
+	else if ( op->type == NSLX_OP_SENDV )
+	{
+		/* a short sendmsg goes straight back for the rest */
+		op->count += result;
+		if ( result > 0 && Nslx_Iov_Advance ( op, ( size_t ) result ) )
+		{
+			if ( op->timed_out )
+				op->error = TCP_ETIMEDOUT;
+			else
+			{
+				Nslx_Uring_Start ( e, op );
+				return;
+			}
+		}
+	}
+	else
+		op->count = result;
+
+	Nslx_Uring_Finish ( e, op );
+}
+#endif
+
+/***************************************************************
+*
+* NAME:                           Nslx_Poll
+*
+* FUNCTION:             One epoll_wait pass over this thread's
+*                       sockets.
+*
+* RETURNS:              int - events seen, -1 on failure
+***************************************************************/
+static int Nslx_Poll ( NSLX_ENGINE *e, int timeout_ms )
+{
+	struct epoll_event	 events[NSLX_MAX_EVENTS];
+	NSLX_FILE		*file;
+	int			 count;
+	int			 i;
+
+#ifdef NSUR_HAVE_IO_URING
+	if ( e->mode == TCP_ENGINE_IO_URING )
+	{
+		if ( nsur_enter ( &e->ring, timeout_ms ? 1 : 0, timeout_ms ) < 0 )
+			return errno == EINTR ? 0 : -1;
+		return nsur_reap ( &e->ring, Nslx_Uring_Done, e );
+	}
+#endif
+
+	count = epoll_wait ( e->epfd, events, NSLX_MAX_EVENTS, timeout_ms );
+	if ( count < 0 )
+		return errno == EINTR ? 0 : -1;
+
+	for ( i = 0; i < count; i++ )
+	{
+		if ( events[i].data.fd >= e->file_count )
+			continue;
+		file = &e->files[events[i].data.fd];
+
+		if ( events[i].events & ( EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR ) )
+			Nslx_Run_Queue ( e, &file->readq );
+		if ( events[i].events & ( EPOLLOUT | EPOLLHUP | EPOLLERR ) )
+			Nslx_Run_Queue ( e, &file->writeq );
+	}
+
+	return count;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Take_Done
+*
+* FUNCTION:             Unlinks the oldest finished op, either for
+*                       any file (fd < 0) or for one file.
+*
+* RETURNS:              NSLX_OP * - 0 if none
+***************************************************************/
+static NSLX_OP *Nslx_Take_Done ( NSLX_ENGINE *e, int fd )
+{
+	NSLX_OP *prev = 0;
+	NSLX_OP *op;
+
+	if ( fd < 0 )
+		op = Nslx_Queue_Pop ( &e->done );
+	else
+	{
+		for ( op = e->done.head; op && op->fd != fd; op = op->next )
+			prev = op;
+		if ( !op )
+			return 0;
+
+		if ( prev )
+			prev->next = op->next;
+		else
+			e->done.head = op->next;
+		if ( e->done.tail == op )
+			e->done.tail = prev;
+		op->next = 0;
+	}
+
+	if ( op )
+	{
+		e->outstanding--;
+		if ( op->fd < e->file_count )
+		{
+			e->files[op->fd].outstanding--;
+			e->files[op->fd].last_error = ( short ) op->error;
+		}
+		e->last_error = ( short ) op->error;
+	}
+	return op;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Discard
+*
+* FUNCTION:             Drops every op (queued or finished) that
+*                       belongs to a descriptor which is going away.
+*
+***************************************************************/
+static void Nslx_Discard ( NSLX_ENGINE *e, int fd )
+{
+	NSLX_FILE	*file;
+	NSLX_OP		*op;
+
+	if ( fd >= e->file_count )
+		return;
+	file = &e->files[fd];
+
+#ifdef NSUR_HAVE_IO_URING
+	/* the kernel still owns the in-flight head of each queue; it is
+	*  cancelled and recycled when its CQE comes back */
+	if ( e->mode == TCP_ENGINE_IO_URING && ( file->readq.head || file->writeq.head ) )
+	{
+		if ( file->readq.head )
+			Nslx_Uring_Cancel ( e, Nslx_Queue_Pop ( &file->readq ) );
+		if ( file->writeq.head )
+			Nslx_Uring_Cancel ( e, Nslx_Queue_Pop ( &file->writeq ) );
+
+		/* the kernel holds a file reference until the cancel lands */
+		nsur_enter ( &e->ring, 0, 0 );
+	}
+#endif
+
+	while ( ( op = Nslx_Queue_Pop ( &file->readq ) ) != 0 )
+	{
+		e->outstanding--;
+		Nslx_Op_Put ( e, op );
+	}
+	while ( ( op = Nslx_Queue_Pop ( &file->writeq ) ) != 0 )
+	{
+		e->outstanding--;
+		Nslx_Op_Put ( e, op );
+	}
+	while ( ( op = Nslx_Take_Done ( e, fd ) ) != 0 )
+		Nslx_Op_Put ( e, op );
+
+	memset ( file, 0, sizeof ( *file ) );
+}
+
+
+/***************************************************************************************
+*						GUARDIAN SOCKET LIBRARY
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                       socket_set_inet_name
+*
+* FUNCTION:             Linux has a single stack, so the process
+*                       name is only remembered.
+*
+* RETURNS:              int - 0
+***************************************************************/
+int socket_set_inet_name ( char *name )
+{
+	NSLX_ENGINE *e = Nslx_Engine ( );
+
+	if ( e && name )
+	{
+		strncpy ( e->inet_name, name, sizeof ( e->inet_name ) - 1 );
+		e->inet_name[sizeof ( e->inet_name ) - 1] = '\0';
+	}
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           socket_nw
+*
+* FUNCTION:             Creates a non-blocking socket. flags and
+*                       sync only mean something to Guardian.
+*
+* RETURNS:              int - socket, or -1 with errno set
+***************************************************************/
+int socket_nw ( int domain, int type, int protocol, int flags, int sync )
+{
+	( void ) flags;
+	( void ) sync;
+
+	return socket ( domain, type | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol );
+}
+
+/***************************************************************
+*
+* NAME:                           bind_nw
+*
+* FUNCTION:             Binds now; the result is reported through
+*                       AWAITIOX like any other nowait call.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int bind_nw ( int socket, struct sockaddr *address, int address_len, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_OP		*op = Nslx_New_Op ( &e, NSLX_OP_IMMEDIATE, socket, tag );
+
+	if ( !op )
+		return -1;
+
+	if ( bind ( socket, address, ( socklen_t ) address_len ) < 0 )
+		op->error = errno;
+
+	return Nslx_Submit ( e, op );
+}
+
+/***************************************************************
+*
+* NAME:                           connect_nw
+*
+* FUNCTION:             Starts a non-blocking connect; completes
+*                       once the handshake finishes or fails.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int connect_nw ( int socket, struct sockaddr *address, int address_len, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_OP		*op = Nslx_New_Op ( &e, NSLX_OP_CONNECT, socket, tag );
+
+	if ( !op )
+		return -1;
+
+	op->address = address;
+	op->length = address_len;
+
+	return Nslx_Submit ( e, op );
+}
+
+/***************************************************************
+*
+* NAME:                           accept_nw
+*
+* FUNCTION:             Waits for an incoming connection. On
+*                       completion the remote address is filled in;
+*                       hand it to accept_nw2/accept_nw3 together
+*                       with a fresh socket_nw socket.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int accept_nw ( int socket, struct sockaddr *address, long *address_len, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_OP		*op = Nslx_New_Op ( &e, NSLX_OP_ACCEPT, socket, tag );
+
+	if ( !op )
+		return -1;
+
+	op->address = address;
+	op->address_len = address_len;
+
+	return Nslx_Submit ( e, op );
+}
+
+/***************************************************************
+*
+* NAME:                           accept_nw1
+*
+* FUNCTION:             accept_nw with an implied listen() using
+*                       the given backlog.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int accept_nw1 ( int socket, struct sockaddr *address, long *address_len, long tag, short queue_length )
+{
+	if ( listen ( socket, queue_length ) < 0 )
+		return -1;
+
+	return accept_nw ( socket, address, address_len, tag );
+}
+
+/***************************************************************
+*
+* NAME:                           accept_nw2
+*
+* FUNCTION:             Moves the connection accept_nw reported for
+*                       this remote address onto new_socket.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int accept_nw2 ( int new_socket, struct sockaddr *address, long tag )
+{
+	return accept_nw3 ( new_socket, address, 0, tag );
+}
+
+/***************************************************************
+*
+* NAME:                           accept_nw3
+*
+* FUNCTION:             accept_nw2, also returning the local
+*                       address of the connection in me.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int accept_nw3 ( int new_socket, struct sockaddr *address, struct sockaddr *me, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_ACCEPTED	*entry;
+	NSLX_OP		*op = Nslx_New_Op ( &e, NSLX_OP_IMMEDIATE, new_socket, tag );
+	socklen_t	 len;
+
+	if ( !op )
+		return -1;
+
+	entry = Nslx_Accepted_Take ( e, address );
+	if ( !entry )
+	{
+		Nslx_Op_Put ( e, op );
+		errno = ENOTCONN;
+		return -1;
+	}
+
+	/* whatever new_socket was before is replaced by the connection */
+	Nslx_Discard ( e, new_socket );
+	if ( dup3 ( entry->fd, new_socket, O_CLOEXEC ) < 0 )
+		op->error = errno;
+	close ( entry->fd );
+	entry->next = e->free_accepted;
+	e->free_accepted = entry;
+
+	if ( !op->error && me )
+	{
+		len = sizeof ( struct sockaddr_in );
+		if ( getsockname ( new_socket, me, &len ) < 0 )
+			op->error = errno;
+	}
+
+	return Nslx_Submit ( e, op );
+}
+
+/***************************************************************
+*
+* NAME:                           send_nw
+*
+* FUNCTION:             Queues a send. The completion count is
+*                       what the kernel took, which for a stream
+*                       socket may be less than length.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int send_nw ( int socket, char *buffer, int length, int flags, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_OP		*op = Nslx_New_Op ( &e, NSLX_OP_SEND, socket, tag );
+
+	if ( !op )
+		return -1;
+
+	op->buffer = buffer;
+	op->length = length;
+	op->flags = flags;
+
+	return Nslx_Submit ( e, op );
+}
+
+/***************************************************************
+*
+* NAME:                           recv_nw
+*
+* FUNCTION:             Queues a receive. A count of 0 on
+*                       completion means the peer closed.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int recv_nw ( int socket, char *buffer, int length, int flags, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_OP		*op = Nslx_New_Op ( &e, NSLX_OP_RECV, socket, tag );
+
+	if ( !op )
+		return -1;
+
+	op->buffer = buffer;
+	op->length = length;
+	op->flags = flags;
+
+	return Nslx_Submit ( e, op );
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Vector_Op
+*
+* FUNCTION:             Builds a RECVV / SENDV op. The iovec array
+*                       is copied, so only the buffers it points at
+*                       must stay put until the completion.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+static int Nslx_Vector_Op ( int type, int socket, struct iovec *iov, int iovcnt, int flags, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_OP		*op;
+	long		 total = 0;
+	int		 i;
+
+	if ( !iov || iovcnt <= 0 || iovcnt > IOV_MAX )
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	op = Nslx_New_Op ( &e, type, socket, tag );
+	if ( !op )
+		return -1;
+
+	if ( iovcnt <= NSLX_IOV_INLINE )
+		op->iov = op->iov_inline;
+	else if ( ( op->iov = ( struct iovec * ) malloc ( iovcnt * sizeof ( struct iovec ) ) ) == 0 )
+	{
+		Nslx_Op_Put ( e, op );
+		errno = ENOMEM;
+		return -1;
+	}
+
+	memcpy ( op->iov, iov, iovcnt * sizeof ( struct iovec ) );
+	for ( i = 0; i < iovcnt; i++ )
+		total += ( long ) iov[i].iov_len;
+
+	op->msg.msg_iov = op->iov;
+	op->msg.msg_iovlen = iovcnt;
+	op->buffer = ( char * ) iov[0].iov_base;
+	op->length = ( int ) total;
+	op->flags = flags;
+
+	return Nslx_Submit ( e, op );
+}
+
+/***************************************************************
+*
+* NAME:                           nslx_accepted_fd
+*
+* FUNCTION:             Hands over the connection accept_nw reported
+*                       for this remote address as a descriptor of
+*                       its own, saving accept_nw2's extra socket_nw
+*                       and dup. A null address takes the oldest.
+*
+* RETURNS:              int - descriptor, or -1 with errno set
+***************************************************************/
+int nslx_accepted_fd ( struct sockaddr *address )
+{
+	NSLX_ENGINE	*e = Nslx_Engine ( );
+	NSLX_ACCEPTED	*entry;
+	int		 fd;
+
+	if ( !e )
+	{
+		errno = ENOMEM;
+		return -1;
+	}
+
+	entry = Nslx_Accepted_Take ( e, address );
+	if ( !entry )
+	{
+		errno = ENOTCONN;
+		return -1;
+	}
+
+	fd = entry->fd;
+	entry->next = e->free_accepted;
+	e->free_accepted = entry;
+
+	/* the number may have been used before without FILE_CLOSE_ */
+	Nslx_Discard ( e, fd );
+	return fd;
+}
+
+/***************************************************************
+*
+* NAME:                           nslx_sendv_nw
+*
+* FUNCTION:             send_nw for several buffers at once. Unlike
+*                       send_nw it completes only when every byte
+*                       is out (or on error), so a multi-part
+*                       message is never split by a short write.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int nslx_sendv_nw ( int socket, struct iovec *iov, int iovcnt, int flags, long tag )
+{
+	return Nslx_Vector_Op ( NSLX_OP_SENDV, socket, iov, iovcnt, flags, tag );
+}
+
+/***************************************************************
+*
+* NAME:                           nslx_recvv_nw
+*
+* FUNCTION:             recv_nw into several buffers, filled in
+*                       order. Like recv_nw it completes with
+*                       whatever arrived, 0 meaning the peer closed.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int nslx_recvv_nw ( int socket, struct iovec *iov, int iovcnt, int flags, long tag )
+{
+	return Nslx_Vector_Op ( NSLX_OP_RECVV, socket, iov, iovcnt, flags, tag );
+}
+
+/***************************************************************
+*
+* NAME:                           shutdown_nw
+*
+* FUNCTION:             Shuts the socket down now and reports the
+*                       result through AWAITIOX.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int shutdown_nw ( int socket, int how, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_OP		*op = Nslx_New_Op ( &e, NSLX_OP_IMMEDIATE, socket, tag );
+
+	if ( !op )
+		return -1;
+
+	if ( shutdown ( socket, how ) < 0 )
+		op->error = errno;
+
+	return Nslx_Submit ( e, op );
+}
+
+/***************************************************************
+*
+* NAME:                           getsockname_nw
+*
+* FUNCTION:             Fetches the local address now and reports
+*                       the result through AWAITIOX.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+int getsockname_nw ( int socket, struct sockaddr *address, long *address_len, long tag )
+{
+	NSLX_ENGINE	*e;
+	NSLX_OP		*op = Nslx_New_Op ( &e, NSLX_OP_IMMEDIATE, socket, tag );
+	socklen_t	 len;
+
+	if ( !op )
+		return -1;
+
+	len = ( address_len && *address_len > 0 ) ? ( socklen_t ) *address_len : sizeof ( struct sockaddr_in );
+	if ( getsockname ( socket, address, &len ) < 0 )
+		op->error = errno;
+	else if ( address_len )
+		*address_len = len;
+
+	return Nslx_Submit ( e, op );
+}
+
+
+/***************************************************************************************
+*						GUARDIAN FILE SYSTEM
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           FILE_CLOSE_
+*
+* FUNCTION:             Closes the descriptor. Like Guardian, any
+*                       nowait I/O still outstanding on it is
+*                       cancelled without a completion.
+*
+* RETURNS:              short - 0 or errno
+***************************************************************/
+short FILE_CLOSE_ ( int filenum )
+{
+	if ( nslx_engine )
+		Nslx_Discard ( nslx_engine, filenum );
+
+	if ( close ( filenum ) < 0 )
+		return ( short ) errno;
+	return FEOK;
+}
+
+/***************************************************************
+*
+* NAME:                           FILE_GETINFO_
+*
+* FUNCTION:             Returns the error from the last completed
+*                       operation on filenum, or on any file when
+*                       filenum is -1.
+*
+* RETURNS:              short - 0
+***************************************************************/
+short FILE_GETINFO_ ( short filenum, short *lasterror )
+{
+	NSLX_ENGINE *e = Nslx_Engine ( );
+
+	if ( !lasterror )
+		return FEOK;
+
+	if ( !e )
+		*lasterror = ENOMEM;
+	else if ( filenum < 0 || filenum >= e->file_count )
+		*lasterror = e->last_error;
+	else
+		*lasterror = e->files[filenum].last_error;
+
+	return FEOK;
+}
+
+/***************************************************************
+*
+* NAME:                           Nslx_Wait
+*
+* FUNCTION:             Drives epoll until a finished op is waiting
+*                       on the done list, for any file (want < 0)
+*                       or for one file.
+*
+* NOTE:                 timelimit is in 0.01 second units;
+*                       -1 waits forever, 0 only checks.
+*
+* RETURNS:              int - FEOK, FENONEOUT, FETIMEDOUT or errno
+*                       (also left in last_error)
+***************************************************************/
+static int Nslx_Wait ( NSLX_ENGINE *e, int want, long timelimit )
+{
+	NSLX_OP		*op;
+	struct timespec	 now;
+	long long	 deadline_ms = 0;
+	long long	 remaining;
+	int		 polled = 0;
+	int		 outstanding;
+
+	if ( timelimit > 0 )
+	{
+		clock_gettime ( CLOCK_MONOTONIC, &now );
+		deadline_ms = ( long long ) now.tv_sec * 1000 + now.tv_nsec / 1000000 + ( long long ) timelimit * 10;
+	}
+
+	for ( ;; )
+	{
+		for ( op = e->done.head; op && want >= 0 && op->fd != want; op = op->next )
+			;
+		if ( op )
+			return FEOK;
+
+		outstanding = want < 0 ? e->outstanding
+					: ( want < e->file_count ? e->files[want].outstanding : 0 );
+		if ( !outstanding )
+		{
+			e->last_error = FENONEOUT;
+			return FENONEOUT;
+		}
+
+		if ( timelimit < 0 )
+			remaining = -1;
+		else if ( timelimit == 0 )
+			remaining = polled ? -2 : 0;
+		else
+		{
+			clock_gettime ( CLOCK_MONOTONIC, &now );
+			remaining = deadline_ms - ( ( long long ) now.tv_sec * 1000 + now.tv_nsec / 1000000 );
+			if ( remaining < 0 )
+				remaining = polled ? -2 : 0;
+		}
+
+		if ( remaining == -2 )
+		{
+			e->last_error = FETIMEDOUT;
+			if ( want >= 0 && want < e->file_count )
+				e->files[want].last_error = FETIMEDOUT;
+			return FETIMEDOUT;
+		}
+
+		if ( Nslx_Poll ( e, ( int ) remaining ) < 0 )
+		{
+			e->last_error = ( short ) errno;
+			return errno;
+		}
+		polled = 1;
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           AWAITIOX
+*
+* FUNCTION:             Completes one outstanding nowait operation,
+*                       on any file (*filenum == -1) or one file.
+*
+* NOTE:                 timelimit is in 0.01 second units;
+*                       -1 waits forever, 0 only checks.
+*                       Counts above 65535 are truncated; use
+*                       nslx_reap_completions for those.
+*
+* RETURNS:              _cc_status - CCE on success, CCL on error
+*                       (details from FILE_GETINFO_)
+***************************************************************/
+_cc_status AWAITIOX ( short *filenum, long *bufaddr, unsigned short *count, long *tag, long timelimit )
+{
+	NSLX_ENGINE	*e = Nslx_Engine ( );
+	NSLX_OP		*op;
+	int		 want = ( filenum && *filenum >= 0 ) ? *filenum : -1;
+
+	if ( !e )
+		return -1;
+
+	if ( Nslx_Wait ( e, want, timelimit ) != FEOK )
+		return -1;
+
+	op = Nslx_Take_Done ( e, want );
+	if ( filenum )
+		*filenum = ( short ) op->fd;
+	if ( bufaddr )
+		*bufaddr = ( long ) op->buffer;
+	if ( count )
+		*count = ( unsigned short ) op->count;
+	if ( tag )
+		*tag = op->tag;
+
+	Nslx_Op_Put ( e, op );
+	return e->last_error ? -1 : 0;
+}
+
+/***************************************************************
+*
+* NAME:                           CANCELREQ
+*
+* FUNCTION:             Withdraws the nowait operation submitted on
+*                       filenum under tag, as Guardian does: it
+*                       never completes. One that has finished but
+*                       not been reaped is dropped too.
+*
+* NOTE:                 An op already in the kernel on io_uring is
+*                       cancelled there and its result thrown away.
+*
+* RETURNS:              _cc_status - CCE, or CCL if no such op
+*                       is outstanding
+***************************************************************/
+_cc_status CANCELREQ ( int filenum, long tag )
+{
+	NSLX_ENGINE	*e = nslx_engine;
+	NSLX_FILE	*file;
+	NSLX_QUEUE	*queues[3];
+	NSLX_QUEUE	*queue;
+	NSLX_OP		*prev;
+	NSLX_OP		*op;
+	int		 q;
+
+	if ( !e || filenum < 0 || filenum >= e->file_count )
+		return -1;
+
+	file = &e->files[filenum];
+	queues[0] = &file->readq;
+	queues[1] = &file->writeq;
+	queues[2] = &e->done;
+	for ( q = 0; q < 3; q++ )
+	{
+		queue = queues[q];
+		for ( prev = 0, op = queue->head; op && ( op->fd != filenum || op->tag != tag ); op = op->next )
+			prev = op;
+		if ( !op )
+			continue;
+
+		if ( prev )
+			prev->next = op->next;
+		else
+			queue->head = op->next;
+		if ( queue->tail == op )
+			queue->tail = prev;
+		op->next = 0;
+		file->outstanding--;
+
+#ifdef NSUR_HAVE_IO_URING
+		/* the head of a queue is the one in flight */
+		if ( e->mode == TCP_ENGINE_IO_URING && q < 2 && !prev )
+		{
+			Nslx_Uring_Cancel ( e, op );
+			nsur_enter ( &e->ring, 0, 0 );
+
+			/* the next in line goes to the kernel now */
+			if ( queue->head )
+				Nslx_Uring_Start ( e, queue->head );
+			return 0;
+		}
+#endif
+
+		e->outstanding--;
+		Nslx_Op_Put ( e, op );
+
+		/* an edge may already have passed the op behind it */
+		if ( q < 2 && !prev )
+			Nslx_Run_Queue ( e, queue );
+		return 0;
+	}
+
+	return -1;
+}
+
+
+/***************************************************************************************
+*						LIBRARY EXTENSIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                       nslx_set_timing
+*
+* FUNCTION:             Stamps every nowait op with its submit time,
+*                       so nslx_reap_completions can report how long
+*                       it took (TCP_COMPLETION::usec).
+*
+* RETURNS:              nothing
+***************************************************************/
+void nslx_set_timing ( int on )
+{
+	nslx_timing = on ? 1 : 0;
+}
+
+/***************************************************************
+*
+* NAME:                       nslx_timeout_op
+*
+* FUNCTION:             Ends the outstanding op submitted on socket
+*                       under tag with error TCP_ETIMEDOUT (for timer
+*                       deadlines). An op already in the kernel on
+*                       io_uring is cancelled there, and completes
+*                       normally if the cancel comes too late.
+*
+* RETURNS:              int - 0, -1 if no such op is outstanding
+*                       (it may already be done)
+***************************************************************/
+int nslx_timeout_op ( int socket, long tag )
+{
+	NSLX_ENGINE	*e = nslx_engine;
+	NSLX_QUEUE	*queues[2];
+	NSLX_QUEUE	*queue;
+	NSLX_OP		*prev;
+	NSLX_OP		*op;
+	int		 q;
+
+	if ( !e || socket < 0 || socket >= e->file_count )
+		return -1;
+
+	queues[0] = &e->files[socket].readq;
+	queues[1] = &e->files[socket].writeq;
+	for ( q = 0; q < 2; q++ )
+	{
+		queue = queues[q];
+		for ( prev = 0, op = queue->head; op && op->tag != tag; op = op->next )
+			prev = op;
+		if ( !op )
+			continue;
+
+#ifdef NSUR_HAVE_IO_URING
+		/* the head of a queue is the one in flight */
+		if ( e->mode == TCP_ENGINE_IO_URING && !prev )
+		{
+			struct io_uring_sqe *sqe;
+
+			if ( op->timed_out )
+				return 0;
+			sqe = Nslx_Uring_Sqe ( e );
+			if ( !sqe )
+				return -1;
+			op->timed_out = 1;
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->addr = ( unsigned long long ) ( uintptr_t ) op;
+			sqe->user_data = 0;
+			return 0;
+		}
+#endif
+
+		if ( prev )
+			prev->next = op->next;
+		else
+			queue->head = op->next;
+		if ( queue->tail == op )
+			queue->tail = prev;
+
+		op->error = TCP_ETIMEDOUT;
+		Nslx_Complete ( e, op );
+		return 0;
+	}
+
+	return -1;
+}
+
+/***************************************************************
+*
+* NAME:                       nslx_thread_exit
+*
+* FUNCTION:             Tears down this thread's completion domain:
+*                       epoll set or ring, op slabs, fd table and
+*                       any accepted connection nobody collected.
+*
+* NOTE:                 Close the thread's sockets first; whatever
+*                       was still outstanding is dropped.
+*
+* RETURNS:              nothing
+***************************************************************/
+void nslx_thread_exit ( void )
+{
+	NSLX_ENGINE	*e = nslx_engine;
+	NSLX_ACCEPTED	*entry;
+	NSLX_OP		*slab;
+	NSLX_OP		*op;
+	int		 fd;
+	int		 i;
+
+	if ( !e )
+		return;
+
+#ifdef NSUR_HAVE_IO_URING
+	if ( e->mode == TCP_ENGINE_IO_URING )
+		nsur_teardown ( &e->ring );
+#endif
+	close ( e->epfd );
+
+	while ( ( entry = e->accepted ) != 0 )
+	{
+		e->accepted = entry->next;
+		close ( entry->fd );
+		free ( entry );
+	}
+	while ( ( entry = e->free_accepted ) != 0 )
+	{
+		e->free_accepted = entry->next;
+		free ( entry );
+	}
+
+	/* queued or unreaped ops may still own an iovec array */
+	for ( fd = 0; fd < e->file_count; fd++ )
+	{
+		while ( ( op = Nslx_Queue_Pop ( &e->files[fd].readq ) ) != 0 )
+			Nslx_Op_Put ( e, op );
+		while ( ( op = Nslx_Queue_Pop ( &e->files[fd].writeq ) ) != 0 )
+			Nslx_Op_Put ( e, op );
+	}
+	while ( ( op = Nslx_Queue_Pop ( &e->done ) ) != 0 )
+		Nslx_Op_Put ( e, op );
+
+	while ( ( slab = e->op_slabs ) != 0 )
+	{
+		/* accepts the ring still had (or was cancelling) keep their entry */
+		for ( i = 1; i <= NSLX_OP_SLAB; i++ )
+			free ( slab[i].accepted );
+
+		e->op_slabs = slab[0].next;
+		free ( slab );
+	}
+
+	free ( e->files );
+	free ( e );
+	nslx_engine = 0;
+}
+
+/***************************************************************
+*
+* NAME:                       nslx_select_engine
+*
+* FUNCTION:             Picks how this thread's nowait calls reach
+*                       the kernel: TCP_ENGINE_EPOLL or
+*                       TCP_ENGINE_IO_URING. TCP_ENGINE_DEFAULT
+*                       reads NSTCP_ENGINE from the environment
+*                       ("io_uring" or "epoll").
+*
+* NOTE:                 Falls back to epoll if the kernel (or the
+*                       build) lacks io_uring support. The engine
+*                       does not change while I/O is outstanding.
+*
+* RETURNS:              int - the engine now in effect
+***************************************************************/
+int nslx_select_engine ( int engine )
+{
+	NSLX_ENGINE	*e = Nslx_Engine ( );
+	char		*env;
+	int		 i;
+
+	if ( !e )
+		return TCP_ENGINE_EPOLL;
+
+	if ( engine == TCP_ENGINE_DEFAULT )
+	{
+		env = getenv ( "NSTCP_ENGINE" );
+		engine = ( env && !strcmp ( env, "io_uring" ) ) ? TCP_ENGINE_IO_URING : TCP_ENGINE_EPOLL;
+	}
+
+	if ( engine == e->mode || e->outstanding )
+		return e->mode;
+
+	if ( engine == TCP_ENGINE_IO_URING )
+	{
+#ifdef NSUR_HAVE_IO_URING
+		if ( !e->ring.sq_ring && nsur_setup ( &e->ring, NSLX_URING_ENTRIES ) != 0 )
+			return e->mode;
+		e->mode = TCP_ENGINE_IO_URING;
+#else
+		return e->mode;
+#endif
+	}
+	else
+		e->mode = TCP_ENGINE_EPOLL;
+
+	/* blocking mode expectations differ between the engines */
+	for ( i = 0; i < e->file_count; i++ )
+		e->files[i].prepared = 0;
+
+	return e->mode;
+}
+
+/***************************************************************
+*
+* NAME:                       nslx_reap_completions
+*
+* FUNCTION:             Batch form of AWAITIOX. Waits up to
+*                       timelimit for at least one completion,
+*                       then hands back as many as are ready (up
+*                       to max) from a single epoll pass.
+*
+* NOTE:                 Full-width fd and byte count, unlike
+*                       AWAITIOX.
+*
+* RETURNS:              int - completions stored, 0 if the time
+*                       limit passed, -1 when nothing is outstanding
+*                       or the wait failed (see FILE_GETINFO_(-1))
+***************************************************************/
+int nslx_reap_completions ( TCP_COMPLETION *completions, int max, long timelimit )
+{
+	NSLX_ENGINE	*e = Nslx_Engine ( );
+	NSLX_OP		*op;
+	long long	 now = -1;
+	int		 reaped = 0;
+	int		 rc;
+
+	if ( !e )
+		return -1;
+
+	rc = Nslx_Wait ( e, -1, timelimit );
+	if ( rc == FETIMEDOUT )
+		return 0;
+	if ( rc != FEOK )
+		return -1;
+
+	while ( reaped < max && ( op = Nslx_Take_Done ( e, -1 ) ) != 0 )
+	{
+		completions[reaped].sock = op->fd;
+		completions[reaped].tag = op->tag;
+		completions[reaped].count = op->count;
+		completions[reaped].error = op->error;
+		completions[reaped].buffer = op->buffer;
+		completions[reaped].length = op->length;
+		completions[reaped].op = nslx_op_kind[op->type];
+		completions[reaped].usec = -1;
+		if ( op->submitted >= 0 )
+		{
+			/* one clock read serves the whole batch */
+			if ( now < 0 )
+				now = tcp_clock_usec ( );
+			completions[reaped].usec = now - op->submitted;
+		}
+		reaped++;
+
+		Nslx_Op_Put ( e, op );
+	}
+
+	return reaped;
+}
+
+#ifdef __cplusplus
+}
+#endif
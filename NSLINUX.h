@@ -0,0 +1,128 @@
+/************************************************************************************
+*		FILE:		"nslinux.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Linux stand-ins for the Guardian socket and file-system
+*					calls used by nstcp.c (socket_nw, recv_nw, send_nw,
+*					accept_nw*, FILE_CLOSE_, AWAITIOX, ...). This lets the
+*					whole TCP function table build and run on stock Linux
+*					for profiling and capacity testing.
+*
+*		Notes:		The nowait contract is kept: every *_nw call returns
+*					right away and its completion (tag, byte count, error)
+*					is picked up later through AWAITIOX / FILE_GETINFO_.
+*					Underneath, sockets are non-blocking and readiness is
+*					driven by an edge-triggered epoll set.
+*
+*					Each thread owns its own completion domain, the same
+*					way each Guardian process owns its own AWAITIOX queue.
+*					A socket must be driven by the thread that submitted
+*					its nowait operations.
+*
+*					Guardian ints and longs are both 32 bits, so nstcp.c
+*					keeps socket address lengths in a long. The calls that
+*					write a length back take a long * for that reason.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.1.0	  10/17/26		Initial Release
+*		1.2.0	  10/17/26		nslx_reap_completions batch reaping
+*		1.3.0	  10/17/26		nslx_select_engine: epoll or io_uring (nsuring.c)
+*		1.6.0	  10/17/26		nslx_sendv_nw / nslx_recvv_nw
+*		1.9.0	  10/17/26		nslx_accepted_fd, nslx_thread_exit
+*		1.11.0	  10/17/26		nslx_set_timing
+*		1.12.0	  10/17/26		nslx_timeout_op
+*************************************************************************************/
+
+#ifndef _NSLINUXH_INCLUDE_
+#define _NSLINUXH_INCLUDE_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <net/if.h>
+
+
+/* Guardian condition code, as handed back by AWAITIOX */
+typedef short			_cc_status;
+
+#define _status_lt(cc)		( ( cc ) < 0 )
+#define _status_eq(cc)		( ( cc ) == 0 )
+#define _status_gt(cc)		( ( cc ) > 0 )
+
+/* Guardian file-system errors raised by the emulation itself.
+*  Socket failures are reported with their Linux errno value. */
+#define FEOK			0
+#define FENONEOUT		26		/* no outstanding operation to complete */
+#define FETIMEDOUT		40		/* AWAITIOX time limit expired */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************
+*		Guardian socket library (nowait)
+**********************************************************/
+int socket_set_inet_name ( char *name );
+int socket_nw ( int domain, int type, int protocol, int flags, int sync );
+int bind_nw ( int socket, struct sockaddr *address, int address_len, long tag );
+int connect_nw ( int socket, struct sockaddr *address, int address_len, long tag );
+int accept_nw ( int socket, struct sockaddr *address, long *address_len, long tag );
+int accept_nw1 ( int socket, struct sockaddr *address, long *address_len, long tag, short queue_length );
+int accept_nw2 ( int new_socket, struct sockaddr *address, long tag );
+int accept_nw3 ( int new_socket, struct sockaddr *address, struct sockaddr *me, long tag );
+int send_nw ( int socket, char *buffer, int length, int flags, long tag );
+int recv_nw ( int socket, char *buffer, int length, int flags, long tag );
+int shutdown_nw ( int socket, int how, long tag );
+int getsockname_nw ( int socket, struct sockaddr *address, long *address_len, long tag );
+
+/**********************************************************
+*		Guardian file system
+*
+*	filenum is an int for FILE_CLOSE_ and CANCELREQ so
+*	descriptors above 32767 survive. AWAITIOX keeps the
+*	Guardian short/ushort widths for source compatibility.
+**********************************************************/
+short FILE_CLOSE_ ( int filenum );
+short FILE_GETINFO_ ( short filenum, short *lasterror );
+_cc_status AWAITIOX ( short *filenum, long *bufaddr, unsigned short *count, long *tag, long timelimit );
+_cc_status CANCELREQ ( int filenum, long tag );
+
+/**********************************************************
+*		Library extensions (no Guardian equivalent)
+**********************************************************/
+struct tcp_completion;
+
+int nslx_select_engine ( int engine );
+int nslx_reap_completions ( struct tcp_completion *completions, int max, long timelimit );
+int nslx_sendv_nw ( int socket, struct iovec *iov, int iovcnt, int flags, long tag );
+int nslx_recvv_nw ( int socket, struct iovec *iov, int iovcnt, int flags, long tag );
+int nslx_accepted_fd ( struct sockaddr *address );
+void nslx_thread_exit ( void );
+void nslx_set_timing ( int on );
+int nslx_timeout_op ( int socket, long tag );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSLINUXH_INCLUDE_
@@ -0,0 +1,908 @@
+/************************************************************************************
+*		FILE:		"nsload.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Load generator: opens many client connections through
+*					the nowait calls (make_connect_nw, new_send_nw,
+*					new_recv_nw, reap_completions) and drives echo
+*					requests over them at a target rate, to find where
+*					the library stops scaling on one host.
+*
+*		Notes:		Linux only. Build and run:
+*
+*					gcc -O2 -o nsload NSLOAD.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./nsload [-c connections] [-w connects in flight]
+*					         [-m open|closed] [-r requests/sec] [-s seconds]
+*					         [-l bytes] [-T threads] [-S server shards]
+*					         [-b source addresses] [-a address] [-p port]
+*					         [-e epoll|io_uring] [-y spin usec]
+*
+*					Each client thread has its own TCP and engine and a
+*					share of the connections and of the rate. A request is
+*					-l bytes sent and the same bytes echoed back.
+*
+*					closed: every connection has at most one request out.
+*					With -r the requests are due on a fixed schedule, each
+*					connection in turn; without it a connection sends again
+*					as soon as its reply is in.
+*					open: requests are due on a fixed schedule whatever the
+*					replies do, and go out on any idle connection; -r is
+*					required.
+*
+*					Latency is measured from when a request was due, not
+*					from when it went out, so a stall that holds requests
+*					back shows up in the percentiles (no coordinated
+*					omission). Requests still waiting at the end are
+*					reported as backlog.
+*
+*					Without -p the requests go to an in-process sharded
+*					echo server. Past about 20000 connections to one
+*					loopback address the ephemeral ports run out, so the
+*					connects are striped over 127.0.0.2, 127.0.0.3, ...
+*					(-b, one address per 20000 by default).
+*
+*					-y has reap_completions spin up to that many
+*					microseconds before it blocks (TCP_SPIN_ADAPTIVE; see
+*					nsspin.h), in the in-process server too. The traffic
+*					line then reports the spin counters.
+*
+*					Results are JSON objects, one per line, on stdout: the
+*					connect phase, then the traffic phase.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.23.0	  10/17/26		Initial Release
+*		1.25.0	  10/17/26		-y adaptive spin wait
+*		1.25.1	  10/17/26		Echo server is tcp_loopback_start
+*************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "NSSHARD.h"
+#include "NSSTRIP.h"
+#include "NSSTATS.h"
+#include "NSSPIN.h"
+#include <sys/resource.h>
+#include <sched.h>
+
+/* bytes of receive buffer per server connection slot */
+#define LOAD_SLOT_BUFFER		4096
+#define LOAD_MAX_SIZE			LOAD_SLOT_BUFFER
+#define LOAD_MAX_THREADS		64
+
+/* connections per loopback source address when -b is not given */
+#define LOAD_PER_SOURCE			20000
+
+/* latency histogram: exact below LOAD_SUB_BUCKETS * 2 us, then
+*  LOAD_SUB_BUCKETS buckets per power of two (about 3% wide) */
+#define LOAD_SUB_BITS			5
+#define LOAD_SUB_BUCKETS		( 1 << LOAD_SUB_BITS )
+#define LOAD_BUCKETS			( 64 * LOAD_SUB_BUCKETS )
+
+/* what a completion was; the rest of the tag is the connection */
+#define LOAD_TAG_CONNECT		1
+#define LOAD_TAG_SEND			2
+#define LOAD_TAG_RECV			3
+#define LOAD_TAG(index, op)		( ( long ) ( index ) << 2 | ( op ) )
+#define LOAD_TAG_INDEX(tag)		( ( int ) ( ( tag ) >> 2 ) )
+#define LOAD_TAG_OP(tag)		( ( int ) ( ( tag ) & 3 ) )
+
+/* connection states */
+enum { LOAD_CONNECTING = 0, LOAD_IDLE, LOAD_BUSY, LOAD_DEAD };
+
+typedef struct load_options
+{
+	TCP_IPADDR			ipaddr;
+	TCP_PORT			port;
+	int				connections;
+	int				window;		/* connects in flight per thread */
+	int				open_loop;
+	double				rate;		/* requests/sec, 0 = as fast as replies */
+	double				seconds;
+	int				size;
+	int				threads;
+	int				shards;
+	int				sources;
+	int				engine;
+	long				spin;		/* usec, 0 = block at once */
+} LOAD_OPTIONS;
+
+typedef struct load_histogram
+{
+	long long			counts[LOAD_BUCKETS];
+	long long			total;
+	long long			max;
+} LOAD_HISTOGRAM;
+
+/***************************************************************
+*
+*	Name:		LOAD_CONN
+*	Type:		struct
+*	Purpose:	One client connection. due is when its current
+*				request was due (while connecting, when the
+*				connect was made). In a paced closed loop it
+*				gets requests position, position + open, ...;
+*				taken is how many of those it has sent and
+*				owed how many more have fallen due.
+*
+***************************************************************/
+typedef struct load_conn
+{
+	TCP_CONNECTION_INFO		*connection;
+	long long			due;
+	long				position;
+	long				taken;
+	long				owed;
+	int				sent;
+	int				got;
+	int				ops;		/* send / recv outstanding */
+	int				state;
+} LOAD_CONN;
+
+typedef struct load_worker
+{
+	LOAD_OPTIONS			*options;
+	pthread_barrier_t		*barrier;
+	pthread_t			thread;
+	int				index;
+	TCP				*tcp;
+	int				engine;		/* in use */
+	LOAD_CONN			*conns;
+	int				count;
+	int				*idle;		/* open loop: idle connections */
+	int				idle_top;
+	int				busy;
+	int				live;
+	char				*out;
+	char				*in;
+	double				rate;		/* this thread's share */
+
+	/* connect phase */
+	int				open;
+	int				failed;
+	double				connect_seconds;
+	LOAD_HISTOGRAM			connect_latency;
+
+	/* traffic phase */
+	double				seconds;
+	long long			requests;
+	long long			errors;
+	long long			backlog;	/* due but never sent */
+	LOAD_HISTOGRAM			latency;
+} LOAD_WORKER;
+
+
+/***************************************************************************************
+*						SERVER SIDE
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Load_Server_Start
+*
+* FUNCTION:             In-process echo server (tcp_loopback_start)
+*                       on a free port, with room in each shard for
+*                       all the connections (SO_REUSEPORT doesn't
+*                       spread them evenly).
+*
+* RETURNS:              int - 0, -1 on failure
+***************************************************************/
+static int Load_Server_Start ( TCP_LOOPBACK *load, LOAD_OPTIONS *options )
+{
+	memset ( load, 0, sizeof ( *load ) );
+	load->mode = TCP_LOOPBACK_ECHO;
+	load->slot = LOAD_SLOT_BUFFER;
+
+	load->config.shards = options->shards;
+	load->config.max_connections = options->connections + 64;
+	load->config.engine = options->engine;
+
+	return tcp_loopback_start ( load );
+}
+
+
+/***************************************************************************************
+*						LATENCY HISTOGRAM
+***************************************************************************************/
+
+static int Load_Bucket ( long long usec )
+{
+	int shift;
+
+	if ( usec < 0 )
+		usec = 0;
+	if ( usec < 2 * LOAD_SUB_BUCKETS )
+		return ( int ) usec;
+
+	shift = 63 - __builtin_clzll ( ( unsigned long long ) usec ) - LOAD_SUB_BITS;
+	return ( shift + 1 ) * LOAD_SUB_BUCKETS + ( int ) ( ( usec >> shift ) & ( LOAD_SUB_BUCKETS - 1 ) );
+}
+
+/* the highest value that lands in bucket */
+static long long Load_Bucket_Value ( int bucket )
+{
+	int shift = bucket / LOAD_SUB_BUCKETS - 1;
+
+	if ( bucket < 2 * LOAD_SUB_BUCKETS )
+		return bucket;
+
+	return ( ( long long ) ( LOAD_SUB_BUCKETS + bucket % LOAD_SUB_BUCKETS + 1 ) << shift ) - 1;
+}
+
+static void Load_Record ( LOAD_HISTOGRAM *histogram, long long usec )
+{
+	histogram->counts[Load_Bucket ( usec )]++;
+	histogram->total++;
+	if ( usec > histogram->max )
+		histogram->max = usec;
+}
+
+static void Load_Merge ( LOAD_HISTOGRAM *into, LOAD_HISTOGRAM *from )
+{
+	int i;
+
+	for ( i = 0; i < LOAD_BUCKETS; i++ )
+		into->counts[i] += from->counts[i];
+	into->total += from->total;
+	if ( from->max > into->max )
+		into->max = from->max;
+}
+
+static long long Load_Percentile ( LOAD_HISTOGRAM *histogram, double fraction )
+{
+	long long	rank = ( long long ) ( histogram->total * fraction );
+	long long	seen = 0;
+	int		i;
+
+	for ( i = 0; i < LOAD_BUCKETS; i++ )
+	{
+		seen += histogram->counts[i];
+		if ( seen > rank )
+			return Load_Bucket_Value ( i ) < histogram->max ? Load_Bucket_Value ( i ) : histogram->max;
+	}
+
+	return histogram->max;
+}
+
+/* the latency part of a result line */
+static void Load_Print_Latency ( LOAD_HISTOGRAM *histogram )
+{
+	if ( !histogram->total )
+		return;
+
+	printf ( ",\"p50_us\":%lld,\"p90_us\":%lld,\"p99_us\":%lld,\"p999_us\":%lld,\"max_us\":%lld"
+		   , Load_Percentile ( histogram, 0.50 )
+		   , Load_Percentile ( histogram, 0.90 )
+		   , Load_Percentile ( histogram, 0.99 )
+		   , Load_Percentile ( histogram, 0.999 )
+		   , histogram->max );
+}
+
+
+/***************************************************************************************
+*						CLIENT SIDE
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Load_Connect
+*
+* FUNCTION:             Starts connection index connecting.
+*
+* RETURNS:              int - 0, -1 when it couldn't be started
+***************************************************************/
+static int Load_Connect ( LOAD_WORKER *worker, int index )
+{
+	LOAD_CONN		*conn = &worker->conns[index];
+	TCP			*tcp = worker->tcp;
+	TCP_CONNECTION_INFO	*connection = tcp->get_conn_info ( );
+
+	conn->state = LOAD_DEAD;
+	if ( !connection )
+		return -1;
+
+	strcpy ( connection->ipaddr, worker->options->ipaddr );
+	connection->port = worker->options->port;
+	tcp->set_sockaddr ( connection, AF_INET );
+	tcp->set_addtionals ( connection, 0, 0, LOAD_TAG ( index, LOAD_TAG_CONNECT ), sizeof ( struct sockaddr_in ) );
+	if ( tcp->get_sock_nw ( connection, AF_INET, SOCK_STREAM, 0, 0 ) < 0
+	  || tcp->make_connect_nw ( connection ) < 0 )
+	{
+		tcp->close_sock ( connection );
+		tcp->clean_conn_info ( connection );
+		return -1;
+	}
+
+	conn->connection = connection;
+	conn->due = tcp_clock_usec ( );
+	conn->state = LOAD_CONNECTING;
+	return 0;
+}
+
+static void Load_Drop ( LOAD_WORKER *worker, LOAD_CONN *conn )
+{
+	worker->tcp->close_sock ( conn->connection );
+	worker->tcp->clean_conn_info ( conn->connection );
+	conn->connection = 0;
+	conn->state = LOAD_DEAD;
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Connect_All
+*
+* FUNCTION:             Opens the thread's connections, keeping at
+*                       most window connects in flight.
+*
+***************************************************************/
+static void Load_Connect_All ( LOAD_WORKER *worker )
+{
+	TCP_COMPLETION	 completions[TCP_COMPLETION_BATCH];
+	LOAD_CONN	*conn;
+	long long	 start = tcp_clock_usec ( );
+	int		 next = 0;
+	int		 flight = 0;
+	int		 on = 1;
+	int		 count;
+	int		 i;
+
+	while ( next < worker->count || flight > 0 )
+	{
+		while ( next < worker->count && flight < worker->options->window )
+		{
+			if ( Load_Connect ( worker, next++ ) < 0 )
+				worker->failed++;
+			else
+				flight++;
+		}
+		if ( !flight )
+			continue;
+
+		count = worker->tcp->reap_completions ( completions, TCP_COMPLETION_BATCH, 500 );
+		if ( count <= 0 )
+			break;
+		for ( i = 0; i < count; i++ )
+		{
+			conn = &worker->conns[LOAD_TAG_INDEX ( completions[i].tag )];
+			flight--;
+			if ( completions[i].error )
+			{
+				Load_Drop ( worker, conn );
+				worker->failed++;
+				continue;
+			}
+			setsockopt ( completions[i].sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+			Load_Record ( &worker->connect_latency, tcp_clock_usec ( ) - conn->due );
+			conn->state = LOAD_IDLE;
+			worker->open++;
+		}
+	}
+	worker->connect_seconds = ( tcp_clock_usec ( ) - start ) / 1e6;
+
+	/* connects that never finished */
+	for ( i = 0; i < worker->count; i++ )
+		if ( worker->conns[i].state == LOAD_CONNECTING )
+		{
+			Load_Drop ( worker, &worker->conns[i] );
+			worker->failed++;
+		}
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Request
+*
+* FUNCTION:             Sends a request on an idle connection and
+*                       reads for its echo. due is when it was due.
+*
+***************************************************************/
+static void Load_Request ( LOAD_WORKER *worker, int index, long long due )
+{
+	LOAD_CONN		*conn = &worker->conns[index];
+	TCP_CONNECTION_INFO	*connection = conn->connection;
+	int			 size = worker->options->size;
+
+	conn->due = due;
+	conn->sent = 0;
+	conn->got = 0;
+	conn->ops = 2;
+	conn->state = LOAD_BUSY;
+	worker->busy++;
+
+	connection->tag = LOAD_TAG ( index, LOAD_TAG_SEND );
+	if ( worker->tcp->new_send_nw ( connection, worker->out, size ) < 0 )
+		conn->ops--;
+	connection->tag = LOAD_TAG ( index, LOAD_TAG_RECV );
+	if ( worker->tcp->new_recv_nw ( connection, worker->in + ( size_t ) index * size, size ) < 0 )
+		conn->ops--;
+
+	if ( conn->ops < 2 )
+	{
+		/* dropped once the half still out (if any) completes */
+		worker->errors++;
+		worker->busy--;
+		conn->state = LOAD_DEAD;
+		if ( !conn->ops )
+			Load_Drop ( worker, conn );
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Complete
+*
+* FUNCTION:             Carries a request on: finishes a short send
+*                       or read, and once both halves are done
+*                       records the latency. A connection that fails
+*                       is closed and not used again.
+*
+* RETURNS:              int - 1 when the connection fell idle
+***************************************************************/
+static int Load_Complete ( LOAD_WORKER *worker, TCP_COMPLETION *completion )
+{
+	LOAD_CONN		*conn = &worker->conns[LOAD_TAG_INDEX ( completion->tag )];
+	TCP_CONNECTION_INFO	*connection = conn->connection;
+	int			 size = worker->options->size;
+	int			 failed;
+
+	conn->ops--;
+	failed = completion->error || ( LOAD_TAG_OP ( completion->tag ) == LOAD_TAG_RECV && completion->count <= 0 );
+
+	if ( !failed && conn->state == LOAD_BUSY )
+	{
+		connection->tag = completion->tag;
+		if ( LOAD_TAG_OP ( completion->tag ) == LOAD_TAG_SEND )
+		{
+			conn->sent += ( int ) completion->count;
+			if ( conn->sent < size )
+			{
+				failed = worker->tcp->new_send_nw ( connection, worker->out + conn->sent, size - conn->sent ) < 0;
+				conn->ops += !failed;
+			}
+		}
+		else
+		{
+			conn->got += ( int ) completion->count;
+			if ( conn->got < size )
+			{
+				failed = worker->tcp->new_recv_nw ( connection, completion->buffer + completion->count, size - conn->got ) < 0;
+				conn->ops += !failed;
+			}
+		}
+	}
+
+	if ( failed && conn->state == LOAD_BUSY )
+	{
+		worker->errors++;
+		worker->busy--;
+		conn->state = LOAD_DEAD;
+	}
+	if ( conn->state == LOAD_DEAD )
+	{
+		if ( !conn->ops )
+			Load_Drop ( worker, conn );
+		return 0;
+	}
+	if ( conn->ops )
+		return 0;
+
+	Load_Record ( &worker->latency, tcp_clock_usec ( ) - conn->due );
+	worker->requests++;
+	worker->busy--;
+	conn->state = LOAD_IDLE;
+	return 1;
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Wait
+*
+* FUNCTION:             Reaps what is done, waiting no later than
+*                       until. The wait can only be cut in 0.01 sec
+*                       steps, so the last of it is spun through,
+*                       yielding the CPU on each empty pass (a server
+*                       or the kernel's io_uring work may need it).
+*
+* RETURNS:              int - as reap_completions
+***************************************************************/
+static int Load_Wait ( LOAD_WORKER *worker, TCP_COMPLETION *completions, long long until )
+{
+	long long	gap = until - tcp_clock_usec ( );
+	int		count;
+
+	count = worker->tcp->reap_completions ( completions, TCP_COMPLETION_BATCH, gap > 20000 ? ( long ) ( gap / 10000 ) - 1 : 0 );
+	if ( count == 0 && gap > 0 )
+		sched_yield ( );
+	else if ( count < 0 && gap > 1000 )
+		usleep ( ( useconds_t ) ( gap > 20000 ? 10000 : gap - 1000 ) );
+
+	return count;
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Closed_Next
+*
+* FUNCTION:             Closed loop: sends a connection's next
+*                       request if one is due (paced) or at once
+*                       (unpaced).
+*
+***************************************************************/
+static void Load_Closed_Next ( LOAD_WORKER *worker, int index, long long start, double interval, long long now )
+{
+	LOAD_CONN *conn = &worker->conns[index];
+
+	if ( conn->state != LOAD_IDLE )
+		return;
+
+	if ( interval <= 0 )
+		Load_Request ( worker, index, now );
+	else if ( conn->owed )
+	{
+		conn->owed--;
+		Load_Request ( worker, index, start + ( long long ) ( ( conn->position + conn->taken * ( long ) worker->live ) * interval ) );
+		conn->taken++;
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Traffic
+*
+* FUNCTION:             Drives requests for options->seconds, then
+*                       waits (up to a second) for those still out.
+*
+*                       With a rate, request k of the thread is due
+*                       at start + k / rate. The open loop gives it
+*                       to whichever connection is idle; the closed
+*                       loop to connection k % live, which sends it
+*                       once its previous one is back. Unpaced, each
+*                       connection sends again as soon as it can.
+*
+***************************************************************/
+static void Load_Traffic ( LOAD_WORKER *worker )
+{
+	TCP_COMPLETION	 completions[TCP_COMPLETION_BATCH];
+	LOAD_OPTIONS	*options = worker->options;
+	int		*live;		/* the connections open at the start */
+	long long	 start;
+	long long	 end;
+	long long	 now;
+	long long	 next_due;
+	double		 interval = worker->rate > 0 ? 1e6 / worker->rate : 0;
+	long		 scheduled = 0;	/* requests fallen due */
+	long		 issued = 0;	/* open loop: of those, sent */
+	int		 count;
+	int		 index;
+	int		 i;
+
+	live = ( int * ) malloc ( ( worker->count + 1 ) * sizeof ( int ) );
+	worker->live = 0;
+	for ( i = 0; i < worker->count; i++ )
+		if ( worker->conns[i].state == LOAD_IDLE )
+		{
+			worker->conns[i].position = worker->live;
+			live[worker->live++] = i;
+			worker->idle[worker->idle_top++] = i;
+		}
+
+	start = tcp_clock_usec ( );
+	end = start + ( long long ) ( options->seconds * 1e6 );
+	if ( !options->open_loop && interval <= 0 )
+		for ( i = 0; i < worker->live; i++ )
+			Load_Closed_Next ( worker, live[i], start, interval, start );
+
+	for ( now = start; now < end && worker->live; now = tcp_clock_usec ( ) )
+	{
+		next_due = end;
+		if ( interval > 0 )
+		{
+			for ( ; start + ( long long ) ( scheduled * interval ) <= now; scheduled++ )
+				if ( !options->open_loop )
+				{
+					index = live[scheduled % worker->live];
+					worker->conns[index].owed++;
+					Load_Closed_Next ( worker, index, start, interval, now );
+				}
+			next_due = start + ( long long ) ( scheduled * interval );
+		}
+
+		for ( ; options->open_loop && issued < scheduled && worker->idle_top > 0; issued++ )
+			Load_Request ( worker, worker->idle[--worker->idle_top], start + ( long long ) ( issued * interval ) );
+
+		count = Load_Wait ( worker, completions, next_due );
+		for ( i = 0; i < count; i++ )
+		{
+			if ( !Load_Complete ( worker, &completions[i] ) )
+				continue;
+			index = LOAD_TAG_INDEX ( completions[i].tag );
+			if ( options->open_loop )
+				worker->idle[worker->idle_top++] = index;
+			else if ( tcp_clock_usec ( ) < end )
+				Load_Closed_Next ( worker, index, start, interval, tcp_clock_usec ( ) );
+		}
+	}
+	worker->seconds = ( tcp_clock_usec ( ) - start ) / 1e6;
+
+	worker->backlog = scheduled - issued;
+	if ( !options->open_loop )
+		for ( i = 0, worker->backlog = 0; i < worker->live; i++ )
+			worker->backlog += worker->conns[live[i]].owed;
+
+	/* the last replies */
+	end = tcp_clock_usec ( ) + 1000000;
+	while ( worker->busy > 0 && tcp_clock_usec ( ) < end )
+	{
+		count = worker->tcp->reap_completions ( completions, TCP_COMPLETION_BATCH, 10 );
+		for ( i = 0; i < count; i++ )
+			Load_Complete ( worker, &completions[i] );
+		if ( count < 0 )
+			break;
+	}
+	free ( live );
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Worker
+*
+* FUNCTION:             A client thread: connects, waits for the
+*                       others, runs the traffic, closes up.
+*
+***************************************************************/
+static void *Load_Worker ( void *argument )
+{
+	LOAD_WORKER	*worker = ( LOAD_WORKER * ) argument;
+	int		 size = worker->options->size;
+	int		 i;
+
+	worker->tcp = intialize_tcp_engine ( worker->options->engine );
+	worker->conns = ( LOAD_CONN * ) calloc ( worker->count, sizeof ( LOAD_CONN ) );
+	worker->idle = ( int * ) malloc ( ( worker->count + 1 ) * sizeof ( int ) );
+	worker->out = ( char * ) malloc ( size );
+	worker->in = ( char * ) malloc ( ( size_t ) worker->count * size );
+	if ( worker->tcp && worker->conns && worker->idle && worker->out && worker->in )
+	{
+		worker->engine = worker->tcp->engine;
+		memset ( worker->out, 'l', size );
+		Load_Connect_All ( worker );
+	}
+	else
+		worker->failed = worker->count;
+
+	pthread_barrier_wait ( worker->barrier );
+	if ( worker->open )
+		Load_Traffic ( worker );
+
+	for ( i = 0; worker->conns && i < worker->count; i++ )
+		if ( worker->conns[i].connection )
+			Load_Drop ( worker, &worker->conns[i] );
+	release_tcp ( worker->tcp );
+	worker->tcp = 0;
+	tcp_thread_exit ( );
+	free ( worker->in );
+	free ( worker->out );
+	free ( worker->idle );
+	free ( worker->conns );
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Report
+*
+* FUNCTION:             Adds up the threads and prints the connect
+*                       and traffic result lines.
+*
+***************************************************************/
+static void Load_Report ( LOAD_WORKER *workers, LOAD_OPTIONS *options )
+{
+	LOAD_HISTOGRAM	*connect_latency = ( LOAD_HISTOGRAM * ) calloc ( 1, sizeof ( LOAD_HISTOGRAM ) );
+	LOAD_HISTOGRAM	*latency = ( LOAD_HISTOGRAM * ) calloc ( 1, sizeof ( LOAD_HISTOGRAM ) );
+	TCP_STATS	 stats;
+	long long	 requests = 0;
+	long long	 errors = 0;
+	long long	 backlog = 0;
+	double		 connect_seconds = 0;
+	double		 seconds = 0;
+	long		 open = 0;
+	long		 failed = 0;
+	int		 i;
+
+	if ( !connect_latency || !latency )
+		return;
+
+	for ( i = 0; i < options->threads; i++ )
+	{
+		open += workers[i].open;
+		failed += workers[i].failed;
+		requests += workers[i].requests;
+		errors += workers[i].errors;
+		backlog += workers[i].backlog;
+		if ( workers[i].connect_seconds > connect_seconds )
+			connect_seconds = workers[i].connect_seconds;
+		if ( workers[i].seconds > seconds )
+			seconds = workers[i].seconds;
+		Load_Merge ( connect_latency, &workers[i].connect_latency );
+		Load_Merge ( latency, &workers[i].latency );
+	}
+
+	printf ( "{\"load\":\"connect\",\"engine\":%d,\"threads\":%d,\"connections\":%d,\"open\":%ld,\"failed\":%ld"
+			 ",\"seconds\":%.3f,\"connects_per_sec\":%.0f"
+		   , workers[0].engine, options->threads, options->connections, open, failed
+		   , connect_seconds, connect_seconds > 0 ? open / connect_seconds : 0 );
+	Load_Print_Latency ( connect_latency );
+	printf ( "}\n" );
+
+	printf ( "{\"load\":\"traffic\",\"mode\":\"%s\",\"threads\":%d,\"connections\":%ld,\"size\":%d,\"target_per_sec\":%.0f"
+			 ",\"seconds\":%.3f,\"requests\":%lld,\"requests_per_sec\":%.0f,\"mb_per_sec\":%.2f,\"errors\":%lld,\"backlog\":%lld"
+		   , options->open_loop ? "open" : "closed", options->threads, open, options->size, options->rate
+		   , seconds, requests, seconds > 0 ? requests / seconds : 0
+		   , seconds > 0 ? 2.0 * requests * options->size / seconds / 1e6 : 0
+		   , errors, backlog );
+	Load_Print_Latency ( latency );
+	if ( options->spin )
+	{
+		tcp_stats_snapshot ( &stats );
+		printf ( ",\"spin_waits\":%ld,\"spin_hits\":%ld,\"spin_skips\":%ld,\"spin_budget_us\":%.1f,\"spun_us\":%.1f"
+			   , stats.spin_waits, stats.spin_hits, stats.spin_skips
+			   , stats.spin_waits ? ( double ) stats.spin_budget / stats.spin_waits : 0
+			   , stats.spin_waits ? ( double ) stats.spin_usec / stats.spin_waits : 0 );
+	}
+	printf ( "}\n" );
+	fflush ( stdout );
+
+	free ( connect_latency );
+	free ( latency );
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Sources
+*
+* FUNCTION:             Stripes the connects over count loopback
+*                       source addresses, 127.0.0.2 on.
+*
+* RETURNS:              int - 0, -1 on failure
+***************************************************************/
+static int Load_Sources ( int count )
+{
+	char	 names[TCP_STRIPE_MAX][16];
+	char	*pointers[TCP_STRIPE_MAX];
+	int	 i;
+
+	for ( i = 0; i < count; i++ )
+	{
+		snprintf ( names[i], sizeof ( names[i] ), "127.0.0.%d", i + 2 );
+		pointers[i] = names[i];
+	}
+
+	return stripe_set ( pointers, count, TCP_STRIPE_LEAST_LOADED );
+}
+
+/***************************************************************
+*
+* NAME:                           Load_Usage
+*
+***************************************************************/
+static void Load_Usage ( const char *name )
+{
+	fprintf ( stderr, "usage: %s [-c connections] [-w connects in flight] [-m open|closed]\n"
+					  "          [-r requests/sec] [-s seconds] [-l bytes] [-T threads] [-S shards]\n"
+					  "          [-b source addresses] [-a address] [-p port] [-e epoll|io_uring]\n"
+					  "          [-y spin usec]\n", name );
+	exit ( 2 );
+}
+
+int main ( int argc, char **argv )
+{
+	LOAD_OPTIONS		 options;
+	TCP_LOOPBACK		 load;
+	LOAD_WORKER		*workers;
+	pthread_barrier_t	 barrier;
+	struct rlimit		 limit;
+	int			 opt;
+	int			 i;
+
+	memset ( &options, 0, sizeof ( options ) );
+	memset ( &load, 0, sizeof ( load ) );
+	strcpy ( options.ipaddr, "127.0.0.1" );
+	options.connections = 10000;
+	options.window = 1000;
+	options.seconds = 5.0;
+	options.size = 64;
+	options.threads = 1;
+	options.shards = 1;
+	options.sources = -1;
+	options.engine = TCP_ENGINE_DEFAULT;
+
+	while ( ( opt = getopt ( argc, argv, "c:w:m:r:s:l:T:S:b:a:p:e:y:h" ) ) != -1 )
+	{
+		switch ( opt )
+		{
+		case 'c': options.connections = atoi ( optarg ); break;
+		case 'w': options.window = atoi ( optarg ); break;
+		case 'm': options.open_loop = !strcmp ( optarg, "open" ); break;
+		case 'r': options.rate = atof ( optarg ); break;
+		case 's': options.seconds = atof ( optarg ); break;
+		case 'l': options.size = atoi ( optarg ); break;
+		case 'T': options.threads = atoi ( optarg ); break;
+		case 'S': options.shards = atoi ( optarg ); break;
+		case 'b': options.sources = atoi ( optarg ); break;
+		case 'a': snprintf ( options.ipaddr, sizeof ( options.ipaddr ), "%s", optarg ); break;
+		case 'p': options.port = ( TCP_PORT ) atoi ( optarg ); break;
+		case 'e': options.engine = !strcmp ( optarg, "io_uring" ) ? TCP_ENGINE_IO_URING : TCP_ENGINE_EPOLL; break;
+		case 'y': options.spin = atol ( optarg ); break;
+		default: Load_Usage ( argv[0] );
+		}
+	}
+	if ( options.connections <= 0 || options.window <= 0 || options.rate < 0 || options.seconds <= 0
+	  || options.size <= 0 || options.size > LOAD_MAX_SIZE || options.shards < 0
+	  || options.threads <= 0 || options.threads > LOAD_MAX_THREADS || options.threads > options.connections
+	  || options.sources > TCP_STRIPE_MAX || ( options.open_loop && options.rate <= 0 ) )
+		Load_Usage ( argv[0] );
+
+	if ( options.spin && spin_set ( TCP_SPIN_ADAPTIVE, options.spin ) < 0 )
+		Load_Usage ( argv[0] );
+
+	if ( options.sources < 0 )
+		options.sources = !strncmp ( options.ipaddr, "127.", 4 ) && options.connections > LOAD_PER_SOURCE
+						? ( options.connections + LOAD_PER_SOURCE - 1 ) / LOAD_PER_SOURCE : 0;
+	if ( options.sources > TCP_STRIPE_MAX )
+		options.sources = TCP_STRIPE_MAX;
+	if ( options.sources && Load_Sources ( options.sources ) < 0 )
+		Load_Usage ( argv[0] );
+
+	/* both ends of every connection may live in this process */
+	if ( getrlimit ( RLIMIT_NOFILE, &limit ) == 0 )
+	{
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit ( RLIMIT_NOFILE, &limit );
+		if ( limit.rlim_cur < ( rlim_t ) options.connections * ( options.port ? 1 : 2 ) + 64 )
+			fprintf ( stderr, "load: only %ld files may be open; raise the hard limit\n", ( long ) limit.rlim_cur );
+	}
+
+	if ( !options.port )
+	{
+		if ( Load_Server_Start ( &load, &options ) < 0 )
+		{
+			fprintf ( stderr, "load: server didn't start\n" );
+			return 1;
+		}
+		options.port = load.config.port;
+	}
+
+	workers = ( LOAD_WORKER * ) calloc ( options.threads, sizeof ( LOAD_WORKER ) );
+	if ( !workers )
+		return 1;
+	pthread_barrier_init ( &barrier, 0, options.threads );
+	for ( i = 0; i < options.threads; i++ )
+	{
+		workers[i].options = &options;
+		workers[i].barrier = &barrier;
+		workers[i].index = i;
+		workers[i].count = options.connections / options.threads + ( i < options.connections % options.threads );
+		workers[i].rate = options.rate / options.threads;
+		pthread_create ( &workers[i].thread, 0, Load_Worker, &workers[i] );
+	}
+	for ( i = 0; i < options.threads; i++ )
+		pthread_join ( workers[i].thread, 0 );
+	fprintf ( stderr, "load: done\n" );
+
+	Load_Report ( workers, &options );
+
+	pthread_barrier_destroy ( &barrier );
+	tcp_loopback_stop ( &load );
+	free ( workers );
+	tcp_thread_exit ( );
+	return 0;
+}
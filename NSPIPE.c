@@ -0,0 +1,446 @@
+/************************************************************************************
+*		FILE:		"nspipe.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Pipelined requests with correlation IDs. See nspipe.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.18.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Coalesced requests flushed before waiting
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nspipeh"
+#include "=nsframeh"
+#include "=nscorkh"
+#include "=nsstatsh"
+#else
+#include "NSPIPE.h"
+#include "NSFRAME.h"
+#include "NSCORK.h"
+#include "NSSTATS.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Pipe_Put_Id
+*
+* FUNCTION:             Writes id into id_width bytes at field, in
+*                       the framer's byte order.
+*
+***************************************************************/
+static void Pipe_Put_Id ( TCP_CONNECTION_INFO *connection, char *field, unsigned long id )
+{
+	int width = connection->pipeline->id_width;
+	int i;
+
+	for ( i = 0; i < width; i++ )
+	{
+		if ( connection->framer->flags & TCP_FRAME_LITTLE_ENDIAN )
+			field[i] = ( char ) ( id >> ( 8 * i ) );
+		else
+			field[i] = ( char ) ( id >> ( 8 * ( width - 1 - i ) ) );
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           Pipe_Get_Id
+*
+* FUNCTION:             Reads the id_width byte ID at field.
+*
+* RETURNS:                         unsigned long
+***************************************************************/
+static unsigned long Pipe_Get_Id ( TCP_CONNECTION_INFO *connection, char *field )
+{
+	unsigned char	*p = ( unsigned char * ) field;
+	unsigned long	 id = 0;
+	int		 width = connection->pipeline->id_width;
+	int		 i;
+
+	if ( connection->framer->flags & TCP_FRAME_LITTLE_ENDIAN )
+		for ( i = width - 1; i >= 0; i-- )
+			id = ( id << 8 ) | p[i];
+	else
+		for ( i = 0; i < width; i++ )
+			id = ( id << 8 ) | p[i];
+
+	return id;
+}
+
+/***************************************************************
+*
+* NAME:                           Pipe_Write
+*
+* FUNCTION:             Sends prefix and body, all of both. With a
+*                       coalescing buffer on the connection they go
+*                       through it, so back to back requests share
+*                       writes; otherwise as one gather send.
+*
+* RETURNS:              int - 0, or -1 on error
+***************************************************************/
+static int Pipe_Write ( TCP_CONNECTION_INFO *connection, char *prefix, int width, char *body, long length )
+{
+	int		status;
+#ifdef __TANDEM
+	char		*part;
+	long		 left;
+	int		 i;
+#else
+	TCP_IOVEC	 iov[2];
+	struct msghdr	 msg;
+	long		 left = width + length;
+#endif
+
+	if ( connection->coalesce )
+	{
+		if ( coalesce_send ( connection, prefix, width ) < 0
+		  || coalesce_send ( connection, body, length ) < 0 )
+			return -1;
+		return 0;
+	}
+
+#ifdef __TANDEM
+	for ( i = 0; i < 2; i++ )
+	{
+		part = i ? body : prefix;
+		for ( left = i ? length : width; left > 0; left -= status, part += status )
+		{
+			status = send ( *connection->sock, part, ( int ) left, connection->flags );
+			TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, left, status );
+			if ( status < 0 )
+				return -1;
+		}
+	}
+	return 0;
+#else
+	iov[0].iov_base = prefix;
+	iov[0].iov_len = width;
+	iov[1].iov_base = body;
+	iov[1].iov_len = length;
+	memset ( &msg, 0, sizeof ( msg ) );
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	while ( msg.msg_iovlen )
+	{
+		status = ( int ) sendmsg ( *connection->sock, &msg, connection->flags );
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, left, status );
+		if ( status < 0 )
+		{
+			if ( errno == EINTR )
+				continue;
+			return -1;
+		}
+		left -= status;
+
+		while ( msg.msg_iovlen && ( size_t ) status >= msg.msg_iov->iov_len )
+		{
+			status -= ( int ) msg.msg_iov->iov_len;
+			msg.msg_iov++;
+			msg.msg_iovlen--;
+		}
+		if ( msg.msg_iovlen )
+		{
+			msg.msg_iov->iov_base = ( char * ) msg.msg_iov->iov_base + status;
+			msg.msg_iov->iov_len -= status;
+		}
+	}
+	return 0;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           Pipe_Flush
+*
+* FUNCTION:             Sends the requests still in the connection's
+*                       coalescing buffer, so no one waits for the
+*                       responses to requests the server never got.
+*                       A non-blocking socket that fills keeps the
+*                       rest for the next flush.
+*
+* RETURNS:              int - 0, or -1 on a send error
+***************************************************************/
+static int Pipe_Flush ( TCP_CONNECTION_INFO *connection )
+{
+	if ( !connection->coalesce )
+		return 0;
+
+	if ( coalesce_flush ( connection ) < 0 && errno != EAGAIN && errno != EWOULDBLOCK )
+		return -1;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           pipe_attach
+*
+* FUNCTION:             Puts a connection in pipelined mode: at most
+*                       window requests in flight, the correlation
+*                       ID id_width bytes (1 up to a long) at
+*                       id_offset in every request and response.
+*
+* NOTE:                 Attach the framer (set_framer) first.
+*
+* RETURNS:              int - 0, or -1 on bad arguments / no memory
+***************************************************************/
+int pipe_attach ( TCP_CONNECTION_INFO *connection, int window, long id_offset, int id_width )
+{
+	TCP_PIPELINE	*p;
+	unsigned long	 size = 1;
+	unsigned long	 limit = 0;
+
+	if ( !connection->framer || window <= 0 || id_offset < 0
+	  || id_width <= 0 || id_width > ( int ) sizeof ( unsigned long ) )
+		return -1;
+
+	if ( id_width < ( int ) sizeof ( unsigned long ) )
+	{
+		limit = 1UL << ( 8 * id_width );
+		if ( ( unsigned long ) window > limit )
+			return -1;
+	}
+	while ( size < ( unsigned long ) window )
+		size <<= 1;
+
+	p = ( TCP_PIPELINE * ) calloc ( 1, sizeof ( TCP_PIPELINE ) );
+	if ( !p )
+		return -1;
+	p->slots = ( TCP_PIPE_SLOT * ) calloc ( size, sizeof ( TCP_PIPE_SLOT ) );
+	if ( !p->slots )
+	{
+		free ( p );
+		return -1;
+	}
+
+	p->mask = size - 1;
+	p->id_limit = limit;
+	p->window = window;
+	p->id_offset = id_offset;
+	p->id_width = id_width;
+
+	pipe_detach ( connection );
+	connection->pipeline = p;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           pipe_detach
+*
+* FUNCTION:             Frees a connection's pipeline. Requests in
+*                       flight are forgotten, so pipe_fail first
+*                       if anyone is waiting. Called by
+*                       clean_conn_info.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void pipe_detach ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_PIPELINE *p = connection->pipeline;
+
+	if ( !p )
+		return;
+
+	free ( p->slots );
+	free ( p );
+	connection->pipeline = 0;
+}
+
+/***************************************************************
+*
+* NAME:                           pipe_send
+*
+* FUNCTION:             Sends one request without waiting for its
+*                       response, which goes to on_response with
+*                       context once pipe_dispatch reads it. The
+*                       request's correlation ID is written into
+*                       body at id_offset first.
+*
+* NOTE:                 Before TCP_PIPE_FULL comes back, requests
+*                       held in a coalescing buffer are flushed.
+*
+* RETURNS:              long - the correlation ID; TCP_PIPE_FULL
+*                       when window requests are in flight; -1 on
+*                       bad arguments or a send error (the stream
+*                       is then broken: pipe_fail and close)
+***************************************************************/
+long pipe_send ( TCP_CONNECTION_INFO *connection, char *body, long length
+			   , TCP_PIPE_RESPONSE on_response, void *context )
+{
+	TCP_PIPELINE	*p = connection->pipeline;
+	TCP_PIPE_SLOT	*slot;
+	char		 prefix[8];
+	unsigned long	 id;
+	int		 width;
+
+	if ( !p || !connection->framer || !on_response || length < p->id_offset + p->id_width )
+		return -1;
+	if ( p->inflight >= p->window )
+		return Pipe_Flush ( connection ) < 0 ? -1 : TCP_PIPE_FULL;
+
+	id = p->next_id;
+	slot = &p->slots[id & p->mask];
+	if ( slot->busy )
+		return Pipe_Flush ( connection ) < 0 ? -1 : TCP_PIPE_FULL;
+
+	width = frame_prefix ( connection, prefix, length );
+	if ( width < 0 )
+		return -1;
+	Pipe_Put_Id ( connection, body + p->id_offset, id );
+	if ( Pipe_Write ( connection, prefix, width, body, length ) < 0 )
+		return -1;
+
+	slot->id = id;
+	slot->on_response = on_response;
+	slot->context = context;
+	slot->busy = 1;
+	p->inflight++;
+	p->next_id = p->id_limit ? ( id + 1 ) % p->id_limit : id + 1;
+
+	return ( long ) id;
+}
+
+/***************************************************************
+*
+* NAME:                           pipe_dispatch
+*
+* FUNCTION:             Hands every complete response received so
+*                       far to its request's callback. A callback
+*                       may send the next request straight away.
+*
+* NOTE:                 Requests in a coalescing buffer are flushed
+*                       before and after, so the next frame_recv_nw
+*                       waits only on requests the server has. Flush
+*                       once before the first frame_recv_nw.
+*
+* RETURNS:              int - responses dispatched, -1 on a bad
+*                       frame or a send error (close the connection)
+***************************************************************/
+int pipe_dispatch ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_PIPELINE		*p = connection->pipeline;
+	TCP_PIPE_SLOT		*slot;
+	TCP_PIPE_RESPONSE	 on_response;
+	void			*context;
+	char			*frame;
+	long			 length;
+	unsigned long		 id;
+	int			 dispatched = 0;
+	int			 status;
+
+	if ( !p || Pipe_Flush ( connection ) < 0 )
+		return -1;
+
+	while ( ( status = frame_next ( connection, &frame, &length ) ) > 0 )
+	{
+		if ( length < p->id_offset + p->id_width )
+		{
+			p->stray++;
+			continue;
+		}
+
+		id = Pipe_Get_Id ( connection, frame + p->id_offset );
+		slot = &p->slots[id & p->mask];
+		if ( !slot->busy || slot->id != id )
+		{
+			p->stray++;
+			continue;
+		}
+
+		/* free the slot first, the callback may reuse it */
+		on_response = slot->on_response;
+		context = slot->context;
+		slot->busy = 0;
+		p->inflight--;
+		on_response ( connection, context, frame, length, 0 );
+		dispatched++;
+	}
+
+	if ( status < 0 || Pipe_Flush ( connection ) < 0 )
+		return -1;
+	return dispatched;
+}
+
+/***************************************************************
+*
+* NAME:                           pipe_recv
+*
+* FUNCTION:             One frame_recv, then pipe_dispatch: the
+*                       blocking way to wait for responses. Requests
+*                       in a coalescing buffer are flushed first.
+*
+* RETURNS:              int - responses dispatched, -1 when the
+*                       peer closed or on error
+***************************************************************/
+int pipe_recv ( TCP_CONNECTION_INFO *connection )
+{
+	if ( Pipe_Flush ( connection ) < 0 || frame_recv ( connection ) <= 0 )
+		return -1;
+
+	return pipe_dispatch ( connection );
+}
+
+/***************************************************************
+*
+* NAME:                           pipe_inflight
+*
+* FUNCTION:             Requests sent and not yet answered.
+*
+* RETURNS:                           int
+***************************************************************/
+int pipe_inflight ( TCP_CONNECTION_INFO *connection )
+{
+	return connection->pipeline ? connection->pipeline->inflight : 0;
+}
+
+/***************************************************************
+*
+* NAME:                           pipe_fail
+*
+* FUNCTION:             Completes every request in flight with
+*                       error and no frame, e.g. once the
+*                       connection is lost.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void pipe_fail ( TCP_CONNECTION_INFO *connection, int error )
+{
+	TCP_PIPELINE		*p = connection->pipeline;
+	TCP_PIPE_SLOT		*slot;
+	TCP_PIPE_RESPONSE	 on_response;
+	unsigned long		 i;
+
+	if ( !p )
+		return;
+
+	for ( i = 0; i <= p->mask; i++ )
+	{
+		slot = &p->slots[i];
+		if ( !slot->busy )
+			continue;
+		on_response = slot->on_response;
+		slot->busy = 0;
+		p->inflight--;
+		on_response ( connection, slot->context, 0, 0, error );
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,118 @@
+/************************************************************************************
+*		FILE:		"nspipe.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Pipelined requests on a framed connection: up to
+*					window requests are sent without waiting, and each
+*					response is handed to its own callback by the
+*					correlation ID it carries, so a connection's
+*					throughput grows with the window instead of being
+*					one request per round trip.
+*
+*		Notes:		The correlation ID is id_width bytes at id_offset in
+*					the frame body, in the framer's byte order. pipe_send
+*					writes a fresh ID there in the request; the server is
+*					expected to copy it to the same place in the response.
+*					Responses may come back in any order.
+*
+*					Needs set_framer on the connection first. Receive as
+*					usual, with frame_recv (or pipe_recv) or frame_recv_nw
+*					and frame_commit, then call pipe_dispatch to run the
+*					callbacks. A response whose ID matches no request in
+*					flight is dropped and counted in stray.
+*
+*					With a coalescing buffer (set_coalesce) requests may
+*					wait in it below its thresholds. pipe_recv, pipe_send
+*					returning TCP_PIPE_FULL and pipe_dispatch flush it;
+*					with frame_recv_nw, coalesce_flush before the first
+*					receive.
+*
+*					When the connection fails, pipe_fail hands every
+*					request still in flight to its callback with the
+*					error, so no caller waits forever.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.18.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Coalesced requests flushed before waiting
+*************************************************************************************/
+
+#ifndef _NSPIPEH_INCLUDE_
+#define _NSPIPEH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* pipe_send: the window is full, dispatch some responses first */
+#define TCP_PIPE_FULL			( -2L )
+
+/***************************************************************
+*
+*	Name:		TCP_PIPE_SLOT
+*	Type:		struct
+*	Purpose:	One request in flight.
+*
+***************************************************************/
+typedef struct tcp_pipe_slot
+{
+	unsigned long			id;
+	TCP_PIPE_RESPONSE		on_response;
+	void				*context;
+	int				busy;
+} TCP_PIPE_SLOT;
+
+/***************************************************************
+*
+*	Name:		TCP_PIPELINE
+*	Type:		struct
+*	Purpose:	Requests in flight on one connection
+*				(TCP_CONNECTION_INFO::pipeline). Request id
+*				sits in slot id & mask; the table is the
+*				window rounded up to a power of two, and an
+*				ID whose slot is still taken waits, like a
+*				full window.
+*
+***************************************************************/
+typedef struct tcp_pipeline
+{
+	TCP_PIPE_SLOT			*slots;
+	unsigned long			 mask;
+	unsigned long			 next_id;
+	unsigned long			 id_limit;	/* IDs wrap here */
+	int				 window;
+	int				 inflight;
+	long				 id_offset;
+	int				 id_width;
+	long				 stray;
+} TCP_PIPELINE;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int pipe_attach ( TCP_CONNECTION_INFO *connection, int window, long id_offset, int id_width );
+void pipe_detach ( TCP_CONNECTION_INFO *connection );
+long pipe_send ( TCP_CONNECTION_INFO *connection, char *body, long length
+			   , TCP_PIPE_RESPONSE on_response, void *context );
+int pipe_dispatch ( TCP_CONNECTION_INFO *connection );
+int pipe_recv ( TCP_CONNECTION_INFO *connection );
+int pipe_inflight ( TCP_CONNECTION_INFO *connection );
+void pipe_fail ( TCP_CONNECTION_INFO *connection, int error );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSPIPEH_INCLUDE_
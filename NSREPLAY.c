@@ -0,0 +1,418 @@
+/************************************************************************************
+*		FILE:		"nsreplay.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Plays a capture file (see nscapt.h) back at a test
+*					server, keeping the captured timing or scaling it, so
+*					a load test can use real traffic.
+*
+*		Notes:		Linux only. Build and run:
+*
+*					gcc -O2 -o nsreplay NSREPLAY.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./nsreplay [-f file] [-a address] [-p port]
+*					           [-d send|recv] [-x speed] [-e epoll|io_uring]
+*
+*					Each captured socket becomes one client connection,
+*					opened when its first message is due. -d picks which
+*					messages are sent: the ones the captured process
+*					sent (default) or the ones it received. -x 1 keeps
+*					the captured gaps, 2 halves them, 0 sends as fast as
+*					possible. Snapped messages are padded with zeros to
+*					their captured length.
+*
+*					Without -p the messages go to an in-process server
+*					that swallows them. The result is one JSON object on
+*					stdout; lag is how late each send started against
+*					the schedule, in microseconds (not with -x 0).
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.22.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Sink is tcp_loopback_start
+*************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "NSSHARD.h"
+#include "NSCAPT.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* bytes of receive buffer per sink connection slot */
+#define REPLAY_SLOT_BUFFER		16384
+#define REPLAY_MAX_CONNECTIONS		8192
+
+/* sleep rather than spin when a send is further off than this */
+#define REPLAY_SPIN_USEC		200
+
+typedef struct replay_options
+{
+	const char			*file;
+	TCP_IPADDR			ipaddr;
+	TCP_PORT			port;
+	int				type;
+	double				speed;
+	int				engine;
+} REPLAY_OPTIONS;
+
+/* a captured socket and the connection replaying it */
+typedef struct replay_socket
+{
+	int				sock;
+	TCP_CONNECTION_INFO		*connection;
+} REPLAY_SOCKET;
+
+
+/***************************************************************************************
+*						SINK SERVER
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Replay_Sink_Start
+*
+* FUNCTION:             One-shard loopback sink (tcp_loopback_start)
+*                       on a free port.
+*
+* RETURNS:              int - 0, -1 on failure
+***************************************************************/
+static int Replay_Sink_Start ( TCP_LOOPBACK *sink, REPLAY_OPTIONS *options )
+{
+	memset ( sink, 0, sizeof ( *sink ) );
+	sink->mode = TCP_LOOPBACK_SINK;
+	sink->slot = REPLAY_SLOT_BUFFER;
+
+	strcpy ( sink->config.ipaddr, "127.0.0.1" );
+	sink->config.shards = 1;
+	sink->config.max_connections = REPLAY_MAX_CONNECTIONS;
+	sink->config.engine = options->engine;
+
+	return tcp_loopback_start ( sink );
+}
+
+
+/***************************************************************************************
+*						CAPTURE FILE
+***************************************************************************************/
+
+static int Replay_Compare_Time ( const void *a, const void *b )
+{
+	const TCP_CAPTURE_RECORD *x = *( const TCP_CAPTURE_RECORD * const * ) a;
+	const TCP_CAPTURE_RECORD *y = *( const TCP_CAPTURE_RECORD * const * ) b;
+
+	if ( x->usec != y->usec )
+		return x->usec < y->usec ? -1 : 1;
+	/* same microsecond: keep file order, which is per-thread order */
+	return x < y ? -1 : x > y;
+}
+
+/***************************************************************
+*
+* NAME:                           Replay_Load
+*
+* FUNCTION:             Maps the capture file and lists its records
+*                       of type, in time order.
+*
+* RETURNS:              long - records listed, -1 on a bad file
+***************************************************************/
+static long Replay_Load ( const char *file, int type, TCP_CAPTURE_HEADER **header, TCP_CAPTURE_RECORD ***records )
+{
+	TCP_CAPTURE_RECORD	*record;
+	struct stat		 info;
+	char			*map;
+	char			*at;
+	char			*end;
+	long			 count = 0;
+	int			 fd;
+
+	fd = open ( file, O_RDONLY );
+	if ( fd < 0 || fstat ( fd, &info ) < 0 || info.st_size < ( off_t ) sizeof ( TCP_CAPTURE_HEADER ) )
+		return -1;
+	map = ( char * ) mmap ( 0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close ( fd );
+	if ( map == MAP_FAILED || memcmp ( map, TCP_CAPTURE_MAGIC, sizeof ( TCP_CAPTURE_MAGIC ) ) )
+		return -1;
+
+	*header = ( TCP_CAPTURE_HEADER * ) map;
+	end = map + info.st_size;
+	*records = ( TCP_CAPTURE_RECORD ** ) malloc ( ( info.st_size / sizeof ( TCP_CAPTURE_RECORD ) + 1 ) * sizeof ( TCP_CAPTURE_RECORD * ) );
+	if ( !*records )
+		return -1;
+
+	for ( at = map + sizeof ( TCP_CAPTURE_HEADER ); at + sizeof ( TCP_CAPTURE_RECORD ) <= end; at += record->size )
+	{
+		record = ( TCP_CAPTURE_RECORD * ) at;
+		if ( record->size < sizeof ( TCP_CAPTURE_RECORD ) || at + record->size > end )
+			break;
+		if ( record->type == type )
+			( *records )[count++] = record;
+	}
+
+	qsort ( *records, count, sizeof ( TCP_CAPTURE_RECORD * ), Replay_Compare_Time );
+	return count;
+}
+
+
+/***************************************************************************************
+*						CLIENT SIDE
+***************************************************************************************/
+
+static int Replay_Compare ( const void *a, const void *b )
+{
+	long long x = *( const long long * ) a;
+	long long y = *( const long long * ) b;
+
+	return x < y ? -1 : x > y;
+}
+
+/***************************************************************
+*
+* NAME:                           Replay_Connection
+*
+* FUNCTION:             The connection replaying captured socket
+*                       sock, opened on first use.
+*
+* RETURNS:              TCP_CONNECTION_INFO * - 0 on failure
+***************************************************************/
+static TCP_CONNECTION_INFO *Replay_Connection ( TCP *tcp, REPLAY_OPTIONS *options, REPLAY_SOCKET *sockets, int *count, int sock )
+{
+	TCP_CONNECTION_INFO	*connection;
+	int			 i;
+
+	for ( i = 0; i < *count; i++ )
+		if ( sockets[i].sock == sock )
+			return sockets[i].connection;
+	if ( *count == REPLAY_MAX_CONNECTIONS )
+		return 0;
+
+	connection = tcp->get_conn_info ( );
+	if ( !connection )
+		return 0;
+	strcpy ( connection->ipaddr, options->ipaddr );
+	connection->port = options->port;
+	tcp->set_sockaddr ( connection, AF_INET );
+	if ( tcp->get_sock ( connection, AF_INET, SOCK_STREAM, 0 ) < 0
+	  || tcp->make_connect ( connection ) < 0 )
+	{
+		tcp->close_sock ( connection );
+		tcp->clean_conn_info ( connection );
+		return 0;
+	}
+
+	sockets[*count].sock = sock;
+	sockets[*count].connection = connection;
+	( *count )++;
+	return connection;
+}
+
+/***************************************************************
+*
+* NAME:                           Replay_Send
+*
+* FUNCTION:             Sends one captured message, all of it.
+*
+* RETURNS:              int - 0, -1 on failure
+***************************************************************/
+static int Replay_Send ( TCP *tcp, TCP_CONNECTION_INFO *connection, TCP_CAPTURE_RECORD *record, char *scratch )
+{
+	char	*data = ( char * ) ( record + 1 );
+	long	 done = 0;
+	int	 status;
+
+	if ( record->saved < record->length )
+	{
+		memcpy ( scratch, data, record->saved );
+		memset ( scratch + record->saved, 0, record->length - record->saved );
+		data = scratch;
+	}
+
+	while ( done < ( long ) record->length )
+	{
+		status = tcp->new_send ( connection, data + done, ( int ) ( record->length - done ) );
+		if ( status <= 0 )
+			return -1;
+		done += status;
+	}
+
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Replay_Wait
+*
+* FUNCTION:             Sleeps, then spins, until target.
+*
+***************************************************************/
+static void Replay_Wait ( long long target )
+{
+	long long now;
+
+	while ( ( now = tcp_clock_usec ( ) ) < target )
+		if ( target - now > REPLAY_SPIN_USEC )
+			usleep ( ( useconds_t ) ( target - now - REPLAY_SPIN_USEC / 2 ) );
+}
+
+/***************************************************************
+*
+* NAME:                           Replay_Run
+*
+* FUNCTION:             Sends the records on schedule and prints
+*                       the result line.
+*
+* RETURNS:              int - 0, -1 when a connect or send failed
+***************************************************************/
+static int Replay_Run ( TCP *tcp, REPLAY_OPTIONS *options, TCP_CAPTURE_HEADER *header, TCP_CAPTURE_RECORD **records, long count )
+{
+	TCP_CONNECTION_INFO	*connection;
+	REPLAY_SOCKET		*sockets = ( REPLAY_SOCKET * ) calloc ( REPLAY_MAX_CONNECTIONS, sizeof ( REPLAY_SOCKET ) );
+	long long		*lags = ( long long * ) malloc ( ( count + 1 ) * sizeof ( long long ) );
+	char			*scratch = 0;
+	long long		 start;
+	long long		 target;
+	long long		 first = count ? records[0]->usec : 0;
+	double			 seconds;
+	long			 bytes = 0;
+	long			 sent = 0;
+	unsigned int		 longest = 0;
+	int			 opened = 0;
+	int			 status = 0;
+	long			 i;
+
+	for ( i = 0; i < count; i++ )
+		if ( records[i]->length > longest )
+			longest = records[i]->length;
+	scratch = ( char * ) malloc ( longest + 1 );
+	if ( !sockets || !lags || !scratch )
+		return -1;
+
+	start = tcp_clock_usec ( );
+	for ( i = 0; i < count; i++ )
+	{
+		target = start;
+		if ( options->speed > 0 )
+		{
+			target += ( long long ) ( ( records[i]->usec - first ) / options->speed );
+			Replay_Wait ( target );
+		}
+		lags[sent] = tcp_clock_usec ( ) - target;
+
+		connection = Replay_Connection ( tcp, options, sockets, &opened, records[i]->sock );
+		if ( !connection || Replay_Send ( tcp, connection, records[i], scratch ) < 0 )
+		{
+			fprintf ( stderr, "replay: %s failed at record %ld\n", connection ? "send" : "connect", i );
+			status = -1;
+			break;
+		}
+		bytes += records[i]->length;
+		sent++;
+	}
+	seconds = ( tcp_clock_usec ( ) - start ) / 1e6;
+
+	for ( i = 0; i < opened; i++ )
+	{
+		tcp->close_sock ( sockets[i].connection );
+		tcp->clean_conn_info ( sockets[i].connection );
+	}
+
+	printf ( "{\"test\":\"replay\",\"speed\":%g,\"captured\":%lld,\"dropped\":%lld,\"connections\":%d"
+			 ",\"messages\":%ld,\"bytes\":%ld,\"seconds\":%.3f,\"msgs_per_sec\":%.0f,\"mb_per_sec\":%.2f"
+		   , options->speed, header->records, header->dropped, opened
+		   , sent, bytes, seconds
+		   , seconds > 0 ? sent / seconds : 0
+		   , seconds > 0 ? bytes / seconds / 1e6 : 0 );
+	if ( sent && options->speed > 0 )
+	{
+		qsort ( lags, sent, sizeof ( long long ), Replay_Compare );
+		printf ( ",\"lag_p50_us\":%lld,\"lag_p99_us\":%lld,\"lag_max_us\":%lld"
+			   , lags[sent / 2], lags[( long ) ( sent * 0.99 )], lags[sent - 1] );
+	}
+	printf ( "}\n" );
+
+	free ( scratch );
+	free ( lags );
+	free ( sockets );
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           Replay_Usage
+*
+***************************************************************/
+static void Replay_Usage ( const char *name )
+{
+	fprintf ( stderr, "usage: %s [-f file] [-a address] [-p port]\n"
+					  "          [-d send|recv] [-x speed] [-e epoll|io_uring]\n", name );
+	exit ( 2 );
+}
+
+int main ( int argc, char **argv )
+{
+	REPLAY_OPTIONS		 options;
+	TCP_LOOPBACK		 sink;
+	TCP_CAPTURE_HEADER	*header;
+	TCP_CAPTURE_RECORD	**records;
+	TCP			*tcp;
+	long			 count;
+	int			 opt;
+	int			 status;
+
+	memset ( &options, 0, sizeof ( options ) );
+	memset ( &sink, 0, sizeof ( sink ) );
+	options.file = "nscapt.dat";
+	strcpy ( options.ipaddr, "127.0.0.1" );
+	options.type = TCP_CAPTURE_SEND;
+	options.speed = 1.0;
+	options.engine = TCP_ENGINE_DEFAULT;
+
+	while ( ( opt = getopt ( argc, argv, "f:a:p:d:x:e:h" ) ) != -1 )
+	{
+		switch ( opt )
+		{
+		case 'f': options.file = optarg; break;
+		case 'a': snprintf ( options.ipaddr, sizeof ( options.ipaddr ), "%s", optarg ); break;
+		case 'p': options.port = ( TCP_PORT ) atoi ( optarg ); break;
+		case 'd': options.type = !strcmp ( optarg, "recv" ) ? TCP_CAPTURE_RECV : TCP_CAPTURE_SEND; break;
+		case 'x': options.speed = atof ( optarg ); break;
+		case 'e': options.engine = !strcmp ( optarg, "io_uring" ) ? TCP_ENGINE_IO_URING : TCP_ENGINE_EPOLL; break;
+		default: Replay_Usage ( argv[0] );
+		}
+	}
+	if ( options.speed < 0 )
+		Replay_Usage ( argv[0] );
+
+	count = Replay_Load ( options.file, options.type, &header, &records );
+	if ( count < 0 )
+	{
+		fprintf ( stderr, "replay: %s is not a capture file\n", options.file );
+		return 1;
+	}
+
+	if ( !options.port )
+	{
+		if ( Replay_Sink_Start ( &sink, &options ) < 0 )
+			return 1;
+		options.port = sink.config.port;
+	}
+
+	tcp = intialize_tcp_engine ( options.engine );
+	if ( !tcp )
+		return 1;
+	status = Replay_Run ( tcp, &options, header, records, count );
+
+	tcp_loopback_stop ( &sink );
+	release_tcp ( tcp );
+	tcp_thread_exit ( );
+	free ( records );
+	return status < 0;
+}
@@ -0,0 +1,389 @@
+/************************************************************************************
+*		FILE:		"nssendq.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Multi-producer send queue. See nssendq.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.17.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nssendqh"
+#include "=nsstatsh"
+#else
+#include "NSSENDQ.h"
+#include "NSSTATS.h"
+#include <sched.h>
+#endif
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __TANDEM
+#define SENDQ_LOAD(p)			( *( p ) )
+#define SENDQ_STORE(p, v)		( *( p ) = ( v ) )
+#define SENDQ_EXCHANGE(p, v)		Sendq_Exchange ( p, v )
+#define SENDQ_ADD(p, v)			( ( *( p ) += ( v ) ) - ( v ) )
+#define SENDQ_PAUSE()			( ( void ) 0 )
+
+static TCP_SENDQ_ITEM *Sendq_Exchange ( TCP_SENDQ_ITEM **slot, TCP_SENDQ_ITEM *item )
+{
+	TCP_SENDQ_ITEM *old = *slot;
+
+	*slot = item;
+	return old;
+}
+#else
+#define SENDQ_LOAD(p)			__atomic_load_n ( p, __ATOMIC_ACQUIRE )
+#define SENDQ_STORE(p, v)		__atomic_store_n ( p, v, __ATOMIC_RELEASE )
+#define SENDQ_EXCHANGE(p, v)		__atomic_exchange_n ( p, v, __ATOMIC_ACQ_REL )
+#define SENDQ_ADD(p, v)			__atomic_fetch_add ( p, v, __ATOMIC_ACQ_REL )
+#define SENDQ_PAUSE()			sched_yield ( )
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Sendq_Link
+*
+* FUNCTION:             Appends item to the list: swap it in as the
+*                       tail, then link the old tail to it. Between
+*                       the two the list is cut short; Sendq_Pop
+*                       sees that and waits.
+*
+***************************************************************/
+static void Sendq_Link ( TCP_SENDQ *q, TCP_SENDQ_ITEM *item )
+{
+	TCP_SENDQ_ITEM *prev;
+
+	item->next = 0;
+	prev = SENDQ_EXCHANGE ( &q->tail, item );
+	SENDQ_STORE ( &prev->next, item );
+}
+
+/***************************************************************
+*
+* NAME:                           Sendq_Pop
+*
+* FUNCTION:             Takes the oldest message off the list (owner
+*                       only). The stub item keeps the list from
+*                       ever being empty, so producers never touch
+*                       head.
+*
+* RETURNS:              TCP_SENDQ_ITEM * - 0 if none is linked yet
+***************************************************************/
+static TCP_SENDQ_ITEM *Sendq_Pop ( TCP_SENDQ *q )
+{
+	TCP_SENDQ_ITEM	*head = q->head;
+	TCP_SENDQ_ITEM	*next = SENDQ_LOAD ( &head->next );
+
+	if ( head == &q->stub )
+	{
+		if ( !next )
+			return 0;
+		q->head = next;
+		head = next;
+		next = SENDQ_LOAD ( &next->next );
+	}
+	if ( next )
+	{
+		q->head = next;
+		return head;
+	}
+
+	/* head is the last one; put the stub behind it to take it */
+	if ( head != SENDQ_LOAD ( &q->tail ) )
+		return 0;
+	Sendq_Link ( q, &q->stub );
+	next = SENDQ_LOAD ( &head->next );
+	if ( next )
+	{
+		q->head = next;
+		return head;
+	}
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Sendq_Written
+*
+* FUNCTION:             Frees the messages the last write finished,
+*                       counts the bytes off, and calls on_drained
+*                       when that takes the queue from above
+*                       high_water down to low_water.
+*
+***************************************************************/
+static void Sendq_Written ( TCP_CONNECTION_INFO *connection, TCP_SENDQ *q, long written )
+{
+	TCP_SENDQ_ITEM	*item;
+	long		 level;
+	long		 left = written;
+
+	while ( ( item = q->ready ) != 0 && left >= item->length - q->offset )
+	{
+		left -= item->length - q->offset;
+		q->offset = 0;
+		q->ready = item->next;
+		q->ready_count--;
+		free ( item );
+	}
+	if ( !q->ready )
+		q->ready_tail = 0;
+	q->offset += left;
+
+	level = SENDQ_ADD ( &q->bytes, -written ) - written;
+	if ( level <= q->low_water && SENDQ_LOAD ( &q->over ) )
+	{
+		SENDQ_STORE ( &q->over, 0 );
+		if ( q->on_drained )
+			q->on_drained ( connection, q->context );
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           Sendq_Write
+*
+* FUNCTION:             One gather write of the ready messages.
+*                       Guardian has no gather send, so there it is
+*                       the first message only.
+*
+* RETURNS:              int - bytes written, or -1 with errno set
+***************************************************************/
+static int Sendq_Write ( TCP_CONNECTION_INFO *connection, TCP_SENDQ *q )
+{
+	int		status;
+#ifdef __TANDEM
+	status = send ( *connection->sock
+				  , q->ready->data + q->offset
+				  , ( int ) ( q->ready->length - q->offset )
+				  , connection->flags );
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, q->ready->length - q->offset, status );
+#else
+	TCP_IOVEC	 iov[TCP_SENDQ_IOV];
+	struct msghdr	 msg;
+	TCP_SENDQ_ITEM	*item;
+	long		 asked = 0;
+	int		 count = 0;
+
+	for ( item = q->ready; item && count < TCP_SENDQ_IOV; item = item->next, count++ )
+	{
+		iov[count].iov_base = item->data;
+		iov[count].iov_len = item->length;
+		if ( item == q->ready )
+		{
+			iov[count].iov_base = item->data + q->offset;
+			iov[count].iov_len -= q->offset;
+		}
+		asked += ( long ) iov[count].iov_len;
+	}
+
+	memset ( &msg, 0, sizeof ( msg ) );
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count;
+	status = ( int ) sendmsg ( *connection->sock, &msg, connection->flags );
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, asked, status );
+#endif
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           sendq_attach
+*
+* FUNCTION:             Gives a connection a send queue. high_water
+*                       is where pushes start returning
+*                       TCP_SENDQ_HIGH (0 = never); on_drained, if
+*                       given, is called once the queue is back
+*                       down to low_water (0 = empty).
+*
+* RETURNS:              int - 0, or -1 on bad arguments / no memory
+***************************************************************/
+int sendq_attach ( TCP_CONNECTION_INFO *connection, long high_water, long low_water
+				 , TCP_SENDQ_DRAINED on_drained, void *context )
+{
+	TCP_SENDQ *q;
+
+	if ( high_water < 0 || low_water < 0 || ( high_water && low_water > high_water ) )
+		return -1;
+
+	q = ( TCP_SENDQ * ) calloc ( 1, sizeof ( TCP_SENDQ ) );
+	if ( !q )
+		return -1;
+
+	q->head = &q->stub;
+	q->tail = &q->stub;
+	q->high_water = high_water;
+	q->low_water = low_water;
+	q->on_drained = on_drained;
+	q->context = context;
+
+	sendq_detach ( connection );
+	connection->sendq = q;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           sendq_detach
+*
+* FUNCTION:             Frees a connection's queue. Anything still
+*                       in it is dropped, so sendq_flush first.
+*                       Called by clean_conn_info.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void sendq_detach ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_SENDQ	*q = connection->sendq;
+	TCP_SENDQ_ITEM	*item;
+
+	if ( !q )
+		return;
+
+	while ( ( item = q->ready ) != 0 )
+	{
+		q->ready = item->next;
+		free ( item );
+	}
+	while ( ( item = Sendq_Pop ( q ) ) != 0 )
+		free ( item );
+	free ( q );
+	connection->sendq = 0;
+}
+
+/***************************************************************
+*
+* NAME:                           sendq_push
+*
+* FUNCTION:             Queues a copy of one message. Any thread may
+*                       call it, and it never waits.
+*
+* RETURNS:              int - TCP_SENDQ_* flags, or -1 with no queue
+*                       attached / no memory
+***************************************************************/
+int sendq_push ( TCP_CONNECTION_INFO *connection, char *buffer, long length )
+{
+	TCP_SENDQ	*q = connection->sendq;
+	TCP_SENDQ_ITEM	*item;
+	long		 before;
+	int		 flags = 0;
+
+	if ( !q || length <= 0 )
+		return length ? -1 : 0;
+
+	item = ( TCP_SENDQ_ITEM * ) malloc ( offsetof ( TCP_SENDQ_ITEM, data ) + length );
+	if ( !item )
+		return -1;
+	item->length = length;
+	memcpy ( item->data, buffer, length );
+
+	/* count it first: the owner keeps draining while bytes says
+	*  something is on the way */
+	before = SENDQ_ADD ( &q->bytes, length );
+	Sendq_Link ( q, item );
+
+	if ( !before )
+		flags |= TCP_SENDQ_FIRST;
+	if ( q->high_water && before + length > q->high_water )
+	{
+		if ( !SENDQ_LOAD ( &q->over ) )
+			SENDQ_STORE ( &q->over, 1 );
+		flags |= TCP_SENDQ_HIGH;
+	}
+	return flags;
+}
+
+/***************************************************************
+*
+* NAME:                           sendq_flush
+*
+* FUNCTION:             Writes out what is queued, up to
+*                       TCP_SENDQ_IOV messages per gather write,
+*                       until the queue is empty or the socket
+*                       would block. The owner thread only.
+*
+* NOTE:                 A producer that has counted its message but
+*                       not linked it yet is waited for (a few
+*                       instructions, unless it was preempted).
+*
+* RETURNS:              long - bytes written, or -1 on a socket
+*                       error (what was written stays counted off)
+***************************************************************/
+long sendq_flush ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_SENDQ	*q = connection->sendq;
+	TCP_SENDQ_ITEM	*item;
+	long		 total = 0;
+	int		 status;
+
+	if ( !q )
+		return 0;
+
+	for ( ;; )
+	{
+		while ( q->ready_count < TCP_SENDQ_IOV && ( item = Sendq_Pop ( q ) ) != 0 )
+		{
+			item->next = 0;
+			if ( q->ready_tail )
+				q->ready_tail->next = item;
+			else
+				q->ready = item;
+			q->ready_tail = item;
+			q->ready_count++;
+		}
+
+		if ( !q->ready )
+		{
+			if ( SENDQ_LOAD ( &q->bytes ) <= 0 )
+				break;
+			SENDQ_PAUSE ( );
+			continue;
+		}
+
+		status = Sendq_Write ( connection, q );
+		if ( status < 0 )
+		{
+			if ( errno == EINTR )
+				continue;
+			if ( errno == EAGAIN || errno == EWOULDBLOCK )
+				break;
+			return -1;
+		}
+		Sendq_Written ( connection, q, status );
+		total += status;
+	}
+
+	return total;
+}
+
+/***************************************************************
+*
+* NAME:                           sendq_pending
+*
+* FUNCTION:             Bytes pushed and not yet written. Any thread
+*                       may ask, e.g. before producing more.
+*
+* RETURNS:                         long
+***************************************************************/
+long sendq_pending ( TCP_CONNECTION_INFO *connection )
+{
+	return connection->sendq ? SENDQ_LOAD ( &connection->sendq->bytes ) : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+/************************************************************************************
+*		FILE:		"nssendq.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	A send queue for a connection that many threads write
+*					to: producers push messages without taking a lock,
+*					and the one thread that owns the socket drains them
+*					with gather writes.
+*
+*		Notes:		The queue is an intrusive multi-producer single-
+*					consumer list: a push is one atomic add and one atomic
+*					exchange, never a wait. Messages are copied on push,
+*					so the caller's buffer is free again on return.
+*
+*					sendq_push tells the producer two things in its
+*					result: TCP_SENDQ_FIRST when the queue had nothing
+*					unsent (the owner may be asleep and need waking), and
+*					TCP_SENDQ_HIGH when the queue holds more than
+*					high_water bytes, so the producer should hold off.
+*					Once the owner has drained it back to low_water it
+*					calls the drained callback, on its own thread.
+*
+*					Only the owner calls sendq_flush. On a non-blocking
+*					socket it writes what the socket takes and returns;
+*					call it again when the socket is writable. attach and
+*					detach need the producers stopped.
+*
+*					Guardian processes are single threaded, so there the
+*					atomics are plain loads and stores.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.17.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifndef _NSSENDQH_INCLUDE_
+#define _NSSENDQH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* sendq_push result flags */
+#define TCP_SENDQ_FIRST			0x01	/* queue was empty: wake the owner */
+#define TCP_SENDQ_HIGH			0x02	/* over high_water: back off */
+
+/* most messages gathered into one write */
+#define TCP_SENDQ_IOV			64
+
+/***************************************************************
+*
+*	Name:		TCP_SENDQ_ITEM
+*	Type:		struct
+*	Purpose:	One queued message, copied in behind the
+*				header.
+*
+***************************************************************/
+typedef struct tcp_sendq_item
+{
+	struct tcp_sendq_item		*next;
+	long				length;
+	char				data[1];
+} TCP_SENDQ_ITEM;
+
+/***************************************************************
+*
+*	Name:		TCP_SENDQ
+*	Type:		struct
+*	Purpose:	Send queue of one connection
+*				(TCP_CONNECTION_INFO::sendq). The producers'
+*				fields and the owner's are kept on separate
+*				cache lines. bytes counts pushed and not yet
+*				written; it goes up before a message is
+*				linked, so the owner knows to wait for one
+*				still being linked.
+*
+***************************************************************/
+typedef struct tcp_send_queue
+{
+	/* producers */
+	TCP_SENDQ_ITEM			*tail;
+	long				bytes;
+	int				over;		/* above high_water, not yet drained */
+	char				pad[64];
+
+	/* owner */
+	TCP_SENDQ_ITEM			*head;
+	TCP_SENDQ_ITEM			*ready;		/* taken off the list, not all written */
+	TCP_SENDQ_ITEM			*ready_tail;
+	int				ready_count;
+	long				offset;		/* bytes of ready already written */
+	long				high_water;
+	long				low_water;
+	TCP_SENDQ_DRAINED		on_drained;
+	void				*context;
+	TCP_SENDQ_ITEM			stub;
+} TCP_SENDQ;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sendq_attach ( TCP_CONNECTION_INFO *connection, long high_water, long low_water
+				 , TCP_SENDQ_DRAINED on_drained, void *context );
+void sendq_detach ( TCP_CONNECTION_INFO *connection );
+int sendq_push ( TCP_CONNECTION_INFO *connection, char *buffer, long length );
+long sendq_flush ( TCP_CONNECTION_INFO *connection );
+long sendq_pending ( TCP_CONNECTION_INFO *connection );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSSENDQH_INCLUDE_
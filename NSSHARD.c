@@ -0,0 +1,612 @@
+/************************************************************************************
+*		FILE:		"nsshard.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Sharded SO_REUSEPORT server. See nsshard.h.
+*
+*		Notes:		The listeners are all bound by tcp_server_start on the
+*					caller's thread, so a bad address or a port in use is
+*					reported there. Port 0 picks a free port once and the
+*					other shards join it; config.port then holds it.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.9.0	  10/17/26		Initial Release
+*		1.11.0	  10/17/26		Accepts counted in the operation counters
+*		1.14.0	  10/17/26		Shard_Accept drains the listen queue per completion
+*		1.25.1	  10/17/26		Accepted sockets tuned (config.tuning)
+*		1.25.1	  10/17/26		Loopback echo/sink server for the tools
+*************************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#ifdef __TANDEM
+#include "=nsshardh"
+#include "=nsstatsh"
+#include "=nstuneh"
+#else
+#include "NSSHARD.h"
+#include "NSSTATS.h"
+#include "NSTUNE.h"
+#include <sched.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __TANDEM
+
+/* connections a shard's table holds unless told otherwise */
+#define TCP_SHARD_CONNECTIONS		4096
+/* how long a shard waits for I/O before looking at stop (0.01 s) */
+#define TCP_SHARD_WAIT			10
+/* most connections one accept completion takes off the listen queue */
+#define TCP_SHARD_ACCEPT_BATCH		64
+/* receive buffer per loopback connection unless told otherwise */
+#define TCP_LOOPBACK_SLOT		16384
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Shard_Listen
+*
+* FUNCTION:             Opens, binds and listens on one shard's
+*                       socket. reuseport says whether the shards
+*                       share the port.
+*
+* RETURNS:              int - socket, or -1 with errno set
+***************************************************************/
+static int Shard_Listen ( TCP_SERVER_CONFIG *config, int reuseport )
+{
+	struct sockaddr_in	address;
+	socklen_t		length = sizeof ( address );
+	int			fd;
+	int			on = 1;
+	int			saved;
+
+	memset ( &address, 0, sizeof ( address ) );
+	address.sin_family = AF_INET;
+	address.sin_port = htons ( config->port );
+	if ( !config->ipaddr[0] )
+		address.sin_addr.s_addr = htonl ( INADDR_ANY );
+	else if ( inet_pton ( AF_INET, config->ipaddr, &address.sin_addr ) != 1 )
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = socket_nw ( AF_INET, SOCK_STREAM, 0, 0, 0 );
+	if ( fd < 0 )
+		return -1;
+
+	setsockopt ( fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof ( on ) );
+#ifdef SO_REUSEPORT
+	if ( reuseport && setsockopt ( fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof ( on ) ) < 0 )
+		goto fail;
+#endif
+
+	if ( bind ( fd, ( struct sockaddr * ) &address, sizeof ( address ) ) < 0
+	  || listen ( fd, config->backlog ? config->backlog : SOMAXCONN ) < 0 )
+		goto fail;
+
+	/* port 0: everybody else joins the port the kernel chose */
+	if ( !config->port && getsockname ( fd, ( struct sockaddr * ) &address, &length ) == 0 )
+		config->port = ntohs ( address.sin_port );
+
+	return fd;
+
+fail:
+	saved = errno;
+	close ( fd );
+	errno = saved;
+	return -1;
+}
+
+/***************************************************************
+*
+* NAME:                           Shard_Post_Accept
+*
+* FUNCTION:             Puts the listener's accept_nw back up.
+*
+* RETURNS:              int - 0, or -1 with errno set
+***************************************************************/
+static int Shard_Post_Accept ( TCP_SHARD *shard )
+{
+	int status;
+
+	shard->from_len = sizeof ( shard->from );
+
+	status = accept_nw ( shard->listen_fd
+					   , ( struct sockaddr * ) &shard->from
+					   , &shard->from_len
+					   , TCP_SHARD_ACCEPT_TAG );
+	TCP_STATS_SUBMIT ( 0, TCP_OP_ACCEPT, status );
+
+	return status;
+}
+
+/***************************************************************
+*
+* NAME:                           Shard_File
+*
+* FUNCTION:             Files a new connection in the shard's table
+*                       and tells the application.
+*
+* RETURNS:              nothing
+***************************************************************/
+static void Shard_File ( TCP_SHARD *shard, int fd, struct sockaddr_in *from, long from_len )
+{
+	TCP_SERVER_CONFIG	*config = &shard->server->config;
+	TCP_CONN_COLD		*cold;
+	TCP_HANDLE		 handle;
+
+	handle = conn_add ( shard->table, fd, TCP_CONN_CONNECTED, 0 );
+	if ( handle == TCP_HANDLE_NONE )
+	{
+		FILE_CLOSE_ ( fd );
+		shard->refused++;
+		return;
+	}
+
+	cold = conn_cold ( shard->table, handle );
+	cold->sockaddr = *from;
+	cold->sockaddr_len = from_len;
+	cold->tune_short = tune_accepted ( shard->server->tune, fd );
+	cold->port = ntohs ( from->sin_port );
+	inet_ntop ( AF_INET, &from->sin_addr, cold->ipaddr, sizeof ( cold->ipaddr ) );
+	shard->accepted++;
+
+	if ( config->on_accept && config->on_accept ( shard, handle, config->context ) )
+	{
+		FILE_CLOSE_ ( fd );
+		conn_remove ( shard->table, handle );
+		shard->refused++;
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           Shard_Accept
+*
+* FUNCTION:             Takes a finished accept_nw: files the new
+*                       connection, then drains the rest of the
+*                       listen queue straight off the listener (up
+*                       to TCP_SHARD_ACCEPT_BATCH, so a connection
+*                       storm doesn't starve the shard's traffic),
+*                       and re-arms the listener.
+*
+* NOTE:                 Only with epoll, where the listener is non-
+*                       blocking; io_uring keeps it blocking and does
+*                       the waiting itself, one accept per completion.
+*
+* RETURNS:              int - Shard_Post_Accept status
+***************************************************************/
+static int Shard_Accept ( TCP_SHARD *shard, TCP_COMPLETION *completion )
+{
+	struct sockaddr_in	 from;
+	socklen_t		 from_len;
+	int			 fd;
+	int			 i;
+
+	if ( completion->error )
+	{
+		shard->error = completion->error;
+		return Shard_Post_Accept ( shard );
+	}
+	if ( ( fd = nslx_accepted_fd ( ( struct sockaddr * ) &shard->from ) ) < 0 )
+		return Shard_Post_Accept ( shard );
+
+	Shard_File ( shard, fd, &shard->from, shard->from_len );
+
+	if ( shard->tcp->engine == TCP_ENGINE_EPOLL )
+	{
+		for ( i = 1; i < TCP_SHARD_ACCEPT_BATCH; i++ )
+		{
+			from_len = sizeof ( from );
+			fd = accept4 ( shard->listen_fd, ( struct sockaddr * ) &from, &from_len, SOCK_NONBLOCK | SOCK_CLOEXEC );
+			if ( fd < 0 )
+				break;
+			Shard_File ( shard, fd, &from, ( long ) from_len );
+		}
+		TCP_STATS_CALL ( 0, TCP_OP_ACCEPT, 0, i - 1 );
+	}
+
+	return Shard_Post_Accept ( shard );
+}
+
+/***************************************************************
+*
+* NAME:                           Shard_Main
+*
+* FUNCTION:             A shard's thread: its own engine, table and
+*                       event loop, until tcp_server_stop.
+*
+* RETURNS:              void * - 0
+***************************************************************/
+static void *Shard_Main ( void *argument )
+{
+	TCP_SHARD		*shard = ( TCP_SHARD * ) argument;
+	TCP_SERVER		*server = shard->server;
+	TCP_SERVER_CONFIG	*config = &server->config;
+	TCP_COMPLETION		 batch[TCP_COMPLETION_BATCH];
+	unsigned		 i;
+	int			 count;
+	int			 armed;
+#ifdef CPU_SET
+	cpu_set_t		 cpus;
+
+	if ( config->pin )
+	{
+		CPU_ZERO ( &cpus );
+		CPU_SET ( shard->cpu, &cpus );
+		pthread_setaffinity_np ( pthread_self ( ), sizeof ( cpus ), &cpus );
+	}
+#endif
+
+	if ( config->on_start )
+		config->on_start ( shard, config->context );
+
+	armed = Shard_Post_Accept ( shard ) == 0;
+	if ( !armed )
+		shard->error = errno;
+
+	while ( !server->stop )
+	{
+		count = shard->tcp->reap_completions ( batch, TCP_COMPLETION_BATCH, TCP_SHARD_WAIT );
+		if ( count < 0 )
+		{
+			/* nothing outstanding, not even the accept: try to re-arm */
+			armed = Shard_Post_Accept ( shard ) == 0;
+			if ( !armed )
+				usleep ( TCP_SHARD_WAIT * 10000 );
+			continue;
+		}
+
+		for ( i = 0; i < ( unsigned ) count; i++ )
+		{
+			if ( batch[i].sock == shard->listen_fd && batch[i].tag == TCP_SHARD_ACCEPT_TAG )
+			{
+				if ( Shard_Accept ( shard, &batch[i] ) < 0 )
+					shard->error = errno;
+			}
+			else if ( config->on_completion )
+				config->on_completion ( shard, &batch[i], config->context );
+		}
+	}
+
+	if ( config->on_stop )
+		config->on_stop ( shard, config->context );
+
+	/* the shard owns its connections outright, so it closes them */
+	for ( i = 0; i < shard->table->count; i++ )
+		FILE_CLOSE_ ( shard->table->fd[shard->table->live[i]] );
+	FILE_CLOSE_ ( shard->listen_fd );
+	shard->listen_fd = -1;
+
+	release_tcp ( shard->tcp );
+	shard->tcp = 0;
+	shard->table = 0;
+	tcp_thread_exit ( );
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Shard_Thread_Start
+*
+* FUNCTION:             Builds a shard's TCP and table on its own
+*                       thread, before the loop proper.
+*
+* RETURNS:              void * - 0
+***************************************************************/
+static void *Shard_Thread_Start ( void *argument )
+{
+	TCP_SHARD	*shard = ( TCP_SHARD * ) argument;
+	int		 capacity = shard->server->config.max_connections;
+
+	/* the engine is per thread, so the TCP has to be made here */
+	shard->tcp = intialize_tcp_engine ( shard->server->config.engine );
+	if ( shard->tcp )
+		shard->table = shard->tcp->conn_table =
+			conn_table_new ( capacity ? capacity : TCP_SHARD_CONNECTIONS );
+
+	if ( !shard->tcp || !shard->table )
+	{
+		shard->error = ENOMEM;
+		FILE_CLOSE_ ( shard->listen_fd );
+		shard->listen_fd = -1;
+		if ( shard->tcp )
+			release_tcp ( shard->tcp );
+		shard->tcp = 0;
+		tcp_thread_exit ( );
+		return 0;
+	}
+
+	return Shard_Main ( shard );
+}
+
+#endif // !__TANDEM
+
+/***************************************************************
+*
+* NAME:                           tcp_server_start
+*
+* FUNCTION:             Binds one listener per shard and starts the
+*                       shard threads. The config is copied.
+*
+* RETURNS:              TCP_SERVER * - 0 with errno set on failure,
+*                       EINVAL for an unknown tuning profile
+*                       (always 0 on Guardian)
+***************************************************************/
+TCP_SERVER *tcp_server_start ( TCP_SERVER_CONFIG *config )
+{
+#ifdef __TANDEM
+	( void ) config;
+	return 0;
+#else
+	TCP_SERVER	*server;
+	TCP_SHARD	*shard;
+	TCP_TUNE	 profile;
+	long		 cpus = sysconf ( _SC_NPROCESSORS_ONLN );
+	int		 count = config->shards;
+	int		 reuseport = 1;
+	int		 saved;
+	int		 i;
+
+	if ( cpus < 1 )
+		cpus = 1;
+	if ( count <= 0 )
+		count = ( int ) cpus;
+#ifndef SO_REUSEPORT
+	count = 1;
+	reuseport = 0;
+#endif
+
+	server = ( TCP_SERVER * ) calloc ( 1, sizeof ( TCP_SERVER ) );
+	if ( !server )
+		return 0;
+	server->config = *config;
+
+	server->tune = tune_number ( config->tuning );
+	if ( server->tune < 0 )
+	{
+		free ( server );
+		errno = EINVAL;
+		return 0;
+	}
+	if ( !server->config.backlog && tune_lookup ( config->tuning, &profile ) == 0
+	  && profile.backlog != TCP_TUNE_LEAVE )
+		server->config.backlog = profile.backlog;
+
+	server->shards = ( TCP_SHARD * ) calloc ( count, sizeof ( TCP_SHARD ) );
+	if ( !server->shards )
+	{
+		free ( server );
+		return 0;
+	}
+
+	for ( i = 0; i < count; i++ )
+	{
+		shard = &server->shards[i];
+		shard->index = i;
+		shard->cpu = ( int ) ( i % cpus );
+		shard->server = server;
+		shard->listen_fd = Shard_Listen ( &server->config, reuseport );
+		if ( shard->listen_fd < 0 )
+			goto fail;
+		server->count++;
+	}
+	config->port = server->config.port;
+
+	for ( i = 0; i < count; i++ )
+	{
+		shard = &server->shards[i];
+		if ( pthread_create ( &shard->thread, 0, Shard_Thread_Start, shard ) )
+		{
+			errno = EAGAIN;
+			goto fail;
+		}
+		shard->started = 1;
+	}
+
+	return server;
+
+fail:
+	saved = errno;
+	tcp_server_stop ( server );
+	errno = saved;
+	return 0;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_server_stop
+*
+* FUNCTION:             Stops every shard, waits for its thread and
+*                       frees the server. Each shard closes its own
+*                       connections and listener on the way out.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void tcp_server_stop ( TCP_SERVER *server )
+{
+#ifdef __TANDEM
+	( void ) server;
+#else
+	TCP_SHARD	*shard;
+	int		 i;
+
+	if ( !server )
+		return;
+
+	server->stop = 1;
+	for ( i = 0; i < server->count; i++ )
+	{
+		shard = &server->shards[i];
+		if ( shard->started )
+			pthread_join ( shard->thread, 0 );
+		else if ( shard->listen_fd >= 0 )
+			close ( shard->listen_fd );
+	}
+
+	free ( server->shards );
+	free ( server );
+#endif
+}
+
+#ifndef __TANDEM
+
+/***************************************************************
+*
+* NAME:                           Loopback_Shard_Start
+*
+* FUNCTION:             Gives a loopback shard one receive buffer
+*                       per connection slot; Loopback_Stop frees it.
+*
+***************************************************************/
+static void Loopback_Shard_Start ( TCP_SHARD *shard, void *context )
+{
+	TCP_LOOPBACK *loopback = ( TCP_LOOPBACK * ) context;
+
+	shard->user = calloc ( shard->table->capacity, loopback->slot );
+}
+
+static void Loopback_Shard_Stop ( TCP_SHARD *shard, void *context )
+{
+	( void ) context;
+	free ( shard->user );
+	shard->user = 0;
+}
+
+static char *Loopback_Slot ( TCP_SHARD *shard, TCP_LOOPBACK *loopback, TCP_HANDLE handle )
+{
+	return ( char * ) shard->user + ( size_t ) TCP_HANDLE_INDEX ( handle ) * loopback->slot;
+}
+
+/***************************************************************
+*
+* NAME:                           Loopback_Accept
+*
+* FUNCTION:             Starts reading a new connection.
+*
+* RETURNS:              int - 0 to keep it
+***************************************************************/
+static int Loopback_Accept ( TCP_SHARD *shard, TCP_HANDLE handle, void *context )
+{
+	TCP_LOOPBACK	*loopback = ( TCP_LOOPBACK * ) context;
+	int		 on = 1;
+
+	if ( !shard->user )
+		return 1;
+	setsockopt ( TCP_CONN_FD ( shard->table, handle ), IPPROTO_TCP, TCP_NODELAY, &on, sizeof ( on ) );
+
+	return conn_recv_nw ( shard->table, handle, Loopback_Slot ( shard, loopback, handle ), ( int ) loopback->slot ) < 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Loopback_Completion
+*
+* FUNCTION:             Echoes (or swallows) what came in and reads
+*                       again; closes on EOF or error.
+*
+***************************************************************/
+static void Loopback_Completion ( TCP_SHARD *shard, TCP_COMPLETION *completion, void *context )
+{
+	TCP_LOOPBACK	*loopback = ( TCP_LOOPBACK * ) context;
+	TCP_HANDLE	 handle = conn_complete ( shard->table, completion );
+	char		*slot;
+
+	if ( handle == TCP_HANDLE_NONE )
+		return;
+	slot = Loopback_Slot ( shard, loopback, handle );
+
+	if ( ( unsigned long ) completion->tag & TCP_CONN_TAG_SEND )
+	{
+		if ( completion->error )
+			goto close;
+		conn_recv_nw ( shard->table, handle, slot, ( int ) loopback->slot );
+		return;
+	}
+
+	if ( completion->error || completion->count <= 0 )
+		goto close;
+
+	if ( loopback->mode == TCP_LOOPBACK_SINK )
+	{
+		__atomic_add_fetch ( &loopback->sunk, completion->count, __ATOMIC_RELAXED );
+		conn_recv_nw ( shard->table, handle, slot, ( int ) loopback->slot );
+	}
+	else
+		conn_send_nw ( shard->table, handle, slot, ( int ) completion->count );
+	return;
+
+close:
+	FILE_CLOSE_ ( completion->sock );
+	conn_remove ( shard->table, handle );
+}
+
+#endif // !__TANDEM
+
+/***************************************************************
+*
+* NAME:                           tcp_loopback_start
+*
+* FUNCTION:             Starts an in-process echo or sink server
+*                       (loopback->mode) for the test tools, from
+*                       loopback->config with the handlers filled
+*                       in. A zero slot takes TCP_LOOPBACK_SLOT.
+*
+* RETURNS:              int - 0, -1 with errno set on failure
+***************************************************************/
+int tcp_loopback_start ( TCP_LOOPBACK *loopback )
+{
+#ifdef __TANDEM
+	( void ) loopback;
+	return -1;
+#else
+	if ( loopback->slot <= 0 )
+		loopback->slot = TCP_LOOPBACK_SLOT;
+	loopback->sunk = 0;
+
+	loopback->config.on_accept = Loopback_Accept;
+	loopback->config.on_completion = Loopback_Completion;
+	loopback->config.on_start = Loopback_Shard_Start;
+	loopback->config.on_stop = Loopback_Shard_Stop;
+	loopback->config.context = loopback;
+
+	loopback->server = tcp_server_start ( &loopback->config );
+	return loopback->server ? 0 : -1;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_loopback_stop
+*
+* FUNCTION:             Stops a server tcp_loopback_start started;
+*                       nothing if it never started.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void tcp_loopback_stop ( TCP_LOOPBACK *loopback )
+{
+	tcp_server_stop ( loopback->server );
+	loopback->server = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,177 @@
+/************************************************************************************
+*		FILE:		"nsshard.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Sharded server mode for Linux: N threads, each with
+*					its own SO_REUSEPORT listener, nowait engine and
+*					connection table, optionally pinned to a CPU. The
+*					kernel spreads incoming connections over the
+*					listeners, and a connection stays with the shard
+*					that accepted it, so the data path takes no locks.
+*
+*		Notes:		Handlers run on the shard's own thread and must
+*					only touch that shard's connections. Use
+*					shard->table / shard->tcp to post I/O; completions
+*					come back to the same shard.
+*
+*					config.tuning names a socket tuning profile
+*					(nstune.h) for every accepted socket, applied before
+*					on_accept; what it fell short of is in the
+*					connection's TCP_CONN_COLD::tune_short.
+*
+*					TCP_LOOPBACK is a ready-made echo or sink server on
+*					top of this, for benchmarks and load tests that need
+*					nothing outside the process.
+*
+*					Without SO_REUSEPORT a single shard is started.
+*					Guardian processes are single threaded; there, run
+*					one server process per CPU instead (tcp_server_start
+*					returns 0).
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.9.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Tuning profile for accepted sockets
+*		1.25.1	  10/17/26		TCP_LOOPBACK echo/sink server
+*************************************************************************************/
+
+#ifndef _NSSHARDH_INCLUDE_
+#define _NSSHARDH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nsctabh"
+#else
+#include "NSCTAB.h"
+#include <pthread.h>
+#endif
+
+
+/* tag of the listener's accept_nw */
+#define TCP_SHARD_ACCEPT_TAG		( -1L )
+
+struct tcp_shard;
+struct tcp_server;
+
+/* a new connection is in the shard's table; return non-zero to refuse
+*  it (the library then closes it) */
+typedef int (*TCP_SHARD_ACCEPT)			(struct tcp_shard *, TCP_HANDLE, void *);
+/* any other completion reaped by the shard */
+typedef void (*TCP_SHARD_COMPLETION)		(struct tcp_shard *, TCP_COMPLETION *, void *);
+/* shard start-up / shut-down, on the shard's thread */
+typedef void (*TCP_SHARD_EVENT)			(struct tcp_shard *, void *);
+
+/***************************************************************
+*
+*	Name:		TCP_SERVER_CONFIG
+*	Type:		struct
+*	Purpose:	What tcp_server_start needs. Zero fields take
+*				the defaults noted.
+*
+***************************************************************/
+typedef struct tcp_server_config
+{
+	TCP_IPADDR			ipaddr;		/* "" = any */
+	TCP_PORT			port;
+	int				shards;		/* 0 = one per online CPU */
+	int				pin;		/* pin shard i to CPU i */
+	int				backlog;	/* 0 = the profile's, else SOMAXCONN */
+	int				max_connections;/* per shard, 0 = 4096 */
+	int				engine;		/* TCP_ENGINE_* */
+	const char			*tuning;	/* profile for accepted sockets, 0 = none; see nstune.h */
+	TCP_SHARD_ACCEPT		on_accept;
+	TCP_SHARD_COMPLETION		on_completion;
+	TCP_SHARD_EVENT			on_start;
+	TCP_SHARD_EVENT			on_stop;
+	void				*context;
+} TCP_SERVER_CONFIG;
+
+/***************************************************************
+*
+*	Name:		TCP_SHARD
+*	Type:		struct
+*	Purpose:	One shard: its thread, listener, TCP (with
+*				the thread's engine) and connections. user
+*				is free for the application.
+*
+***************************************************************/
+typedef struct tcp_shard
+{
+	int				index;
+	int				cpu;
+	int				listen_fd;
+	TCP				*tcp;
+	TCP_CONN_TABLE			*table;
+	struct tcp_server		*server;
+	struct sockaddr_in		from;
+	long				from_len;
+	long				accepted;
+	long				refused;
+	int				error;
+	void				*user;
+#ifndef __TANDEM
+	pthread_t			thread;
+	int				started;
+#endif
+} TCP_SHARD;
+
+/***************************************************************
+*
+*	Name:		TCP_SERVER
+*	Type:		struct
+*	Purpose:	A running sharded server.
+*
+***************************************************************/
+typedef struct tcp_server
+{
+	TCP_SERVER_CONFIG		config;
+	TCP_SHARD			*shards;
+	int				count;
+	int				tune;		/* config.tuning's number */
+	volatile int			stop;
+} TCP_SERVER;
+
+/* what a loopback server does with what it reads */
+#define TCP_LOOPBACK_ECHO		0
+#define TCP_LOOPBACK_SINK		1
+
+/***************************************************************
+*
+*	Name:		TCP_LOOPBACK
+*	Type:		struct
+*	Purpose:	An in-process echo or sink server. Zero it, set
+*				mode, slot and config's address, shards,
+*				max_connections and engine, then call
+*				tcp_loopback_start; config.port then holds the
+*				port. The handlers and context are its own.
+*
+***************************************************************/
+typedef struct tcp_loopback
+{
+	TCP_SERVER			*server;
+	TCP_SERVER_CONFIG		config;
+	int				mode;		/* TCP_LOOPBACK_* */
+	long				slot;		/* receive buffer per connection, 0 = 16384 */
+	long				sunk;		/* bytes swallowed in sink mode */
+} TCP_LOOPBACK;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+TCP_SERVER *tcp_server_start ( TCP_SERVER_CONFIG *config );
+void tcp_server_stop ( TCP_SERVER *server );
+int tcp_loopback_start ( TCP_LOOPBACK *loopback );
+void tcp_loopback_stop ( TCP_LOOPBACK *loopback );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSSHARDH_INCLUDE_
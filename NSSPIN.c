@@ -0,0 +1,195 @@
+/************************************************************************************
+*		FILE:		"nsspin.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Hybrid spin / blocking wait. See nsspin.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nsspinh"
+#include "=nsstatsh"
+#else
+#include "NSSPIN.h"
+#include "NSSTATS.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __TANDEM
+#define SPIN_LOAD(p)			( *( p ) )
+#define SPIN_STORE(p, v)		( *( p ) = ( v ) )
+#else
+#define SPIN_LOAD(p)			__atomic_load_n ( p, __ATOMIC_RELAXED )
+#define SPIN_STORE(p, v)		__atomic_store_n ( p, v, __ATOMIC_RELAXED )
+#endif
+
+/* EWMA weight of a new wait: 1 / SPIN_WEIGHT */
+#define SPIN_WEIGHT			8
+
+static int		spin_mode;
+static long		spin_usec;
+static unsigned		spin_generation;	/* spin_set count */
+
+/* the calling thread's recent waits */
+static TCP_THREAD_LOCAL long long	spin_gap;	/* usual time of those ended within spin_usec */
+static TCP_THREAD_LOCAL int		spin_catch;	/* share of them ended within spin_usec, of 1024 */
+static TCP_THREAD_LOCAL unsigned	spin_seen;	/* spin_generation they were timed under */
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Spin_Observe
+*
+* FUNCTION:             Adds one wait that took gap microseconds to
+*                       the thread's timing. A wait that timed out
+*                       within the budget says nothing and is left
+*                       out.
+*
+* RETURNS:                         nothing
+***************************************************************/
+static void Spin_Observe ( long limit, long long gap, int arrived )
+{
+	int caught = gap <= limit;
+
+	if ( !arrived && caught )
+		return;
+
+	if ( caught )
+		spin_gap += ( gap - spin_gap ) / SPIN_WEIGHT;
+	spin_catch += ( ( caught ? 1024 : 0 ) - spin_catch ) / SPIN_WEIGHT;
+}
+
+/***************************************************************
+*
+* NAME:                           spin_set
+*
+* FUNCTION:             Picks how reap_completions waits, for every
+*                       thread: TCP_SPIN_OFF, TCP_SPIN_FIXED (spin
+*                       usec first) or TCP_SPIN_ADAPTIVE (spin up to
+*                       usec, as the waits seen call for). Threads
+*                       start their timing over.
+*
+* RETURNS:              int - 0, or -1 for a bad mode or usec
+***************************************************************/
+int spin_set ( int mode, long usec )
+{
+	if ( mode < TCP_SPIN_OFF || mode > TCP_SPIN_ADAPTIVE
+	  || ( mode != TCP_SPIN_OFF && ( usec <= 0 || usec > TCP_SPIN_MAX_USEC ) ) )
+		return -1;
+
+	SPIN_STORE ( &spin_usec, mode == TCP_SPIN_OFF ? 0L : usec );
+	SPIN_STORE ( &spin_mode, mode );
+	SPIN_STORE ( &spin_generation, SPIN_LOAD ( &spin_generation ) + 1 );
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           spin_budget
+*
+* FUNCTION:             How long the calling thread's next wait
+*                       spins before it blocks.
+*
+* RETURNS:              long - microseconds, 0 for no spin, -1 when
+*                       spinning is off
+***************************************************************/
+long spin_budget ( void )
+{
+	int		mode = SPIN_LOAD ( &spin_mode );
+	long		limit = SPIN_LOAD ( &spin_usec );
+	unsigned	generation = SPIN_LOAD ( &spin_generation );
+	long long	budget;
+
+	if ( mode == TCP_SPIN_OFF )
+		return -1;
+	if ( mode == TCP_SPIN_FIXED )
+		return limit;
+
+	if ( spin_seen != generation )
+	{
+		/* start hopeful: spin the whole budget until timed */
+		spin_gap = limit / 2;
+		spin_catch = 1024;
+		spin_seen = generation;
+	}
+	if ( spin_catch < TCP_SPIN_CATCH )
+		return 0;
+
+	budget = spin_gap * 2 + 1;
+	return budget < limit ? ( long ) budget : limit;
+}
+
+/***************************************************************
+*
+* NAME:                           spin_reap
+*
+* FUNCTION:             One wait of reap_completions: polls with
+*                       reap for up to the spin budget, then waits
+*                       with it for what is left of timelimit
+*                       (0.01 sec units, -1 = forever). The time the
+*                       wait took feeds the adaptive budget and the
+*                       spin counters.
+*
+* RETURNS:              int - as reap: completions stored, 0 if the
+*                       time limit passed, -1 when nothing is
+*                       outstanding or the wait failed
+***************************************************************/
+int spin_reap ( TCP_COMPLETION *completions, int max, long timelimit, TCP_SPIN_REAP reap )
+{
+	long long	start;
+	long long	now;
+	long long	spun;
+	long		budget;
+	int		reaped = 0;
+
+	if ( !timelimit || ( budget = spin_budget ( ) ) < 0 )
+		return reap ( completions, max, timelimit );
+
+	if ( timelimit > 0 && budget > timelimit * 10000 )
+		budget = timelimit * 10000;
+
+	start = now = tcp_clock_usec ( );
+	while ( budget > 0 )
+	{
+		reaped = reap ( completions, max, 0 );
+		now = tcp_clock_usec ( );
+		if ( reaped || now - start >= budget )
+			break;
+	}
+	if ( reaped < 0 )
+		return reaped;
+	spun = now - start;
+	TCP_STATS_SPIN ( budget, ( long ) spun, reaped > 0 );
+
+	if ( !reaped )
+	{
+		if ( timelimit > 0 )
+			timelimit -= ( long ) ( spun / 10000 );
+		reaped = reap ( completions, max, timelimit );
+		if ( reaped < 0 )
+			return reaped;
+		now = tcp_clock_usec ( );
+	}
+
+	if ( SPIN_LOAD ( &spin_mode ) == TCP_SPIN_ADAPTIVE )
+		Spin_Observe ( SPIN_LOAD ( &spin_usec ), now - start, reaped > 0 );
+	return reaped;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+/************************************************************************************
+*		FILE:		"nsspin.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Hybrid wait for reap_completions: poll for completions
+*					for a short spin budget, then fall back to the
+*					blocking wait. A completion that arrives within the
+*					budget is picked up without the wakeup latency of a
+*					blocking wait; an idle thread still sleeps.
+*
+*		Notes:		set_spin_wait ( TCP_SPIN_FIXED, usec ) spins for usec
+*					microseconds before every blocking wait.
+*					TCP_SPIN_ADAPTIVE sets the budget from how long each
+*					thread's recent waits took to end: it spins only
+*					while most waits (TCP_SPIN_CATCH / 1024 of them)
+*					ended within usec, and then for twice the usual time
+*					those took, up to usec. Once waits grow longer it
+*					stops spinning, still times the blocking waits, and
+*					starts again when they shorten. TCP_SPIN_OFF (the
+*					default) waits as before and costs nothing.
+*
+*					The setting is process wide; the timing and budget
+*					are per thread. spin_wait_budget gives the calling
+*					thread's budget now. Waits with a time limit of 0
+*					never spin, and no spin runs past the time limit.
+*
+*					The spins are counted in TCP_STATS (nsstats.h):
+*					spin_waits that spun, spin_hits of those ended by a
+*					completion while spinning, spin_skips where the
+*					adaptive budget was 0, and spin_usec / spin_budget
+*					the time spun and the budgets given, summed.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifndef _NSSPINH_INCLUDE_
+#define _NSSPINH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* set_spin_wait modes */
+enum
+{
+	TCP_SPIN_OFF		= 0,
+	TCP_SPIN_FIXED		= 1,
+	TCP_SPIN_ADAPTIVE	= 2
+};
+
+/* longest spin budget, microseconds (one timelimit unit) */
+#define TCP_SPIN_MAX_USEC		10000
+
+/* adaptive: spin while at least this share (of 1024) of waits
+*  ended within the budget */
+#define TCP_SPIN_CATCH			512
+
+/* one wait without spinning: Reap_Batch in nstcp.c */
+typedef int (*TCP_SPIN_REAP)			(TCP_COMPLETION *, int, long);
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int spin_set ( int mode, long usec );
+long spin_budget ( void );
+
+/* called by reap_completions */
+int spin_reap ( TCP_COMPLETION *completions, int max, long timelimit, TCP_SPIN_REAP reap );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSSPINH_INCLUDE_
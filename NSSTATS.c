@@ -0,0 +1,495 @@
+/************************************************************************************
+*		FILE:		"nsstats.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Operation counters. See nsstats.h.
+*
+*		Notes:		Only the owning thread writes a block, so a counter
+*					update is a plain load and store; on Linux the store
+*					is a relaxed atomic so tcp_stats_snapshot never sees
+*					half a word. Blocks are never freed, which is what
+*					lets the snapshot walk the list without a lock.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.11.0	  10/17/26		Initial Release
+*		1.25.0	  10/17/26		tcp_stats_spin
+*		1.25.1	  10/17/26		No shared spare block when calloc fails
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nsstatsh"
+#else
+#include "NSSTATS.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						TYPES AND CONSTANTS
+***************************************************************************************/
+
+/* one thread's counters; in_use is clear once the thread has left */
+typedef struct tcp_stats_block
+{
+	TCP_STATS			stats;
+	struct tcp_stats_block		*next;
+	int				in_use;
+} TCP_STATS_BLOCK;
+
+#ifdef __TANDEM
+#define STATS_LOAD(x)			( x )
+#define STATS_ADD(x, n)			( ( x ) += ( n ) )
+#else
+#define STATS_LOAD(x)			__atomic_load_n ( &( x ), __ATOMIC_RELAXED )
+#define STATS_ADD(x, n)			__atomic_store_n ( &( x ), ( x ) + ( n ), __ATOMIC_RELAXED )
+#endif
+
+static TCP_STATS_BLOCK *stats_blocks;
+static TCP_THREAD_LOCAL TCP_STATS_BLOCK *stats_local;
+static TCP_THREAD_LOCAL TCP_STATS stats_lost;	/* where a thread with no block counts */
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Stats_Local
+*
+* FUNCTION:             The calling thread's block. The first call
+*                       on a thread takes over a block a finished
+*                       thread left behind, or adds a new one.
+*
+* NOTE:                 If no block can be allocated the thread
+*                       counts into its own stats_lost, which no
+*                       snapshot reads, and tries again next call.
+*                       Sharing one block would take atomic adds.
+*
+* RETURNS:              TCP_STATS *
+***************************************************************/
+static TCP_STATS *Stats_Local ( void )
+{
+	TCP_STATS_BLOCK *block;
+
+	if ( stats_local )
+		return &stats_local->stats;
+
+#ifdef __TANDEM
+	block = stats_blocks;
+	if ( !block )
+	{
+		block = ( TCP_STATS_BLOCK * ) calloc ( 1, sizeof ( TCP_STATS_BLOCK ) );
+		if ( !block )
+			return &stats_lost;
+		stats_blocks = block;
+	}
+	block->in_use = 1;
+#else
+	for ( block = __atomic_load_n ( &stats_blocks, __ATOMIC_ACQUIRE ); block; block = block->next )
+	{
+		int idle = 0;
+
+		if ( !__atomic_load_n ( &block->in_use, __ATOMIC_RELAXED )
+		  && __atomic_compare_exchange_n ( &block->in_use, &idle, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+			break;
+	}
+
+	if ( !block )
+	{
+		block = ( TCP_STATS_BLOCK * ) calloc ( 1, sizeof ( TCP_STATS_BLOCK ) );
+		if ( !block )
+			return &stats_lost;
+		block->in_use = 1;
+		block->next = __atomic_load_n ( &stats_blocks, __ATOMIC_RELAXED );
+		while ( !__atomic_compare_exchange_n ( &stats_blocks, &block->next, block, 1
+											 , __ATOMIC_RELEASE, __ATOMIC_RELAXED ) )
+			;
+	}
+#endif
+
+	stats_local = block;
+	return &block->stats;
+}
+
+/***************************************************************
+*
+* NAME:                           Stats_Bucket
+*
+* FUNCTION:             Latency bucket for a time: the number of
+*                       significant bits in usec.
+*
+* RETURNS:              int - 0 .. TCP_STATS_BUCKETS - 1
+***************************************************************/
+static int Stats_Bucket ( long long usec )
+{
+	int bucket = 0;
+
+	while ( usec > 0 && bucket < TCP_STATS_BUCKETS - 1 )
+	{
+		usec >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+/***************************************************************
+*
+* NAME:                           Stats_Listen_Overflows
+*
+* FUNCTION:             TcpExt ListenOverflows from /proc/net/netstat:
+*                       connections the host dropped because an
+*                       accept queue was full.
+*
+* RETURNS:              long - 0 where it can't be read
+***************************************************************/
+static long Stats_Listen_Overflows ( void )
+{
+#ifdef __TANDEM
+	return 0;
+#else
+	char	 names[8192];
+	char	 values[8192];
+	char	*name_save;
+	char	*value_save;
+	char	*name;
+	char	*value;
+	long	 overflows = 0;
+	FILE	*file = fopen ( "/proc/net/netstat", "r" );
+
+	if ( !file )
+		return 0;
+
+	/* pairs of lines: "TcpExt: names..." then "TcpExt: values..." */
+	while ( fgets ( names, sizeof ( names ), file ) && fgets ( values, sizeof ( values ), file ) )
+	{
+		if ( strncmp ( names, "TcpExt:", 7 ) )
+			continue;
+
+		name = strtok_r ( names, " \n", &name_save );
+		value = strtok_r ( values, " \n", &value_save );
+		while ( name && value )
+		{
+			if ( !strcmp ( name, "ListenOverflows" ) )
+			{
+				overflows = atol ( value );
+				break;
+			}
+			name = strtok_r ( 0, " \n", &name_save );
+			value = strtok_r ( 0, " \n", &value_save );
+		}
+		break;
+	}
+
+	fclose ( file );
+	return overflows;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_call
+*
+* FUNCTION:             Counts one blocking call that returned
+*                       status, asked bytes being the length asked
+*                       for on a send or receive.
+*
+* NOTE:                 conn may be 0. errno must still be the
+*                       call's.
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_stats_call ( TCP_CONN_STATS *conn, int op, long asked, long status )
+{
+	TCP_STATS	*stats = Stats_Local ( );
+	int		 again;
+
+	STATS_ADD ( stats->calls[op], 1 );
+	if ( conn )
+	{
+		if ( op == TCP_OP_SEND )
+			conn->sends++;
+		else if ( op == TCP_OP_RECV )
+			conn->recvs++;
+	}
+
+	if ( status < 0 )
+	{
+		again = errno == EAGAIN || errno == EWOULDBLOCK;
+		if ( again )
+			STATS_ADD ( stats->again, 1 );
+		else
+			STATS_ADD ( stats->errors[op], 1 );
+		if ( conn )
+		{
+			if ( again )
+				conn->again++;
+			else
+				conn->errors++;
+		}
+		return;
+	}
+
+	if ( op == TCP_OP_SEND )
+	{
+		STATS_ADD ( stats->send_bytes, status );
+		if ( status < asked )
+			STATS_ADD ( stats->partial_sends, 1 );
+		if ( conn )
+		{
+			conn->send_bytes += status;
+			if ( status < asked )
+				conn->partial_sends++;
+		}
+	}
+	else if ( op == TCP_OP_RECV )
+	{
+		STATS_ADD ( stats->recv_bytes, status );
+		if ( conn )
+			conn->recv_bytes += status;
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_submit
+*
+* FUNCTION:             Counts one nowait submission. Bytes are
+*                       counted when it completes.
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_stats_submit ( TCP_CONN_STATS *conn, int op, int status )
+{
+	TCP_STATS *stats = Stats_Local ( );
+
+	STATS_ADD ( stats->calls[op], 1 );
+	STATS_ADD ( stats->nowait, 1 );
+	if ( status < 0 )
+		STATS_ADD ( stats->errors[op], 1 );
+
+	if ( conn )
+	{
+		if ( op == TCP_OP_SEND )
+			conn->sends++;
+		else if ( op == TCP_OP_RECV )
+			conn->recvs++;
+		if ( status < 0 )
+			conn->errors++;
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_complete
+*
+* FUNCTION:             Counts a batch of reaped completions, and
+*                       their latency when it was measured.
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_stats_complete ( TCP_COMPLETION *completions, int count )
+{
+	TCP_STATS	*stats;
+	int		 i;
+	int		 op;
+
+	if ( count <= 0 )
+		return;
+
+	stats = Stats_Local ( );
+	STATS_ADD ( stats->completions, count );
+
+	for ( i = 0; i < count; i++ )
+	{
+		op = completions[i].op;
+		if ( completions[i].error )
+			STATS_ADD ( stats->errors[op], 1 );
+		else if ( op == TCP_OP_SEND )
+		{
+			STATS_ADD ( stats->send_bytes, completions[i].count );
+			if ( completions[i].count < completions[i].length )
+				STATS_ADD ( stats->partial_sends, 1 );
+		}
+		else if ( op == TCP_OP_RECV )
+			STATS_ADD ( stats->recv_bytes, completions[i].count );
+
+		if ( completions[i].usec >= 0 )
+			STATS_ADD ( stats->latency[op][Stats_Bucket ( completions[i].usec )], 1 );
+	}
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_conn_complete
+*
+* FUNCTION:             Adds a completion to its connection's
+*                       counters, for callers that can map one to
+*                       the other (conn_complete).
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_stats_conn_complete ( TCP_CONN_STATS *conn, int op, TCP_COMPLETION *completion )
+{
+	if ( completion->error )
+		conn->errors++;
+	else if ( op == TCP_OP_SEND )
+	{
+		conn->send_bytes += completion->count;
+		if ( completion->count < completion->length )
+			conn->partial_sends++;
+	}
+	else if ( op == TCP_OP_RECV )
+		conn->recv_bytes += completion->count;
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_spin
+*
+* FUNCTION:             Counts the spin before one wait: budget
+*                       microseconds given (0 = skipped), spun
+*                       taken, and whether a completion came in it.
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_stats_spin ( long budget, long spun, int hit )
+{
+	TCP_STATS *stats = Stats_Local ( );
+
+	if ( !budget )
+	{
+		STATS_ADD ( stats->spin_skips, 1 );
+		return;
+	}
+
+	STATS_ADD ( stats->spin_waits, 1 );
+	STATS_ADD ( stats->spin_usec, spun );
+	STATS_ADD ( stats->spin_budget, budget );
+	if ( hit )
+		STATS_ADD ( stats->spin_hits, 1 );
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_snapshot
+*
+* FUNCTION:             Adds up every thread's counters into stats,
+*                       without stopping any of them.
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_stats_snapshot ( TCP_STATS *stats )
+{
+	TCP_STATS_BLOCK	*block;
+	long		*from;
+	long		*to = ( long * ) stats;
+	size_t		 words = sizeof ( TCP_STATS ) / sizeof ( long );
+	size_t		 i;
+
+	memset ( stats, 0, sizeof ( *stats ) );
+
+#ifdef __TANDEM
+	block = stats_blocks;
+#else
+	block = __atomic_load_n ( &stats_blocks, __ATOMIC_ACQUIRE );
+#endif
+	for ( ; block; block = block->next )
+	{
+		from = ( long * ) &block->stats;
+		for ( i = 0; i < words; i++ )
+			to[i] += STATS_LOAD ( from[i] );
+	}
+
+	stats->listen_overflows = Stats_Listen_Overflows ( );
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_latency
+*
+* FUNCTION:             Turns submit-to-completion timing of nowait
+*                       operations on or off, for every thread.
+*                       It costs a clock read per submission.
+*
+* RETURNS:              int - 0, -1 where it isn't available (Guardian)
+***************************************************************/
+int tcp_stats_latency ( int on )
+{
+#ifdef __TANDEM
+	( void ) on;
+	return -1;
+#else
+	nslx_set_timing ( on );
+	return 0;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_percentile
+*
+* FUNCTION:             Latency below which fraction (0.5, 0.99,
+*                       0.999, ...) of the timed op completions
+*                       fell, to the resolution of the buckets.
+*
+* RETURNS:              long long - microseconds, the top of the
+*                       bucket; -1 if nothing was timed
+***************************************************************/
+long long tcp_stats_percentile ( const TCP_STATS *stats, int op, double fraction )
+{
+	long	total = 0;
+	long	seen = 0;
+	double	want;
+	int	bucket;
+
+	for ( bucket = 0; bucket < TCP_STATS_BUCKETS; bucket++ )
+		total += stats->latency[op][bucket];
+	if ( !total )
+		return -1;
+
+	want = fraction * total;
+	for ( bucket = 0; bucket < TCP_STATS_BUCKETS - 1; bucket++ )
+	{
+		seen += stats->latency[op][bucket];
+		if ( seen >= want )
+			break;
+	}
+
+	return ( 1LL << bucket ) - 1;
+}
+
+/***************************************************************
+*
+* NAME:                           tcp_stats_thread_exit
+*
+* FUNCTION:             Hands the calling thread's block on to the
+*                       next new thread (from tcp_thread_exit).
+*
+* RETURNS:              nothing
+***************************************************************/
+void tcp_stats_thread_exit ( void )
+{
+	if ( !stats_local )
+		return;
+
+#ifdef __TANDEM
+	stats_local->in_use = 0;
+#else
+	__atomic_store_n ( &stats_local->in_use, 0, __ATOMIC_RELEASE );
+#endif
+	stats_local = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+/************************************************************************************
+*		FILE:		"nsstats.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Operation counters: calls, errors, EAGAINs, bytes and
+*					partial sends for every TCP call, per connection
+*					(TCP_CONNECTION_INFO::stats) and for the process,
+*					plus an optional submit-to-completion latency
+*					histogram for nowait operations.
+*
+*		Notes:		Each thread counts into a block of its own, so the
+*					hot path takes no lock and shares no cache line.
+*					tcp_stats_snapshot adds the blocks up while traffic
+*					carries on; every counter is read whole, but the
+*					snapshot as a set is not taken at one instant.
+*
+*					A thread's block goes back on the list at
+*					tcp_thread_exit and the next new thread carries on
+*					counting in it, so totals never go backwards.
+*
+*					Build with -DNSTCP_NO_STATS to compile the counting
+*					out of the library.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.11.0	  10/17/26		Initial Release
+*		1.25.0	  10/17/26		Spin-wait counters (nsspin.c)
+*************************************************************************************/
+
+#ifndef _NSSTATSH_INCLUDE_
+#define _NSSTATSH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* latency buckets: bucket b holds times below 2^b microseconds
+*  (and at least 2^(b-1)); the last one takes everything longer */
+#define TCP_STATS_BUCKETS		32
+
+/***************************************************************
+*
+*	Name:		TCP_STATS
+*	Type:		struct
+*	Purpose:	Process-wide counters, indexed by TCP_OP_*
+*				where there is one per operation kind. calls
+*				counts blocking calls and nowait submissions.
+*				Every member is a long, so blocks can be
+*				added up a word at a time.
+*
+*				listen_overflows is the host's count of
+*				connections dropped on a full accept queue
+*				(Linux, read when the snapshot is taken).
+*
+*				spin_* count the spinning part of waits; see
+*				nsspin.h. spin_budget / spin_waits is the
+*				mean budget, spin_usec / spin_waits the mean
+*				time spun.
+*
+***************************************************************/
+typedef struct tcp_stats
+{
+	long				calls[TCP_OP_COUNT];
+	long				errors[TCP_OP_COUNT];
+	long				again;		/* EAGAIN / EWOULDBLOCK */
+	long				send_bytes;
+	long				recv_bytes;
+	long				partial_sends;
+	long				nowait;		/* nowait submissions */
+	long				completions;
+	long				listen_overflows;
+	long				spin_waits;	/* waits that spun */
+	long				spin_hits;	/* ... and got a completion spinning */
+	long				spin_skips;	/* waits the adaptive budget didn't spin */
+	long				spin_usec;
+	long				spin_budget;	/* microseconds */
+	long				latency[TCP_OP_COUNT][TCP_STATS_BUCKETS];
+} TCP_STATS;
+
+/* hooks the library's own calls go through */
+#ifdef NSTCP_NO_STATS
+#define TCP_STATS_CALL(c, op, asked, status)	( ( void ) 0 )
+#define TCP_STATS_SUBMIT(c, op, status)		( ( void ) 0 )
+#define TCP_STATS_COMPLETE(c, n)		( ( void ) 0 )
+#define TCP_STATS_CONN_COMPLETE(c, op, x)	( ( void ) 0 )
+#define TCP_STATS_SPIN(budget, spun, hit)	( ( void ) 0 )
+#else
+#define TCP_STATS_CALL(c, op, asked, status)	tcp_stats_call ( c, op, asked, status )
+#define TCP_STATS_SUBMIT(c, op, status)		tcp_stats_submit ( c, op, status )
+#define TCP_STATS_COMPLETE(c, n)		tcp_stats_complete ( c, n )
+#define TCP_STATS_CONN_COMPLETE(c, op, x)	tcp_stats_conn_complete ( c, op, x )
+#define TCP_STATS_SPIN(budget, spun, hit)	tcp_stats_spin ( budget, spun, hit )
+#endif
+
+/**********************************************************
+*		Function Prototype Definition(s)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void tcp_stats_snapshot ( TCP_STATS *stats );
+int tcp_stats_latency ( int on );
+long long tcp_stats_percentile ( const TCP_STATS *stats, int op, double fraction );
+
+/* counting, called by the library */
+void tcp_stats_call ( TCP_CONN_STATS *conn, int op, long asked, long status );
+void tcp_stats_submit ( TCP_CONN_STATS *conn, int op, int status );
+void tcp_stats_complete ( TCP_COMPLETION *completions, int count );
+void tcp_stats_conn_complete ( TCP_CONN_STATS *conn, int op, TCP_COMPLETION *completion );
+void tcp_stats_spin ( long budget, long spun, int hit );
+void tcp_stats_thread_exit ( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSSTATSH_INCLUDE_
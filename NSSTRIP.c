@@ -0,0 +1,244 @@
+/************************************************************************************
+*		FILE:		"nsstrip.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Striping sockets over several stacks. See nsstrip.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.21.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nsstriph"
+#else
+#include "NSSTRIP.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __TANDEM
+#define STRIPE_LOAD(p)			( *( p ) )
+#define STRIPE_ADD(p, v)		( ( *( p ) += ( v ) ) - ( v ) )
+#else
+#define STRIPE_LOAD(p)			__atomic_load_n ( p, __ATOMIC_RELAXED )
+#define STRIPE_ADD(p, v)		__atomic_fetch_add ( p, v, __ATOMIC_RELAXED )
+#endif
+
+static TCP_STRIPE	stripes[TCP_STRIPE_MAX];
+static int		stripe_count;
+static int		stripe_policy;
+static unsigned		stripe_cursor;
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Stripe_Take
+*
+* FUNCTION:             Counts one more socket on stack index and
+*                       marks the connection with it.
+*
+***************************************************************/
+static void Stripe_Take ( TCP_CONNECTION_INFO *connection, int index )
+{
+	STRIPE_ADD ( &stripes[index].open, 1 );
+	STRIPE_ADD ( &stripes[index].assigned, 1 );
+	connection->stripe = index + 1;
+}
+
+/***************************************************************
+*
+* NAME:                           Stripe_Pick
+*
+* FUNCTION:             The stack for a new socket: the next in
+*                       turn, or with TCP_STRIPE_LEAST_LOADED the one
+*                       with the fewest open, looking from the next
+*                       in turn so that ties are spread too.
+*
+* RETURNS:              int - the stack's index
+***************************************************************/
+static int Stripe_Pick ( void )
+{
+	int	count = stripe_count;
+	int	start = ( int ) ( STRIPE_ADD ( &stripe_cursor, 1 ) % ( unsigned ) count );
+	int	best = start;
+	int	i;
+	int	k;
+
+	if ( stripe_policy == TCP_STRIPE_LEAST_LOADED )
+		for ( i = 1; i < count; i++ )
+		{
+			k = ( start + i ) % count;
+			if ( STRIPE_LOAD ( &stripes[k].open ) < STRIPE_LOAD ( &stripes[best].open ) )
+				best = k;
+		}
+
+	return best;
+}
+
+/***************************************************************
+*
+* NAME:                           stripe_set
+*
+* FUNCTION:             Spreads new sockets over count stacks with
+*                       policy (TCP_STRIPE_*): TCP/IP process names
+*                       on Guardian, local IPv4 source addresses on
+*                       Linux. count 0 turns striping off.
+*
+* NOTE:                 Not while sockets are being made or closed.
+*
+* RETURNS:              int - 0, or -1 on bad arguments
+***************************************************************/
+int stripe_set ( char **names, int count, int policy )
+{
+	TCP_STRIPE	set[TCP_STRIPE_MAX];
+	int		i;
+
+	if ( count < 0 || count > TCP_STRIPE_MAX || ( count && !names )
+	  || ( policy != TCP_STRIPE_ROUND_ROBIN && policy != TCP_STRIPE_LEAST_LOADED ) )
+		return -1;
+
+	memset ( set, 0, sizeof ( set ) );
+	for ( i = 0; i < count; i++ )
+	{
+		if ( !names[i] || strlen ( names[i] ) >= sizeof ( TCP_PROC_NAME ) )
+			return -1;
+		strcpy ( set[i].name, names[i] );
+#ifndef __TANDEM
+		if ( inet_pton ( AF_INET, names[i], &set[i].address ) != 1 )
+			return -1;
+#endif
+	}
+
+	memcpy ( stripes, set, sizeof ( stripes ) );
+	stripe_policy = policy;
+	stripe_cursor = 0;
+	stripe_count = count;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           stripe_snapshot
+*
+* FUNCTION:             Copies out up to max stacks with their
+*                       loads.
+*
+* RETURNS:              int - stacks in the stripe
+***************************************************************/
+int stripe_snapshot ( TCP_STRIPE *out, int max )
+{
+	int i;
+
+	for ( i = 0; i < stripe_count && i < max; i++ )
+	{
+		out[i] = stripes[i];
+		out[i].open = STRIPE_LOAD ( &stripes[i].open );
+		out[i].assigned = STRIPE_LOAD ( &stripes[i].assigned );
+	}
+
+	return stripe_count;
+}
+
+/***************************************************************
+*
+* NAME:                           stripe_socket
+*
+* FUNCTION:             On Guardian, points the socket about to be
+*                       made at the connection's stack, picking one
+*                       if it has none. Linux stripes at connect
+*                       instead. Called by get_sock / get_sock_nw.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void stripe_socket ( TCP_CONNECTION_INFO *connection )
+{
+#ifdef __TANDEM
+	int index;
+
+	if ( !stripe_count )
+		return;
+
+	index = connection->stripe > 0 && connection->stripe <= stripe_count
+		  ? connection->stripe - 1 : Stripe_Pick ( );
+	Stripe_Take ( connection, index );
+	socket_set_inet_name ( stripes[index].name );
+#else
+	( void ) connection;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           stripe_connect
+*
+* FUNCTION:             On Linux, binds a socket about to connect
+*                       to a source address from the stripe (port
+*                       left to connect, so ephemeral ports aren't
+*                       used up by bind). A socket already on a
+*                       stack is left alone. Called by make_connect
+*                       / make_connect_nw. Only IPv4 connects are
+*                       striped.
+*
+* RETURNS:              int - 0, or -1 when the bind fails
+***************************************************************/
+int stripe_connect ( TCP_CONNECTION_INFO *connection )
+{
+#ifdef __TANDEM
+	( void ) connection;
+	return 0;
+#else
+	struct sockaddr_in	source;
+	int			on = 1;
+	int			index;
+
+	if ( !stripe_count || connection->stripe || !connection->sock || *connection->sock < 0
+	  || ( connection->sockaddr && connection->sockaddr->sin_family != AF_INET ) )
+		return 0;
+
+	index = Stripe_Pick ( );
+	memset ( &source, 0, sizeof ( source ) );
+	source.sin_family = AF_INET;
+	source.sin_addr = stripes[index].address;
+#ifdef IP_BIND_ADDRESS_NO_PORT
+	setsockopt ( *connection->sock, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, &on, sizeof ( on ) );
+#else
+	( void ) on;
+#endif
+	if ( bind ( *connection->sock, ( struct sockaddr * ) &source, sizeof ( source ) ) < 0 )
+		return -1;
+
+	Stripe_Take ( connection, index );
+	return 0;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           stripe_close
+*
+* FUNCTION:             Takes a closing socket off its stack's
+*                       load. Called by close_sock.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void stripe_close ( TCP_CONNECTION_INFO *connection )
+{
+	if ( connection->stripe > 0 && connection->stripe <= stripe_count )
+		STRIPE_ADD ( &stripes[connection->stripe - 1].open, -1 );
+	connection->stripe = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
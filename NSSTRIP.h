@@ -0,0 +1,96 @@
+/************************************************************************************
+*		FILE:		"nsstrip.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Striping: spreads the process's sockets over several
+*					TCP/IP stacks instead of the one set_proc names, so
+*					no single stack process carries all the traffic.
+*
+*		Notes:		set_proc_stripe ( names, count, policy ) gives the
+*					stacks. On Guardian they are TCP/IP process names
+*					($ZB27D, $ZB26C, ...) and every socket get_sock /
+*					get_sock_nw makes goes on one of them. On Linux there
+*					is one stack, so they are local source addresses
+*					(127.0.0.2, 10.1.0.7, ...), and make_connect /
+*					make_connect_nw bind the socket to one before it
+*					connects; listeners are left alone.
+*
+*					TCP_STRIPE_ROUND_ROBIN takes the stacks in turn;
+*					TCP_STRIPE_LEAST_LOADED takes the one with the fewest
+*					sockets open on it. A socket holds its stack until
+*					close_sock; TCP_CONNECTION_INFO::stripe says which
+*					(index + 1, 0 for none). A connection whose stripe is
+*					set already keeps that stack. A Guardian socket for
+*					accept_nw2 must be on its listener's stack, so copy
+*					the listener's stripe to it before get_sock_nw.
+*
+*					The stacks are process wide. Set them up before the
+*					threads start using sockets; set_proc, or a count of
+*					0, turns striping off.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.21.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifndef _NSSTRIPH_INCLUDE_
+#define _NSSTRIPH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* most stacks in a stripe */
+#define TCP_STRIPE_MAX			16
+
+/* stripe_set policies */
+enum
+{
+	TCP_STRIPE_ROUND_ROBIN = 0,
+	TCP_STRIPE_LEAST_LOADED
+};
+
+/***************************************************************
+*
+*	Name:		TCP_STRIPE
+*	Type:		struct
+*	Purpose:	One stack of the stripe and its load, as
+*				stripe_snapshot reports it.
+*
+***************************************************************/
+typedef struct tcp_stripe
+{
+	TCP_PROC_NAME			name;
+	struct in_addr			address;	/* Linux: the source address */
+	long				open;		/* sockets on it now */
+	long				assigned;	/* sockets ever put on it */
+} TCP_STRIPE;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int stripe_set ( char **names, int count, int policy );
+int stripe_snapshot ( TCP_STRIPE *stripes, int max );
+
+/* called by the TCP calls */
+void stripe_socket ( TCP_CONNECTION_INFO *connection );
+int stripe_connect ( TCP_CONNECTION_INFO *connection );
+void stripe_close ( TCP_CONNECTION_INFO *connection );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSSTRIPH_INCLUDE_
@@ -19,12 +19,70 @@
 *		VERSION		DATE	     COMMENTS
 *		-------    ------       ---------------------------------------------------
 *		1.0.0	  1/28/18		Initial Release
+*		1.1.0	  10/17/26		Builds on Linux against nslinux.c
+*		1.2.0	  10/17/26		Reap_Completions / Dispatch_Completions
+*		1.3.0	  10/17/26		intialize_tcp_engine (epoll / io_uring)
+*		1.4.0	  10/17/26		Free-list pools, no heap on connect/accept
+*		1.5.0	  10/17/26		Connection table entries in the TCP function table
+*		1.6.0	  10/17/26		New_Sendv / New_Recvv / New_Send_All (+ nowait)
+*		1.7.0	  10/17/26		Framing entries, Frame_Send
+*		1.8.0	  10/17/26		Coalescing entries, tcp_clock_usec
+*		1.9.0	  10/17/26		tcp_thread_exit
+*		1.11.0	  10/17/26		Operation counters on every call (nsstats.c)
+*		1.12.0	  10/17/26		Timer wheel (nstimer.c) run by Reap_Completions
+*		1.13.0	  10/17/26		Set_SockAddr takes host names (nsdns.c)
+*		1.14.0	  10/17/26		New_Accept_Batch, New_Recv_Batch / New_Send_Batch
+*		1.15.0	  10/17/26		Reap_Completions waits on timers alone
+*		1.17.0	  10/17/26		Send queue entries (nssendq.c)
+*		1.18.0	  10/17/26		Pipeline entries (nspipe.c)
+*		1.19.0	  10/17/26		Connection pool entries (nscpool.c)
+*		1.20.0	  10/17/26		send_file / zero-copy entries (nszcopy.c)
+*		1.21.0	  10/17/26		Striping over several stacks (nsstrip.c)
+*		1.22.0	  10/17/26		Traffic capture hooks (nscapt.c)
+*		1.24.0	  10/17/26		Socket tuning profiles (nstune.c)
+*		1.25.0	  10/17/26		Reap_Completions spins before it blocks (nsspin.c)
+*		1.25.1	  10/17/26		Accepts keep what tuning fell short of; nw2 / nw3 tune
+*		1.25.1	  10/17/26		New_Accept_Batch no longer switches the listener's mode
+*		1.25.1	  10/17/26		Objects freed on a foreign thread stay off its pool
+*		1.25.1	  10/17/26		Connects to a name still being resolved fail with EAGAIN
 *************************************************************************************/
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #ifdef __TANDEM
 #include "=nstcph"
+#include "=nsctabh"
+#include "=nsframeh"
+#include "=nscorkh"
+#include "=nsstatsh"
+#include "=nstimerh"
+#include "=nsdnsh"
+#include "=nssendqh"
+#include "=nspipeh"
+#include "=nscpoolh"
+#include "=nszcopyh"
+#include "=nsstriph"
+#include "=nscapth"
+#include "=nstuneh"
+#include "=nsspinh"
 #else
-#include "nstcp.h"
+#include "NSTCP.h"
+#include "NSCTAB.h"
+#include "NSFRAME.h"
+#include "NSCORK.h"
+#include "NSSTATS.h"
+#include "NSTIMER.h"
+#include "NSDNS.h"
+#include "NSSENDQ.h"
+#include "NSPIPE.h"
+#include "NSCPOOL.h"
+#include "NSZCOPY.h"
+#include "NSSTRIP.h"
+#include "NSCAPT.h"
+#include "NSTUNE.h"
+#include "NSSPIN.h"
 #endif
 
 #ifdef __cplusplus
@@ -37,6 +95,114 @@ extern "C" {
 ***************************************************************************************/
 
 	/* Add them here if you make some new routines */
+static void Tcp_Set_Additionals ( TCP_CONNECTION_INFO *connection, int flags
+	, int queue_length, long tag, long sockaddr_len);
+
+/* a TCP and its own connection come out of the pool as one block */
+typedef struct tcp_block
+{
+	TCP                      tcp;
+	TCP_CONNECTION_INFO      connection;
+} TCP_BLOCK;
+
+/* free list shared by everything of one size; slabs chains the
+*  slabs themselves for tcp_thread_exit */
+typedef struct tcp_pool
+{
+	void                    *free_list;
+	size_t                   size;
+	void                    *slabs;
+} TCP_POOL;
+
+static TCP_THREAD_LOCAL TCP_POOL tcp_block_pool = { 0, sizeof ( TCP_BLOCK ), 0 };
+static TCP_THREAD_LOCAL TCP_POOL tcp_conn_pool = { 0, sizeof ( TCP_CONNECTION_INFO ), 0 };
+
+
+/***************************************************************
+*
+* NAME:                           Pool_Get
+*
+* FUNCTION:             Takes a zeroed object off a pool's free
+*                       list, refilling it a slab at a time.
+*
+* NOTE:                 Slabs are only given back to the heap by
+*                       tcp_thread_exit; steady-state churn only
+*                       touches the list. The first slot of each
+*                       slab links it into pool->slabs.
+*
+* RETURNS:                   void * - 0 when out of memory
+***************************************************************/
+static void *Pool_Get ( TCP_POOL *pool )
+{
+	char   *slab;
+	void   *object;
+	int     i;
+
+	if ( !pool->free_list )
+	{
+		slab = ( char * ) malloc ( pool->size * ( TCP_POOL_SLAB + 1 ) );
+		if ( !slab )
+			return 0;
+
+		*( void ** ) slab = pool->slabs;
+		pool->slabs = slab;
+		for ( i = 1; i <= TCP_POOL_SLAB; i++ )
+		{
+			*( void ** ) ( slab + i * pool->size ) = pool->free_list;
+			pool->free_list = slab + i * pool->size;
+		}
+	}
+
+	object = pool->free_list;
+	pool->free_list = *( void ** ) object;
+	memset ( object, 0, pool->size );
+
+	return object;
+}
+
+/***************************************************************
+*
+* NAME:                           Pool_Put
+*
+* FUNCTION:             Returns an object to a pool's free list,
+*                       owner being the pool it came from.
+*
+* NOTE:                 The pools are per thread. An object put back
+*                       on another thread is left off both lists
+*                       rather than joining this one: its slab goes
+*                       when the thread that got it calls
+*                       tcp_thread_exit.
+*
+* RETURNS:                         nothing
+***************************************************************/
+static void Pool_Put ( TCP_POOL *pool, void *owner, void *object )
+{
+	if ( owner != pool )
+		return;
+
+	*( void ** ) object = pool->free_list;
+	pool->free_list = object;
+}
+
+/***************************************************************
+*
+* NAME:                           Pool_Drain
+*
+* FUNCTION:             Gives every slab of a pool back to the heap
+*
+* RETURNS:                         nothing
+***************************************************************/
+static void Pool_Drain ( TCP_POOL *pool )
+{
+	void *slab;
+
+	while ( ( slab = pool->slabs ) != 0 )
+	{
+		pool->slabs = *( void ** ) slab;
+		free ( slab );
+	}
+	pool->free_list = 0;
+}
 
 /***************************************************************
 *
@@ -45,11 +211,13 @@ extern "C" {
 * FUNCTION:                 Sets TCPIP Process Address
 *
 * NOTE:                     ex. $ZB27D, $ZB26C
+*                           Turns striping (set_proc_stripe) off.
 *
 * RETURNS:                         nothing
 ***************************************************************/
 static void Set_Proc( TCP_PROC_NAME process_name )
 {
+	stripe_set(0, 0, TCP_STRIPE_ROUND_ROBIN);
 	socket_set_inet_name(process_name);
 }
 
@@ -64,22 +232,37 @@ static void Set_Proc( TCP_PROC_NAME process_name )
 *                       in a network readible format.
 *
 * NOTE:            ex. of address_family : AF_INET, PF_INET, etc.
+*                  ipaddr may be a host name; see nsdns.h. The first use
+*                  of a name (by default) doesn't wait for it: the
+*                  address is left INADDR_NONE with errno EAGAIN, and
+*                  make_connect / make_connect_nw fail the same way
+*                  until the answer is in.
 *
 * RETURNS:                         nothing
 *************************************************************************/
 static void Set_SockAddr ( TCP_CONNECTION_INFO *connection, short address_family )
 {
-	/* allocate memory for the socket address structure */
-	connection->sockaddr = malloc(sizeof(connection->sockaddr));
+	int status;
+
+	/* the socket address structure lives inside the connection */
+	connection->sockaddr = &connection->sockaddr_in;
 	/* zero it out */
 	memset(connection->sockaddr, 0, sizeof(*connection->sockaddr));
-	/* sometimes sa_data fills with junk which makes the server refuse the connection,*/
+	/* sometimes sin_zero fills with junk which makes the server refuse the connection,*/
 	/* so to be safe we zero it out                                                   */
-	memset(connection->sockaddr->sa_data, '\0', sizeof(connection->sockaddr->sa_data));
+	memset(connection->sockaddr->sin_zero, '\0', sizeof(connection->sockaddr->sin_zero));
 	/* here is where we set the values in the structure into a network readable format*/
 	connection->sockaddr->sin_family = address_family;
 	connection->sockaddr->sin_port = htons(connection->port);
-	connection->sockaddr->sin_addr.s_addr = inet_addr(connection->ipaddr);
+	/* a dotted quad, or a host name from the resolver cache; a name that */
+	/* doesn't resolve (yet) leaves INADDR_NONE, as inet_addr always did  */
+	status = tcp_resolve ( connection->ipaddr, &connection->sockaddr->sin_addr, TCP_RESOLVE_WAIT );
+	if ( status != TCP_RESOLVE_FOUND )
+	{
+		connection->sockaddr->sin_addr.s_addr = INADDR_NONE;
+		/* EAGAIN: still being looked up, ask again later */
+		errno = status == TCP_RESOLVE_PENDING ? EAGAIN : EHOSTUNREACH;
+	}
 }
 
 /*******************************************************************
@@ -96,14 +279,19 @@ static int Get_Sock (TCP_CONNECTION_INFO *connection, int address_family, int so
 {
 	int socket_num;
 
-	/* Don't forge to call the freeing proc when done */
-	memset(&connection->sock, '\0', sizeof(*connection->sock));
-	connection->sock = (int *)malloc(sizeof(int));
-
+	/* on Guardian, the stack it goes on when striping */
+	stripe_socket(connection);
 	socket_num = socket(address_family
 		, socket_type
 		, protocol);
 
+	/* the socket number lives inside the connection, no heap needed */
+	connection->sock_num = socket_num;
+	connection->sock = &connection->sock_num;
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_SOCKET, 0, socket_num );
+	if ( socket_num >= 0 )
+		tune_socket ( connection );
+
 	return socket_num;
 }
 
@@ -121,12 +309,19 @@ static int Get_Sock_NW( TCP_CONNECTION_INFO *connection, int address_family, int
 {
 	int socket_num;
 
+	stripe_socket(connection);
 	socket_num = socket_nw(address_family
 		, socket_type
 		, protocol
 		, connection->flags
 		, sync);
 
+	connection->sock_num = socket_num;
+	connection->sock = &connection->sock_num;
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_SOCKET, 0, socket_num );
+	if ( socket_num >= 0 )
+		tune_socket ( connection );
+
 	return socket_num;
 }
 
@@ -181,6 +376,36 @@ static int Set_Bind_NW ( TCP_CONNECTION_INFO *connection )
 }
 
 
+/*******************************************************************
+*
+* NAME:                              Connect_Address
+*
+* FUNCTION:             Checks the address set_sockaddr left before
+*                       a connect. INADDR_NONE for a host name the
+*                       resolver didn't have yet is asked for again,
+*                       without waiting, rather than connecting to
+*                       255.255.255.255.
+*
+* RETURNS:              int - 0, or -1 with errno EAGAIN while the
+*                       name is still being looked up, EHOSTUNREACH
+*                       if it doesn't resolve
+*******************************************************************/
+static int Connect_Address ( TCP_CONNECTION_INFO *connection )
+{
+	int status;
+
+	if ( connection->sockaddr->sin_addr.s_addr != INADDR_NONE || !connection->ipaddr[0] )
+		return 0;
+
+	status = tcp_resolve ( connection->ipaddr, &connection->sockaddr->sin_addr, 0 );
+	if ( status == TCP_RESOLVE_FOUND )
+		return 0;
+
+	connection->sockaddr->sin_addr.s_addr = INADDR_NONE;
+	errno = status == TCP_RESOLVE_PENDING ? EAGAIN : EHOSTUNREACH;
+	return -1;
+}
+
 /*******************************************************************
 *
 * NAME:                                 Make_Connect
@@ -189,22 +414,32 @@ static int Set_Bind_NW ( TCP_CONNECTION_INFO *connection )
 *
 * NOTE:                     Must be called AFTER newSocket()
 *
-* RETURNS:                              int
+* RETURNS:                              int - -1 with errno EAGAIN
+*                                       while a host name is being
+*                                       looked up
 *******************************************************************/
 static int Make_Connect ( TCP_CONNECTION_INFO *connection )
 {
 	int status;
 
-	/* we have to set sa_data, if not, seems like junk fills it
+	/* we have to set sin_zero, if not, seems like junk fills it
 	* , which makes the server refuse the connection */
-	memset ( connection->sockaddr->sa_data
+	memset ( connection->sockaddr->sin_zero
 		   , '\0'
-		   , sizeof(connection->sockaddr->sa_data));
+		   , sizeof(connection->sockaddr->sin_zero));
+
+	if ( Connect_Address ( connection ) < 0 )
+		return -1;
+
+	/* on Linux, the source address when striping */
+	if ( stripe_connect ( connection ) < 0 )
+		return -1;
 
 	status = connect ( *connection->sock
 					 , ( struct sockaddr *) connection->sockaddr
 					 , sizeof ( *connection->sockaddr ) );
 
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_CONNECT, 0, status );
 	return status;
 }
 
@@ -216,22 +451,30 @@ static int Make_Connect ( TCP_CONNECTION_INFO *connection )
 *
 * NOTE:                 Must be called AFTER newSocket_nw()
 *
-* RETURNS:                              int
+* RETURNS:                              int - -1 with errno EAGAIN
+*                                       while a host name is being
+*                                       looked up
 *******************************************************************/
 static int Make_Connect_NW ( TCP_CONNECTION_INFO *connection )
 {
 	int status;
 
-	/* we have to set sa_data, if not, seems like junk fills it, which makes the server refuse the connection */
-	memset ( connection->sockaddr->sa_data
+	/* we have to set sin_zero, if not, seems like junk fills it, which makes the server refuse the connection */
+	memset ( connection->sockaddr->sin_zero
 		   , '\0'
-		   , sizeof( connection->sockaddr->sa_data ) );
+		   , sizeof( connection->sockaddr->sin_zero ) );
+
+	if ( Connect_Address ( connection ) < 0 )
+		return -1;
+	if ( stripe_connect ( connection ) < 0 )
+		return -1;
 
 	status = connect_nw ( *connection->sock
-						, (struct sockaddr *) &connection->sockaddr
+						, (struct sockaddr *) connection->sockaddr
 						, connection->sockaddr_len
 						, connection->tag );
 
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_CONNECT, status );
 	return status;
 }
 
@@ -251,8 +494,9 @@ static int Set_Listen (TCP_CONNECTION_INFO *connection )
 {
 	int status;
 
+	/* a tuning profile's backlog wins over queue_len */
 	status = listen ( *connection->sock
-					, connection->queue_len );
+					, tune_backlog ( connection ) );
 
 	return status;
 }
@@ -274,8 +518,11 @@ static int New_Accept ( TCP_CONNECTION_INFO *connection, int *from_len_ptr )
 
 	status = accept ( *connection->sock
 					, ( struct sockaddr * ) connection->sockaddr
-					, from_len_ptr );
+					, ( TCP_SOCKLEN * ) from_len_ptr );
 
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_ACCEPT, 0, status );
+	if ( status >= 0 )
+		connection->accept_short = tune_accepted ( connection->tune, status );
 	return status;
 }
 
@@ -299,6 +546,7 @@ static int New_Accept_NW ( TCP_CONNECTION_INFO *connection )
 					   , &connection->sockaddr_len
 					   , connection->tag );
 
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_ACCEPT, status );
 	return status;
 }
 
@@ -325,6 +573,7 @@ static int New_Accept_NW1 ( TCP_CONNECTION_INFO *connection )
 						, connection->tag
 						, ( short ) connection->queue_len);
 
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_ACCEPT, status );
 	return status;
 }
 
@@ -334,7 +583,9 @@ static int New_Accept_NW1 ( TCP_CONNECTION_INFO *connection )
 *
 * FUNCTION:
 *
-* NOTE:
+* NOTE:                     The connection's tuning profile is
+*                           applied again once the accepted
+*                           connection is on its socket.
 *
 * RETURNS:                              int
 * *******************************************************************/
@@ -346,6 +597,8 @@ static int New_Accept_NW2 ( TCP_CONNECTION_INFO *connection )
 						, ( struct sockaddr * ) connection->sockaddr
 						, connection->tag );
 
+	if ( status >= 0 )
+		tune_socket ( connection );
 	return status;
 }
 
@@ -355,7 +608,7 @@ static int New_Accept_NW2 ( TCP_CONNECTION_INFO *connection )
 *
 * FUNCTION:
 *
-* NOTE:
+* NOTE:                     Tuned as New_Accept_NW2.
 *
 * RETURNS:                              int
 * *******************************************************************/
@@ -368,9 +621,75 @@ static int New_Accept_NW3 (TCP_CONNECTION_INFO *connection, struct sockaddr *me_
 						, me_ptr
 						, connection->tag );
 
+	if ( status >= 0 )
+		tune_socket ( connection );
 	return status;
 }
 
+/*******************************************************************
+*
+* NAME:                                 New_Accept_Batch
+*
+* FUNCTION:                 A server based func. Takes every
+*                           connection waiting on a non-blocking
+*                           listener, up to max, in one call.
+*
+* NOTE:                     The listener's mode is left alone, since
+*                           other threads may be accepting on it too:
+*                           a blocking listener waits for the first as
+*                           New_Accept would and takes only that one.
+*                           Set O_NONBLOCK on the listener once, after
+*                           set_listen, to drain the backlog. The
+*                           Guardian socket library can't tell
+*                           whether more are waiting without blocking,
+*                           so there it takes one.
+*
+* RETURNS:                              int - connections taken,
+*                                       -1 on error (EAGAIN: none)
+* *******************************************************************/
+static int New_Accept_Batch ( TCP_CONNECTION_INFO *connection, TCP_ACCEPTED *accepted, int max )
+{
+	TCP_SOCKLEN	length;
+	int		count = 0;
+	int		status = -1;
+#ifndef __TANDEM
+	int		mode = fcntl ( *connection->sock, F_GETFL );
+#endif
+
+	while ( count < max )
+	{
+		length = sizeof ( accepted[count].sockaddr );
+#ifdef __TANDEM
+		status = accept ( *connection->sock
+						, ( struct sockaddr * ) &accepted[count].sockaddr
+						, &length );
+		if ( status >= 0 )
+		{
+			accepted[count].tune_short = tune_accepted ( connection->tune, status );
+			accepted[count++].sock = status;
+		}
+		break;
+#else
+		status = accept4 ( *connection->sock
+						 , ( struct sockaddr * ) &accepted[count].sockaddr
+						 , &length
+						 , SOCK_CLOEXEC );
+		if ( status < 0 )
+			break;
+		accepted[count].tune_short = tune_accepted ( connection->tune, status );
+		accepted[count++].sock = status;
+
+		/* more would block a blocking listener */
+		if ( mode < 0 || !( mode & O_NONBLOCK ) )
+			break;
+#endif
+	}
+
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_ACCEPT, 0, count ? count : status );
+
+	return count ? count : -1;
+}
+
 /**********************************************************************
 *
 * NAME:                                 New_Send
@@ -391,6 +710,9 @@ static int New_Send (TCP_CONNECTION_INFO *connection, char *buffer_ptr, int buff
 				  , buffer_length
 				  , connection->flags );
 
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, buffer_length, status );
+	if ( status > 0 )
+		TCP_CAPTURE ( TCP_CAPTURE_SEND, *connection->sock, buffer_ptr, status );
 	return status;
 }
 
@@ -415,6 +737,7 @@ static int New_Send_NW ( TCP_CONNECTION_INFO *connection, char *buffer_ptr, int
 					 , connection->flags
 					 , connection->tag );
 
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_SEND, status );
 	return status;
 }
 
@@ -437,6 +760,9 @@ static int New_Recv (TCP_CONNECTION_INFO *connection, char *buffer_ptr, int buff
 				  , buff_length
 				  , connection->flags );
 
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_RECV, buff_length, status );
+	if ( status > 0 )
+		TCP_CAPTURE ( TCP_CAPTURE_RECV, *connection->sock, buffer_ptr, status );
 	return status;
 }
 
@@ -461,7 +787,450 @@ static int New_Recv_NW (TCP_CONNECTION_INFO *connection, char *buffer_ptr, int l
 					 , connection->flags
 					 , connection->tag );
 
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_RECV, status );
+	return status;
+}
+
+#if !defined ( __TANDEM ) && !defined ( NSTCP_NO_STATS )
+/* bytes described by an iovec array, for the partial-send counter */
+static long Iov_Length ( TCP_IOVEC *iov, int count )
+{
+	long length = 0;
+	int  i;
+
+	for ( i = 0; i < count; i++ )
+		length += ( long ) iov[i].iov_len;
+
+	return length;
+}
+#endif
+
+/*********************************************************************************
+*
+* NAME:                                 New_Sendv
+*
+* FUNCTION:                     Sends several buffers (header, body,
+*                               trailer, ...) on a connected socket
+*                               with one call and no copying
+*
+* NOTE:                         Like New_Send this may take fewer bytes
+*                               than asked; New_Send_All finishes the job.
+*                               The Guardian socket library has no
+*                               gather send, so there it is one send
+*                               per part, stopping at the first short one.
+*
+* RETURNS:                              int - bytes sent, -1 on error
+* *******************************************************************************/
+static int New_Sendv ( TCP_CONNECTION_INFO *connection, TCP_IOVEC *iov, int count )
+{
+#ifdef __TANDEM
+	int status;
+	int total = 0;
+	int i;
+
+	for ( i = 0; i < count; i++ )
+	{
+		status = send ( *connection->sock
+					  , iov[i].iov_base
+					  , iov[i].iov_len
+					  , connection->flags );
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, iov[i].iov_len, status );
+		if ( status < 0 )
+			return total ? total : status;
+
+		total += status;
+		if ( status < iov[i].iov_len )
+			break;
+	}
+
+	return total;
+#else
+	struct msghdr msg;
+	int status;
+
+	memset ( &msg, 0, sizeof ( msg ) );
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count;
+
+	status = ( int ) sendmsg ( *connection->sock, &msg, connection->flags );
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, Iov_Length ( iov, count ), status );
+
+	return status;
+#endif
+}
+
+/*******************************************************************************
+*
+* NAME:                                 New_Sendv_NW
+*
+* FUNCTION:                     This is a NOWAIT operation.
+*                               Sends several buffers on a connected
+*                               socket. The completion comes once
+*                               all of them have gone (or on error).
+*
+* NOTE:                         The parts themselves must stay put until
+*                               the completion; the TCP_IOVEC array need not.
+*                               Guardian has no gather send_nw, so there
+*                               only a single part is accepted.
+*
+* RETURNS:                              int
+* *****************************************************************************/
+static int New_Sendv_NW ( TCP_CONNECTION_INFO *connection, TCP_IOVEC *iov, int count )
+{
+#ifdef __TANDEM
+	int status;
+
+	if ( count != 1 )
+		return -1;
+
+	status = send_nw ( *connection->sock
+					 , iov[0].iov_base
+					 , iov[0].iov_len
+					 , connection->flags
+					 , connection->tag );
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_SEND, status );
+
+	return status;
+#else
+	int status;
+
+	status = nslx_sendv_nw ( *connection->sock
+						, iov
+						, count
+						, connection->flags
+						, connection->tag );
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_SEND, status );
+
 	return status;
+#endif
+}
+
+/*********************************************************************************
+*
+* NAME:                                 New_Recvv
+*
+* FUNCTION:                     Receives into several buffers, filling
+*                               them in order
+*
+* NOTE:                         On Guardian this is one recv per part,
+*                               stopping at the first short one.
+*
+* RETURNS:                              int - bytes received, 0 when the
+*                                       peer closed, -1 on error
+* *******************************************************************************/
+static int New_Recvv ( TCP_CONNECTION_INFO *connection, TCP_IOVEC *iov, int count )
+{
+#ifdef __TANDEM
+	int status;
+	int total = 0;
+	int i;
+
+	for ( i = 0; i < count; i++ )
+	{
+		status = recv ( *connection->sock
+					  , iov[i].iov_base
+					  , iov[i].iov_len
+					  , connection->flags );
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_RECV, iov[i].iov_len, status );
+		if ( status < 0 )
+			return total ? total : status;
+
+		total += status;
+		if ( status < iov[i].iov_len )
+			break;
+	}
+
+	return total;
+#else
+	struct msghdr msg;
+	int status;
+
+	memset ( &msg, 0, sizeof ( msg ) );
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count;
+
+	status = ( int ) recvmsg ( *connection->sock, &msg, connection->flags );
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_RECV, Iov_Length ( iov, count ), status );
+
+	return status;
+#endif
+}
+
+/*******************************************************************************
+*
+* NAME:                                 New_Recvv_NW
+*
+* FUNCTION:                 This is a NOWAIT operation.
+*                           Receives into several buffers.
+*
+* NOTE:                     Guardian has no scatter recv_nw, so there
+*                           only a single part is accepted.
+*
+* RETURNS:                              int
+* *****************************************************************************/
+static int New_Recvv_NW ( TCP_CONNECTION_INFO *connection, TCP_IOVEC *iov, int count )
+{
+#ifdef __TANDEM
+	int status;
+
+	if ( count != 1 )
+		return -1;
+
+	status = recv_nw ( *connection->sock
+					 , iov[0].iov_base
+					 , iov[0].iov_len
+					 , connection->flags
+					 , connection->tag );
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_RECV, status );
+
+	return status;
+#else
+	int status;
+
+	status = nslx_recvv_nw ( *connection->sock
+						, iov
+						, count
+						, connection->flags
+						, connection->tag );
+	TCP_STATS_SUBMIT ( &connection->stats, TCP_OP_RECV, status );
+
+	return status;
+#endif
+}
+
+/*******************************************************************************
+*
+* NAME:                                 New_Send_All
+*
+* FUNCTION:                     Sends every byte of every part, picking
+*                               up after short writes part-way through
+*                               a buffer
+*
+* NOTE:                         iov is used as the cursor: on return the
+*                               entries sent have been stepped past (the
+*                               array is not restored).
+*
+* RETURNS:                              int - bytes sent, -1 on error
+* *****************************************************************************/
+static int New_Send_All ( TCP_CONNECTION_INFO *connection, TCP_IOVEC *iov, int count )
+{
+	int status;
+	int total = 0;
+
+	while ( count > 0 )
+	{
+		/* skip parts that are empty or already gone */
+		if ( !iov->iov_len )
+		{
+			iov++;
+			count--;
+			continue;
+		}
+
+		status = New_Sendv ( connection, iov, count );
+		if ( status < 0 )
+		{
+#ifndef __TANDEM
+			if ( errno == EINTR )
+				continue;
+#endif
+			return -1;
+		}
+		total += status;
+
+		while ( count > 0 && status >= ( int ) iov->iov_len )
+		{
+			status -= ( int ) iov->iov_len;
+			iov->iov_len = 0;
+			iov++;
+			count--;
+		}
+		if ( count > 0 )
+		{
+			iov->iov_base = ( char * ) iov->iov_base + status;
+			iov->iov_len -= status;
+		}
+	}
+
+	return total;
+}
+
+/*******************************************************************************
+*
+* NAME:                                 New_Recv_Batch
+*
+* FUNCTION:                     Receives up to count datagrams (at most
+*                               TCP_DATAGRAM_BATCH) with one call: waits
+*                               for the first as New_Recv would, then
+*                               takes whatever else is already queued.
+*
+* NOTE:                         For SOCK_DGRAM sockets. On Guardian
+*                               there is no recvmmsg, so one datagram
+*                               is taken per call.
+*
+* RETURNS:                              int - datagrams received,
+*                                       -1 on error
+* *****************************************************************************/
+static int New_Recv_Batch ( TCP_CONNECTION_INFO *connection, TCP_DATAGRAM *datagrams, int count )
+{
+#ifdef __TANDEM
+	int length = sizeof ( datagrams[0].address );
+	int status;
+
+	if ( count < 1 )
+		return 0;
+
+	status = recvfrom ( *connection->sock
+					  , datagrams[0].buffer
+					  , datagrams[0].size
+					  , connection->flags
+					  , ( struct sockaddr * ) &datagrams[0].address
+					  , &length );
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_RECV, datagrams[0].size, status );
+	if ( status < 0 )
+		return status;
+
+	datagrams[0].length = status;
+	datagrams[0].truncated = 0;
+
+	return 1;
+#else
+	struct mmsghdr	msgs[TCP_DATAGRAM_BATCH];
+	struct iovec	iov[TCP_DATAGRAM_BATCH];
+	int		status;
+	int		i;
+
+	if ( count > TCP_DATAGRAM_BATCH )
+		count = TCP_DATAGRAM_BATCH;
+	if ( count < 1 )
+		return 0;
+
+	memset ( msgs, 0, count * sizeof ( struct mmsghdr ) );
+	for ( i = 0; i < count; i++ )
+	{
+		iov[i].iov_base = datagrams[i].buffer;
+		iov[i].iov_len = datagrams[i].size;
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &datagrams[i].address;
+		msgs[i].msg_hdr.msg_namelen = sizeof ( datagrams[i].address );
+	}
+
+	status = recvmmsg ( *connection->sock, msgs, count, connection->flags | MSG_WAITFORONE, 0 );
+	if ( status < 0 )
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_RECV, 0, status );
+
+	for ( i = 0; i < status; i++ )
+	{
+		datagrams[i].length = ( int ) msgs[i].msg_len;
+		datagrams[i].truncated = ( msgs[i].msg_hdr.msg_flags & MSG_TRUNC ) != 0;
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_RECV, datagrams[i].size, datagrams[i].length );
+	}
+
+	return status;
+#endif
+}
+
+/*******************************************************************************
+*
+* NAME:                                 New_Send_Batch
+*
+* FUNCTION:                     Sends up to count datagrams (at most
+*                               TCP_DATAGRAM_BATCH) with one call
+*
+* NOTE:                         For SOCK_DGRAM sockets. A datagram goes
+*                               whole or not at all, so only the count
+*                               can come up short. On Guardian this is
+*                               one sendto per datagram.
+*
+* RETURNS:                              int - datagrams sent, -1 on
+*                                       error before the first
+* *****************************************************************************/
+static int New_Send_Batch ( TCP_CONNECTION_INFO *connection, TCP_DATAGRAM *datagrams, int count )
+{
+#ifdef __TANDEM
+	int status;
+	int i;
+
+	for ( i = 0; i < count; i++ )
+	{
+		status = sendto ( *connection->sock
+						, datagrams[i].buffer
+						, datagrams[i].length
+						, connection->flags
+						, datagrams[i].address.sin_family ? ( struct sockaddr * ) &datagrams[i].address : 0
+						, datagrams[i].address.sin_family ? sizeof ( datagrams[i].address ) : 0 );
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, datagrams[i].length, status );
+		if ( status < 0 )
+			return i ? i : status;
+	}
+
+	return count;
+#else
+	struct mmsghdr	msgs[TCP_DATAGRAM_BATCH];
+	struct iovec	iov[TCP_DATAGRAM_BATCH];
+	int		status;
+	int		i;
+
+	if ( count > TCP_DATAGRAM_BATCH )
+		count = TCP_DATAGRAM_BATCH;
+	if ( count < 1 )
+		return 0;
+
+	memset ( msgs, 0, count * sizeof ( struct mmsghdr ) );
+	for ( i = 0; i < count; i++ )
+	{
+		iov[i].iov_base = datagrams[i].buffer;
+		iov[i].iov_len = datagrams[i].length;
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		if ( datagrams[i].address.sin_family )
+		{
+			msgs[i].msg_hdr.msg_name = &datagrams[i].address;
+			msgs[i].msg_hdr.msg_namelen = sizeof ( datagrams[i].address );
+		}
+	}
+
+	status = sendmmsg ( *connection->sock, msgs, count, connection->flags );
+	if ( status < 0 )
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, 0, status );
+
+	for ( i = 0; i < status; i++ )
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, datagrams[i].length, ( long ) msgs[i].msg_len );
+
+	return status;
+#endif
+}
+
+/*******************************************************************************
+*
+* NAME:                                 Frame_Send
+*
+* FUNCTION:                     Sends one message with the prefix the
+*                               connection's framer expects, prefix and
+*                               body in a single gather send
+*
+* NOTE:                         set_framer must have been called.
+*
+* RETURNS:                              int - bytes sent (prefix included),
+*                                       -1 on error
+* *****************************************************************************/
+static int Frame_Send ( TCP_CONNECTION_INFO *connection, char *buffer_ptr, long length )
+{
+	char		prefix[4];
+	TCP_IOVEC	iov[2];
+	int		width;
+
+	width = frame_prefix ( connection, prefix, length );
+	if ( width < 0 )
+		return -1;
+
+	iov[0].iov_base = prefix;
+	iov[0].iov_len = width;
+	iov[1].iov_base = buffer_ptr;
+	iov[1].iov_len = length;
+
+	return New_Send_All ( connection, iov, 2 );
 }
 
 /*********************************************************************************
@@ -516,9 +1285,9 @@ static int Shutdown_Sock_NW (TCP_CONNECTION_INFO *connection, int how )
 * NAME:                 Close_Sock
 *
 * FUNCTION:             closes the socket/fd. & sets it
-*                       back to NULL
+*                       back to -1
 *
-* NOTE:
+* NOTE:                 Closing again does nothing.
 *
 * RETURNS:                 int
 * *******************************************************/
@@ -526,21 +1295,20 @@ static int Close_Sock (TCP_CONNECTION_INFO *connection )
 {
 	int status;
 
-	if ( !connection->sock )
+	/* already closed (or never opened): don't close fd 0 */
+	if ( !connection->sock || *connection->sock < 0 )
 	{
-		*connection->sock = 0;
-		memset ( &connection->sock
-			   , 0
-			   , sizeof ( *connection->sock ) );
-
 		status = 0;
 		return status;
 	}
+#ifdef __TANDEM
 	status = FILE_CLOSE_ ( ( signed short ) *connection->sock ); /* We use the nonstop call here you can use close(), but sometimes its finickey*/
-	
-	memset ( &connection->sock
-		   , 0
-		   , sizeof ( *connection->sock ) );
+#else
+	status = FILE_CLOSE_ ( *connection->sock ); /* nslinux.c also drops any nowait I/O still queued on the socket */
+#endif
+	TCP_STATS_CALL ( &connection->stats, TCP_OP_CLOSE, 0, status ? -1 : 0 );
+	stripe_close ( connection );
+	*connection->sock = -1;
 
 	return status;
 }
@@ -558,10 +1326,13 @@ static int Close_Sock (TCP_CONNECTION_INFO *connection )
 static int Get_Sock_Name (TCP_CONNECTION_INFO *connection )
 {
 	int status;
+	TCP_SOCKLEN addr_len = ( TCP_SOCKLEN ) connection->sockaddr_len;
 
 	status = getsockname ( *connection->sock
 						 , ( struct sockaddr * ) connection->sockaddr
-						 , &connection->sockaddr_len );
+						 , &addr_len );
+
+	connection->sockaddr_len = addr_len;
 
 	return status;
 }
@@ -592,8 +1363,14 @@ static int Get_Sock_Name_NW ( TCP_CONNECTION_INFO *connection )
 *
 * NAME:                 Clean_Conn_Info
 *
-* FUNCTION:             Clean up memory allocated for sockaddr structure and socket.
-*                       Will also zero out some other elements, for the next transaction.
+* FUNCTION:             Resets the sockaddr structure and socket for the next transaction.
+*                       Will also zero out some other elements. A connection that came
+*                       from get_conn_info goes back to the pool, so don't touch it after.
+*                       Cleaned on another thread than the one that got it, it isn't
+*                       reused (see Pool_Put).
+*
+* NOTE:                 sock / sockaddr only need freeing if the caller pointed them at
+*                       their own heap memory; the inline storage needs nothing.
 *
 * RETURNS:              Nadda
 *
@@ -602,13 +1379,22 @@ static void Clean_Conn_Info ( TCP_CONNECTION_INFO *connection )
 {
 	if (connection->sockaddr != 0)
 	{
-		free(connection->sockaddr);
+		if (connection->sockaddr != &connection->sockaddr_in)
+			free(connection->sockaddr);
 		connection->sockaddr = 0;
 	}
-	if (connection->sock != 0)
-	{
+	if (connection->sock != 0 && connection->sock != &connection->sock_num)
 		free(connection->sock);
-		connection->sock = 0;
+	framer_detach(connection);
+	coalesce_detach(connection);
+	sendq_detach(connection);
+	pipe_detach(connection);
+	zcopy_detach(connection);
+
+	if (connection->pooled)
+	{
+		Pool_Put(&tcp_conn_pool, connection->pool, connection);
+		return;
 	}
 
 	/* cleanup all data which is set each time a socket is created */
@@ -616,6 +1402,213 @@ static void Clean_Conn_Info ( TCP_CONNECTION_INFO *connection )
 	connection->flags = '\0';
 	connection->sockaddr_len = '\0';
 	connection->tag = '\0';
+	connection->tune = 0;
+	connection->tune_short = 0;
+	connection->accept_short = 0;
+	memset(&connection->sockaddr_in, 0, sizeof(connection->sockaddr_in));
+
+	/* sock keeps pointing at its slot so "*sock = get_sock(...)" is always safe */
+	connection->sock_num = -1;
+	connection->sock = &connection->sock_num;
+}
+
+/******************************************************************************************
+*
+* NAME:                 Get_Conn_Info
+*
+* FUNCTION:             Hands out a zeroed TCP_CONNECTION_INFO from the pool, e.g. one per
+*                       accepted client. clean_conn_info gives it back.
+*
+* NOTE:                 The pool is the calling thread's. The connection may be used and
+*                       cleaned on another thread (e.g. handed to a send queue's owner),
+*                       but only this thread reuses it, and its memory is freed when this
+*                       thread calls tcp_thread_exit.
+*
+* RETURNS:              TCP_CONNECTION_INFO * - 0 when out of memory
+*
+******************************************************************************************/
+static TCP_CONNECTION_INFO *Get_Conn_Info ( void )
+{
+	TCP_CONNECTION_INFO *connection;
+
+	connection = ( TCP_CONNECTION_INFO * ) Pool_Get ( &tcp_conn_pool );
+	if ( connection )
+	{
+		connection->pooled = 1;
+		connection->pool = &tcp_conn_pool;
+		connection->sock_num = -1;
+		connection->sock = &connection->sock_num;
+	}
+
+	return connection;
+}
+
+/******************************************************************************************
+*
+* NAME:                 Reap_Batch
+*
+* FUNCTION:             One wait of Reap_Completions, without the timers.
+*
+* NOTE:                 On Guardian this is an AWAITIOX(-1) loop; on Linux it is one
+*                       epoll pass in nslinux.c.
+*
+* RETURNS:              int - completions stored, 0 if the time limit passed,
+*                       -1 when nothing is outstanding or the wait failed
+*
+******************************************************************************************/
+static int Reap_Batch ( TCP_COMPLETION *completions, int max, long timelimit )
+{
+#ifdef __TANDEM
+	short              filenum;
+	long               bufaddr;
+	unsigned short     count;
+	long               tag;
+	short              error;
+	_cc_status         cc;
+	int                reaped = 0;
+
+	while ( reaped < max )
+	{
+		filenum = -1;
+		cc = AWAITIOX ( &filenum, &bufaddr, &count, &tag, reaped ? 0L : timelimit );
+
+		error = 0;
+		if ( !_status_eq ( cc ) )
+			FILE_GETINFO_ ( filenum, &error );
+
+		if ( error == FETIMEDOUT || error == FENONEOUT || filenum < 0 )
+		{
+			if ( reaped || error == FETIMEDOUT )
+				break;
+			return -1;
+		}
+
+		completions[reaped].sock = filenum;
+		completions[reaped].tag = tag;
+		completions[reaped].count = count;
+		completions[reaped].error = error;
+		completions[reaped].buffer = ( char * ) bufaddr;
+		completions[reaped].length = count;
+		completions[reaped].op = TCP_OP_OTHER;
+		completions[reaped].usec = -1;
+		reaped++;
+	}
+
+	return reaped;
+#else
+	return nslx_reap_completions ( completions, max, timelimit );
+#endif
+}
+
+/******************************************************************************************
+*
+* NAME:                 Reap_Completions
+*
+* FUNCTION:             Library-owned completion queue. Waits up to timelimit (0.01 sec
+*                       units, -1 = forever, 0 = just check) for the first nowait
+*                       operation on any socket to finish, then collects every other
+*                       one that is already done, up to max, without waiting again.
+*
+* NOTE:                 Runs the thread's timers (nstimer.h) on the way: the wait is cut
+*                       short at the next due timer, the timer fired, and the wait
+*                       resumed for what is left of timelimit. With no operation
+*                       outstanding but a timer armed, it sleeps until the timer
+*                       instead of returning -1. With set_spin_wait on, each wait
+*                       polls for a spin budget before it blocks (nsspin.h).
+*
+* RETURNS:              int - completions stored, 0 if the time limit passed,
+*                       -1 when nothing is outstanding or the wait failed
+*
+******************************************************************************************/
+static int Reap_Completions ( TCP_COMPLETION *completions, int max, long timelimit )
+{
+	long long          deadline = 0;
+	long               wait;
+	long               due;
+	int                reaped;
+
+	if ( timelimit > 0 )
+		deadline = tcp_clock_usec ( ) + ( long long ) timelimit * 10000;
+
+	for ( ;; )
+	{
+		timer_run ( );
+		reaped = timer_reap_expired ( completions, max );
+		if ( reaped )
+			break;
+
+		wait = timelimit;
+		due = timer_due ( );
+		if ( due >= 0 && ( wait < 0 || due < wait ) )
+			wait = due;
+
+		reaped = spin_reap ( completions, max, wait, Reap_Batch );
+		if ( reaped < 0 && due >= 0 )
+		{
+			/* nothing outstanding but timers: sleep until one is due */
+			if ( wait > 0 )
+#ifdef __TANDEM
+				DELAY ( wait );
+#else
+				usleep ( ( useconds_t ) wait * 10000 );
+#endif
+			reaped = 0;
+		}
+		if ( reaped != 0 || wait == timelimit )
+			break;
+
+		/* woken for a timer; carry on with what is left */
+		if ( timelimit > 0 )
+		{
+			timelimit = ( long ) ( ( deadline - tcp_clock_usec ( ) ) / 10000 );
+			if ( timelimit < 0 )
+				timelimit = 0;
+		}
+	}
+	TCP_STATS_COMPLETE ( completions, reaped );
+	TCP_CAPTURE_COMPLETE ( completions, reaped );
+
+	return reaped;
+}
+
+/******************************************************************************************
+*
+* NAME:                 Dispatch_Completions
+*
+* FUNCTION:             Event loop over Reap_Completions. Reaps completions a batch at a
+*                       time and calls handler for each one, so callers only write the
+*                       per-tag work, not the wait loop.
+*
+* NOTE:                 Stops once handler returns non-zero (the rest of that batch is
+*                       still delivered), nothing is outstanding any more, or timelimit
+*                       passes without a completion.
+*
+* RETURNS:              int - completions dispatched
+*
+******************************************************************************************/
+static int Dispatch_Completions ( TCP_COMPLETION_HANDLER handler, void *context, long timelimit )
+{
+	TCP_COMPLETION     batch[TCP_COMPLETION_BATCH];
+	int                dispatched = 0;
+	int                stop = 0;
+	int                reaped;
+	int                i;
+
+	while ( !stop )
+	{
+		reaped = Reap_Completions ( batch, TCP_COMPLETION_BATCH, timelimit );
+		if ( reaped <= 0 )
+			break;
+
+		for ( i = 0; i < reaped; i++ )
+		{
+			if ( handler ( &batch[i], context ) )
+				stop = 1;
+		}
+		dispatched += reaped;
+	}
+
+	return dispatched;
 }
 
 #pragma PAGE "init_tcpip"
@@ -632,13 +1625,40 @@ static void Clean_Conn_Info ( TCP_CONNECTION_INFO *connection )
 *
 *****************************************************************************************/
 TCP* intialize_tcp ( )
+{
+	return intialize_tcp_engine ( TCP_ENGINE_DEFAULT );
+}
+
+/******************************************************************************************
+*
+* NAME:                 intialize_tcp_engine
+*
+* FUNCTION:             Same as intialize_tcp, but also chooses the nowait engine on Linux:
+*                       TCP_ENGINE_EPOLL, TCP_ENGINE_IO_URING, or TCP_ENGINE_DEFAULT to go
+*                       by the NSTCP_ENGINE environment variable. io_uring falls back to
+*                       epoll when the kernel can't do it; tcp->engine says which one won.
+*
+* NOTE:                 The engine belongs to the calling thread, like AWAITIOX does.
+*
+* RETURNS:              TCP *
+*
+*****************************************************************************************/
+TCP *intialize_tcp_engine ( int engine )
 {
 	TCP               *tcp;
+	TCP_BLOCK         *block;
 	BOOLEAN            status;
 	ERROR_MESSAGE      error_text;
 
-	/* allocate memory */
-	tcp = (TCP *) malloc ( sizeof ( TCP ) );
+	/* take the TCP and its connection structure from the pool, in one piece */
+	block = ( TCP_BLOCK * ) Pool_Get ( &tcp_block_pool );
+	if ( !block )
+		return 0;
+	tcp = &block->tcp;
+	tcp->tcp_connect = &block->connection;
+	tcp->tcp_connect->pool = &tcp_block_pool;
+	tcp->tcp_connect->sock_num = -1;
+	tcp->tcp_connect->sock = &tcp->tcp_connect->sock_num;
 
 	/* redirect function calls to address of tcpip calls*/
 	tcp->set_proc = Set_Proc;
@@ -666,13 +1686,166 @@ TCP* intialize_tcp ( )
 	tcp->clean_conn_info = Clean_Conn_Info;
 	tcp->set_addtionals = Tcp_Set_Additionals;
 	tcp->set_sockaddr = Set_SockAddr;
+	tcp->reap_completions = Reap_Completions;
+	tcp->dispatch_completions = Dispatch_Completions;
+	tcp->get_conn_info = Get_Conn_Info;
+	tcp->new_conn_table = conn_table_new;
+	tcp->free_conn_table = conn_table_free;
+	tcp->conn_add = conn_add;
+	tcp->conn_remove = conn_remove;
+	tcp->conn_by_fd = conn_by_fd;
+	tcp->conn_cold = conn_cold;
+	tcp->conn_send_nw = conn_send_nw;
+	tcp->conn_recv_nw = conn_recv_nw;
+	tcp->conn_complete = conn_complete;
+	tcp->new_sendv = New_Sendv;
+	tcp->new_sendv_nw = New_Sendv_NW;
+	tcp->new_recvv = New_Recvv;
+	tcp->new_recvv_nw = New_Recvv_NW;
+	tcp->new_send_all = New_Send_All;
+	tcp->set_framer = framer_attach;
+	tcp->frame_recv = frame_recv;
+	tcp->frame_recv_nw = frame_recv_nw;
+	tcp->frame_commit = frame_commit;
+	tcp->frame_next = frame_next;
+	tcp->frame_send = Frame_Send;
+	tcp->set_coalesce = coalesce_attach;
+	tcp->coalesce_send = coalesce_send;
+	tcp->coalesce_flush = coalesce_flush;
+	tcp->coalesce_due = coalesce_due;
+	tcp->coalesce_tick = coalesce_tick;
+	tcp->timer_arm = timer_arm;
+	tcp->timer_cancel = timer_cancel;
+	tcp->timer_deadline = timer_deadline;
+	tcp->conn_set_timeouts = conn_set_timeouts;
+	tcp->resolve = tcp_resolve;
+	tcp->new_accept_batch = New_Accept_Batch;
+	tcp->new_recv_batch = New_Recv_Batch;
+	tcp->new_send_batch = New_Send_Batch;
+	tcp->set_send_queue = sendq_attach;
+	tcp->sendq_push = sendq_push;
+	tcp->sendq_flush = sendq_flush;
+	tcp->sendq_pending = sendq_pending;
+	tcp->set_pipeline = pipe_attach;
+	tcp->pipe_send = pipe_send;
+	tcp->pipe_dispatch = pipe_dispatch;
+	tcp->pipe_recv = pipe_recv;
+	tcp->pipe_inflight = pipe_inflight;
+	tcp->pipe_fail = pipe_fail;
+	tcp->new_conn_pool = cpool_new;
+	tcp->free_conn_pool = cpool_free;
+	tcp->pool_checkout = cpool_checkout;
+	tcp->pool_checkin = cpool_checkin;
+	tcp->pool_prewarm = cpool_prewarm;
+	tcp->pool_tick = cpool_tick;
+	tcp->pool_idle = cpool_idle;
+	tcp->send_file = send_file;
+	tcp->set_zerocopy = zcopy_attach;
+	tcp->zcopy_send = zcopy_send;
+	tcp->zcopy_reap = zcopy_reap;
+	tcp->zcopy_done = zcopy_done;
+	tcp->set_proc_stripe = stripe_set;
+	tcp->stripe_snapshot = stripe_snapshot;
+	tcp->capture_start = capture_start;
+	tcp->capture_stop = capture_stop;
+	tcp->capture_flush = capture_flush;
+	tcp->set_tuning = tune_set;
+	tcp->define_tuning = tune_define;
+	tcp->get_tuning = tune_lookup;
+	tcp->read_tuning = tune_read;
+	tcp->set_spin_wait = spin_set;
+	tcp->spin_wait_budget = spin_budget;
 
-	/* allocate memory for connection structure */
-	tcp->tcp_connect = ( TCP_CONNECTION_INFO * ) malloc ( sizeof ( TCP_CONNECTION_INFO ) );
+#ifdef __TANDEM
+	tcp->engine = TCP_ENGINE_DEFAULT;
+#else
+	tcp->engine = nslx_select_engine ( engine );
+#endif
 
 	return tcp;
 }
 
+/******************************************************************************************
+*
+* NAME:                 release_tcp
+*
+* FUNCTION:             Returns a TCP from intialize_tcp (and its tcp_connect) to the pool.
+*                       Close the socket first; the structure must not be used afterwards.
+*                       A conn_table, framer or coalescing buffer left on it is freed too
+*                       (sockets are not closed, buffered sends are dropped); a conn_pool
+*                       closes its idle connections.
+*
+* RETURNS:              Nadda
+*
+*****************************************************************************************/
+void release_tcp ( TCP *tcp )
+{
+	if ( !tcp )
+		return;
+
+	if ( tcp->conn_table )
+		conn_table_free ( tcp->conn_table );
+	if ( tcp->conn_pool )
+		cpool_free ( tcp->conn_pool );
+	if ( tcp->tcp_connect )
+	{
+		framer_detach ( tcp->tcp_connect );
+		coalesce_detach ( tcp->tcp_connect );
+		sendq_detach ( tcp->tcp_connect );
+		pipe_detach ( tcp->tcp_connect );
+		zcopy_detach ( tcp->tcp_connect );
+	}
+	Pool_Put ( &tcp_block_pool, ( ( TCP_BLOCK * ) tcp )->connection.pool, ( TCP_BLOCK * ) tcp );
+}
+
+/******************************************************************************************
+*
+* NAME:                 tcp_thread_exit
+*
+* FUNCTION:             Frees everything the library keeps for the calling thread: the
+*                       TCP / connection pools and, on Linux, the nowait engine. For
+*                       threads that come and go (e.g. server shards).
+*
+* NOTE:                 Call it last. Every TCP and connection the thread got must have
+*                       been released, and its sockets closed, on whichever thread used
+*                       them: their memory goes here, even if another thread cleaned them.
+*
+* RETURNS:              Nadda
+*
+*****************************************************************************************/
+void tcp_thread_exit ( void )
+{
+	Pool_Drain ( &tcp_block_pool );
+	Pool_Drain ( &tcp_conn_pool );
+	tcp_stats_thread_exit ( );
+	capture_thread_exit ( );
+	timer_thread_exit ( );
+#ifndef __TANDEM
+	nslx_thread_exit ( );
+#endif
+}
+
+/******************************************************************************************
+*
+* NAME:                 tcp_clock_usec
+*
+* FUNCTION:             Monotonic clock in microseconds, for deadlines and timings.
+*
+* RETURNS:              long long
+*
+*****************************************************************************************/
+long long tcp_clock_usec ( void )
+{
+#ifdef __TANDEM
+	return JULIANTIMESTAMP ( 0 );
+#else
+	struct timespec now;
+
+	clock_gettime ( CLOCK_MONOTONIC, &now );
+	return ( long long ) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
+
 /******************************************************************************************
 *
 * NAME:                 Tcp_Set_Additionals
@@ -19,9 +19,34 @@
 *		VERSION		DATE	     COMMENTS
 *		-------    ------       ---------------------------------------------------
 *		1.0.0	  1/28/18		Initial Release 
+*		1.1.0	  10/17/26		Linux backend (nslinux.c) for non-Guardian builds
+*		1.2.0	  10/17/26		Completion queue: reap_completions / dispatch_completions
+*		1.3.0	  10/17/26		intialize_tcp_engine: epoll or io_uring on Linux
+*		1.4.0	  10/17/26		Pooled TCP / TCP_CONNECTION_INFO, inline sock + sockaddr
+*		1.5.0	  10/17/26		Connection table (nsctab.c) for many sockets per TCP
+*		1.6.0	  10/17/26		Scatter/gather: new_sendv / new_recvv / new_send_all
+*		1.7.0	  10/17/26		Length-prefixed framing (nsframe.c)
+*		1.8.0	  10/17/26		Send coalescing (nscork.c), tcp_clock_usec
+*		1.9.0	  10/17/26		Sharded SO_REUSEPORT server (nsshard.c), tcp_thread_exit
+*		1.11.0	  10/17/26		Operation counters (nsstats.c): TCP_CONN_STATS, TCP_OP_*
+*		1.12.0	  10/17/26		Timer wheel (nstimer.c), connection-table timeouts
+*		1.13.0	  10/17/26		Resolver cache (nsdns.c): set_sockaddr takes host names
+*		1.14.0	  10/17/26		new_accept_batch, new_recv_batch / new_send_batch
+*		1.17.0	  10/17/26		Multi-producer send queue (nssendq.c)
+*		1.18.0	  10/17/26		Pipelined requests with correlation IDs (nspipe.c)
+*		1.19.0	  10/17/26		Client connection pool (nscpool.c)
+*		1.20.0	  10/17/26		send_file and zero-copy sends (nszcopy.c)
+*		1.21.0	  10/17/26		Striping over several stacks (nsstrip.c)
+*		1.22.0	  10/17/26		Traffic capture (nscapt.c)
+*		1.24.0	  10/17/26		Socket tuning profiles (nstune.c)
+*		1.25.0	  10/17/26		Hybrid spin / blocking wait (nsspin.c)
+*		1.25.1	  10/17/26		TCP_ACCEPTED::tune_short, accept_short
+*		1.25.1	  10/17/26		TCP_ETIMEDOUT
+*		1.25.1	  10/17/26		TCP_CONNECTION_INFO::pool
 *************************************************************************************/
 
 #ifndef _NSTCPH_INCLUDE_
+#define _NSTCPH_INCLUDE_
 
 #ifdef __TANDEM
 #include <stdio.h>
@@ -40,20 +65,156 @@
 #include <in6.h>
 #include <ioctl.h>
 #else
-/* fill in what you would like here....*/
+/* Linux: nslinux.c supplies the Guardian nowait socket calls,
+*  FILE_CLOSE_ and AWAITIOX on top of non-blocking sockets + epoll */
+#include "NSLINUX.h"
 #endif
 
 
 /* Type Definitions */
-typedef char			TCP_IPADDR;
-typedef char			TCP_PROC_NAME;
+typedef char			TCP_IPADDR[64];
+typedef char			TCP_PROC_NAME[64];
 typedef unsigned short		TCP_PORT;
 typedef char			ERROR_MESSAGE[128];
+typedef unsigned int		TCP_HANDLE;
+#ifdef __TANDEM
+typedef int			TCP_SOCKLEN;
+#else
+typedef socklen_t		TCP_SOCKLEN;
+#endif
+
+/* one part of a scatter/gather send or receive; on Linux this is
+*  struct iovec itself, so the array goes to the kernel as is */
+#ifdef __TANDEM
+typedef struct tcp_iovec
+{
+	char				*iov_base;
+	int				iov_len;
+} TCP_IOVEC;
+#else
+typedef struct iovec		TCP_IOVEC;
+#endif
+
+/* per-thread storage for the library's free lists; Guardian
+*  processes are single threaded */
+#ifdef __TANDEM
+#define TCP_THREAD_LOCAL
+#else
+#define TCP_THREAD_LOCAL		__thread
+#endif
+
+/* objects carved out of the heap per refill of a pool free list */
+#define TCP_POOL_SLAB			64
 /* These ones below you may already have, 
 *  feel free to remove if you need to
 *  if using C99 --> #include<stdbool.h> */
 typedef enum { FAIL, SUCCESS } BOOLEAN;
 
+/* Guardian file-system errors the completion calls look for */
+#ifndef FENONEOUT
+#define FENONEOUT		26
+#endif
+#ifndef FETIMEDOUT
+#define FETIMEDOUT		40
+#endif
+
+/* TCP_COMPLETION error of an operation a timer deadline ended: the
+*  Guardian file-system error on Guardian, ETIMEDOUT on Linux, where
+*  completion errors are errno values (40 there is ELOOP) */
+#ifdef __TANDEM
+#define TCP_ETIMEDOUT		FETIMEDOUT
+#else
+#define TCP_ETIMEDOUT		ETIMEDOUT
+#endif
+
+/* nowait engines, see intialize_tcp_engine (Linux only; Guardian
+*  always runs on its own file system) */
+enum
+{
+	TCP_ENGINE_DEFAULT = 0,
+	TCP_ENGINE_EPOLL = 1,
+	TCP_ENGINE_IO_URING = 2
+};
+
+/* how many completions dispatch_completions reaps per wait */
+#define TCP_COMPLETION_BATCH	64
+/* most datagrams new_recv_batch / new_send_batch move per call */
+#define TCP_DATAGRAM_BATCH	64
+
+/* kinds of operation, for the counters in nsstats.h and
+*  TCP_COMPLETION::op (Guardian completions are TCP_OP_OTHER) */
+enum
+{
+	TCP_OP_OTHER = 0,
+	TCP_OP_SOCKET,
+	TCP_OP_CONNECT,
+	TCP_OP_ACCEPT,
+	TCP_OP_SEND,
+	TCP_OP_RECV,
+	TCP_OP_CLOSE,
+	TCP_OP_COUNT
+};
+
+/***************************************************************
+*
+*	Name:		TCP_CONN_STATS
+*	Type:		struct
+*	Purpose:	Counters of one connection. sends / recvs
+*				count calls, nowait ones when submitted;
+*				bytes from nowait calls are only known at
+*				completion, so they are counted here for
+*				connection-table sockets (conn_complete).
+*
+***************************************************************/
+typedef struct tcp_conn_stats
+{
+	long				sends;
+	long				recvs;
+	long				send_bytes;
+	long				recv_bytes;
+	long				partial_sends;
+	long				again;		/* EAGAIN / EWOULDBLOCK */
+	long				errors;
+} TCP_CONN_STATS;
+
+/***************************************************************
+*
+*	Name:		TCP_ACCEPTED
+*	Type:		struct
+*	Purpose:	One connection taken by new_accept_batch:
+*				its socket, the remote address, and what the
+*				listener's tuning profile fell short of on
+*				it (see nstune.h).
+*
+***************************************************************/
+typedef struct tcp_accepted
+{
+	int				sock;
+	struct sockaddr_in		sockaddr;
+	int				tune_short;
+} TCP_ACCEPTED;
+
+/***************************************************************
+*
+*	Name:		TCP_DATAGRAM
+*	Type:		struct
+*	Purpose:	One datagram for new_recv_batch or
+*				new_send_batch. Receiving, buffer holds size
+*				bytes; length comes back as the bytes taken,
+*				address as the sender, and truncated is set
+*				when the datagram didn't fit. Sending, length
+*				bytes of buffer go to address, or to the
+*				connected peer when sin_family is 0.
+*
+***************************************************************/
+typedef struct tcp_datagram
+{
+	char				*buffer;
+	int				size;
+	int				length;
+	int				truncated;
+	struct sockaddr_in		address;
+} TCP_DATAGRAM;
 
 
 /***************************************************************
@@ -66,7 +227,32 @@ typedef enum { FAIL, SUCCESS } BOOLEAN;
 *				you are free to change throughout your process
 *				as needed.
 *
+*				sock points at sock_num (-1 = no socket) and
+*				set_sockaddr points sockaddr at sockaddr_in,
+*				so no heap is used per connection.
+*
+*				framer is set by set_framer; see nsframe.h.
+*				coalesce is set by set_coalesce; see nscork.h.
+*				sendq is set by set_send_queue; see nssendq.h.
+*				pipeline is set by set_pipeline; see nspipe.h.
+*				zcopy is set by set_zerocopy; see nszcopy.h.
+*				stripe is the stack the socket is on when
+*				striping; see nsstrip.h.
+*				tune is the profile set by set_tuning and
+*				tune_short what the kernel didn't grant of it;
+*				accept_short is the same for the socket
+*				new_accept took last. See nstune.h.
+*				stats is kept by the library; see nsstats.h.
+*				pool is the thread's free list a connection
+*				from get_conn_info (or a TCP) came out of.
+*
 ***************************************************************/
+struct tcp_framer;
+struct tcp_coalesce;
+struct tcp_send_queue;
+struct tcp_pipeline;
+struct tcp_zcopy;
+
 typedef struct tcp_connection_info
 {
 	TCP_IPADDR			ipaddr;
@@ -79,8 +265,67 @@ typedef struct tcp_connection_info
 	long				tag;
 	struct sockaddr_in		*sockaddr;
 	int				sock_shutdown_how;
+	int				sock_num;
+	struct sockaddr_in		sockaddr_in;
+	int				pooled;
+	void				*pool;
+	struct tcp_framer		*framer;
+	struct tcp_coalesce		*coalesce;
+	TCP_CONN_STATS			stats;
+	struct tcp_send_queue		*sendq;
+	struct tcp_pipeline		*pipeline;
+	struct tcp_zcopy		*zcopy;
+	int				stripe;
+	int				tune;
+	int				tune_short;
+	int				accept_short;
 } TCP_CONNECTION_INFO;
 
+/* called by sendq_flush once a connection's send queue is back
+*  down to its low-water mark; see set_send_queue */
+typedef void (*TCP_SENDQ_DRAINED)		(TCP_CONNECTION_INFO *, void *);
+
+/* called by pipe_dispatch with a request's response (frame, length),
+*  or by pipe_fail with no frame and the error; see set_pipeline */
+typedef void (*TCP_PIPE_RESPONSE)		(TCP_CONNECTION_INFO *, void *, char *, long, int);
+
+/* called by zcopy_reap when the kernel is done with zero-copy sends
+*  first..last, copied set if it copied them after all; see set_zerocopy */
+typedef void (*TCP_ZCOPY_DONE)			(TCP_CONNECTION_INFO *, void *, unsigned int, unsigned int, int);
+
+/***************************************************************
+*
+*	Name:		TCP_COMPLETION
+*	Type:		struct
+*	Purpose:	One finished nowait operation, as handed back
+*				by reap_completions. tag is whatever was in
+*				TCP_CONNECTION_INFO::tag when the operation
+*				was submitted; count is the bytes moved out of
+*				the length asked for, and error is 0 or the
+*				failure reported for it. Guardian does not hand
+*				back the requested length, so there it is count.
+*
+*				op is the TCP_OP_* kind and usec the time from
+*				submit to completion when tcp_stats_latency is
+*				on, else -1 (both Linux only).
+*
+***************************************************************/
+typedef struct tcp_completion
+{
+	int				sock;
+	long				tag;
+	long				count;
+	int				error;
+	char				*buffer;
+	long				length;
+	int				op;
+	long long			usec;
+} TCP_COMPLETION;
+
+/* called once per completion by dispatch_completions;
+*  return non-zero to stop after the current batch */
+typedef int (*TCP_COMPLETION_HANDLER)		(TCP_COMPLETION *, void *);
+
 /***************************************************************
 *
 *	Name:		TCP
@@ -89,12 +334,46 @@ typedef struct tcp_connection_info
 *				be utilized throughout this library. It also
 *				contains a pointer to the TCP_CONNECTION_INFO
 *				structure, so you can operate solely from the 
-*				TCP structure pointer.
+*				TCP structure pointer. engine is the nowait
+*				engine actually in use (TCP_ENGINE_*).
+*
+*				conn_table is for servers and clients holding
+*				many sockets at once; see nsctab.h. It is 0
+*				until new_conn_table is called. conn_pool keeps
+*				client connections open between transactions;
+*				see nscpool.h. It is 0 until new_conn_pool is
+*				called.
+*
+*				The timer_* entries drive the thread's timer
+*				wheel; see nstimer.h. resolve (and so
+*				set_sockaddr) goes through the resolver
+*				cache; see nsdns.h. set_proc_stripe spreads
+*				sockets over several stacks; see nsstrip.h.
+*				capture_start records the traffic to a file
+*				for NSREPLAY.c; see nscapt.h. set_tuning
+*				gives a connection a socket tuning profile;
+*				see nstune.h. set_spin_wait has
+*				reap_completions spin before it blocks; see
+*				nsspin.h.
 *
 ***************************************************************/
+struct tcp_conn_table;
+struct tcp_conn_cold;
+struct tcp_conn_pool;
+struct tcp_stripe;
+struct tcp_timer;
+struct tcp_tune;
+
+/* called by the connection table when a connection has been idle
+*  for its idle timeout; see conn_set_timeouts */
+typedef void (*TCP_CONN_IDLE)			(struct tcp_conn_table *, TCP_HANDLE, void *);
+
 typedef	struct _tcp
 {
 	TCP_CONNECTION_INFO				*tcp_connect;
+	int						engine;
+	struct tcp_conn_table				*conn_table;
+	struct tcp_conn_pool				*conn_pool;
 	void(*set_proc)					(TCP_PROC_NAME);
 	int(*get_sock)					(TCP_CONNECTION_INFO *, int, int, int);
 	int(*get_sock_nw)				(TCP_CONNECTION_INFO *, int, int, int, int);
@@ -120,12 +399,93 @@ typedef	struct _tcp
 	void(*clean_conn_info)				(TCP_CONNECTION_INFO *);
 	void(*set_addtionals)				(TCP_CONNECTION_INFO *, int, int, long, long);
 	void(*set_sockaddr)				(TCP_CONNECTION_INFO *, short);
+	int(*reap_completions)				(TCP_COMPLETION *, int, long);
+	int(*dispatch_completions)			(TCP_COMPLETION_HANDLER, void *, long);
+	TCP_CONNECTION_INFO *(*get_conn_info)		(void);
+	struct tcp_conn_table *(*new_conn_table)	(int);
+	void(*free_conn_table)				(struct tcp_conn_table *);
+	TCP_HANDLE(*conn_add)				(struct tcp_conn_table *, int, int, long);
+	void(*conn_remove)				(struct tcp_conn_table *, TCP_HANDLE);
+	TCP_HANDLE(*conn_by_fd)				(struct tcp_conn_table *, int);
+	struct tcp_conn_cold *(*conn_cold)		(struct tcp_conn_table *, TCP_HANDLE);
+	int(*conn_send_nw)				(struct tcp_conn_table *, TCP_HANDLE, char*, int);
+	int(*conn_recv_nw)				(struct tcp_conn_table *, TCP_HANDLE, char*, int);
+	TCP_HANDLE(*conn_complete)			(struct tcp_conn_table *, TCP_COMPLETION *);
+	int(*new_sendv)					(TCP_CONNECTION_INFO *, TCP_IOVEC *, int);
+	int(*new_sendv_nw)				(TCP_CONNECTION_INFO *, TCP_IOVEC *, int);
+	int(*new_recvv)					(TCP_CONNECTION_INFO *, TCP_IOVEC *, int);
+	int(*new_recvv_nw)				(TCP_CONNECTION_INFO *, TCP_IOVEC *, int);
+	int(*new_send_all)				(TCP_CONNECTION_INFO *, TCP_IOVEC *, int);
+	int(*set_framer)				(TCP_CONNECTION_INFO *, long, int, int, long);
+	int(*frame_recv)				(TCP_CONNECTION_INFO *);
+	int(*frame_recv_nw)				(TCP_CONNECTION_INFO *);
+	void(*frame_commit)				(TCP_CONNECTION_INFO *, long);
+	int(*frame_next)				(TCP_CONNECTION_INFO *, char **, long *);
+	int(*frame_send)				(TCP_CONNECTION_INFO *, char *, long);
+	int(*set_coalesce)				(TCP_CONNECTION_INFO *, long, long, int, long, int);
+	int(*coalesce_send)				(TCP_CONNECTION_INFO *, char *, long);
+	int(*coalesce_flush)				(TCP_CONNECTION_INFO *);
+	long(*coalesce_due)				(TCP_CONNECTION_INFO *);
+	int(*coalesce_tick)				(TCP_CONNECTION_INFO *);
+	int(*timer_arm)					(struct tcp_timer *, long);
+	void(*timer_cancel)				(struct tcp_timer *);
+	int(*timer_deadline)				(struct tcp_timer *, int, long, long);
+	int(*conn_set_timeouts)				(struct tcp_conn_table *, long, long, TCP_CONN_IDLE, void *);
+	int(*resolve)					(const char *, struct in_addr *, long);
+	int(*new_accept_batch)				(TCP_CONNECTION_INFO *, TCP_ACCEPTED *, int);
+	int(*new_recv_batch)				(TCP_CONNECTION_INFO *, TCP_DATAGRAM *, int);
+	int(*new_send_batch)				(TCP_CONNECTION_INFO *, TCP_DATAGRAM *, int);
+	int(*set_send_queue)				(TCP_CONNECTION_INFO *, long, long, TCP_SENDQ_DRAINED, void *);
+	int(*sendq_push)				(TCP_CONNECTION_INFO *, char *, long);
+	long(*sendq_flush)				(TCP_CONNECTION_INFO *);
+	long(*sendq_pending)				(TCP_CONNECTION_INFO *);
+	int(*set_pipeline)				(TCP_CONNECTION_INFO *, int, long, int);
+	long(*pipe_send)				(TCP_CONNECTION_INFO *, char *, long, TCP_PIPE_RESPONSE, void *);
+	int(*pipe_dispatch)				(TCP_CONNECTION_INFO *);
+	int(*pipe_recv)					(TCP_CONNECTION_INFO *);
+	int(*pipe_inflight)				(TCP_CONNECTION_INFO *);
+	void(*pipe_fail)				(TCP_CONNECTION_INFO *, int);
+	struct tcp_conn_pool *(*new_conn_pool)		(struct _tcp *, int, int, long);
+	void(*free_conn_pool)				(struct tcp_conn_pool *);
+	TCP_CONNECTION_INFO *(*pool_checkout)		(struct tcp_conn_pool *, const char *, TCP_PORT);
+	void(*pool_checkin)				(struct tcp_conn_pool *, TCP_CONNECTION_INFO *, int);
+	int(*pool_prewarm)				(struct tcp_conn_pool *, const char *, TCP_PORT, int);
+	int(*pool_tick)					(struct tcp_conn_pool *);
+	int(*pool_idle)					(struct tcp_conn_pool *, const char *, TCP_PORT);
+	long(*send_file)				(TCP_CONNECTION_INFO *, int, long, long);
+	int(*set_zerocopy)				(TCP_CONNECTION_INFO *, long, TCP_ZCOPY_DONE, void *);
+	long(*zcopy_send)				(TCP_CONNECTION_INFO *, char *, long, unsigned int *);
+	int(*zcopy_reap)				(TCP_CONNECTION_INFO *);
+	int(*zcopy_done)				(TCP_CONNECTION_INFO *, unsigned int);
+	int(*set_proc_stripe)				(char **, int, int);
+	int(*stripe_snapshot)				(struct tcp_stripe *, int);
+	int(*capture_start)				(const char *, long, long);
+	int(*capture_stop)				(void);
+	void(*capture_flush)				(void);
+	int(*set_tuning)				(TCP_CONNECTION_INFO *, const char *);
+	int(*define_tuning)				(const struct tcp_tune *);
+	int(*get_tuning)				(const char *, struct tcp_tune *);
+	int(*read_tuning)				(int, struct tcp_tune *);
+	int(*set_spin_wait)				(int, long);
+	long(*spin_wait_budget)				(void);
 } TCP;
 
 /**********************************************************
 *		Function Prototype Definition(s)
 **********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 TCP *intialize_tcp ( void );
+TCP *intialize_tcp_engine ( int engine );
+void release_tcp ( TCP *tcp );
+long long tcp_clock_usec ( void );
+void tcp_thread_exit ( void );
+
+#ifdef __cplusplus
+}
+#endif
 
 enum
 {
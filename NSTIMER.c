@@ -0,0 +1,429 @@
+/************************************************************************************
+*		FILE:		"nstimer.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Per-thread hierarchical timer wheel. See nstimer.h.
+*
+*		Notes:		The slot layout follows the classic kernel timer
+*					wheel: a timer due within 256 ticks sits in level 0
+*					at its own tick, further ones in the level whose
+*					span covers the distance, indexed by that level's
+*					bits of the expiry tick. Each time level 0 wraps,
+*					the next slot of level 1 is re-filed (and so on up),
+*					which puts its timers back at their exact tick.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.12.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Deadlines end with TCP_ETIMEDOUT
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nstimerh"
+#else
+#include "NSTIMER.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						TYPES AND CONSTANTS
+***************************************************************************************/
+
+#define TIMER_SLOT_MASK			( TCP_TIMER_SLOTS - 1 )
+#define TIMER_INDEX(tick, level)	( ( int ) ( ( tick ) >> ( ( level ) * TCP_TIMER_SLOT_BITS ) ) & TIMER_SLOT_MASK )
+#define TIMER_MAX_TICKS			0xffffffffLL
+
+static TCP_THREAD_LOCAL TCP_TIMER_WHEEL *timer_wheel;
+
+/* Guardian: operations cancelled by a deadline, waiting to be
+*  handed back as TCP_ETIMEDOUT completions */
+static TCP_THREAD_LOCAL TCP_TIMER *timer_expired;
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Timer_Wheel
+*
+* FUNCTION:             The calling thread's wheel, made on first
+*                       use when create is set.
+*
+* RETURNS:              TCP_TIMER_WHEEL * - 0 if none / no memory
+***************************************************************/
+static TCP_TIMER_WHEEL *Timer_Wheel ( int create )
+{
+	if ( !timer_wheel && create )
+	{
+		timer_wheel = ( TCP_TIMER_WHEEL * ) calloc ( 1, sizeof ( TCP_TIMER_WHEEL ) );
+		if ( timer_wheel )
+			timer_wheel->origin_usec = tcp_clock_usec ( );
+	}
+
+	return timer_wheel;
+}
+
+static long long Timer_Tick_Now ( TCP_TIMER_WHEEL *wheel )
+{
+	return ( tcp_clock_usec ( ) - wheel->origin_usec ) / TCP_TIMER_TICK_USEC;
+}
+
+/***************************************************************
+*
+* NAME:                           Timer_Link / Timer_Unlink
+*
+* FUNCTION:             Files a timer in the slot its expiry tick
+*                       belongs to, or takes it out of its slot.
+*
+***************************************************************/
+static void Timer_Link ( TCP_TIMER_WHEEL *wheel, TCP_TIMER *timer )
+{
+	long long	  distance = timer->expires - wheel->now_tick;
+	TCP_TIMER	**slot;
+
+	if ( distance < 0 )
+		slot = &wheel->slots[0][TIMER_INDEX ( wheel->now_tick, 0 )];
+	else if ( distance < 1LL << TCP_TIMER_SLOT_BITS )
+		slot = &wheel->slots[0][TIMER_INDEX ( timer->expires, 0 )];
+	else if ( distance < 1LL << ( 2 * TCP_TIMER_SLOT_BITS ) )
+		slot = &wheel->slots[1][TIMER_INDEX ( timer->expires, 1 )];
+	else if ( distance < 1LL << ( 3 * TCP_TIMER_SLOT_BITS ) )
+		slot = &wheel->slots[2][TIMER_INDEX ( timer->expires, 2 )];
+	else
+	{
+		if ( distance > TIMER_MAX_TICKS )
+			timer->expires = wheel->now_tick + TIMER_MAX_TICKS;
+		slot = &wheel->slots[3][TIMER_INDEX ( timer->expires, 3 )];
+	}
+
+	timer->next = *slot;
+	if ( timer->next )
+		timer->next->link = &timer->next;
+	*slot = timer;
+	timer->link = slot;
+}
+
+static void Timer_Unlink ( TCP_TIMER *timer )
+{
+	*timer->link = timer->next;
+	if ( timer->next )
+		timer->next->link = timer->link;
+	timer->next = 0;
+	timer->link = 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Timer_Cascade
+*
+* FUNCTION:             Re-files every timer of one slot of a higher
+*                       level into the levels below.
+*
+* RETURNS:              int - the slot index (0 means the level
+*                       above is due to cascade as well)
+***************************************************************/
+static int Timer_Cascade ( TCP_TIMER_WHEEL *wheel, int level, int index )
+{
+	TCP_TIMER *list = wheel->slots[level][index];
+	TCP_TIMER *timer;
+
+	wheel->slots[level][index] = 0;
+	if ( list )
+		list->link = &list;
+
+	while ( ( timer = list ) != 0 )
+	{
+		Timer_Unlink ( timer );
+		Timer_Link ( wheel, timer );
+	}
+
+	return index;
+}
+
+/***************************************************************
+*
+* NAME:                           Timer_Op_Expired
+*
+* FUNCTION:             Callback of timer_deadline: has the
+*                       operation it guards handed back with
+*                       TCP_ETIMEDOUT, unless it has completed.
+*
+***************************************************************/
+static void Timer_Op_Expired ( TCP_TIMER *timer, void *context )
+{
+	( void ) context;
+
+#ifdef __TANDEM
+	/* Guardian drops a cancelled request without a completion, so
+	*  the timer itself carries it to Reap_Completions */
+	if ( _status_eq ( CANCELREQ ( ( short ) timer->sock, timer->tag ) ) )
+	{
+		timer->next = timer_expired;
+		timer_expired = timer;
+	}
+#else
+	nslx_timeout_op ( timer->sock, timer->tag );
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           timer_init
+*
+* FUNCTION:             Prepares a timer; callback runs with context
+*                       each time it fires.
+*
+* RETURNS:              nothing
+***************************************************************/
+void timer_init ( TCP_TIMER *timer, TCP_TIMER_CALLBACK callback, void *context )
+{
+	memset ( timer, 0, sizeof ( *timer ) );
+	timer->callback = callback;
+	timer->context = context;
+	timer->sock = -1;
+}
+
+/***************************************************************
+*
+* NAME:                           timer_arm
+*
+* FUNCTION:             Fires the timer usec from now (rounded up to
+*                       the next tick). An armed timer is moved, so
+*                       pushing an idle timeout back on every message
+*                       is a single re-file.
+*
+* RETURNS:              int - 0, -1 if the wheel can't be made
+***************************************************************/
+int timer_arm ( TCP_TIMER *timer, long usec )
+{
+	TCP_TIMER_WHEEL	*wheel = Timer_Wheel ( 1 );
+
+	if ( !wheel )
+		return -1;
+
+	if ( timer->link )
+		Timer_Unlink ( timer );
+	else
+		wheel->count++;
+
+	if ( usec < 0 )
+		usec = 0;
+	timer->expires = Timer_Tick_Now ( wheel ) + ( usec + TCP_TIMER_TICK_USEC - 1 ) / TCP_TIMER_TICK_USEC;
+	Timer_Link ( wheel, timer );
+
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           timer_cancel
+*
+* FUNCTION:             Disarms a timer; nothing happens if it isn't
+*                       armed.
+*
+* RETURNS:              nothing
+***************************************************************/
+void timer_cancel ( TCP_TIMER *timer )
+{
+	if ( !timer->link )
+		return;
+
+	Timer_Unlink ( timer );
+	timer_wheel->count--;
+}
+
+int timer_armed ( TCP_TIMER *timer )
+{
+	return timer->link != 0;
+}
+
+/***************************************************************
+*
+* NAME:                           timer_deadline
+*
+* FUNCTION:             Gives the nowait operation submitted on sock
+*                       under tag usec to finish. If it hasn't by
+*                       then it is cancelled and reaped with error
+*                       TCP_ETIMEDOUT (on Linux, with whatever count
+*                       it had reached).
+*
+* NOTE:                 The timer is overwritten; cancel it when the
+*                       operation completes. On Guardian, don't reuse
+*                       it until the TCP_ETIMEDOUT completion is reaped.
+*
+* RETURNS:              int - 0, -1 if the wheel can't be made
+***************************************************************/
+int timer_deadline ( TCP_TIMER *timer, int sock, long tag, long usec )
+{
+	if ( !timer->link )
+		timer_init ( timer, Timer_Op_Expired, 0 );
+	timer->callback = Timer_Op_Expired;
+	timer->context = 0;
+	timer->sock = sock;
+	timer->tag = tag;
+
+	return timer_arm ( timer, usec );
+}
+
+/***************************************************************
+*
+* NAME:                           timer_run
+*
+* FUNCTION:             Fires every timer that is due, running the
+*                       wheel up to the current tick.
+*
+* RETURNS:              int - timers fired
+***************************************************************/
+int timer_run ( void )
+{
+	TCP_TIMER_WHEEL	*wheel = timer_wheel;
+	TCP_TIMER	*list;
+	TCP_TIMER	*timer;
+	long long	 target;
+	int		 index;
+	int		 fired = 0;
+
+	if ( !wheel )
+		return 0;
+
+	target = Timer_Tick_Now ( wheel );
+	while ( wheel->now_tick <= target )
+	{
+		/* nothing armed: skip the idle ticks in one step */
+		if ( !wheel->count )
+		{
+			wheel->now_tick = target + 1;
+			break;
+		}
+
+		index = TIMER_INDEX ( wheel->now_tick, 0 );
+		if ( !index
+		  && !Timer_Cascade ( wheel, 1, TIMER_INDEX ( wheel->now_tick, 1 ) )
+		  && !Timer_Cascade ( wheel, 2, TIMER_INDEX ( wheel->now_tick, 2 ) ) )
+			Timer_Cascade ( wheel, 3, TIMER_INDEX ( wheel->now_tick, 3 ) );
+
+		/* take the tick's list first, so timers armed by the
+		*  callbacks land in a later tick */
+		list = wheel->slots[0][index];
+		wheel->slots[0][index] = 0;
+		if ( list )
+			list->link = &list;
+		wheel->now_tick++;
+
+		while ( ( timer = list ) != 0 )
+		{
+			Timer_Unlink ( timer );
+			wheel->count--;
+			fired++;
+			timer->callback ( timer, timer->context );
+		}
+	}
+
+	return fired;
+}
+
+/***************************************************************
+*
+* NAME:                           timer_due
+*
+* FUNCTION:             How long reap_completions may wait before
+*                       the wheel needs running again: up to the
+*                       next non-empty tick, or the next cascade.
+*
+* RETURNS:              long - 0.01 sec units, -1 if nothing armed
+***************************************************************/
+long timer_due ( void )
+{
+	TCP_TIMER_WHEEL	*wheel = timer_wheel;
+	long long	 tick;
+	long long	 due;
+	int		 i;
+
+	if ( !wheel || !wheel->count )
+		return -1;
+
+	/* bounded scan: stops at the next level-0 wrap */
+	tick = wheel->now_tick;
+	for ( i = 0; i < TCP_TIMER_SLOTS; i++, tick++ )
+	{
+		if ( wheel->slots[0][TIMER_INDEX ( tick, 0 )] || ( i && !TIMER_INDEX ( tick, 0 ) ) )
+			break;
+	}
+
+	due = ( tick - Timer_Tick_Now ( wheel ) ) * ( TCP_TIMER_TICK_USEC / 10000 );
+	return due > 0 ? ( long ) due : 0;
+}
+
+/***************************************************************
+*
+* NAME:                           timer_reap_expired
+*
+* FUNCTION:             Hands back the operations Guardian cancelled
+*                       for a deadline, as TCP_ETIMEDOUT completions.
+*                       Linux reports them through the engine itself.
+*
+* RETURNS:              int - completions stored
+***************************************************************/
+int timer_reap_expired ( TCP_COMPLETION *completions, int max )
+{
+	TCP_TIMER	*timer;
+	int		 reaped = 0;
+
+	while ( reaped < max && ( timer = timer_expired ) != 0 )
+	{
+		timer_expired = timer->next;
+		timer->next = 0;
+
+		memset ( &completions[reaped], 0, sizeof ( TCP_COMPLETION ) );
+		completions[reaped].sock = timer->sock;
+		completions[reaped].tag = timer->tag;
+		completions[reaped].error = TCP_ETIMEDOUT;
+		completions[reaped].op = TCP_OP_OTHER;
+		completions[reaped].usec = -1;
+		reaped++;
+	}
+
+	return reaped;
+}
+
+/***************************************************************
+*
+* NAME:                           timer_thread_exit
+*
+* FUNCTION:             Frees the calling thread's wheel. Timers
+*                       still armed are disarmed, not fired.
+*
+* RETURNS:              nothing
+***************************************************************/
+void timer_thread_exit ( void )
+{
+	TCP_TIMER	*timer;
+	int		 level;
+	int		 index;
+
+	if ( !timer_wheel )
+		return;
+
+	for ( level = 0; level < TCP_TIMER_LEVELS; level++ )
+		for ( index = 0; index < TCP_TIMER_SLOTS; index++ )
+			while ( ( timer = timer_wheel->slots[level][index] ) != 0 )
+				Timer_Unlink ( timer );
+
+	free ( timer_wheel );
+	timer_wheel = 0;
+	timer_expired = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
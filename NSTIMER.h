@@ -0,0 +1,119 @@
+/************************************************************************************
+*		FILE:		"nstimer.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Timers for the completion engine: deadlines on nowait
+*					operations, idle and keepalive timeouts, or any other
+*					callback an event loop needs at a later time.
+*
+*		Notes:		A hierarchical timing wheel per thread: four levels of
+*					256 slots, ticking every 0.01 sec (the AWAITIOX unit),
+*					so arm, re-arm and cancel are O(1) and reaching about
+*					497 days. A level-0 slot holds the timers of one tick;
+*					each higher level holds 256 times the span of the one
+*					below and is cascaded down as time reaches it. Timers
+*					are intrusive: the caller owns the TCP_TIMER, usually
+*					inside its own connection record, so nothing is
+*					allocated per timer.
+*
+*					Timers fire from reap_completions (and so from
+*					dispatch_completions), which also shortens its wait
+*					to the next due timer. A callback may arm or cancel
+*					any timer, including its own.
+*
+*					timer_deadline bounds one nowait operation: when it
+*					fires the operation comes back as a completion with
+*					error TCP_ETIMEDOUT (ETIMEDOUT on Linux, FETIMEDOUT
+*					on Guardian). Cancel the timer when the operation
+*					completes first.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.12.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Deadlines end with TCP_ETIMEDOUT
+*************************************************************************************/
+
+#ifndef _NSTIMERH_INCLUDE_
+#define _NSTIMERH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* wheel geometry */
+#define TCP_TIMER_TICK_USEC		10000L
+#define TCP_TIMER_LEVELS		4
+#define TCP_TIMER_SLOT_BITS		8
+#define TCP_TIMER_SLOTS			( 1 << TCP_TIMER_SLOT_BITS )
+
+struct tcp_timer;
+typedef void (*TCP_TIMER_CALLBACK)		(struct tcp_timer *, void *);
+
+/***************************************************************
+*
+*	Name:		TCP_TIMER
+*	Type:		struct
+*	Purpose:	One timer. Set it up with timer_init; after
+*				that the library owns every field. link is
+*				0 while the timer is not armed.
+*
+***************************************************************/
+typedef struct tcp_timer
+{
+	struct tcp_timer		*next;
+	struct tcp_timer		**link;		/* the pointer that points at this timer */
+	long long			expires;	/* tick */
+	TCP_TIMER_CALLBACK		callback;
+	void				*context;
+	int				sock;		/* timer_deadline */
+	long				tag;
+} TCP_TIMER;
+
+/***************************************************************
+*
+*	Name:		TCP_TIMER_WHEEL
+*	Type:		struct
+*	Purpose:	A thread's wheel. now_tick is the next tick to
+*				be run; ticks count from origin_usec.
+*
+***************************************************************/
+typedef struct tcp_timer_wheel
+{
+	long long			origin_usec;
+	long long			now_tick;
+	long				count;
+	TCP_TIMER			*slots[TCP_TIMER_LEVELS][TCP_TIMER_SLOTS];
+} TCP_TIMER_WHEEL;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void timer_init ( TCP_TIMER *timer, TCP_TIMER_CALLBACK callback, void *context );
+int timer_arm ( TCP_TIMER *timer, long usec );
+void timer_cancel ( TCP_TIMER *timer );
+int timer_armed ( TCP_TIMER *timer );
+int timer_deadline ( TCP_TIMER *timer, int sock, long tag, long usec );
+
+/* used by reap_completions */
+int timer_run ( void );
+long timer_due ( void );
+int timer_reap_expired ( TCP_COMPLETION *completions, int max );
+void timer_thread_exit ( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSTIMERH_INCLUDE_
@@ -0,0 +1,375 @@
+/************************************************************************************
+*		FILE:		"nstune.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Socket tuning profiles. See nstune.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.24.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		tune_number; tune_accepted takes the profile number
+*************************************************************************************/
+
+#ifdef __TANDEM
+#include "=nstuneh"
+#else
+#include "NSTUNE.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* options some platforms lack; -1 = not here */
+#ifdef TCP_QUICKACK
+#define TUNE_QUICKACK			TCP_QUICKACK
+#else
+#define TUNE_QUICKACK			( -1 )
+#endif
+#ifdef SO_BUSY_POLL
+#define TUNE_BUSY_POLL			SO_BUSY_POLL
+#else
+#define TUNE_BUSY_POLL			( -1 )
+#endif
+#ifdef TCP_KEEPIDLE
+#define TUNE_KEEP_IDLE			TCP_KEEPIDLE
+#else
+#define TUNE_KEEP_IDLE			( -1 )
+#endif
+#ifdef TCP_KEEPINTVL
+#define TUNE_KEEP_INTVL			TCP_KEEPINTVL
+#else
+#define TUNE_KEEP_INTVL			( -1 )
+#endif
+#ifdef TCP_KEEPCNT
+#define TUNE_KEEP_CNT			TCP_KEEPCNT
+#else
+#define TUNE_KEEP_CNT			( -1 )
+#endif
+
+/* how a value read back is checked against the one asked for */
+enum { TUNE_CHECK_NONE = 0, TUNE_CHECK_FLAG, TUNE_CHECK_AT_LEAST, TUNE_CHECK_EXACT };
+
+/* one option a profile can set, in TCP_TUNE order */
+typedef struct tune_option
+{
+	int				bit;
+	int				level;
+	int				option;
+	int				check;
+} TUNE_OPTION;
+
+static const TUNE_OPTION tune_options[] =
+{
+	{ TCP_TUNE_NODELAY,	IPPROTO_TCP,	TCP_NODELAY,		TUNE_CHECK_FLAG },
+	{ TCP_TUNE_QUICKACK,	IPPROTO_TCP,	TUNE_QUICKACK,		TUNE_CHECK_NONE },
+	{ TCP_TUNE_SNDBUF,	SOL_SOCKET,	SO_SNDBUF,		TUNE_CHECK_AT_LEAST },
+	{ TCP_TUNE_RCVBUF,	SOL_SOCKET,	SO_RCVBUF,		TUNE_CHECK_AT_LEAST },
+	{ TCP_TUNE_BUSY_POLL,	SOL_SOCKET,	TUNE_BUSY_POLL,		TUNE_CHECK_EXACT },
+	{ TCP_TUNE_KEEPALIVE,	SOL_SOCKET,	SO_KEEPALIVE,		TUNE_CHECK_FLAG },
+	{ TCP_TUNE_KEEP_IDLE,	IPPROTO_TCP,	TUNE_KEEP_IDLE,		TUNE_CHECK_EXACT },
+	{ TCP_TUNE_KEEP_INTVL,	IPPROTO_TCP,	TUNE_KEEP_INTVL,	TUNE_CHECK_EXACT },
+	{ TCP_TUNE_KEEP_CNT,	IPPROTO_TCP,	TUNE_KEEP_CNT,		TUNE_CHECK_EXACT }
+};
+
+#define TUNE_OPTIONS			( ( int ) ( sizeof ( tune_options ) / sizeof ( tune_options[0] ) ) )
+
+/*	name		nodelay	quickack sndbuf		rcvbuf		busy_poll keepalive idle intvl cnt backlog */
+static TCP_TUNE tune_profiles[TCP_TUNE_MAX] =
+{
+	{ "low-latency",	1,  1, -1,		-1,		50, -1, -1, -1, -1, -1 },
+	{ "bulk",		0, -1, 4 * 1024 * 1024,	4 * 1024 * 1024, -1, -1, -1, -1, -1, -1 },
+	{ "many-idle",		1, -1, 16384,		16384,		-1,  1, 60, 10,  6, 4096 }
+};
+static int tune_count = 3;
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/***************************************************************
+*
+* NAME:                           Tune_Field
+*
+* FUNCTION:             The value of option i (tune_options order)
+*                       in a profile.
+*
+* RETURNS:              int * - the field
+***************************************************************/
+static int *Tune_Field ( TCP_TUNE *profile, int i )
+{
+	switch ( i )
+	{
+	case 0:  return &profile->nodelay;
+	case 1:  return &profile->quickack;
+	case 2:  return &profile->sndbuf;
+	case 3:  return &profile->rcvbuf;
+	case 4:  return &profile->busy_poll;
+	case 5:  return &profile->keepalive;
+	case 6:  return &profile->keep_idle;
+	case 7:  return &profile->keep_intvl;
+	default: return &profile->keep_cnt;
+	}
+}
+
+static int Tune_Find ( const char *name )
+{
+	int i;
+
+	for ( i = 0; i < tune_count; i++ )
+		if ( !strcmp ( tune_profiles[i].name, name ) )
+			return i;
+
+	return -1;
+}
+
+/***************************************************************
+*
+* NAME:                           Tune_Apply
+*
+* FUNCTION:             Sets every option profile gives on sock,
+*                       then reads them back.
+*
+* RETURNS:              int - TCP_TUNE_* bits of the options
+*                       refused or granted short
+***************************************************************/
+static int Tune_Apply ( int sock, TCP_TUNE *profile )
+{
+	TCP_TUNE	granted;
+	int		asked;
+	int		got;
+	int		shorted = 0;
+	int		i;
+
+	for ( i = 0; i < TUNE_OPTIONS; i++ )
+	{
+		asked = *Tune_Field ( profile, i );
+		if ( asked == TCP_TUNE_LEAVE )
+			continue;
+		if ( tune_options[i].option < 0
+		  || setsockopt ( sock, tune_options[i].level, tune_options[i].option, ( char * ) &asked, sizeof ( asked ) ) < 0 )
+			shorted |= tune_options[i].bit;
+	}
+
+	tune_read ( sock, &granted );
+	for ( i = 0; i < TUNE_OPTIONS; i++ )
+	{
+		asked = *Tune_Field ( profile, i );
+		got = *Tune_Field ( &granted, i );
+		if ( asked == TCP_TUNE_LEAVE )
+			continue;
+		switch ( tune_options[i].check )
+		{
+		case TUNE_CHECK_FLAG:
+			if ( ( got > 0 ) != ( asked != 0 ) )
+				shorted |= tune_options[i].bit;
+			break;
+		case TUNE_CHECK_AT_LEAST:
+			if ( got < asked )
+				shorted |= tune_options[i].bit;
+			break;
+		case TUNE_CHECK_EXACT:
+			if ( got != asked )
+				shorted |= tune_options[i].bit;
+			break;
+		}
+	}
+
+	return shorted;
+}
+
+/***************************************************************
+*
+* NAME:                           tune_set
+*
+* FUNCTION:             Gives a connection the profile called name
+*                       (0 or "" for none), and applies it to the
+*                       socket the connection has, if any.
+*
+* RETURNS:              int - 0, or -1 for an unknown name
+***************************************************************/
+int tune_set ( TCP_CONNECTION_INFO *connection, const char *name )
+{
+	int tune = tune_number ( name );
+
+	connection->tune_short = 0;
+	if ( tune < 0 )
+		return -1;
+
+	connection->tune = tune;
+	if ( tune && connection->sock && *connection->sock >= 0 )
+		tune_socket ( connection );
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           tune_number
+*
+* FUNCTION:             The number of the profile called name, as
+*                       TCP_CONNECTION_INFO::tune keeps it.
+*
+* RETURNS:              int - 0 for no name, -1 for an unknown one
+***************************************************************/
+int tune_number ( const char *name )
+{
+	int index;
+
+	if ( !name || !*name )
+		return 0;
+
+	index = Tune_Find ( name );
+	return index < 0 ? -1 : index + 1;
+}
+
+/***************************************************************
+*
+* NAME:                           tune_define
+*
+* FUNCTION:             Adds a profile, or replaces the one with
+*                       the same name (built-in ones too).
+*
+* NOTE:                 Not while sockets are being made.
+*
+* RETURNS:              int - 0, or -1 when unnamed or the table
+*                       is full
+***************************************************************/
+int tune_define ( const TCP_TUNE *profile )
+{
+	int index;
+
+	if ( !profile || !profile->name[0] || !memchr ( profile->name, '\0', sizeof ( profile->name ) ) )
+		return -1;
+
+	index = Tune_Find ( profile->name );
+	if ( index < 0 )
+	{
+		if ( tune_count == TCP_TUNE_MAX )
+			return -1;
+		index = tune_count++;
+	}
+
+	tune_profiles[index] = *profile;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           tune_lookup
+*
+* FUNCTION:             Copies out the profile called name.
+*
+* RETURNS:              int - 0, or -1 for an unknown name
+***************************************************************/
+int tune_lookup ( const char *name, TCP_TUNE *profile )
+{
+	int index = name ? Tune_Find ( name ) : -1;
+
+	if ( index < 0 )
+		return -1;
+
+	*profile = tune_profiles[index];
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           tune_read
+*
+* FUNCTION:             Reads back what sock has of every option a
+*                       profile can set; TCP_TUNE_LEAVE for those
+*                       that can't be read here. backlog can't be
+*                       read back at all.
+*
+* RETURNS:              int - 0, or -1 when sock isn't a socket
+***************************************************************/
+int tune_read ( int sock, TCP_TUNE *granted )
+{
+	TCP_SOCKLEN	length;
+	int		value;
+	int		read = 0;
+	int		i;
+
+	memset ( granted, 0, sizeof ( *granted ) );
+	granted->backlog = TCP_TUNE_LEAVE;
+
+	for ( i = 0; i < TUNE_OPTIONS; i++ )
+	{
+		value = TCP_TUNE_LEAVE;
+		length = sizeof ( value );
+		if ( tune_options[i].option >= 0
+		  && getsockopt ( sock, tune_options[i].level, tune_options[i].option, ( char * ) &value, &length ) == 0 )
+			read++;
+		else
+			value = TCP_TUNE_LEAVE;
+		*Tune_Field ( granted, i ) = value;
+	}
+
+	return read ? 0 : -1;
+}
+
+/***************************************************************
+*
+* NAME:                           tune_socket
+*
+* FUNCTION:             Applies the connection's profile to its
+*                       socket and notes what fell short. Called by
+*                       get_sock / get_sock_nw.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void tune_socket ( TCP_CONNECTION_INFO *connection )
+{
+	if ( connection->tune <= 0 || connection->tune > tune_count || *connection->sock < 0 )
+		return;
+
+	connection->tune_short = Tune_Apply ( *connection->sock, &tune_profiles[connection->tune - 1] );
+}
+
+/***************************************************************
+*
+* NAME:                           tune_accepted
+*
+* FUNCTION:             Applies profile number tune (a listener's)
+*                       to a socket it accepted. Called by
+*                       new_accept / new_accept_batch and the
+*                       sharded server.
+*
+* RETURNS:              int - TCP_TUNE_* bits of the options
+*                       refused or granted short
+***************************************************************/
+int tune_accepted ( int tune, int sock )
+{
+	if ( tune <= 0 || tune > tune_count || sock < 0 )
+		return 0;
+
+	return Tune_Apply ( sock, &tune_profiles[tune - 1] );
+}
+
+/***************************************************************
+*
+* NAME:                           tune_backlog
+*
+* FUNCTION:             The listen backlog for a connection: its
+*                       profile's, else queue_len. Called by
+*                       set_listen.
+*
+* RETURNS:              int - the backlog
+***************************************************************/
+int tune_backlog ( TCP_CONNECTION_INFO *connection )
+{
+	if ( connection->tune > 0 && connection->tune <= tune_count
+	  && tune_profiles[connection->tune - 1].backlog != TCP_TUNE_LEAVE )
+		return tune_profiles[connection->tune - 1].backlog;
+
+	return connection->queue_len;
+}
+
+#ifdef __cplusplus
+}
+#endif
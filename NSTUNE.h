@@ -0,0 +1,143 @@
+/************************************************************************************
+*		FILE:		"nstune.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Socket tuning profiles: named sets of socket options
+*					(TCP_NODELAY, buffer sizes, TCP_QUICKACK, SO_BUSY_POLL,
+*					keepalive, listen backlog) that the library applies to
+*					a socket as it is made, instead of ad-hoc setsockopt
+*					calls in every application.
+*
+*		Notes:		set_tuning ( connection, name ) picks a profile for
+*					the connection. From then on get_sock / get_sock_nw
+*					apply it to each socket they make, before it connects
+*					or listens; a socket the connection has already is
+*					tuned at once. set_listen uses the profile's backlog
+*					over queue_len, and new_accept / new_accept_batch
+*					apply the listener's profile to every socket they
+*					accept. For new_accept_nw2 / _nw3, give the accepting
+*					connection the profile too: it is applied once the
+*					accepted connection is on that socket. The sharded
+*					server takes a profile name in
+*					TCP_SERVER_CONFIG::tuning. name 0 (or "") turns
+*					tuning off.
+*
+*					Built in are "low-latency" (TCP_NODELAY, TCP_QUICKACK,
+*					SO_BUSY_POLL), "bulk" (4 MB buffers, Nagle left on)
+*					and "many-idle" (small buffers, keepalive that finds
+*					dead peers in about two minutes, a long backlog).
+*					define_tuning adds a profile or replaces one by name;
+*					TCP_TUNE_LEAVE leaves an option as the system has it.
+*
+*					After applying a profile the library reads every
+*					option back. Bits of TCP_CONNECTION_INFO::tune_short
+*					(TCP_TUNE_*) mark the ones the kernel refused or
+*					granted less of. For accepted sockets they land in
+*					the listener's accept_short (new_accept, the last
+*					socket taken), in TCP_ACCEPTED::tune_short
+*					(new_accept_batch), in the accepting connection's
+*					tune_short (new_accept_nw2 / _nw3) and in
+*					TCP_CONN_COLD::tune_short (sharded server). Typical
+*					shortfalls are buffers capped by
+*					net.core.wmem_max, or SO_BUSY_POLL without
+*					CAP_NET_ADMIN. read_tuning gives the values granted.
+*					Linux reports twice the buffer size asked for (the
+*					rest is its bookkeeping); that counts as granted.
+*					TCP_QUICKACK does not stick on Linux, so it is set but
+*					not checked. Options the platform lacks (TCP_QUICKACK,
+*					SO_BUSY_POLL and the keepalive timings on Guardian)
+*					are marked short.
+*
+*					Profiles are process wide. Define them before the
+*					threads start making sockets.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.24.0	  10/17/26		Initial Release
+*		1.25.1	  10/17/26		Accepted sockets' shortfalls kept; nowait, shard accepts tuned
+*************************************************************************************/
+
+#ifndef _NSTUNEH_INCLUDE_
+#define _NSTUNEH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* most profiles, built-in ones included */
+#define TCP_TUNE_MAX			16
+
+/* an option a profile leaves alone (or, read back, couldn't read) */
+#define TCP_TUNE_LEAVE			( -1 )
+
+/* TCP_CONNECTION_INFO::tune_short bits */
+enum
+{
+	TCP_TUNE_NODELAY	= 0x001,
+	TCP_TUNE_QUICKACK	= 0x002,
+	TCP_TUNE_SNDBUF		= 0x004,
+	TCP_TUNE_RCVBUF		= 0x008,
+	TCP_TUNE_BUSY_POLL	= 0x010,
+	TCP_TUNE_KEEPALIVE	= 0x020,
+	TCP_TUNE_KEEP_IDLE	= 0x040,
+	TCP_TUNE_KEEP_INTVL	= 0x080,
+	TCP_TUNE_KEEP_CNT	= 0x100
+};
+
+/***************************************************************
+*
+*	Name:		TCP_TUNE
+*	Type:		struct
+*	Purpose:	A profile: the value for each option, or
+*				TCP_TUNE_LEAVE. Buffer sizes are in bytes,
+*				busy_poll in microseconds, keep_idle and
+*				keep_intvl in seconds. read_tuning fills one
+*				with what a socket has.
+*
+***************************************************************/
+typedef struct tcp_tune
+{
+	char				name[24];
+	int				nodelay;
+	int				quickack;
+	int				sndbuf;
+	int				rcvbuf;
+	int				busy_poll;
+	int				keepalive;
+	int				keep_idle;
+	int				keep_intvl;
+	int				keep_cnt;
+	int				backlog;	/* listen; not read back */
+} TCP_TUNE;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int tune_set ( TCP_CONNECTION_INFO *connection, const char *name );
+int tune_define ( const TCP_TUNE *profile );
+int tune_lookup ( const char *name, TCP_TUNE *profile );
+int tune_read ( int sock, TCP_TUNE *granted );
+int tune_number ( const char *name );
+
+/* called by the TCP calls */
+void tune_socket ( TCP_CONNECTION_INFO *connection );
+int tune_accepted ( int tune, int sock );
+int tune_backlog ( TCP_CONNECTION_INFO *connection );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSTUNEH_INCLUDE_
@@ -0,0 +1,356 @@
+/************************************************************************************
+*		FILE:		"nsuring.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	io_uring setup, submission and completion harvesting
+*					for the Linux backend. See nsuring.h.
+*
+*		Notes:		nsur_setup refuses kernels that lack anything the
+*					backend relies on (EXT_ARG timeouts, SEND/RECV and the
+*					MSG forms, ACCEPT, CONNECT, ASYNC_CANCEL), so the
+*					caller can fall back to epoll on a single check.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.3.0	  10/17/26		Initial Release
+*		1.6.0	  10/17/26		Also requires SENDMSG / RECVMSG
+*************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "NSURING.h"
+
+#ifdef NSUR_HAVE_IO_URING
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+/* opcodes the Linux backend submits */
+static const unsigned char nsur_required_ops[] =
+{
+	IORING_OP_SEND,
+	IORING_OP_RECV,
+	IORING_OP_SENDMSG,
+	IORING_OP_RECVMSG,
+	IORING_OP_ACCEPT,
+	IORING_OP_CONNECT,
+	IORING_OP_ASYNC_CANCEL
+};
+
+
+/***************************************************************
+*
+* NAME:                           Nsur_Probe
+*
+* FUNCTION:             Checks the kernel supports every opcode
+*                       the backend needs.
+*
+* RETURNS:              int - 0 or errno (EOPNOTSUPP)
+***************************************************************/
+static int Nsur_Probe ( int fd )
+{
+	struct io_uring_probe	*probe;
+	size_t			 size;
+	unsigned		 i;
+	int			 rc = 0;
+
+	size = sizeof ( *probe ) + 256 * sizeof ( struct io_uring_probe_op );
+	probe = ( struct io_uring_probe * ) calloc ( 1, size );
+	if ( !probe )
+		return ENOMEM;
+
+	if ( syscall ( __NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256 ) < 0 )
+		rc = EOPNOTSUPP;
+
+	for ( i = 0; !rc && i < sizeof ( nsur_required_ops ); i++ )
+	{
+		if ( nsur_required_ops[i] > probe->last_op
+		  || !( probe->ops[nsur_required_ops[i]].flags & IO_URING_OP_SUPPORTED ) )
+			rc = EOPNOTSUPP;
+	}
+
+	free ( probe );
+	return rc;
+}
+
+/***************************************************************
+*
+* NAME:                           nsur_setup
+*
+* FUNCTION:             Creates a ring with room for entries
+*                       submissions and maps it.
+*
+* RETURNS:              int - 0 or errno
+***************************************************************/
+int nsur_setup ( NSUR_RING *ring, unsigned entries )
+{
+	struct io_uring_params	 params;
+	char			*sq;
+	char			*cq;
+	int			 rc;
+
+	memset ( ring, 0, sizeof ( *ring ) );
+	memset ( &params, 0, sizeof ( params ) );
+
+	ring->fd = ( int ) syscall ( __NR_io_uring_setup, entries, &params );
+	if ( ring->fd < 0 )
+	{
+		rc = errno;
+		ring->fd = -1;
+		return rc ? rc : ENOSYS;
+	}
+
+	if ( !( params.features & IORING_FEAT_EXT_ARG ) )
+	{
+		rc = EOPNOTSUPP;
+		goto fail;
+	}
+	rc = Nsur_Probe ( ring->fd );
+	if ( rc )
+		goto fail;
+
+	ring->features = params.features;
+	ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof ( unsigned );
+	ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof ( struct io_uring_cqe );
+	if ( params.features & IORING_FEAT_SINGLE_MMAP )
+	{
+		if ( ring->cq_ring_size > ring->sq_ring_size )
+			ring->sq_ring_size = ring->cq_ring_size;
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+
+	ring->sq_ring = mmap ( 0, ring->sq_ring_size, PROT_READ | PROT_WRITE
+						 , MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING );
+	if ( ring->sq_ring == MAP_FAILED )
+	{
+		ring->sq_ring = 0;
+		rc = errno;
+		goto fail;
+	}
+
+	if ( params.features & IORING_FEAT_SINGLE_MMAP )
+		ring->cq_ring = ring->sq_ring;
+	else
+	{
+		ring->cq_ring = mmap ( 0, ring->cq_ring_size, PROT_READ | PROT_WRITE
+							 , MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING );
+		if ( ring->cq_ring == MAP_FAILED )
+		{
+			ring->cq_ring = 0;
+			rc = errno;
+			goto fail;
+		}
+	}
+
+	ring->sqes_size = params.sq_entries * sizeof ( struct io_uring_sqe );
+	ring->sqes = ( struct io_uring_sqe * ) mmap ( 0, ring->sqes_size, PROT_READ | PROT_WRITE
+												, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES );
+	if ( ring->sqes == MAP_FAILED )
+	{
+		ring->sqes = 0;
+		rc = errno;
+		goto fail;
+	}
+
+	sq = ( char * ) ring->sq_ring;
+	cq = ( char * ) ring->cq_ring;
+
+	ring->sq_head = ( unsigned * ) ( sq + params.sq_off.head );
+	ring->sq_tail = ( unsigned * ) ( sq + params.sq_off.tail );
+	ring->sq_mask = ( unsigned * ) ( sq + params.sq_off.ring_mask );
+	ring->sq_array = ( unsigned * ) ( sq + params.sq_off.array );
+	ring->sq_entries = params.sq_entries;
+
+	ring->cq_head = ( unsigned * ) ( cq + params.cq_off.head );
+	ring->cq_tail = ( unsigned * ) ( cq + params.cq_off.tail );
+	ring->cq_mask = ( unsigned * ) ( cq + params.cq_off.ring_mask );
+	ring->cqes = ( struct io_uring_cqe * ) ( cq + params.cq_off.cqes );
+
+	ring->sqe_head = ring->sqe_tail = *ring->sq_tail;
+	return 0;
+
+fail:
+	nsur_teardown ( ring );
+	return rc;
+}
+
+/***************************************************************
+*
+* NAME:                           nsur_teardown
+*
+* FUNCTION:             Unmaps and closes a ring.
+*
+* RETURNS:              nothing
+***************************************************************/
+void nsur_teardown ( NSUR_RING *ring )
+{
+	if ( ring->sqes )
+		munmap ( ring->sqes, ring->sqes_size );
+	if ( ring->cq_ring && ring->cq_ring != ring->sq_ring )
+		munmap ( ring->cq_ring, ring->cq_ring_size );
+	if ( ring->sq_ring )
+		munmap ( ring->sq_ring, ring->sq_ring_size );
+	if ( ring->fd >= 0 )
+		close ( ring->fd );
+
+	memset ( ring, 0, sizeof ( *ring ) );
+	ring->fd = -1;
+}
+
+/***************************************************************
+*
+* NAME:                           nsur_get_sqe
+*
+* FUNCTION:             Hands out the next free submission entry,
+*                       zeroed. It goes to the kernel on the next
+*                       nsur_enter.
+*
+* RETURNS:              struct io_uring_sqe * - 0 if the ring is full
+***************************************************************/
+struct io_uring_sqe *nsur_get_sqe ( NSUR_RING *ring )
+{
+	struct io_uring_sqe	*sqe;
+	unsigned		 head = __atomic_load_n ( ring->sq_head, __ATOMIC_ACQUIRE );
+
+	if ( ring->sqe_tail - head >= ring->sq_entries )
+		return 0;
+
+	sqe = &ring->sqes[ring->sqe_tail & *ring->sq_mask];
+	ring->sqe_tail++;
+	memset ( sqe, 0, sizeof ( *sqe ) );
+	return sqe;
+}
+
+/***************************************************************
+*
+* NAME:                           Nsur_Flush
+*
+* FUNCTION:             Publishes the entries handed out since the
+*                       last flush to the kernel's submission ring.
+*
+* RETURNS:              unsigned - entries published
+***************************************************************/
+static unsigned Nsur_Flush ( NSUR_RING *ring )
+{
+	unsigned tail = *ring->sq_tail;
+	unsigned count = ring->sqe_tail - ring->sqe_head;
+
+	while ( ring->sqe_head != ring->sqe_tail )
+	{
+		ring->sq_array[tail & *ring->sq_mask] = ring->sqe_head & *ring->sq_mask;
+		tail++;
+		ring->sqe_head++;
+	}
+
+	__atomic_store_n ( ring->sq_tail, tail, __ATOMIC_RELEASE );
+	return count;
+}
+
+/***************************************************************
+*
+* NAME:                           nsur_enter
+*
+* FUNCTION:             Submits everything pending and, when
+*                       min_complete is non-zero, waits for that
+*                       many completions or timeout_ms (-1 = no
+*                       limit), all in one io_uring_enter.
+*
+* RETURNS:              int - entries submitted, or -1 with errno
+*                       set (a timeout or signal is not an error)
+***************************************************************/
+int nsur_enter ( NSUR_RING *ring, unsigned min_complete, int timeout_ms )
+{
+	struct io_uring_getevents_arg	 arg;
+	struct __kernel_timespec	 ts;
+	unsigned			 submit = Nsur_Flush ( ring );
+	unsigned			 flags = 0;
+	void				*argp = 0;
+	size_t				 argsz = 0;
+	long				 rc;
+
+	if ( !submit && !min_complete )
+		return 0;
+
+	if ( min_complete )
+	{
+		flags |= IORING_ENTER_GETEVENTS;
+		if ( timeout_ms >= 0 )
+		{
+			memset ( &arg, 0, sizeof ( arg ) );
+			ts.tv_sec = timeout_ms / 1000;
+			ts.tv_nsec = ( long long ) ( timeout_ms % 1000 ) * 1000000;
+			arg.ts = ( unsigned long long ) ( uintptr_t ) &ts;
+			flags |= IORING_ENTER_EXT_ARG;
+			argp = &arg;
+			argsz = sizeof ( arg );
+		}
+	}
+
+	rc = syscall ( __NR_io_uring_enter, ring->fd, submit, min_complete, flags, argp, argsz );
+	if ( rc < 0 )
+	{
+		if ( errno == ETIME || errno == EINTR || errno == EBUSY )
+			return 0;
+		return -1;
+	}
+	return ( int ) rc;
+}
+
+/***************************************************************
+*
+* NAME:                           nsur_reap
+*
+* FUNCTION:             Hands every completion already posted to
+*                       handler (context, user_data, result).
+*
+* RETURNS:              int - completions harvested
+***************************************************************/
+int nsur_reap ( NSUR_RING *ring, NSUR_CQE_HANDLER handler, void *context )
+{
+	struct io_uring_cqe	*cqe;
+	unsigned		 head = *ring->cq_head;
+	unsigned		 tail = __atomic_load_n ( ring->cq_tail, __ATOMIC_ACQUIRE );
+	int			 count = 0;
+
+	while ( head != tail )
+	{
+		cqe = &ring->cqes[head & *ring->cq_mask];
+		handler ( context, cqe->user_data, cqe->res );
+		head++;
+		count++;
+
+		/* release the slot before the handler's next look */
+		__atomic_store_n ( ring->cq_head, head, __ATOMIC_RELEASE );
+		if ( head == tail )
+			tail = __atomic_load_n ( ring->cq_tail, __ATOMIC_ACQUIRE );
+	}
+
+	return count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NSUR_HAVE_IO_URING
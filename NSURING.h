@@ -0,0 +1,96 @@
+/************************************************************************************
+*		FILE:		"nsuring.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Minimal io_uring ring wrapper used by the Linux backend
+*					(nslinux.c) when the io_uring engine is selected. Talks
+*					to the kernel through the raw syscalls, so liburing is
+*					not needed.
+*
+*		Notes:		Build with -DNSTCP_NO_IO_URING to leave io_uring out
+*					altogether; the backend then always runs on epoll.
+*
+*					SQEs handed out by nsur_get_sqe are only published to
+*					the kernel on the next nsur_enter, so a burst of nowait
+*					calls costs one io_uring_enter.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.3.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifndef _NSURINGH_INCLUDE_
+#define _NSURINGH_INCLUDE_
+
+#if defined(__linux__) && !defined(NSTCP_NO_IO_URING)
+#define NSUR_HAVE_IO_URING	1
+#include <stddef.h>
+#include <linux/io_uring.h>
+#endif
+
+#ifdef NSUR_HAVE_IO_URING
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************************************************
+*
+*	Name:		NSUR_RING
+*	Type:		struct
+*	Purpose:	Mapped submission and completion rings of
+*				one io_uring instance.
+*
+***************************************************************/
+typedef struct nsur_ring
+{
+	int				fd;
+	unsigned			features;
+
+	/* submission ring */
+	unsigned			*sq_head;
+	unsigned			*sq_tail;
+	unsigned			*sq_mask;
+	unsigned			*sq_array;
+	unsigned			sq_entries;
+	unsigned			sqe_head;
+	unsigned			sqe_tail;
+	struct io_uring_sqe		*sqes;
+
+	/* completion ring */
+	unsigned			*cq_head;
+	unsigned			*cq_tail;
+	unsigned			*cq_mask;
+	struct io_uring_cqe		*cqes;
+
+	/* mappings, for teardown */
+	void				*sq_ring;
+	size_t				sq_ring_size;
+	void				*cq_ring;
+	size_t				cq_ring_size;
+	size_t				sqes_size;
+} NSUR_RING;
+
+/* called once per harvested CQE */
+typedef void (*NSUR_CQE_HANDLER)		(void *, unsigned long long, int);
+
+/**********************************************************
+*		Function Prototype Definition(s)
+**********************************************************/
+int nsur_setup ( NSUR_RING *ring, unsigned entries );
+void nsur_teardown ( NSUR_RING *ring );
+struct io_uring_sqe *nsur_get_sqe ( NSUR_RING *ring );
+int nsur_enter ( NSUR_RING *ring, unsigned min_complete, int timeout_ms );
+int nsur_reap ( NSUR_RING *ring, NSUR_CQE_HANDLER handler, void *context );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NSUR_HAVE_IO_URING
+
+#endif // !_NSURINGH_INCLUDE_
@@ -0,0 +1,500 @@
+/************************************************************************************
+*		FILE:		"nszcopy.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	send_file and zero-copy sends. See nszcopy.h.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.20.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#ifdef __TANDEM
+#include "=nszcopyh"
+#include "=nsstatsh"
+#else
+#include "NSZCOPY.h"
+#include "NSSTATS.h"
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <linux/errqueue.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __TANDEM
+/* older headers lack these; the kernel says no if it lacks them too */
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY			60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY			0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY		5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED	1
+#endif
+
+/* most one sendfile / splice moves (what the kernel allows) */
+#define ZCOPY_MAX_CALL			0x7ffff000L
+#endif
+
+
+/***************************************************************************************
+*						FUNCTION PROTOTYPES AND DEFINITIONS
+***************************************************************************************/
+
+#ifndef __TANDEM
+/***************************************************************
+*
+* NAME:                           Zcopy_Wait
+*
+* FUNCTION:             Waits until a non-blocking socket takes
+*                       more, so the bulk sends can finish what
+*                       they started.
+*
+* RETURNS:              int - 0, or -1 on error
+***************************************************************/
+static int Zcopy_Wait ( int sock )
+{
+	struct pollfd pfd;
+
+	pfd.fd = sock;
+	pfd.events = POLLOUT;
+	pfd.revents = 0;
+	while ( poll ( &pfd, 1, -1 ) < 0 )
+		if ( errno != EINTR )
+			return -1;
+
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           Send_Splice
+*
+* FUNCTION:             Moves length bytes (0: until end of input)
+*                       of fd to the socket through a pipe with
+*                       splice, for sources sendfile won't take.
+*                       offset is used when fd is seekable.
+*
+* RETURNS:              long - bytes sent, or -1 with errno set
+***************************************************************/
+static long Send_Splice ( TCP_CONNECTION_INFO *connection, int fd, long offset, long length, int seekable )
+{
+	int		 pipes[2];
+	loff_t		 position = offset;
+	long		 total = 0;
+	long		 left;
+	long		 want;
+	ssize_t		 in = 0;
+	ssize_t		 out;
+
+	if ( pipe ( pipes ) < 0 )
+		return -1;
+
+	for ( ;; )
+	{
+		want = ZCOPY_MAX_CALL;
+		if ( length && length - total < want )
+			want = length - total;
+		if ( !want )
+			break;
+
+		in = splice ( fd, seekable ? &position : 0, pipes[1], 0, want, SPLICE_F_MOVE );
+		if ( in < 0 && errno == EINTR )
+			continue;
+		if ( in <= 0 )
+			break;
+
+		/* all of it must leave the pipe before it is closed */
+		for ( left = in; left > 0; )
+		{
+			out = splice ( pipes[0], 0, *connection->sock, 0, left, SPLICE_F_MOVE | SPLICE_F_MORE );
+			TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, left, out );
+			if ( out >= 0 )
+			{
+				left -= out;
+				total += out;
+				continue;
+			}
+			if ( errno == EINTR || ( ( errno == EAGAIN || errno == EWOULDBLOCK ) && Zcopy_Wait ( *connection->sock ) == 0 ) )
+				continue;
+			in = -1;
+			break;
+		}
+		if ( left > 0 )
+			break;
+	}
+
+	close ( pipes[0] );
+	close ( pipes[1] );
+	return ( in < 0 && !total ) ? -1 : total;
+}
+#endif
+
+/***************************************************************
+*
+* NAME:                           Send_Copy
+*
+* FUNCTION:             send_file the old way: read a chunk, send
+*                       it, for sources neither sendfile nor splice
+*                       can take, and on Guardian.
+*
+* RETURNS:              long - bytes sent, or -1 on error
+***************************************************************/
+static long Send_Copy ( TCP_CONNECTION_INFO *connection, int fd, long offset, long length )
+{
+	char		*buffer;
+	long		 total = 0;
+	long		 want;
+	long		 got;
+	long		 sent;
+	int		 status;
+
+	buffer = ( char * ) malloc ( TCP_SEND_FILE_CHUNK );
+	if ( !buffer )
+		return -1;
+	if ( lseek ( fd, offset, SEEK_SET ) < 0 )
+		offset = -1;	/* not seekable: read on from where it is */
+
+	for ( ;; )
+	{
+		want = TCP_SEND_FILE_CHUNK;
+		if ( length && length - total < want )
+			want = length - total;
+		if ( !want )
+			break;
+
+		got = ( long ) read ( fd, buffer, want );
+		if ( got <= 0 )
+			break;
+		for ( sent = 0; sent < got; sent += status )
+		{
+			status = send ( *connection->sock, buffer + sent, ( int ) ( got - sent ), connection->flags );
+			TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, got - sent, status );
+			if ( status >= 0 )
+				continue;
+			status = 0;
+#ifndef __TANDEM
+			if ( errno == EINTR || ( ( errno == EAGAIN || errno == EWOULDBLOCK ) && Zcopy_Wait ( *connection->sock ) == 0 ) )
+				continue;
+#endif
+			free ( buffer );
+			return total + sent ? total + sent : -1;
+		}
+		total += got;
+	}
+
+	free ( buffer );
+	return total;
+}
+
+/***************************************************************
+*
+* NAME:                           send_file
+*
+* FUNCTION:             Sends length bytes of fd from offset over
+*                       the connection (length 0: up to the end of
+*                       the file), without copying them through a
+*                       user buffer where the system allows.
+*
+* NOTE:                 A non-blocking socket is waited for, so
+*                       this returns once everything is sent. fd's
+*                       file position is not moved, except when it
+*                       has to be read the old way.
+*
+* RETURNS:              long - bytes sent (fewer if the file ends
+*                       first), or -1 on error
+***************************************************************/
+long send_file ( TCP_CONNECTION_INFO *connection, int fd, long offset, long length )
+{
+#ifdef __TANDEM
+	return Send_Copy ( connection, fd, offset, length );
+#else
+	struct stat	 info;
+	off_t		 position = offset;
+	long		 total = 0;
+	long		 want;
+	ssize_t		 status;
+
+	if ( length < 0 || offset < 0 || fstat ( fd, &info ) < 0 )
+		return -1;
+
+	if ( S_ISFIFO ( info.st_mode ) || S_ISSOCK ( info.st_mode ) )
+		return Send_Splice ( connection, fd, 0, length, 0 );
+
+	if ( !length && S_ISREG ( info.st_mode ) )
+	{
+		if ( info.st_size <= offset )
+			return 0;
+		length = ( long ) ( info.st_size - offset );
+	}
+
+	for ( ;; )
+	{
+		want = ZCOPY_MAX_CALL;
+		if ( length && length - total < want )
+			want = length - total;
+		if ( !want )
+			break;
+
+		status = sendfile ( *connection->sock, fd, &position, want );
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, want, status );
+		if ( status > 0 )
+		{
+			total += status;
+			continue;
+		}
+		if ( !status )
+			break;
+		if ( errno == EINTR || ( ( errno == EAGAIN || errno == EWOULDBLOCK ) && Zcopy_Wait ( *connection->sock ) == 0 ) )
+			continue;
+		if ( !total && ( errno == EINVAL || errno == ENOSYS ) )
+		{
+			status = Send_Splice ( connection, fd, offset, length, 1 );
+			if ( status >= 0 || ( errno != EINVAL && errno != ENOSYS ) )
+				return ( long ) status;
+			return Send_Copy ( connection, fd, offset, length );
+		}
+		return total ? total : -1;
+	}
+
+	return total;
+#endif
+}
+
+/***************************************************************
+*
+* NAME:                           zcopy_attach
+*
+* FUNCTION:             Turns zero-copy sends on for a connection's
+*                       socket: zcopy_send then uses MSG_ZEROCOPY for
+*                       buffers of threshold bytes or more, and
+*                       zcopy_reap calls on_done (if given) as the
+*                       kernel finishes with them.
+*
+* NOTE:                 The socket must exist. If the kernel won't
+*                       do zero-copy, enabled stays 0.
+*
+* RETURNS:              int - 0, or -1 on bad arguments / no memory
+***************************************************************/
+int zcopy_attach ( TCP_CONNECTION_INFO *connection, long threshold, TCP_ZCOPY_DONE on_done, void *context )
+{
+	TCP_ZCOPY	*z;
+#ifndef __TANDEM
+	int		 on = 1;
+#endif
+
+	if ( threshold < 0 || !connection->sock || *connection->sock < 0 )
+		return -1;
+
+	z = ( TCP_ZCOPY * ) calloc ( 1, sizeof ( TCP_ZCOPY ) );
+	if ( !z )
+		return -1;
+
+	z->threshold = threshold;
+	z->on_done = on_done;
+	z->context = context;
+#ifndef __TANDEM
+	z->enabled = setsockopt ( *connection->sock, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof ( on ) ) == 0;
+#endif
+
+	zcopy_detach ( connection );
+	connection->zcopy = z;
+	return 0;
+}
+
+/***************************************************************
+*
+* NAME:                           zcopy_detach
+*
+* FUNCTION:             Frees a connection's zero-copy state. Sends
+*                       still in the kernel keep their buffers in
+*                       use until the socket is closed, so keep
+*                       the buffers until then. Called by
+*                       clean_conn_info.
+*
+* RETURNS:                         nothing
+***************************************************************/
+void zcopy_detach ( TCP_CONNECTION_INFO *connection )
+{
+	if ( !connection->zcopy )
+		return;
+
+	free ( connection->zcopy );
+	connection->zcopy = 0;
+}
+
+/***************************************************************
+*
+* NAME:                           zcopy_send
+*
+* FUNCTION:             Sends all of buffer: with MSG_ZEROCOPY when
+*                       it is threshold bytes or more and the socket
+*                       allows it, else as new_send. *last_id (if
+*                       given) gets the ID to pass to zcopy_done
+*                       before the buffer may change.
+*
+* NOTE:                 A non-blocking socket is waited for. When
+*                       the kernel is out of room for zero-copy
+*                       sends (ENOBUFS) the rest goes out copied.
+*
+* RETURNS:              long - bytes sent, or -1 on error
+***************************************************************/
+long zcopy_send ( TCP_CONNECTION_INFO *connection, char *buffer, long length, unsigned int *last_id )
+{
+	TCP_ZCOPY	*z = connection->zcopy;
+	long		 total = 0;
+	int		 flags = connection->flags;
+	int		 used = 0;
+	int		 status;
+
+#ifndef __TANDEM
+	if ( z && z->enabled && length >= z->threshold )
+		flags |= MSG_ZEROCOPY;
+#endif
+
+	while ( total < length )
+	{
+		status = send ( *connection->sock, buffer + total, ( int ) ( length - total ), flags );
+		TCP_STATS_CALL ( &connection->stats, TCP_OP_SEND, length - total, status );
+		if ( status >= 0 )
+		{
+#ifndef __TANDEM
+			if ( ( flags & MSG_ZEROCOPY ) && status > 0 )
+			{
+				z->next_id++;
+				z->sends++;
+				z->bytes += status;
+				used = 1;
+			}
+#endif
+			total += status;
+			continue;
+		}
+#ifndef __TANDEM
+		if ( errno == EINTR )
+			continue;
+		if ( ( flags & MSG_ZEROCOPY ) && errno == ENOBUFS )
+		{
+			zcopy_reap ( connection );
+			flags &= ~MSG_ZEROCOPY;
+			continue;
+		}
+		if ( ( errno == EAGAIN || errno == EWOULDBLOCK ) && Zcopy_Wait ( *connection->sock ) == 0 )
+		{
+			if ( flags & MSG_ZEROCOPY )
+				zcopy_reap ( connection );
+			continue;
+		}
+#endif
+		return total ? total : -1;
+	}
+
+	/* nothing went zero-copy: the buffer is free already */
+	if ( last_id )
+		*last_id = z ? ( used ? z->next_id : z->done_id ) - 1 : 0;
+	return total;
+}
+
+/***************************************************************
+*
+* NAME:                           zcopy_reap
+*
+* FUNCTION:             Reads the kernel's zero-copy notices off the
+*                       socket, without waiting, moves done_id on and
+*                       calls on_done once per range of IDs.
+*
+* RETURNS:              int - sends finished, -1 with no zero-copy
+*                       attached
+***************************************************************/
+int zcopy_reap ( TCP_CONNECTION_INFO *connection )
+{
+	TCP_ZCOPY			*z = connection->zcopy;
+	int				 finished = 0;
+#ifndef __TANDEM
+	struct msghdr			 msg;
+	struct cmsghdr			*cmsg;
+	struct sock_extended_err	*notice;
+	char				 control[128];
+	unsigned int			 first;
+	unsigned int			 last;
+	int				 copied;
+#endif
+
+	if ( !z )
+		return -1;
+
+#ifndef __TANDEM
+	for ( ;; )
+	{
+		memset ( &msg, 0, sizeof ( msg ) );
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof ( control );
+		if ( recvmsg ( *connection->sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT ) < 0 )
+		{
+			if ( errno == EINTR )
+				continue;
+			break;
+		}
+
+		for ( cmsg = CMSG_FIRSTHDR ( &msg ); cmsg; cmsg = CMSG_NXTHDR ( &msg, cmsg ) )
+		{
+			if ( !( ( cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR )
+			     || ( cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR ) ) )
+				continue;
+			notice = ( struct sock_extended_err * ) CMSG_DATA ( cmsg );
+			if ( notice->ee_origin != SO_EE_ORIGIN_ZEROCOPY || notice->ee_errno )
+				continue;
+
+			first = notice->ee_info;
+			last = notice->ee_data;
+			copied = ( notice->ee_code & SO_EE_CODE_ZEROCOPY_COPIED ) != 0;
+			if ( copied )
+				z->copied += last - first + 1;
+			if ( ( int ) ( last + 1 - z->done_id ) > 0 )
+				z->done_id = last + 1;
+			finished += ( int ) ( last - first + 1 );
+			if ( z->on_done )
+				z->on_done ( connection, z->context, first, last, copied );
+		}
+	}
+#endif
+
+	return finished;
+}
+
+/***************************************************************
+*
+* NAME:                           zcopy_done
+*
+* FUNCTION:             Whether the kernel is done with the send
+*                       id and every one before it, going by what
+*                       zcopy_reap has read so far.
+*
+* RETURNS:              int - 1 done, 0 not yet
+***************************************************************/
+int zcopy_done ( TCP_CONNECTION_INFO *connection, unsigned int id )
+{
+	TCP_ZCOPY *z = connection->zcopy;
+
+	return !z || ( int ) ( z->done_id - id ) > 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
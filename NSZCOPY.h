@@ -0,0 +1,107 @@
+/************************************************************************************
+*		FILE:		"nszcopy.h"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Bulk sends without the copies: send_file moves a file
+*					to a connection inside the kernel, and zcopy_send sends
+*					large buffers with MSG_ZEROCOPY, so the kernel reads
+*					them straight from the caller's pages.
+*
+*		Notes:		send_file ( connection, fd, offset, length ) sends
+*					length bytes of fd from offset (length 0: to the end
+*					of the file) and leaves fd's file position alone. On
+*					Linux it uses sendfile; a source sendfile can't take,
+*					such as a pipe, goes through splice instead. Anything
+*					else, and Guardian, is read and sent through one
+*					buffer.
+*
+*					set_zerocopy ( connection, threshold, on_done,
+*					context ) turns SO_ZEROCOPY on for the socket. From
+*					then on, zcopy_send sends buffers of threshold bytes
+*					or more with MSG_ZEROCOPY, and smaller ones as
+*					new_send would. A zero-copy buffer must be left
+*					untouched until the kernel is done with it. Every
+*					MSG_ZEROCOPY send gets the next send ID. zcopy_send
+*					hands back the last ID used for the buffer, and
+*					zcopy_reap reads the kernel's notices off the
+*					socket's error queue and calls on_done for each
+*					range of finished IDs. The buffer is free once
+*					zcopy_done ( connection, id ) is true.
+*
+*					A notice may say the kernel copied after all (it does
+*					over loopback, and for devices without scatter-gather);
+*					those are counted in copied. When the kernel can't
+*					take SO_ZEROCOPY, set_zerocopy still succeeds, enabled
+*					is 0 and every zcopy_send is a plain send.
+*
+*					Pending notices mark the socket with POLLERR, so
+*					don't keep nowait operations on a zero-copy socket
+*					without reaping. Guardian has neither call: there
+*					zcopy_send is always a plain send.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.20.0	  10/17/26		Initial Release
+*************************************************************************************/
+
+#ifndef _NSZCOPYH_INCLUDE_
+#define _NSZCOPYH_INCLUDE_
+
+#ifdef __TANDEM
+#include "=nstcph"
+#else
+#include "NSTCP.h"
+#endif
+
+
+/* buffer size for send_file's read-and-send fallback */
+#define TCP_SEND_FILE_CHUNK		65536
+
+/***************************************************************
+*
+*	Name:		TCP_ZCOPY
+*	Type:		struct
+*	Purpose:	Zero-copy state of one connection
+*				(TCP_CONNECTION_INFO::zcopy). IDs are the
+*				kernel's: 32 bits, counted from 0, and they
+*				wrap.
+*
+***************************************************************/
+typedef struct tcp_zcopy
+{
+	long				threshold;
+	int				enabled;	/* SO_ZEROCOPY is on */
+	unsigned int			next_id;	/* ID of the next MSG_ZEROCOPY send */
+	unsigned int			done_id;	/* every ID before this is done */
+	TCP_ZCOPY_DONE			on_done;
+	void				*context;
+
+	long				sends;		/* MSG_ZEROCOPY sends */
+	long				copied;		/* of those, copied by the kernel */
+	long				bytes;		/* bytes sent with MSG_ZEROCOPY */
+} TCP_ZCOPY;
+
+/**********************************************************
+*		Function Prototype Definition(s)
+*		(normally reached through the TCP structure)
+**********************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+long send_file ( TCP_CONNECTION_INFO *connection, int fd, long offset, long length );
+int zcopy_attach ( TCP_CONNECTION_INFO *connection, long threshold, TCP_ZCOPY_DONE on_done, void *context );
+void zcopy_detach ( TCP_CONNECTION_INFO *connection );
+long zcopy_send ( TCP_CONNECTION_INFO *connection, char *buffer, long length, unsigned int *last_id );
+int zcopy_reap ( TCP_CONNECTION_INFO *connection );
+int zcopy_done ( TCP_CONNECTION_INFO *connection, unsigned int id );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !_NSZCOPYH_INCLUDE_
@@ -0,0 +1,169 @@
+/************************************************************************************
+*		FILE:		"tcapt.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Tests of traffic capture (nscapt.c): several threads
+*					capturing at once through their own rings, with
+*					records bigger than a ring mixed in, into a file big
+*					enough for all of them and into one that fills up.
+*					Every record in the file is checked, each thread's
+*					records must be in order, and the header's record and
+*					dropped counts must add up.
+*
+*		Notes:		Linux only. Build and run from the top directory:
+*
+*					gcc -o tcapt -I. tests/TCAPT.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./tcapt [capture file]
+*
+*					Prints "ok" and exits 0, or names the failed check
+*					and exits 1. The file (default /tmp/tcapt.cap) is
+*					removed afterwards.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.1	  10/17/26		Initial Release
+*************************************************************************************/
+
+#include "NSCAPT.h"
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CHECK(x)	do { if ( !( x ) ) { fprintf ( stderr, "%s:%d: %s\n", __FILE__, __LINE__, #x ); exit ( 1 ); } } while ( 0 )
+
+#define WRITERS			4
+#define RECORDS			20000		/* per writer */
+#define BIG_EVERY		2500		/* one record in so many is bigger than a ring */
+#define BIG_LENGTH		( TCP_CAPTURE_RING + 1000 )
+#define FIRST_SOCK		1000		/* writer i records on socket FIRST_SOCK + i */
+
+static const char		*capture_path = "/tmp/tcapt.cap";
+
+
+/* the length of writer's seq'th record */
+static long Length ( int writer, int seq )
+{
+	if ( seq % BIG_EVERY == BIG_EVERY - 1 )
+		return BIG_LENGTH;
+	return 4 + ( seq * 37 + writer * 11 ) % 700;
+}
+
+/* records seq, then bytes of ( seq + writer ), on its own socket */
+static void *Writer ( void *arg )
+{
+	static TCP_THREAD_LOCAL char	 data[BIG_LENGTH];
+	int				 writer = ( int ) ( long ) arg;
+	int				 seq;
+	long				 length;
+
+	for ( seq = 0; seq < RECORDS; seq++ )
+	{
+		length = Length ( writer, seq );
+		memcpy ( data, &seq, sizeof ( seq ) );
+		memset ( data + sizeof ( seq ), ( seq + writer ) & 0xff, length - sizeof ( seq ) );
+		capture_record ( seq & 1 ? TCP_CAPTURE_RECV : TCP_CAPTURE_SEND, FIRST_SOCK + writer, data, length );
+	}
+
+	tcp_thread_exit ( );
+	return 0;
+}
+
+/* runs the writers into a file of size bytes and checks what it holds;
+*  returns the records found */
+static long Run ( long size, long snap )
+{
+	pthread_t		 threads[WRITERS];
+	TCP_CAPTURE_HEADER	 header;
+	TCP_CAPTURE_RECORD	*record;
+	struct stat		 st;
+	long long		 last_usec[WRITERS];
+	unsigned short		 thread[WRITERS];
+	int			 next[WRITERS];
+	char			*map;
+	char			*at;
+	long			 found = 0;
+	long			 saved;
+	int			 writer;
+	int			 seq;
+	int			 fd;
+	int			 i;
+
+	CHECK ( capture_start ( capture_path, size, snap ) == 0 );
+	CHECK ( capture_start ( capture_path, size, snap ) == -1 );
+	for ( i = 0; i < WRITERS; i++ )
+		pthread_create ( &threads[i], 0, Writer, ( void * ) ( long ) i );
+	for ( i = 0; i < WRITERS; i++ )
+		pthread_join ( threads[i], 0 );
+	CHECK ( capture_stop ( ) == 0 );
+	CHECK ( capture_stop ( ) == -1 );
+
+	fd = open ( capture_path, O_RDONLY );
+	CHECK ( fd >= 0 && fstat ( fd, &st ) == 0 );
+	map = ( char * ) mmap ( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	CHECK ( map != MAP_FAILED );
+	close ( fd );
+	memcpy ( &header, map, sizeof ( header ) );
+	CHECK ( !strcmp ( header.magic, TCP_CAPTURE_MAGIC ) && header.size == st.st_size && header.snap == snap );
+
+	memset ( next, 0, sizeof ( next ) );
+	memset ( thread, 0, sizeof ( thread ) );
+	memset ( last_usec, 0, sizeof ( last_usec ) );
+	for ( at = map + sizeof ( header ); at + sizeof ( *record ) <= map + st.st_size; at += record->size )
+	{
+		record = ( TCP_CAPTURE_RECORD * ) at;
+		if ( !record->size )
+			break;
+		CHECK ( record->size % 8 == 0 && at + record->size <= map + st.st_size );
+
+		writer = record->sock - FIRST_SOCK;
+		CHECK ( writer >= 0 && writer < WRITERS );
+		memcpy ( &seq, record + 1, sizeof ( seq ) );
+
+		/* a writer's records are in order, maybe with some dropped */
+		CHECK ( seq >= next[writer] && seq < RECORDS );
+		CHECK ( record->usec >= last_usec[writer] );
+		CHECK ( !thread[writer] || thread[writer] == record->thread );
+		next[writer] = seq + 1;
+		last_usec[writer] = record->usec;
+		thread[writer] = record->thread;
+
+		saved = snap && Length ( writer, seq ) > snap ? snap : Length ( writer, seq );
+		CHECK ( record->type == ( seq & 1 ? TCP_CAPTURE_RECV : TCP_CAPTURE_SEND ) );
+		CHECK ( record->length == Length ( writer, seq ) && record->saved == saved );
+		CHECK ( record->size == ( ( sizeof ( *record ) + saved + 7 ) & ~7UL ) );
+		for ( i = sizeof ( seq ); i < saved; i++ )
+			CHECK ( ( unsigned char ) ( ( char * ) ( record + 1 ) )[i] == ( ( seq + writer ) & 0xff ) );
+		found++;
+	}
+
+	CHECK ( header.records == found );
+	CHECK ( header.records + header.dropped == ( long long ) WRITERS * RECORDS );
+	munmap ( map, st.st_size );
+	unlink ( capture_path );
+	return found;
+}
+
+int main ( int argc, char **argv )
+{
+	if ( argc > 1 )
+		capture_path = argv[1];
+
+	/* room for everything: nothing dropped, all of every record kept */
+	CHECK ( Run ( 64L << 20, 0 ) == ( long ) WRITERS * RECORDS );
+
+	/* snapped: big records cut short */
+	CHECK ( Run ( 64L << 20, 256 ) == ( long ) WRITERS * RECORDS );
+
+	/* a file that fills up part way */
+	CHECK ( Run ( 1L << 20, 0 ) < ( long ) WRITERS * RECORDS );
+
+	puts ( "ok" );
+	return 0;
+}
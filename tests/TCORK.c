@@ -0,0 +1,202 @@
+/************************************************************************************
+*		FILE:		"tcork.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Tests of the coalescing buffer (nscork.c) against a
+*					non-blocking socket that fills: messages small and
+*					larger than the buffer go through coalesce_send,
+*					coalesce_flush and coalesce_tick while the peer
+*					reads only now and then, and every byte the peer
+*					gets must be the next one of the stream - none
+*					lost, none twice.
+*
+*		Notes:		Linux only. Build and run from the top directory:
+*
+*					gcc -o tcork -I. tests/TCORK.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./tcork
+*
+*					Prints "ok" and exits 0, or names the failed check
+*					and exits 1.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.1	  10/17/26		Initial Release
+*************************************************************************************/
+
+#include "NSCORK.h"
+#include <fcntl.h>
+
+#define CHECK(x)	do { if ( !( x ) ) { fprintf ( stderr, "%s:%d: %s\n", __FILE__, __LINE__, #x ); exit ( 1 ); } } while ( 0 )
+
+#define CAPACITY		1024
+#define MESSAGES		20000
+#define MAX_MESSAGE		( 3 * CAPACITY )
+#define SOCKET_BUFFER		8192
+
+static TCP			*tcp;
+static long			 produced;	/* stream bytes handed to coalesce_send */
+static long			 consumed;	/* stream bytes the peer has checked */
+
+
+/* byte n of the stream; not periodic in any message length used */
+static char Stream_Byte ( long n )
+{
+	return ( char ) ( n * 7 + n / 251 );
+}
+
+/* the next message: mostly small, every 17th bigger than the buffer */
+static long Next ( char *message, int seq )
+{
+	long length = seq % 17 ? 1 + ( seq * 37 ) % 200 : CAPACITY + ( seq * 53 ) % ( MAX_MESSAGE - CAPACITY );
+	long i;
+
+	for ( i = 0; i < length; i++ )
+		message[i] = Stream_Byte ( produced + i );
+	produced += length;
+	return length;
+}
+
+/* reads what has arrived, up to most bytes, checking each; returns the count */
+static long Drain ( int peer, long most )
+{
+	char	 buffer[4096];
+	long	 total = 0;
+	long	 n;
+	long	 i;
+
+	while ( total < most )
+	{
+		n = recv ( peer, buffer, most - total < ( long ) sizeof ( buffer ) ? most - total : ( long ) sizeof ( buffer ), MSG_DONTWAIT );
+		if ( n <= 0 )
+			break;
+		for ( i = 0; i < n; i++ )
+			CHECK ( buffer[i] == Stream_Byte ( consumed + i ) );
+		consumed += n;
+		total += n;
+	}
+	return total;
+}
+
+/* flushes and drains until every byte produced has been checked */
+static void Finish ( TCP_CONNECTION_INFO *connection, int peer )
+{
+	int status;
+
+	for ( ;; )
+	{
+		status = tcp->coalesce_flush ( connection );
+		CHECK ( status >= 0 || errno == EAGAIN );
+		if ( status >= 0 && connection->coalesce->used == 0 )
+			break;
+		Drain ( peer, 1L << 30 );
+	}
+	while ( consumed < produced )
+		CHECK ( Drain ( peer, 1L << 30 ) > 0 || consumed == produced );
+	CHECK ( consumed == produced );
+	CHECK ( Drain ( peer, 1 ) == 0 );
+}
+
+/* a coalescing connection on a non-blocking end of a socketpair */
+static TCP_CONNECTION_INFO *Open ( int *peer, long flush_usec, int flags )
+{
+	TCP_CONNECTION_INFO	*connection = tcp->get_conn_info ( );
+	int			 size = SOCKET_BUFFER;
+	int			 sv[2];
+
+	CHECK ( socketpair ( AF_UNIX, SOCK_STREAM, 0, sv ) == 0 );
+	setsockopt ( sv[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof ( size ) );
+	setsockopt ( sv[1], SOL_SOCKET, SO_RCVBUF, &size, sizeof ( size ) );
+	CHECK ( fcntl ( sv[0], F_SETFL, fcntl ( sv[0], F_GETFL ) | O_NONBLOCK ) == 0 );
+	connection->sock_num = sv[0];
+	connection->sock = &connection->sock_num;
+	*peer = sv[1];
+
+	CHECK ( tcp->set_coalesce ( connection, CAPACITY, CAPACITY / 2, 5, flush_usec, flags ) == 0 );
+	produced = consumed = 0;
+	return connection;
+}
+
+static void Close ( TCP_CONNECTION_INFO *connection, int peer )
+{
+	tcp->close_sock ( connection );
+	tcp->clean_conn_info ( connection );
+	close ( peer );
+}
+
+/* fill the socket with nobody reading, then let it all through */
+static void Test_Fill ( int flags )
+{
+	TCP_CONNECTION_INFO	*connection;
+	char			 message[MAX_MESSAGE];
+	int			 peer;
+	int			 seq;
+
+	connection = Open ( &peer, 0, flags );
+	for ( seq = 0; seq < 2000; seq++ )
+		CHECK ( tcp->coalesce_send ( connection, message, Next ( message, seq ) ) > 0 );
+
+	/* the socket is full and the rest is held, so a flush can't finish */
+	CHECK ( connection->coalesce->used > 0 );
+	CHECK ( tcp->coalesce_flush ( connection ) == -1 && errno == EAGAIN );
+	CHECK ( connection->coalesce->used > 0 );
+
+	Finish ( connection, peer );
+	Close ( connection, peer );
+}
+
+/* sends, explicit flushes and deadline ticks while the peer reads a
+*  little at a time, so pushes keep ending part way */
+static void Test_Mixed ( int flags )
+{
+	TCP_CONNECTION_INFO	*connection;
+	char			 message[MAX_MESSAGE];
+	int			 status;
+	int			 peer;
+	int			 seq;
+
+	connection = Open ( &peer, 100, flags );
+	for ( seq = 0; seq < MESSAGES; seq++ )
+	{
+		CHECK ( tcp->coalesce_send ( connection, message, Next ( message, seq ) ) > 0 );
+
+		if ( seq % 13 == 0 )
+		{
+			status = tcp->coalesce_flush ( connection );
+			CHECK ( status >= 0 || errno == EAGAIN );
+		}
+		if ( seq % 97 == 0 )
+		{
+			usleep ( 200 );
+			CHECK ( tcp->coalesce_due ( connection ) <= 0 );
+			status = tcp->coalesce_tick ( connection );
+			CHECK ( status >= 0 || errno == EAGAIN );
+		}
+		if ( seq % 3 == 0 )
+			Drain ( peer, 1 + ( seq * 131 ) % 1500 );
+	}
+
+	Finish ( connection, peer );
+	Close ( connection, peer );
+}
+
+int main ( void )
+{
+	tcp = intialize_tcp_engine ( TCP_ENGINE_DEFAULT );
+	CHECK ( tcp );
+
+	Test_Fill ( 0 );
+	Test_Fill ( TCP_COALESCE_CORK );
+	Test_Mixed ( 0 );
+	Test_Mixed ( TCP_COALESCE_MSG_MORE );
+
+	release_tcp ( tcp );
+	puts ( "ok" );
+	return 0;
+}
@@ -0,0 +1,347 @@
+/************************************************************************************
+*		FILE:		"tdns.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Tests of the host name cache (nsdns.c): misses that
+*					don't wait (and connects to them that fail with
+*					EAGAIN), the time to live, negative entries, stale
+*					answers while a name is refreshed, which entry a full
+*					set pushes out, and lock-free readers racing the
+*					writers that refresh, evict and flush entries. Lookups
+*					go to a stub through TCP_RESOLVER_CONFIG::lookup, so no
+*					DNS is needed.
+*
+*		Notes:		Linux only. Build and run from the top directory:
+*
+*					gcc -o tdns -I. tests/TDNS.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./tdns
+*
+*					Prints "ok" and exits 0, or names the failed check
+*					and exits 1. Takes about two seconds.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.1	  10/17/26		Initial Release
+*************************************************************************************/
+
+#include "NSDNS.h"
+#include <pthread.h>
+
+#define CHECK(x)	do { if ( !( x ) ) { fprintf ( stderr, "%s:%d: %s\n", __FILE__, __LINE__, #x ); exit ( 1 ); } } while ( 0 )
+
+/* lifetimes, microseconds; well above the coarse clock's few ms */
+#define TTL_USEC		200000L
+#define NEGATIVE_USEC		200000L
+#define STALE_USEC		300000L
+
+#define READERS			3
+#define READS			100000		/* per reader */
+#define NAMES			64
+
+static int		stub_calls;
+static int		stub_delay_ms;
+static int		stub_answer = 1;
+static int		stub_generation;
+static int		readers_done;
+
+/* the stub resolver: "missing.test" doesn't exist, "s<n>.test" is
+*  10.<generation>.<n>, everything else is 10.0.0.<stub_answer> */
+static int Stub_Lookup ( const char *name, struct in_addr *addr, void *context )
+{
+	int n;
+
+	( void ) context;
+	__atomic_add_fetch ( &stub_calls, 1, __ATOMIC_RELAXED );
+	if ( __atomic_load_n ( &stub_delay_ms, __ATOMIC_RELAXED ) )
+		usleep ( __atomic_load_n ( &stub_delay_ms, __ATOMIC_RELAXED ) * 1000 );
+	if ( !strcmp ( name, "missing.test" ) )
+		return TCP_RESOLVE_MISSING;
+	if ( sscanf ( name, "s%d.test", &n ) == 1 )
+	{
+		addr->s_addr = htonl ( 0x0a000000 + ( ( __atomic_add_fetch ( &stub_generation, 1, __ATOMIC_RELAXED ) & 0xff ) << 16 ) + n );
+		return TCP_RESOLVE_FOUND;
+	}
+
+	addr->s_addr = htonl ( 0x0a000000 + __atomic_load_n ( &stub_answer, __ATOMIC_RELAXED ) );
+	return TCP_RESOLVE_FOUND;
+}
+
+static int Calls ( void )
+{
+	return __atomic_load_n ( &stub_calls, __ATOMIC_RELAXED );
+}
+
+static void Setup ( int entries, long miss_wait_usec )
+{
+	TCP_RESOLVER_CONFIG config;
+
+	memset ( &config, 0, sizeof ( config ) );
+	config.ttl_usec = TTL_USEC;
+	config.negative_usec = NEGATIVE_USEC;
+	config.stale_usec = STALE_USEC;
+	config.miss_wait_usec = miss_wait_usec;
+	config.entries = entries;
+	config.lookup = Stub_Lookup;
+	CHECK ( tcp_resolver_config ( &config ) == 0 );
+	stub_calls = 0;
+	stub_delay_ms = 0;
+	stub_answer = 1;
+}
+
+/* a miss with the default configuration comes back at once */
+static void Test_Miss_No_Wait ( void )
+{
+	TCP			*tcp;
+	TCP_CONNECTION_INFO	*connection;
+	struct in_addr		 addr;
+	long long		 start;
+
+	Setup ( 64, 0 );
+	stub_delay_ms = 200;
+
+	start = tcp_clock_usec ( );
+	CHECK ( tcp_resolve ( "slow.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_PENDING );
+	CHECK ( tcp_clock_usec ( ) - start < 100000 );
+
+	tcp = intialize_tcp ( );
+	connection = tcp->get_conn_info ( );
+	strcpy ( connection->ipaddr, "other.test" );
+	connection->port = 80;
+	start = tcp_clock_usec ( );
+	errno = 0;
+	tcp->set_sockaddr ( connection, AF_INET );
+	CHECK ( tcp_clock_usec ( ) - start < 100000 );
+	CHECK ( connection->sockaddr->sin_addr.s_addr == INADDR_NONE && errno == EAGAIN );
+
+	/* the connects fail the same way, not to 255.255.255.255 */
+	CHECK ( tcp->get_sock ( connection, AF_INET, SOCK_STREAM, 0 ) >= 0 );
+	errno = 0;
+	CHECK ( tcp->make_connect ( connection ) == -1 && errno == EAGAIN );
+	tcp->close_sock ( connection );
+	CHECK ( tcp->get_sock_nw ( connection, AF_INET, SOCK_STREAM, 0, 0 ) >= 0 );
+	errno = 0;
+	CHECK ( tcp->make_connect_nw ( connection ) == -1 && errno == EAGAIN );
+	tcp->close_sock ( connection );
+	CHECK ( tcp_clock_usec ( ) - start < 100000 );
+
+	/* an explicit wait gets the answer */
+	CHECK ( tcp_resolve ( "slow.test", &addr, 2000000 ) == TCP_RESOLVE_FOUND );
+	CHECK ( addr.s_addr == htonl ( 0x0a000001 ) );
+	CHECK ( tcp_resolve ( "other.test", &addr, 2000000 ) == TCP_RESOLVE_FOUND );
+	tcp->set_sockaddr ( connection, AF_INET );
+	CHECK ( connection->sockaddr->sin_addr.s_addr == htonl ( 0x0a000001 ) );
+
+	/* a connect after the answer came in uses it, whatever set_sockaddr left */
+	connection->sockaddr->sin_addr.s_addr = INADDR_NONE;
+	CHECK ( tcp->get_sock ( connection, AF_INET, SOCK_STREAM, 0 ) >= 0 );
+	fcntl ( *connection->sock, F_SETFL, O_NONBLOCK );
+	tcp->make_connect ( connection );
+	CHECK ( connection->sockaddr->sin_addr.s_addr == htonl ( 0x0a000001 ) );
+	tcp->close_sock ( connection );
+
+	/* a name that doesn't exist */
+	strcpy ( connection->ipaddr, "missing.test" );
+	CHECK ( tcp_resolve ( "missing.test", &addr, 2000000 ) == TCP_RESOLVE_MISSING );
+	tcp->set_sockaddr ( connection, AF_INET );
+	CHECK ( tcp->get_sock ( connection, AF_INET, SOCK_STREAM, 0 ) >= 0 );
+	errno = 0;
+	CHECK ( tcp->make_connect ( connection ) == -1 && errno == EHOSTUNREACH );
+	tcp->close_sock ( connection );
+
+	tcp->clean_conn_info ( connection );
+	release_tcp ( tcp );
+}
+
+/* within the TTL a name is answered without a lookup */
+static void Test_TTL ( void )
+{
+	struct in_addr	addr;
+	int		i;
+
+	Setup ( 64, 1000000 );
+	CHECK ( tcp_resolve ( "a.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_FOUND );
+	CHECK ( Calls ( ) == 1 );
+
+	stub_answer = 2;
+	for ( i = 0; i < 1000; i++ )
+	{
+		CHECK ( tcp_resolve ( "a.test", &addr, 0 ) == TCP_RESOLVE_FOUND );
+		CHECK ( addr.s_addr == htonl ( 0x0a000001 ) );
+	}
+	usleep ( TTL_USEC / 4 );
+	CHECK ( tcp_resolve ( "a.test", &addr, 0 ) == TCP_RESOLVE_FOUND );
+	CHECK ( Calls ( ) == 1 );
+}
+
+/* a name that doesn't exist is remembered for the negative time */
+static void Test_Negative ( void )
+{
+	struct in_addr addr;
+
+	Setup ( 64, 1000000 );
+	CHECK ( tcp_resolve ( "missing.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_MISSING );
+	CHECK ( Calls ( ) == 1 );
+	CHECK ( tcp_resolve ( "missing.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_MISSING );
+	CHECK ( tcp_resolve ( "missing.test", &addr, 0 ) == TCP_RESOLVE_MISSING );
+	CHECK ( Calls ( ) == 1 );
+
+	usleep ( NEGATIVE_USEC + 50000 );
+	CHECK ( tcp_resolve ( "missing.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_MISSING );
+	CHECK ( Calls ( ) == 2 );
+}
+
+/* past the TTL the old address is served while one lookup refreshes it;
+*  past the stale time too, the name is a miss again */
+static void Test_Stale ( void )
+{
+	struct in_addr	addr;
+	long long	start;
+	int		i;
+
+	Setup ( 64, 1000000 );
+	CHECK ( tcp_resolve ( "a.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_FOUND );
+	CHECK ( tcp_resolve ( "b.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_FOUND );
+	CHECK ( Calls ( ) == 2 );
+
+	usleep ( TTL_USEC + 50000 );
+	stub_answer = 2;
+	stub_delay_ms = 50;
+	start = tcp_clock_usec ( );
+	for ( i = 0; i < 100; i++ )
+	{
+		CHECK ( tcp_resolve ( "a.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_FOUND );
+		if ( addr.s_addr != htonl ( 0x0a000001 ) )
+			break;
+	}
+	CHECK ( tcp_clock_usec ( ) - start < 40000 );
+	CHECK ( addr.s_addr == htonl ( 0x0a000001 ) );
+
+	for ( i = 0; i < 200 && addr.s_addr != htonl ( 0x0a000002 ); i++ )
+	{
+		usleep ( 5000 );
+		CHECK ( tcp_resolve ( "a.test", &addr, 0 ) == TCP_RESOLVE_FOUND );
+	}
+	CHECK ( addr.s_addr == htonl ( 0x0a000002 ) );
+	CHECK ( Calls ( ) == 3 );
+
+	/* b.test was left alone past ttl + stale */
+	usleep ( TTL_USEC + STALE_USEC );
+	stub_delay_ms = 0;
+	CHECK ( tcp_resolve ( "b.test", &addr, 0 ) == TCP_RESOLVE_PENDING );
+	CHECK ( tcp_resolve ( "b.test", &addr, 1000000 ) == TCP_RESOLVE_FOUND );
+	CHECK ( addr.s_addr == htonl ( 0x0a000002 ) );
+}
+
+/* a full set pushes out the entry read least recently */
+static void Test_Eviction ( void )
+{
+	static const char	*names[] = { "a.test", "b.test", "c.test", "d.test" };
+	struct in_addr		 addr;
+	int			 i;
+
+	Setup ( 4, 1000000 );	/* one set of four */
+	for ( i = 0; i < 4; i++ )
+		CHECK ( tcp_resolve ( names[i], &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_FOUND );
+	CHECK ( Calls ( ) == 4 );
+
+	/* read all but b.test, oldest first, a clock tick apart */
+	for ( i = 0; i < 4; i++ )
+	{
+		usleep ( 20000 );
+		if ( i != 1 )
+			CHECK ( tcp_resolve ( names[i], &addr, 0 ) == TCP_RESOLVE_FOUND );
+	}
+	CHECK ( tcp_resolve ( "e.test", &addr, TCP_RESOLVE_WAIT ) == TCP_RESOLVE_FOUND );
+	CHECK ( Calls ( ) == 5 );
+
+	CHECK ( tcp_resolve ( "a.test", &addr, 0 ) == TCP_RESOLVE_FOUND );
+	CHECK ( tcp_resolve ( "c.test", &addr, 0 ) == TCP_RESOLVE_FOUND );
+	CHECK ( tcp_resolve ( "d.test", &addr, 0 ) == TCP_RESOLVE_FOUND );
+	CHECK ( tcp_resolve ( "e.test", &addr, 0 ) == TCP_RESOLVE_FOUND );
+	CHECK ( Calls ( ) == 5 );
+	CHECK ( tcp_resolve ( "b.test", &addr, 0 ) == TCP_RESOLVE_PENDING );
+}
+
+/* reads without a lock; an answer must be the one for its own name */
+static void *Seqlock_Reader ( void *arg )
+{
+	struct in_addr	 addr;
+	char		 name[32];
+	unsigned	 seed = ( unsigned ) ( long ) arg;
+	unsigned	 value;
+	int		 found = 0;
+	int		 result;
+	int		 n;
+	int		 i;
+
+	for ( i = 0; i < READS; i++ )
+	{
+		seed = seed * 1103515245u + 12345u;
+		n = ( int ) ( ( seed >> 16 ) % NAMES );
+		sprintf ( name, "s%d.test", n );
+		result = tcp_resolve ( name, &addr, 0 );
+		CHECK ( result == TCP_RESOLVE_FOUND || result == TCP_RESOLVE_PENDING );
+		if ( result != TCP_RESOLVE_FOUND )
+			continue;
+		value = ntohl ( addr.s_addr );
+		CHECK ( ( value >> 24 ) == 10 && ( int ) ( value & 0xffff ) == n );
+		found++;
+	}
+	CHECK ( found > 0 );
+
+	__atomic_add_fetch ( &readers_done, 1, __ATOMIC_RELEASE );
+	return 0;
+}
+
+/* readers against the resolver thread (refreshes every few ms, and
+*  evictions: 64 names over 16 entries) and against flushes */
+static void Test_Seqlock ( void )
+{
+	TCP_RESOLVER_CONFIG	config;
+	pthread_t		threads[READERS];
+	int			flushes = 0;
+	int			i;
+
+	memset ( &config, 0, sizeof ( config ) );
+	config.ttl_usec = 1000;
+	config.stale_usec = 10000000;
+	config.entries = 16;
+	config.lookup = Stub_Lookup;
+	CHECK ( tcp_resolver_config ( &config ) == 0 );
+	stub_calls = 0;
+	readers_done = 0;
+
+	for ( i = 0; i < READERS; i++ )
+		pthread_create ( &threads[i], 0, Seqlock_Reader, ( void * ) ( long ) ( i + 1 ) );
+	while ( __atomic_load_n ( &readers_done, __ATOMIC_ACQUIRE ) < READERS )
+	{
+		tcp_resolver_flush ( );
+		flushes++;
+		usleep ( 500 );
+	}
+	for ( i = 0; i < READERS; i++ )
+		pthread_join ( threads[i], 0 );
+
+	CHECK ( flushes > 0 && Calls ( ) > NAMES );
+}
+
+int main ( void )
+{
+	Test_Miss_No_Wait ( );
+	Test_TTL ( );
+	Test_Negative ( );
+	Test_Stale ( );
+	Test_Eviction ( );
+	Test_Seqlock ( );
+
+	tcp_resolver_stop ( );
+	puts ( "ok" );
+	return 0;
+}
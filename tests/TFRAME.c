@@ -0,0 +1,233 @@
+/************************************************************************************
+*		FILE:		"tframe.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Tests of length-prefixed framing (nsframe.c) over a
+*					socketpair: a stream of frames fed a few bytes at a
+*					time, so prefixes and bodies split across receives,
+*					in a one-page ring that wraps many times over. Every
+*					prefix width and flag is tried, blocking and with
+*					frame_recv_nw, and each frame must come back whole
+*					and in order - including the ones that straddle the
+*					end of the mirrored ring - followed by a prefix over
+*					max_frame, which must be refused.
+*
+*		Notes:		Linux only. Build and run from the top directory:
+*
+*					gcc -o tframe -I. tests/TFRAME.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./tframe [engine]
+*
+*					Prints "ok" and exits 0, or names the failed check
+*					and exits 1.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.1	  10/17/26		Initial Release
+*************************************************************************************/
+
+#include "NSFRAME.h"
+
+#define CHECK(x)	do { if ( !( x ) ) { fprintf ( stderr, "%s:%d: %s\n", __FILE__, __LINE__, #x ); exit ( 1 ); } } while ( 0 )
+
+#define FRAMES			3000
+#define MAX_FRAME		3000		/* fits a one-page ring with its prefix */
+#define MAX_CHUNK		700		/* most bytes fed between receives */
+#define STREAM_SIZE		( FRAMES * ( 4 + MAX_FRAME ) )
+
+static TCP			*tcp;
+static char			 stream[STREAM_SIZE];
+static int			 got;		/* frames checked */
+static int			 wrapped;	/* of those, frames across the ring's end */
+
+
+/* body byte j of frame seq */
+static char Body_Byte ( int seq, long j )
+{
+	return ( char ) ( seq + j * 3 );
+}
+
+/* frame seq's body length, never above what the prefix can say */
+static long Body_Length ( int seq, long max_frame )
+{
+	return ( seq * 211L ) % ( max_frame + 1 );
+}
+
+/* the prefix, written here rather than by frame_prefix so the two
+*  sides don't share a mistake */
+static void Prefix ( char *at, int width, int flags, long body )
+{
+	unsigned long	 value = ( unsigned long ) body;
+	int		 i;
+
+	if ( flags & TCP_FRAME_LENGTH_INCLUSIVE )
+		value += width;
+	for ( i = 0; i < width; i++ )
+		at[flags & TCP_FRAME_LITTLE_ENDIAN ? i : width - 1 - i] = ( char ) ( value >> ( 8 * i ) );
+}
+
+/* the whole stream of frames; returns its length */
+static long Build ( int width, int flags, long max_frame )
+{
+	long	 at = 0;
+	long	 body;
+	long	 j;
+	int	 seq;
+
+	for ( seq = 0; seq < FRAMES; seq++ )
+	{
+		body = Body_Length ( seq, max_frame );
+		Prefix ( stream + at, width, flags, body );
+		at += width;
+		for ( j = 0; j < body; j++ )
+			stream[at + j] = Body_Byte ( seq, j );
+		at += body;
+	}
+	return at;
+}
+
+/* takes every complete frame out of the ring and checks it */
+static void Take ( TCP_CONNECTION_INFO *connection, long max_frame )
+{
+	TCP_FRAMER	*framer = connection->framer;
+	char		*frame;
+	long		 length;
+	long		 j;
+	int		 status;
+
+	while ( ( status = frame_next ( connection, &frame, &length ) ) == 1 )
+	{
+		CHECK ( got < FRAMES );
+		CHECK ( length == Body_Length ( got, max_frame ) );
+		for ( j = 0; j < length; j++ )
+			CHECK ( frame[j] == Body_Byte ( got, j ) );
+		if ( frame + length > framer->base + framer->size )
+			wrapped++;
+		got++;
+	}
+	CHECK ( status == 0 );
+}
+
+/* one receive into the ring, blocking or nowait */
+static long Receive ( TCP_CONNECTION_INFO *connection, int nowait )
+{
+	TCP_COMPLETION	 completion;
+	int		 reaped;
+
+	if ( !nowait )
+		return frame_recv ( connection );
+
+	CHECK ( frame_recv_nw ( connection ) == 0 );
+	do
+		reaped = tcp->reap_completions ( &completion, 1, -1 );
+	while ( reaped == 0 );
+	CHECK ( reaped == 1 && !completion.error );
+	frame_commit ( connection, completion.count );
+	return completion.count;
+}
+
+/* a framed connection on one end of a socketpair */
+static TCP_CONNECTION_INFO *Open ( int *peer, int width, int flags, long max_frame )
+{
+	TCP_CONNECTION_INFO	*connection = tcp->get_conn_info ( );
+	int			 sv[2];
+
+	CHECK ( socketpair ( AF_UNIX, SOCK_STREAM, 0, sv ) == 0 );
+	connection->sock_num = sv[0];
+	connection->sock = &connection->sock_num;
+	*peer = sv[1];
+
+	/* a page: the frames wrap the ring every few receives */
+	CHECK ( tcp->set_framer ( connection, 1, width, flags, max_frame ) == 0 );
+	CHECK ( connection->framer->mirrored );
+	CHECK ( connection->framer->size >= max_frame + width );
+	return connection;
+}
+
+static void Close ( TCP_CONNECTION_INFO *connection, int peer )
+{
+	tcp->close_sock ( connection );
+	tcp->clean_conn_info ( connection );
+	close ( peer );
+}
+
+/* the stream a few bytes at a time; every frame back whole and in order */
+static void Test_Split ( int width, int flags, int nowait )
+{
+	TCP_CONNECTION_INFO	*connection;
+	long			 max_frame = width == 1 ? 255 - ( flags & TCP_FRAME_LENGTH_INCLUSIVE ? 1 : 0 ) : MAX_FRAME;
+	long			 length = Build ( width, flags, max_frame );
+	long			 sent = 0;
+	long			 received = 0;
+	long			 chunk;
+	long			 n;
+	long			 frame_length;
+	char			*frame;
+	char			 bad[4];
+	int			 peer;
+	int			 round = 0;
+
+	connection = Open ( &peer, width, flags, MAX_FRAME );
+	CHECK ( connection->framer->max_frame == max_frame );
+	got = wrapped = 0;
+
+	while ( sent < length )
+	{
+		/* 1, 2, 3 ... bytes: every cut through a prefix comes up */
+		chunk = round < 64 ? round % 8 + 1 : 1 + ( round * 97L ) % MAX_CHUNK;
+		if ( chunk > length - sent )
+			chunk = length - sent;
+		CHECK ( write ( peer, stream + sent, chunk ) == chunk );
+		sent += chunk;
+		round++;
+
+		while ( received < sent )
+		{
+			n = Receive ( connection, nowait );
+			CHECK ( n > 0 );
+			received += n;
+			Take ( connection, max_frame );
+		}
+	}
+	CHECK ( got == FRAMES && received == length );
+	CHECK ( wrapped > 0 );
+
+	/* a prefix over max_frame can't be framed; the stream is dead
+	*  (a 1-byte prefix can't say more than its max_frame) */
+	if ( width > 1 )
+	{
+		Prefix ( bad, width, flags, max_frame + 1 );
+		CHECK ( write ( peer, bad, width ) == width );
+		CHECK ( Receive ( connection, nowait ) == width );
+		CHECK ( frame_next ( connection, &frame, &frame_length ) == -1 );
+	}
+
+	Close ( connection, peer );
+}
+
+int main ( int argc, char **argv )
+{
+	int flags;
+	int nowait;
+
+	tcp = intialize_tcp_engine ( argc > 1 ? atoi ( argv[1] ) : TCP_ENGINE_DEFAULT );
+	CHECK ( tcp );
+
+	for ( nowait = 0; nowait < 2; nowait++ )
+		for ( flags = 0; flags < 4; flags++ )
+		{
+			Test_Split ( 1, flags, nowait );
+			Test_Split ( 2, flags, nowait );
+			Test_Split ( 4, flags, nowait );
+		}
+
+	release_tcp ( tcp );
+	puts ( "ok" );
+	return 0;
+}
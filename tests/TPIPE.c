@@ -0,0 +1,257 @@
+/************************************************************************************
+*		FILE:		"tpipe.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Tests of pipelined requests (nspipe.c) sent through a
+*					coalescing buffer whose thresholds are never reached,
+*					so nothing goes out unless the pipeline flushes it:
+*					a few requests then pipe_recv, filling the window
+*					until TCP_PIPE_FULL, callbacks sending the next
+*					request, and the same driven by frame_recv_nw. An
+*					echo thread answers every request, and each response
+*					must reach its own callback with its own body.
+*
+*		Notes:		Linux only. Build and run from the top directory:
+*
+*					gcc -o tpipe -I. tests/TPIPE.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./tpipe [engine]
+*
+*					Prints "ok" and exits 0, or names the failed check
+*					and exits 1. A hang is a failure too: it gives up
+*					after 20 seconds.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.1	  10/17/26		Initial Release
+*************************************************************************************/
+
+#include "NSPIPE.h"
+#include "NSFRAME.h"
+#include "NSCORK.h"
+#include <pthread.h>
+#include <signal.h>
+
+#define CHECK(x)	do { if ( !( x ) ) { fprintf ( stderr, "%s:%d: %s\n", __FILE__, __LINE__, #x ); exit ( 1 ); } } while ( 0 )
+
+#define WINDOW			8
+#define ROUNDS			200
+#define CHAIN			500		/* requests sent from callbacks */
+#define MAX_BODY		600
+
+static TCP			*tcp;
+static int			 answered;
+static int			 chained;
+static int			 wrong;
+
+
+static void Hung ( int signal )
+{
+	( void ) signal;
+	fprintf ( stderr, "tpipe: no progress, requests left unsent\n" );
+	_exit ( 1 );
+}
+
+/* the server: every frame straight back, until the peer closes */
+static void *Echo ( void *arg )
+{
+	static char	 buffer[4 + 65536];
+	int		 peer = ( int ) ( long ) arg;
+	long		 length;
+	long		 have;
+	long		 n;
+
+	for ( ;; )
+	{
+		for ( have = 0; have < 4; have += n )
+			if ( ( n = recv ( peer, buffer + have, 4 - have, 0 ) ) <= 0 )
+				return 0;
+		length = ( ( long ) ( unsigned char ) buffer[0] << 24 ) | ( ( unsigned char ) buffer[1] << 16 )
+			   | ( ( unsigned char ) buffer[2] << 8 ) | ( unsigned char ) buffer[3];
+		for ( have = 0; have < length; have += n )
+			if ( ( n = recv ( peer, buffer + 4 + have, length - have, 0 ) ) <= 0 )
+				return 0;
+		for ( have = 0; have < 4 + length; have += n )
+			if ( ( n = send ( peer, buffer + have, 4 + length - have, 0 ) ) <= 0 )
+				return 0;
+	}
+}
+
+/* a request: 4 ID bytes (filled in by pipe_send), then bytes of seq */
+static long Make ( char *body, int seq )
+{
+	long length = 4 + ( seq * 53 ) % ( MAX_BODY - 4 );
+
+	memset ( body + 4, seq & 0xff, length - 4 );
+	return length;
+}
+
+static void Response ( TCP_CONNECTION_INFO *connection, void *context, char *frame, long length, int error )
+{
+	char	 expect[MAX_BODY];
+	int	 seq = ( int ) ( long ) context;
+
+	( void ) connection;
+	if ( error || !frame || length != Make ( expect, seq ) )
+		wrong++;
+	else if ( length > 4 && ( unsigned char ) frame[length - 1] != ( seq & 0xff ) )
+		wrong++;
+	answered++;
+}
+
+/* as Response, then the next request from inside the callback */
+static void Chained ( TCP_CONNECTION_INFO *connection, void *context, char *frame, long length, int error )
+{
+	char	 body[MAX_BODY];
+	int	 seq = ( int ) ( long ) context;
+
+	Response ( connection, context, frame, length, error );
+	if ( chained < CHAIN )
+	{
+		chained++;
+		seq += WINDOW;
+		if ( pipe_send ( connection, body, Make ( body, seq ), Chained, ( void * ) ( long ) seq ) < 0 )
+			wrong++;
+	}
+}
+
+/* a framed, pipelined, coalescing connection on one end of a socketpair */
+static TCP_CONNECTION_INFO *Open ( pthread_t *server, int *peer )
+{
+	TCP_CONNECTION_INFO	*connection = tcp->get_conn_info ( );
+	int			 sv[2];
+
+	CHECK ( socketpair ( AF_UNIX, SOCK_STREAM, 0, sv ) == 0 );
+	connection->sock_num = sv[0];
+	connection->sock = &connection->sock_num;
+	*peer = sv[1];
+	pthread_create ( server, 0, Echo, ( void * ) ( long ) sv[1] );
+
+	CHECK ( tcp->set_framer ( connection, 65536, 4, 0, 65536 ) == 0 );
+	CHECK ( tcp->set_coalesce ( connection, 1L << 20, 1L << 20, 0, 0, 0 ) == 0 );
+	CHECK ( tcp->set_pipeline ( connection, WINDOW, 0, 4 ) == 0 );
+	return connection;
+}
+
+static void Close ( TCP_CONNECTION_INFO *connection, pthread_t server, int peer )
+{
+	shutdown ( *connection->sock, SHUT_WR );
+	pthread_join ( server, 0 );
+	tcp->close_sock ( connection );
+	tcp->clean_conn_info ( connection );
+	close ( peer );
+}
+
+/* a few requests below every threshold, then the blocking wait */
+static void Test_Recv ( void )
+{
+	TCP_CONNECTION_INFO	*connection;
+	pthread_t		 server;
+	char			 body[MAX_BODY];
+	int			 peer;
+	int			 seq;
+
+	connection = Open ( &server, &peer );
+	answered = wrong = 0;
+	for ( seq = 0; seq < 3; seq++ )
+		CHECK ( pipe_send ( connection, body, Make ( body, seq ), Response, ( void * ) ( long ) seq ) >= 0 );
+	CHECK ( connection->coalesce->used > 0 );
+	while ( pipe_inflight ( connection ) )
+		CHECK ( pipe_recv ( connection ) >= 0 );
+	CHECK ( answered == 3 && !wrong );
+	Close ( connection, server, peer );
+}
+
+/* fill the window until TCP_PIPE_FULL, then wait for the responses */
+static void Test_Full ( void )
+{
+	TCP_CONNECTION_INFO	*connection;
+	pthread_t		 server;
+	char			 body[MAX_BODY];
+	long			 id;
+	int			 peer;
+	int			 round;
+	int			 seq = 0;
+	int			 sent = 0;
+
+	connection = Open ( &server, &peer );
+	answered = wrong = 0;
+	for ( round = 0; round < ROUNDS; round++ )
+	{
+		while ( ( id = pipe_send ( connection, body, Make ( body, seq ), Response, ( void * ) ( long ) seq ) ) >= 0 )
+		{
+			seq++;
+			sent++;
+		}
+		CHECK ( id == TCP_PIPE_FULL && pipe_inflight ( connection ) == WINDOW );
+		CHECK ( connection->coalesce->used == 0 );
+		while ( pipe_inflight ( connection ) > round % WINDOW )
+			CHECK ( pipe_recv ( connection ) >= 0 );
+	}
+	while ( pipe_inflight ( connection ) )
+		CHECK ( pipe_recv ( connection ) >= 0 );
+	CHECK ( answered == sent && !wrong && !connection->pipeline->stray );
+	Close ( connection, server, peer );
+}
+
+/* callbacks send the next request; blocking, or with frame_recv_nw */
+static void Test_Chain ( int nowait )
+{
+	TCP_CONNECTION_INFO	*connection;
+	TCP_COMPLETION		 completion;
+	pthread_t		 server;
+	char			 body[MAX_BODY];
+	int			 peer;
+	int			 seq;
+	int			 reaped;
+
+	connection = Open ( &server, &peer );
+	answered = wrong = chained = 0;
+	for ( seq = 0; seq < WINDOW; seq++ )
+		CHECK ( pipe_send ( connection, body, Make ( body, seq ), Chained, ( void * ) ( long ) seq ) >= 0 );
+
+	if ( nowait )
+		CHECK ( coalesce_flush ( connection ) > 0 );
+	while ( pipe_inflight ( connection ) )
+	{
+		if ( !nowait )
+		{
+			CHECK ( pipe_recv ( connection ) >= 0 );
+			continue;
+		}
+		CHECK ( frame_recv_nw ( connection ) == 0 );
+		do
+			reaped = tcp->reap_completions ( &completion, 1, -1 );
+		while ( reaped == 0 );
+		CHECK ( reaped == 1 && !completion.error && completion.count > 0 );
+		frame_commit ( connection, completion.count );
+		CHECK ( pipe_dispatch ( connection ) >= 0 );
+		CHECK ( connection->coalesce->used == 0 );
+	}
+	CHECK ( answered == WINDOW + CHAIN && !wrong );
+	Close ( connection, server, peer );
+}
+
+int main ( int argc, char **argv )
+{
+	signal ( SIGALRM, Hung );
+	alarm ( 20 );
+
+	tcp = intialize_tcp_engine ( argc > 1 ? atoi ( argv[1] ) : TCP_ENGINE_DEFAULT );
+	CHECK ( tcp );
+
+	Test_Recv ( );
+	Test_Full ( );
+	Test_Chain ( 0 );
+	Test_Chain ( 1 );
+
+	release_tcp ( tcp );
+	puts ( "ok" );
+	return 0;
+}
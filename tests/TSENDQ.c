@@ -0,0 +1,274 @@
+/************************************************************************************
+*		FILE:		"tsendq.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Tests of the shared send queue (nssendq.c): the
+*					TCP_SENDQ_FIRST / TCP_SENDQ_HIGH flags and on_drained
+*					step by step, then several producer threads pushing
+*					messages of mixed sizes while the owner flushes, with
+*					every message checked for order and every byte
+*					accounted for.
+*
+*		Notes:		Linux only. Build and run from the top directory:
+*
+*					gcc -o tsendq -I. tests/TSENDQ.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./tsendq
+*
+*					Prints "ok" and exits 0, or names the failed check
+*					and exits 1.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.1	  10/17/26		Initial Release
+*************************************************************************************/
+
+#include "NSSENDQ.h"
+#include <pthread.h>
+
+#define CHECK(x)	do { if ( !( x ) ) { fprintf ( stderr, "%s:%d: %s\n", __FILE__, __LINE__, #x ); exit ( 1 ); } } while ( 0 )
+
+#define PRODUCERS		4
+#define MESSAGES		50000		/* per producer */
+#define HIGH_WATER		( 64 * 1024L )
+#define LOW_WATER		( 16 * 1024L )
+
+/* a message: header, then length bytes of ( seq + producer ) */
+typedef struct test_message
+{
+	unsigned short			producer;
+	unsigned short			length;
+	unsigned int			seq;
+} TEST_MESSAGE;
+
+static TCP			*tcp;
+static TCP_CONNECTION_INFO	*queued;
+static pthread_t		 owner;
+static int			 drained;
+static int			 drained_wrong;
+static int			 highs;
+static int			 producers_done;
+static long			 pushed;
+
+
+static void Drained ( TCP_CONNECTION_INFO *connection, void *context )
+{
+	CHECK ( connection == queued && context == &drained );
+	if ( !pthread_equal ( pthread_self ( ), owner ) || sendq_pending ( connection ) > LOW_WATER )
+		drained_wrong++;
+	drained++;
+}
+
+/* a connection with its socket one end of a socketpair */
+static TCP_CONNECTION_INFO *Open ( int *peer )
+{
+	TCP_CONNECTION_INFO	*connection = tcp->get_conn_info ( );
+	int			 sv[2];
+
+	CHECK ( socketpair ( AF_UNIX, SOCK_STREAM, 0, sv ) == 0 );
+	connection->sock_num = sv[0];
+	connection->sock = &connection->sock_num;
+	*peer = sv[1];
+	return connection;
+}
+
+static void Close ( TCP_CONNECTION_INFO *connection, int peer )
+{
+	tcp->close_sock ( connection );
+	tcp->clean_conn_info ( connection );
+	close ( peer );
+}
+
+/* reads whatever the peer has, without waiting */
+static long Discard ( int peer )
+{
+	char	buffer[65536];
+	long	total = 0;
+	long	n;
+
+	while ( ( n = recv ( peer, buffer, sizeof ( buffer ), MSG_DONTWAIT ) ) > 0 )
+		total += n;
+	return total;
+}
+
+/* the flags and on_drained, one push at a time */
+static void Test_Levels ( void )
+{
+	char	message[400];
+	int	peer;
+	char	junk[4096];
+
+	memset ( message, 'x', sizeof ( message ) );
+	memset ( junk, 'j', sizeof ( junk ) );
+	queued = Open ( &peer );
+	owner = pthread_self ( );
+	drained = 0;
+	CHECK ( tcp->set_send_queue ( queued, 10, 20, 0, 0 ) == -1 );
+	CHECK ( tcp->set_send_queue ( queued, 1000, 300, Drained, &drained ) == 0 );
+
+	CHECK ( sendq_push ( queued, message, 400 ) == TCP_SENDQ_FIRST );
+	CHECK ( sendq_push ( queued, message, 400 ) == 0 );
+	CHECK ( sendq_push ( queued, message, 400 ) == TCP_SENDQ_HIGH );
+	CHECK ( sendq_push ( queued, message, 100 ) == TCP_SENDQ_HIGH );
+	CHECK ( sendq_pending ( queued ) == 1300 );
+
+	CHECK ( sendq_flush ( queued ) == 1300 );
+	CHECK ( sendq_pending ( queued ) == 0 && drained == 1 && !drained_wrong );
+	CHECK ( Discard ( peer ) == 1300 );
+
+	/* below high_water: no call */
+	CHECK ( sendq_push ( queued, message, 400 ) == TCP_SENDQ_FIRST );
+	CHECK ( sendq_flush ( queued ) == 400 );
+	CHECK ( drained == 1 );
+	CHECK ( Discard ( peer ) == 400 );
+
+	/* a full socket: flush takes nothing, nothing is counted off */
+	fcntl ( *queued->sock, F_SETFL, fcntl ( *queued->sock, F_GETFL ) | O_NONBLOCK );
+	while ( send ( *queued->sock, junk, sizeof ( junk ), 0 ) > 0 )
+		;
+	CHECK ( sendq_push ( queued, message, 400 ) == TCP_SENDQ_FIRST );
+	CHECK ( sendq_push ( queued, message, 400 ) == 0 );
+	CHECK ( sendq_push ( queued, message, 400 ) == TCP_SENDQ_HIGH );
+	CHECK ( sendq_flush ( queued ) == 0 );
+	CHECK ( sendq_pending ( queued ) == 1200 && drained == 1 );
+
+	Discard ( peer );
+	CHECK ( sendq_flush ( queued ) == 1200 );
+	CHECK ( sendq_pending ( queued ) == 0 && drained == 2 && !drained_wrong );
+
+	Close ( queued, peer );
+}
+
+static void *Producer ( void *arg )
+{
+	char		 message[sizeof ( TEST_MESSAGE ) + 512];
+	TEST_MESSAGE	 header;
+	unsigned	 seq;
+	long		 bytes = 0;
+	int		 high = 0;
+	int		 result;
+
+	header.producer = ( unsigned short ) ( long ) arg;
+	for ( seq = 0; seq < MESSAGES; seq++ )
+	{
+		header.seq = seq;
+		header.length = ( unsigned short ) ( ( seq * 7 + header.producer * 13 ) % 512 );
+		memcpy ( message, &header, sizeof ( header ) );
+		memset ( message + sizeof ( header ), ( int ) ( ( seq + header.producer ) & 0xff ), header.length );
+
+		result = sendq_push ( queued, message, sizeof ( header ) + header.length );
+		CHECK ( result >= 0 );
+		bytes += sizeof ( header ) + header.length;
+		if ( result & TCP_SENDQ_HIGH )
+		{
+			high++;
+			while ( sendq_pending ( queued ) > HIGH_WATER )
+				sched_yield ( );
+		}
+	}
+
+	__atomic_add_fetch ( &pushed, bytes, __ATOMIC_RELAXED );
+	__atomic_add_fetch ( &highs, high, __ATOMIC_RELAXED );
+	__atomic_add_fetch ( &producers_done, 1, __ATOMIC_RELEASE );
+	return 0;
+}
+
+/* the peer end: checks every message and counts the bytes */
+static void *Reader ( void *arg )
+{
+	static char	 buffer[65536 + sizeof ( TEST_MESSAGE ) + 512];
+	unsigned	 next[PRODUCERS] = { 0 };
+	TEST_MESSAGE	 header;
+	long		*received = ( long * ) arg;
+	long		 have = 0;
+	long		 used;
+	long		 n;
+	int		 peer = ( int ) *received;
+	int		 i;
+
+	*received = 0;
+	while ( ( n = recv ( peer, buffer + have, 65536, 0 ) ) > 0 )
+	{
+		*received += n;
+		have += n;
+		used = 0;
+		while ( have - used >= ( long ) sizeof ( header ) )
+		{
+			memcpy ( &header, buffer + used, sizeof ( header ) );
+			if ( have - used < ( long ) sizeof ( header ) + header.length )
+				break;
+			CHECK ( header.producer < PRODUCERS && header.seq == next[header.producer] );
+			next[header.producer]++;
+			for ( i = 0; i < header.length; i++ )
+				CHECK ( ( unsigned char ) buffer[used + sizeof ( header ) + i] == ( ( header.seq + header.producer ) & 0xff ) );
+			used += sizeof ( header ) + header.length;
+		}
+		memmove ( buffer, buffer + used, have - used );
+		have -= used;
+	}
+	CHECK ( n == 0 && have == 0 );
+	for ( i = 0; i < PRODUCERS; i++ )
+		CHECK ( next[i] == MESSAGES );
+	return 0;
+}
+
+/* producers on their own threads, this thread the owner */
+static void Test_Producers ( void )
+{
+	pthread_t	threads[PRODUCERS];
+	pthread_t	reader;
+	long		received;
+	long		flushed = 0;
+	long		n;
+	int		peer;
+	int		i;
+
+	queued = Open ( &peer );
+	owner = pthread_self ( );
+	drained = 0;
+	CHECK ( tcp->set_send_queue ( queued, HIGH_WATER, LOW_WATER, Drained, &drained ) == 0 );
+	fcntl ( *queued->sock, F_SETFL, fcntl ( *queued->sock, F_GETFL ) | O_NONBLOCK );
+
+	received = peer;
+	pthread_create ( &reader, 0, Reader, &received );
+	for ( i = 0; i < PRODUCERS; i++ )
+		pthread_create ( &threads[i], 0, Producer, ( void * ) ( long ) i );
+
+	while ( __atomic_load_n ( &producers_done, __ATOMIC_ACQUIRE ) < PRODUCERS || sendq_pending ( queued ) )
+	{
+		n = sendq_flush ( queued );
+		CHECK ( n >= 0 && sendq_pending ( queued ) >= 0 );
+		flushed += n;
+		if ( !n )
+			sched_yield ( );
+	}
+	for ( i = 0; i < PRODUCERS; i++ )
+		pthread_join ( threads[i], 0 );
+	shutdown ( *queued->sock, SHUT_WR );
+	pthread_join ( reader, 0 );
+
+	CHECK ( flushed == pushed && received == pushed );
+	CHECK ( sendq_pending ( queued ) == 0 );
+	CHECK ( highs > 0 && drained > 0 && drained <= highs && !drained_wrong );
+
+	Close ( queued, peer );
+}
+
+int main ( void )
+{
+	tcp = intialize_tcp ( );
+	CHECK ( tcp );
+
+	Test_Levels ( );
+	Test_Producers ( );
+
+	release_tcp ( tcp );
+	puts ( "ok" );
+	return 0;
+}
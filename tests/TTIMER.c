@@ -0,0 +1,268 @@
+/************************************************************************************
+*		FILE:		"ttimer.c"
+*
+*		AUTHOR:		NonStop-NetTools contributors
+*		DATE:		17 - OCT - 2026
+*		LICENSE:	MIT License
+*
+*		Purpose:	Tests of the timing wheel (nstimer.c): timers on
+*					every level fire once, on their own tick, as they
+*					cascade down; cancelled and re-armed ones (before
+*					and after a cascade, and from other timers'
+*					callbacks in the same tick) never fire early, late
+*					or twice. Then timer_deadline on a socketpair read,
+*					blocking forever unless the deadline ends it with
+*					TCP_ETIMEDOUT, and cancelled once the data arrives.
+*
+*		Notes:		Linux only. Build and run from the top directory:
+*
+*					gcc -o ttimer -I. tests/TTIMER.c NSTCP.c NSLINUX.c NSURING.c \
+*						NSCTAB.c NSFRAME.c NSCORK.c NSSHARD.c NSSTATS.c NSTIMER.c \
+*						NSDNS.c NSSENDQ.c NSPIPE.c NSCPOOL.c NSZCOPY.c \
+*						NSSTRIP.c NSCAPT.c NSTUNE.c NSSPIN.c -lpthread
+*					./ttimer [engine]
+*
+*					Prints "ok" and exits 0, or names the failed check
+*					and exits 1.
+*
+*					Waiting out the higher levels would take hours, so
+*					the wheel's clock is wound forward instead: the
+*					thread's wheel is found from where a level-0 timer
+*					is filed, and its origin_usec moved back.
+*
+*		REVISIONS:
+*		VERSION		DATE	     COMMENTS
+*		-------    ------       ---------------------------------------------------
+*		1.25.1	  10/17/26		Initial Release
+*************************************************************************************/
+
+#include "NSTIMER.h"
+#include <stddef.h>
+
+#define CHECK(x)	do { if ( !( x ) ) { fprintf ( stderr, "%s:%d: %s\n", __FILE__, __LINE__, #x ); exit ( 1 ); } } while ( 0 )
+
+#define TIMERS			3000
+#define LEVEL_TICKS(level)	( 1LL << ( ( level ) * TCP_TIMER_SLOT_BITS ) )
+
+static TCP_TIMER_WHEEL		*wheel;
+static TCP_TIMER		 timers[TIMERS];
+static long long		 expect[TIMERS];		/* tick due, -1 if it mustn't fire */
+static int			 fired[TIMERS];
+static int			 late;				/* fired off its tick */
+
+
+/* the thread's wheel, from the slot a timer one tick out lands in */
+static TCP_TIMER_WHEEL *Find_Wheel ( void )
+{
+	TCP_TIMER	 probe;
+	char		*slot;
+
+	timer_init ( &probe, 0, 0 );
+	CHECK ( timer_arm ( &probe, TCP_TIMER_TICK_USEC ) == 0 );
+	slot = ( char * ) probe.link - ( probe.expires & ( TCP_TIMER_SLOTS - 1 ) ) * sizeof ( TCP_TIMER * );
+	timer_cancel ( &probe );
+	return ( TCP_TIMER_WHEEL * ) ( slot - offsetof ( TCP_TIMER_WHEEL, slots ) );
+}
+
+/* winds the wheel's clock on by ticks and runs it */
+static int Advance ( long long ticks )
+{
+	wheel->origin_usec -= ticks * TCP_TIMER_TICK_USEC;
+	return timer_run ( );
+}
+
+/* the tick being run is the one before now_tick */
+static void Fire ( TCP_TIMER *timer, void *context )
+{
+	int index = ( int ) ( long ) context;
+
+	( void ) timer;
+	fired[index]++;
+	if ( wheel->now_tick - 1 != expect[index] )
+		late++;
+}
+
+/* arms (or moves) timer i ticks out and notes when it is due; a
+*  tick the wheel has already run fires on the next one */
+static void Arm ( int i, long long ticks )
+{
+	if ( !timer_armed ( &timers[i] ) )
+		timer_init ( &timers[i], Fire, ( void * ) ( long ) i );
+	CHECK ( timer_arm ( &timers[i], ( long ) ( ticks * TCP_TIMER_TICK_USEC ) ) == 0 );
+	expect[i] = timers[i].expires;
+	CHECK ( expect[i] >= wheel->now_tick - 1 + ticks );
+	if ( expect[i] < wheel->now_tick )
+		expect[i] = wheel->now_tick;
+}
+
+/* runs the wheel past the last expected tick, in uneven steps */
+static void Run_Out ( void )
+{
+	long long	 last = 0;
+	long		 step = 1;
+	int		 i;
+
+	for ( i = 0; i < TIMERS; i++ )
+		if ( expect[i] > last )
+			last = expect[i];
+	while ( wheel->now_tick <= last + 1 )
+	{
+		Advance ( step );
+		step = step * 7 % 100003 + 1;
+	}
+	CHECK ( timer_due ( ) == -1 && wheel->count == 0 );
+}
+
+/* timers on every level, armed at uneven points of the wheel */
+static void Test_Cascade ( void )
+{
+	static const long long edges[] = { 0, 1, 255, 256, 257, 511, 65535, 65536, 65537, 16777215, 16777216, 16777217 };
+	long	 early = 0;
+	int	 i;
+
+	memset ( fired, 0, sizeof ( fired ) );
+	late = 0;
+
+	Advance ( 77 );
+	for ( i = 0; i < TIMERS; i++ )
+	{
+		if ( i < ( int ) ( sizeof ( edges ) / sizeof ( edges[0] ) ) )
+			Arm ( i, edges[i] );
+		else
+			Arm ( i, ( i * 7919LL ) % LEVEL_TICKS ( 1 + i % 3 ) );
+		/* move on a little now and then so the timers don't share a base */
+		if ( i % 500 == 499 )
+			Advance ( 1 + i % 300 );
+	}
+	for ( i = 0; i < TIMERS; i++ )
+		early += fired[i];
+	CHECK ( wheel->count == TIMERS - early );
+
+	Run_Out ( );
+	for ( i = 0; i < TIMERS; i++ )
+		CHECK ( fired[i] == 1 );
+	CHECK ( !late );
+}
+
+/* a callback that cancels the next timer and re-arms the one after */
+static void Meddle ( TCP_TIMER *timer, void *context )
+{
+	int index = ( int ) ( long ) context;
+
+	Fire ( timer, context );
+	timer_cancel ( &timers[index + 1] );
+	expect[index + 1] = -1;
+	timer_arm ( &timers[index + 2], 3 * TCP_TIMER_TICK_USEC );
+	expect[index + 2] = timers[index + 2].expires;
+}
+
+/* cancels and re-arms, on every level and after cascades */
+static void Test_Cancel ( void )
+{
+	int i;
+
+	memset ( fired, 0, sizeof ( fired ) );
+	late = 0;
+
+	for ( i = 0; i < TIMERS; i++ )
+		Arm ( i, 1 + ( i * 104729LL ) % LEVEL_TICKS ( 1 + i % 3 ) );
+
+	/* a third cancelled at once, twice over (the second is a no-op) */
+	for ( i = 0; i < TIMERS; i += 3 )
+	{
+		timer_cancel ( &timers[i] );
+		timer_cancel ( &timers[i] );
+		CHECK ( !timer_armed ( &timers[i] ) );
+		expect[i] = -1;
+	}
+	CHECK ( wheel->count == TIMERS - ( TIMERS + 2 ) / 3 );
+
+	/* past a few cascades, then cancel another third and move the rest */
+	Advance ( 70000 );
+	for ( i = 1; i < TIMERS; i += 3 )
+		if ( !fired[i] )
+		{
+			CHECK ( timer_armed ( &timers[i] ) );
+			timer_cancel ( &timers[i] );
+			expect[i] = -1;
+		}
+	for ( i = 2; i < TIMERS; i += 3 )
+		if ( !fired[i] && i % 2 )
+			Arm ( i, 1 + i % 40000 );
+
+	/* three timers on one tick: the first cancels the second and
+	*  re-arms the third while the tick's list is being run */
+	for ( i = 0; i < 3; i++ )
+		timer_cancel ( &timers[i] );
+	timer_init ( &timers[0], Meddle, ( void * ) 0L );
+	timer_init ( &timers[1], Fire, ( void * ) 1L );
+	timer_init ( &timers[2], Fire, ( void * ) 2L );
+	fired[0] = fired[1] = fired[2] = 0;
+	CHECK ( timer_arm ( &timers[2], 5 * TCP_TIMER_TICK_USEC ) == 0 );
+	CHECK ( timer_arm ( &timers[1], 5 * TCP_TIMER_TICK_USEC ) == 0 );
+	CHECK ( timer_arm ( &timers[0], 5 * TCP_TIMER_TICK_USEC ) == 0 );
+	expect[0] = expect[1] = expect[2] = timers[0].expires;
+	CHECK ( timers[1].expires == expect[0] && timers[2].expires == expect[0] );
+
+	Run_Out ( );
+	for ( i = 0; i < TIMERS; i++ )
+		CHECK ( fired[i] == ( expect[i] >= 0 ) );
+	CHECK ( !late );
+}
+
+/* timer_deadline on a read that never completes, and on one that does */
+static void Test_Deadline ( TCP *tcp )
+{
+	TCP_COMPLETION	 completion;
+	TCP_TIMER	 deadline;
+	char		 buffer[16];
+	int		 sv[2];
+	int		 reaped;
+
+	CHECK ( socketpair ( AF_UNIX, SOCK_STREAM, 0, sv ) == 0 );
+	timer_init ( &deadline, 0, 0 );
+
+	CHECK ( recv_nw ( sv[0], buffer, sizeof ( buffer ), 0, 11 ) == 0 );
+	CHECK ( tcp->timer_deadline ( &deadline, sv[0], 11, 30000 ) == 0 );
+	do
+		reaped = tcp->reap_completions ( &completion, 1, 100 );
+	while ( reaped == 0 );
+	CHECK ( reaped == 1 && completion.tag == 11 && completion.error == TCP_ETIMEDOUT );
+	CHECK ( !timer_armed ( &deadline ) );
+
+	CHECK ( recv_nw ( sv[0], buffer, sizeof ( buffer ), 0, 12 ) == 0 );
+	CHECK ( tcp->timer_deadline ( &deadline, sv[0], 12, 50000 ) == 0 );
+	CHECK ( write ( sv[1], "abc", 3 ) == 3 );
+	do
+		reaped = tcp->reap_completions ( &completion, 1, 100 );
+	while ( reaped == 0 );
+	CHECK ( reaped == 1 && completion.tag == 12 && !completion.error && completion.count == 3 );
+	tcp->timer_cancel ( &deadline );
+
+	/* nothing comes back for it later */
+	usleep ( 80000 );
+	CHECK ( tcp->reap_completions ( &completion, 1, 0 ) <= 0 );
+
+	close ( sv[0] );
+	close ( sv[1] );
+}
+
+int main ( int argc, char **argv )
+{
+	TCP *tcp;
+
+	tcp = intialize_tcp_engine ( argc > 1 ? atoi ( argv[1] ) : TCP_ENGINE_DEFAULT );
+	CHECK ( tcp );
+
+	wheel = Find_Wheel ( );
+	CHECK ( wheel->count == 0 );
+	Test_Cascade ( );
+	Test_Cancel ( );
+
+	/* back to the real clock's pace for the socket test */
+	Test_Deadline ( tcp );
+
+	release_tcp ( tcp );
+	puts ( "ok" );
+	return 0;
+}